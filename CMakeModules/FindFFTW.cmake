@@ -0,0 +1,54 @@
+#
+# Find FFTW3 includes and libraries with MPI support
+#
+# The following variables will be set if FFTW is found:
+#
+# FFTW_INCLUDE_DIR	where to find fftw3-mpi.h
+# FFTW_LIBRARY		FFTW library to link against
+# FFTW_MPI_LIBRARY	FFTW MPI library to link against
+# FFTW_LIBRARIES	FFTW libraries required for linking
+# FFTW_FOUND		set to True if FFTW was found
+#
+
+if( DEFINED ENV{FFTW_ROOT_DIR} )
+  set( FFTW_ROOT_DIR $ENV{FFTW_ROOT_DIR} )
+elseif( DEFINED ENV{FFTW_DIR} )
+  set( FFTW_ROOT_DIR $ENV{FFTW_DIR} )
+elseif( DEFINED ENV{FFTW_HOME} )
+  set( FFTW_ROOT_DIR $ENV{FFTW_HOME} )
+elseif( DEFINED ENV{FFTW_PREFIX} )
+  set( FFTW_ROOT_DIR $ENV{FFTW_PREFIX} )
+else()
+  set( FFTW_ROOT_DIR "/usr" )
+endif()
+
+find_path( FFTW_INCLUDE_DIR fftw3-mpi.h
+  HINTS ${FFTW_ROOT_DIR}/include $ENV{FFTW_INCLUDE_PATH} $ENV{FFTW_INCLUDE_DIR}
+  PATHS ENV C_INCLUDE_PATH
+  )
+
+find_library( FFTW_MPI_LIBRARY fftw3_mpi
+  HINTS ${FFTW_ROOT_DIR}/lib $ENV{FFTW_LIBRARY_PATH} $ENV{FFTW_LIBRARY_DIR}
+  PATHS ENV LIBRARY_PATH
+  )
+
+find_library( FFTW_LIBRARY fftw3
+  HINTS ${FFTW_ROOT_DIR}/lib $ENV{FFTW_LIBRARY_PATH} $ENV{FFTW_LIBRARY_DIR}
+  PATHS ENV LIBRARY_PATH
+  )
+
+if( FFTW_INCLUDE_DIR AND FFTW_MPI_LIBRARY AND FFTW_LIBRARY )
+  set( FFTW_FOUND "YES" )
+  set( FFTW_LIBRARIES ${FFTW_MPI_LIBRARY} ${FFTW_LIBRARY} )
+endif()
+
+if( FFTW_FOUND )
+  if( NOT FFTW_FIND_QUIETLY )
+    message( STATUS "Found FFTW libraries: ${FFTW_LIBRARIES}")
+    message( STATUS "Found FFTW include dir: ${FFTW_INCLUDE_DIR}")
+  endif()
+else()
+  if( FFTW_FIND_REQUIRED )
+    message( FATAL_ERROR "Could not find FFTW with MPI support!" )
+  endif()
+endif()
@@ -90,18 +90,34 @@ CommMPI::CommMPI(int& argc , char**& argv, int procs, bool mpiinit, MPI_Comm mpi
         execname = strdup(currtok);
     }
 
+    // the application may write data with a background thread which
+    // calls MPI as well
+    bool threadMultiple = false;
+    for (i = 1; i < argc; ++ i) {
+        if (strcmp(argv[i], "--mpithreadmultiple") == 0)
+            threadMultiple = true;
+    }
+
     // initialize mpi
     if (weInitialized) {
 #ifdef _OPENMP
         int provided = 0;
-        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        int required = threadMultiple ? MPI_THREAD_MULTIPLE : MPI_THREAD_FUNNELED;
+        MPI_Init_thread(&argc, &argv, required, &provided);
         INFOMSG("Ippl will be initialized with " <<
                 omp_get_max_threads() << " OMP threads\n");
 
-        if ( provided != MPI_THREAD_FUNNELED )
+        if ( provided < required )
             ERRORMSG("CommMPI: Didn't get requested MPI-OpenMP setting.\n");
 #else
-        MPI_Init(&argc, &argv);
+        if (threadMultiple) {
+            int provided = 0;
+            MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+            if ( provided < MPI_THREAD_MULTIPLE )
+                ERRORMSG("CommMPI: Didn't get requested MPI thread support.\n");
+        } else {
+            MPI_Init(&argc, &argv);
+        }
 #endif
     }
     //else
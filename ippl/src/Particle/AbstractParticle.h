@@ -22,9 +22,9 @@
 #define ABSTRACT_PARTICLE_H
 
 #include "Particle/ParticleLayout.h"
+#include "Particle/ParticleAttribBase.h"
 
 template<class T> class ParticleAttrib;
-class ParticleAttribBase;
 
 template <class T, unsigned Dim>
 class AbstractParticle {
@@ -37,6 +37,7 @@ public:
     typedef ParticleAttrib<Index_t>             ParticleIndex_t;
     typedef typename ParticleLayout<T, Dim>::UpdateFlags UpdateFlags;
     typedef typename ParticleLayout<T, Dim>::Position_t Position_t;
+    typedef ParticleAttribBase::SortList_t SortList_t;
     typedef ParticleLayout<T, Dim> Layout_t;
 
 public:
@@ -88,6 +89,8 @@ public:
 
     virtual void ghostDestroy(size_t M, size_t I) = 0;
 
+    virtual void permute(const SortList_t& order) = 0;
+
 public:
     ParticlePos_t* R_p;
     ParticleIndex_t* ID_p;
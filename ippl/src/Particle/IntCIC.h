@@ -19,6 +19,7 @@
 // include files
 #include "Particle/Interpolator.h"
 #include "Field/Field.h"
+#include "Particle/IntCICTiled.h"
 
 
 // forward declaration
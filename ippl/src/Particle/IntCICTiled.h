@@ -0,0 +1,291 @@
+// -*- C++ -*-
+/***************************************************************************
+ *
+ * The IPPL Framework
+ *
+ *
+ * Visit http://people.web.psi.ch/adelmann/ for more details
+ *
+ ***************************************************************************/
+
+#ifndef INT_CIC_TILED_H
+#define INT_CIC_TILED_H
+
+/* IntCICTiled.h -- Threaded cloud-in-cell scatter of all local particles
+   of an attribute onto a 3D Field.
+
+   The particles are binned by the block of z-planes which contains the
+   lower corner of their cell (stable counting sort). Each thread deposits
+   the particles of one block into a private tile which spans the planes of
+   the block plus the plane above it, and adds the tile to the Field data
+   afterwards. Neighbouring blocks overlap in one plane only, hence first
+   all even and then all odd blocks are processed; the tiles of one color
+   never touch the same element of the Field. The depth of the blocks only
+   depends on the size of the local domain, the result is therefore the
+   same for any number of threads.
+
+   Only Fields with a single LField per node are handled; the functions
+   return false, without touching the Field, if this is not the case or if
+   a particle is not within the local domain. The caller then has to use
+   the serial scatter of IntCIC.                                           */
+
+// include files
+#include "Particle/Interpolator.h"
+#include "Field/Field.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+template <class FT>
+class IntCICTiled {
+
+public:
+  // scatter particle data into Field using particle positions and mesh;
+  // the mesh information is stored in cache if it isn't a null pointer
+  template <class M, class C, class PT>
+  static
+  bool scatter(const FT* pdata, size_t n, Field<FT,3U,M,C>& f,
+               const Vektor<PT,3U>* ppos, const M& mesh,
+               CacheDataCIC<PT,3U>* cache) {
+    LField<FT,3U>* lf = getLField(f);
+    if (lf == nullptr)
+      return false;
+
+    Binning<PT> bins(*lf, n);
+    const long nl = n;
+    bool outside = false;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(||: outside)
+#endif
+    for (long i = 0; i < nl; ++i) {
+      CenteringTag<C> ctag;
+      Vektor<PT,3U> gpos, dpos, delta;
+      NDIndex<3U> ngp;
+      int lgpoff[3U];
+      // same arithmetic as in IntCICImpl<3U>::scatter
+      ngp = FindNGP(mesh, ppos[i], ctag);
+      FindPos(gpos, mesh, ngp, ctag);
+      FindDelta(delta, mesh, ngp, ctag);
+      for (unsigned d=0; d<3U; ++d) {
+        if (gpos(d) > ppos[i](d)) {
+          lgpoff[d] = -1;
+          gpos(d) = gpos(d) - delta(d);
+        }
+        else {
+          lgpoff[d] = 0;
+        }
+      }
+      dpos = ppos[i] - gpos;
+      dpos /= delta;
+      if (cache != nullptr) {
+        cache[i].Index_m = ngp;
+        for (unsigned d=0; d<3U; ++d)
+          cache[i].Offset_m[d] = lgpoff[d];
+        cache[i].Delta_m = dpos;
+      }
+      bins.dpos_m[i] = dpos;
+      outside = !bins.locate(i, ngp, lgpoff) || outside;
+    }
+    if (outside)
+      return false;
+
+    bins.sort();
+    const Vektor<PT,3U>* dpos = bins.dpos_m.data();
+    deposit(pdata, *lf, bins,
+            [dpos](size_t i) -> const Vektor<PT,3U>& { return dpos[i]; });
+    return true;
+  }
+
+  // scatter particle data into Field using cached mesh information; the
+  // cache provides the cell and the weights, only the binning is redone
+  template <class M, class C, class PT>
+  static
+  bool scatter(const FT* pdata, size_t n, Field<FT,3U,M,C>& f,
+               const CacheDataCIC<PT,3U>* cache) {
+    LField<FT,3U>* lf = getLField(f);
+    if (lf == nullptr)
+      return false;
+
+    Binning<PT> bins(*lf, n, false);
+    const long nl = n;
+    bool outside = false;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(||: outside)
+#endif
+    for (long i = 0; i < nl; ++i)
+      outside = !bins.locate(i, cache[i].Index_m, cache[i].Offset_m) || outside;
+    if (outside)
+      return false;
+
+    bins.sort();
+    deposit(pdata, *lf, bins,
+            [cache](size_t i) -> const Vektor<PT,3U>& { return cache[i].Delta_m; });
+    return true;
+  }
+
+private:
+  // target number of Field elements of a tile (2^15 doubles = 256 KiB)
+  static constexpr size_t tileSize_m = 32768;
+
+  // lower corners of the cells of the particles, relative to the allocated
+  // domain of the LField, and the permutation sorting them by block
+  template <class PT>
+  struct Binning {
+    Binning(LField<FT,3U>& lf, size_t n, bool withDelta = true):
+      alloc_m(lf.getAllocated()),
+      corner_m(n),
+      block_m(n),
+      order_m(n)
+    {
+      for (unsigned d=0; d<3U; ++d)
+        length_m[d] = alloc_m[d].length();
+      planeSize_m = static_cast<size_t>(length_m[0]) * length_m[1];
+      depth_m = std::max<long>(1, tileSize_m / std::max<size_t>(1, planeSize_m));
+      depth_m = std::min<long>(depth_m, std::max(1, length_m[2] - 1));
+      numBlocks_m = (std::max(1, length_m[2] - 1) + depth_m - 1) / depth_m;
+      if (withDelta)
+        dpos_m.resize(n);
+    }
+
+    // store the lower corner of particle i; false if a neighbour of the
+    // corner is not within the allocated domain
+    bool locate(size_t i, const NDIndex<3U>& ngp, const int lgpoff[3U]) {
+      int idx[3U];
+      for (unsigned d=0; d<3U; ++d) {
+        idx[d] = ngp[d].first() + lgpoff[d] - alloc_m[d].first();
+        if (idx[d] < 0 || idx[d] + 1 >= length_m[d])
+          return false;
+      }
+      corner_m[i] = idx[0] + length_m[0] * (idx[1] + static_cast<size_t>(length_m[1]) * idx[2]);
+      block_m[i] = idx[2] / depth_m;
+      return true;
+    }
+
+    // stable counting sort of the particles by block; the particles are
+    // split into one chunk per thread, each chunk is counted and placed
+    // independently
+    void sort() {
+      const size_t n = order_m.size();
+      int numChunks = 1;
+#ifdef _OPENMP
+      numChunks = omp_get_max_threads();
+#endif
+      std::vector<size_t> count(numChunks * numBlocks_m + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int c = 0; c < numChunks; ++c) {
+        size_t *ccount = &count[c * numBlocks_m];
+        for (size_t i = n * c / numChunks; i < n * (c + 1) / numChunks; ++i)
+          ++ ccount[block_m[i]];
+      }
+
+      // exclusive scan, block major such that the particles of a block
+      // keep their original order
+      begin_m.assign(numBlocks_m + 1, 0);
+      size_t sum = 0;
+      for (long b = 0; b < numBlocks_m; ++b) {
+        begin_m[b] = sum;
+        for (int c = 0; c < numChunks; ++c) {
+          size_t tmp = count[c * numBlocks_m + b];
+          count[c * numBlocks_m + b] = sum;
+          sum += tmp;
+        }
+      }
+      begin_m[numBlocks_m] = sum;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int c = 0; c < numChunks; ++c) {
+        size_t *ccount = &count[c * numBlocks_m];
+        for (size_t i = n * c / numChunks; i < n * (c + 1) / numChunks; ++i)
+          order_m[ccount[block_m[i]] ++] = i;
+      }
+    }
+
+    const NDIndex<3U>& alloc_m;
+    int length_m[3U];
+    size_t planeSize_m;
+    long depth_m;
+    long numBlocks_m;
+
+    std::vector<size_t> corner_m;
+    std::vector<long> block_m;
+    std::vector<size_t> order_m;
+    std::vector<size_t> begin_m;
+    std::vector<Vektor<PT,3U> > dpos_m;
+  };
+
+  template <class M, class C>
+  static
+  LField<FT,3U>* getLField(Field<FT,3U,M,C>& f) {
+    if (f.size_if() != 1 || (*f.begin_if()).second->IsCompressed())
+      return nullptr;
+    return (*f.begin_if()).second.get();
+  }
+
+  // deposit the particles block by block; delta(i) returns the distance
+  // of particle i to the lower corner of its cell, normalized by the mesh
+  // spacing
+  template <class PT, class Delta>
+  static
+  void deposit(const FT* pdata, LField<FT,3U>& lf, const Binning<PT>& bins,
+               const Delta& delta) {
+    FT* data = lf.getP();
+    const size_t sy = bins.length_m[0];
+    const size_t sz = bins.planeSize_m;
+    const long numPlanes = bins.length_m[2];
+
+    for (long color = 0; color < 2; ++color) {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+      {
+        std::vector<FT> tile((bins.depth_m + 1) * sz);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (long b = color; b < bins.numBlocks_m; b += 2) {
+          if (bins.begin_m[b] == bins.begin_m[b + 1])
+            continue;
+
+          const long firstPlane = b * bins.depth_m;
+          const long planes = std::min(bins.depth_m + 1, numPlanes - firstPlane);
+          const size_t tileOffset = firstPlane * sz;
+          std::fill(tile.begin(), tile.begin() + planes * sz, FT(0));
+
+          FT* t = tile.data();
+          for (size_t k = bins.begin_m[b]; k < bins.begin_m[b + 1]; ++k) {
+            const size_t i = bins.order_m[k];
+            const Vektor<PT,3U>& dpos = delta(i);
+            const FT& pd = pdata[i];
+            FT* c = t + (bins.corner_m[i] - tileOffset);
+            c[0]           += (1 - dpos(0)) * (1 - dpos(1)) * (1 - dpos(2)) * pd;
+            c[1]           += dpos(0) * (1 - dpos(1)) * (1 - dpos(2)) * pd;
+            c[sy]          += (1 - dpos(0)) * dpos(1) * (1 - dpos(2)) * pd;
+            c[sy + 1]      += dpos(0) * dpos(1) * (1 - dpos(2)) * pd;
+            c[sz]          += (1 - dpos(0)) * (1 - dpos(1)) * dpos(2) * pd;
+            c[sz + 1]      += dpos(0) * (1 - dpos(1)) * dpos(2) * pd;
+            c[sz + sy]     += (1 - dpos(0)) * dpos(1) * dpos(2) * pd;
+            c[sz + sy + 1] += dpos(0) * dpos(1) * dpos(2) * pd;
+          }
+
+          FT* target = data + tileOffset;
+          const size_t numElements = planes * sz;
+          for (size_t k = 0; k < numElements; ++k)
+            target[k] += t[k];
+        }
+      }
+    }
+  }
+};
+
+#endif // INT_CIC_TILED_H
@@ -307,6 +307,10 @@ public:
     // Apply the given sortlist to all the attributes.
     void sort(SortList_t &);
 
+    // Reorder all the attributes such that the new ith particle is the one
+    // currently at position order[i].
+    void permute(const SortList_t &order);
+
     //
     // Global operations on all ghost attributes ... generally, these should
     // only be used by the layout object
@@ -742,6 +742,17 @@ void IpplParticleBase<PLayout>::sort(SortList_t &sortlist) {
 }
 
 
+/////////////////////////////////////////////////////////////////////
+// Apply the given permutation to all the attributes.
+template<class PLayout>
+void IpplParticleBase<PLayout>::permute(const SortList_t &order) {
+  attrib_container_t::iterator abeg = AttribList.begin();
+  attrib_container_t::iterator aend = AttribList.end();
+  for ( ; abeg != aend; ++abeg )
+    (*abeg)->permute(order);
+}
+
+
 /////////////////////////////////////////////////////////////////////
 // print it out
 template<class PLayout>
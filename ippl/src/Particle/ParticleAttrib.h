@@ -83,10 +83,18 @@
 #include "Utility/Inform.h"
 #include "Utility/IpplStats.h"
 
+#include <type_traits>
 #include <vector>
 #include <utility>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // forward declarations
+class IntCIC;
+template <class FT> class IntCICTiled;
+template <class T, unsigned Dim> struct CacheDataCIC;
 template<class T, unsigned Dim> class Vektor;
 template<class T, unsigned Dim, class M, class C> class Field;
 template <class T> class ParticleAttribIterator;
@@ -147,6 +155,17 @@ public:
         return ParticleList[n];
     }
 
+    // pointer to the local elements; marks the attribute as dirty once,
+    // hence it can be used in threaded loops instead of operator[]
+    T* data() {
+        attributeIsDirty_ = true;
+        return ParticleList.data();
+    }
+
+    const T* data() const {
+        return ParticleList.data();
+    }
+
     typename ParticleList_t::const_reference
     operator[](size_t n) const {
         return ParticleList[n];
@@ -212,6 +231,17 @@ public:
         f.setGuardCells(zero);
 
         const M& mesh = f.get_mesh();
+        if constexpr (useTiledScatter<Dim, IntOp>()) {
+            if (useThreads() &&
+                IntCICTiled<T>::scatter(ParticleList.data(), LocalSize, f,
+                                        &pp[0], mesh,
+                                        static_cast<CacheDataCIC<PT,Dim>*>(nullptr))) {
+                f.accumGuardCells();
+                INCIPPLSTAT(incParticleScatters);
+                return;
+            }
+        }
+
         // iterate through ParticleAttrib data and call scatter operation
         typename ParticleList_t::const_iterator curr, last = ParticleList.begin()+LocalSize;
         typename ParticleAttrib< Vektor<PT,Dim> >::const_iterator ppiter=pp.cbegin();
@@ -243,6 +273,16 @@ public:
         f.setGuardCells(zero);
 
         const M& mesh = f.get_mesh();
+        if constexpr (useTiledScatter<Dim, IntOp>()) {
+            if (useThreads() &&
+                IntCICTiled<T>::scatter(ParticleList.data(), LocalSize, f,
+                                        &pp[0], mesh, &cache[0])) {
+                f.accumGuardCells();
+                INCIPPLSTAT(incParticleScatters);
+                return;
+            }
+        }
+
         // iterate through ParticleAttrib data and call scatter operation
         typename ParticleList_t::const_iterator curr, last = ParticleList.begin()+LocalSize;
         typename ParticleAttrib< Vektor<PT,Dim> >::const_iterator ppiter=pp.cbegin();
@@ -271,6 +311,15 @@ public:
         T zero = 0;
         f.setGuardCells(zero);
 
+        if constexpr (useTiledScatter<Dim, IntOp>()) {
+            if (useThreads() &&
+                IntCICTiled<T>::scatter(ParticleList.data(), LocalSize, f, &cache[0])) {
+                f.accumGuardCells();
+                INCIPPLSTAT(incParticleScatters);
+                return;
+            }
+        }
+
         // iterate through ParticleAttrib data and call scatter operation
         typename ParticleList_t::const_iterator curr, last = ParticleList.begin()+LocalSize;
         typename ParticleAttrib<CacheData>::const_iterator citer=cache.cbegin();
@@ -300,11 +349,14 @@ public:
             f.fillGuardCells(true);
 
         const M& mesh = f.get_mesh();
-        // iterate through ParticleAttrib data and call gather operation
-        typename ParticleList_t::iterator curr, last = ParticleList.begin()+LocalSize;
-        typename ParticleAttrib< Vektor<PT,Dim> >::const_iterator ppiter=pp.cbegin();
-        for (curr = ParticleList.begin(); curr != last; ++curr, ++ppiter)
-            IntOp::gather(*curr,f,*ppiter,mesh);
+        // iterate through ParticleAttrib data and call gather operation;
+        // the particles are independent of each other
+        const long localSize = LocalSize;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < localSize; ++i)
+            IntOp::gather(ParticleList[i],f,pp[i],mesh);
 
         // try to compress the Field again
         f.Compress();
@@ -331,12 +383,17 @@ public:
             f.fillGuardCells(true);
 
         const M& mesh = f.get_mesh();
-        // iterate through ParticleAttrib data and call gather operation
-        typename ParticleList_t::iterator curr, last = ParticleList.begin()+LocalSize;
-        typename ParticleAttrib< Vektor<PT,Dim> >::const_iterator ppiter=pp.cbegin();
-        typename ParticleAttrib<CacheData>::iterator citer=cache.begin();
-        for (curr=ParticleList.begin(); curr != last; ++curr,++ppiter,++citer)
-            IntOp::gather(*curr,f,*ppiter,mesh,*citer);
+        // iterate through ParticleAttrib data and call gather operation;
+        // the particles are independent of each other
+        // (the cache is written through a plain pointer such that it is
+        // marked as modified only once)
+        const long localSize = LocalSize;
+        CacheData* cacheData = (localSize > 0 ? &cache[0] : nullptr);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < localSize; ++i)
+            IntOp::gather(ParticleList[i],f,pp[i],mesh,cacheData[i]);
 
         // try to compress the Field again
         f.Compress();
@@ -359,11 +416,14 @@ public:
         if (f.isDirty())
             f.fillGuardCells(true);
 
-        // iterate through ParticleAttrib data and call gather operation
-        typename ParticleList_t::iterator curr, last = ParticleList.begin()+LocalSize;
-        typename ParticleAttrib<CacheData>::const_iterator citer=cache.cbegin();
-        for (curr = ParticleList.begin(); curr != last; ++curr, ++citer)
-            IntOp::gather(*curr,f,*citer);
+        // iterate through ParticleAttrib data and call gather operation;
+        // the particles are independent of each other
+        const long localSize = LocalSize;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < localSize; ++i)
+            IntOp::gather(ParticleList[i],f,cache[i]);
 
         // try to compress the Field again
         f.Compress();
@@ -488,6 +548,10 @@ public:
     // the sort-list temporarily, but it will return it in the same state.
     virtual void sort(SortList_t &slist);
 
+    // Reorder the local elements such that the new ith element is the one
+    // currently at position order[i].
+    virtual void permute(const SortList_t &order);
+
     //
     // other functions
     //
@@ -509,6 +573,23 @@ protected:
     size_t LocalSize;
 
 private:
+    // the cloud-in-cell scatter of scalar data onto 3D Fields is done by
+    // IntCICTiled if several threads are available
+    template <unsigned Dim, class IntOp>
+    static constexpr bool useTiledScatter() {
+        return (Dim == 3U &&
+                std::is_same<IntOp, IntCIC>::value &&
+                std::is_arithmetic<T>::value);
+    }
+
+    bool useThreads() const {
+#ifdef _OPENMP
+        return (LocalSize > 0 && omp_get_max_threads() > 1);
+#else
+        return false;
+#endif
+    }
+
     bool attributeIsDirty_;
 };
 
@@ -537,6 +537,29 @@ void ParticleAttrib<T>::sort(SortList_t &slist)
     }
 }
 
+/////////////////////////////////////////////////////////////////////
+// Reorder the local elements according to the given permutation.  The
+// elements are gathered into a temporary array, hence the permutation
+// is applied in a single pass.
+template<class T>
+void ParticleAttrib<T>::permute(const SortList_t &order)
+{
+    PAssert_EQ(order.size(), size());
+
+    const long mysize = size();
+    std::vector<T> tmp(mysize);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < mysize; ++i) {
+        PAssert_LT(order[i], mysize);
+        tmp[i] = ParticleList[order[i]];
+    }
+    std::copy(tmp.begin(), tmp.end(), ParticleList.begin());
+
+    attributeIsDirty_ = true;
+}
+
 //////////////////////////////////////////////////////////////////////
 // scatter functions
 //////////////////////////////////////////////////////////////////////
@@ -156,6 +156,11 @@ public:
   // the sort-list temporarily, but it will return it in the same state.
   virtual void sort(SortList_t &slist) = 0;
 
+  // Reorder the local elements such that the new ith element is the one
+  // currently at position order[i].  The list has to be a permutation of
+  // 0 ... localnum-1; in contrast to "sort" it is not modified.
+  virtual void permute(const SortList_t &order) = 0;
+
   // 
   //
   // other virtual functions
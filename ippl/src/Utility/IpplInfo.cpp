@@ -296,6 +296,9 @@ IpplInfo::IpplInfo(int& argc, char**& argv, int removeargs, MPI_Comm mpicomm) {
                 if ( (i + 1) < argc && argv[i+1][0] != '-' && atoi(argv[i+1]) > 0 )
                     ++i;
 
+            } else if ( ( strcmp(argv[i], "--mpithreadmultiple") == 0 ) ) {
+                // handled by CommMPI, nothing to do here but skip the arg
+
             } else if ( ( strcmp(argv[i], "--nocomminit") == 0 ) ) {
                 // handled above, nothing to do here but skip the arg
 
@@ -749,6 +752,7 @@ void IpplInfo::printHelp() {
     INFOMSG(CommCreator::getAllLibraryNames() << "\n");
     INFOMSG("   --nocomminit             : IPPL does not do communication\n");
     INFOMSG("                              initialization, assume already done.\n");
+    INFOMSG("   --mpithreadmultiple      : Initialize MPI with MPI_THREAD_MULTIPLE.\n");
     INFOMSG("   --connect <x>            : Select external connection method.\n");
     INFOMSG("                              <x> = ");
     INFOMSG(DataConnectCreator::getAllMethodNames() << "\n");
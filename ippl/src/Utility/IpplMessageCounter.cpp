@@ -36,6 +36,17 @@ void IpplMessageCounter::registerMessage(int size)
 		getActiveRegion()->registerMessage(size);
 }
 
+unsigned IpplMessageCounter::getTotalSize(const std::string &name) const
+{
+	unsigned total = 0;
+	for(unsigned int i=0;i<counterRegions.size();++i)
+	{
+		if(counterRegions[i]->getName() == name)
+			total += counterRegions[i]->getTotalSize();
+	}
+	return total;
+}
+
 IpplMessageCounterRegion::IpplMessageCounterRegion(const std::string &n)
  : name(n), count(0), total_size(0)
 {
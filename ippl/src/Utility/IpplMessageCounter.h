@@ -28,6 +28,9 @@ public:
 	void end();
 	void registerMessage(int);
 	void print(Inform&);
+	const std::string& getName() const { return name; }
+	unsigned getCount() const { return count; }
+	unsigned getTotalSize() const { return total_size; }
 private:
 	std::string name;
 	unsigned count;
@@ -52,6 +55,8 @@ public:
 	int addRegion(IpplMessageCounterRegion*);
 	
 	void registerMessage(int);
+	// bytes sent by this node in all regions with the given name, modulo 2^32
+	unsigned getTotalSize(const std::string&) const;
 	void on() { ison = true; }
 	void off() { ison = false; }
 	
@@ -15,15 +15,43 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
 
 Timing* IpplTimings::instance = new Timing();
 std::stack<Timing*> IpplTimings::stashedInstance;
 
+namespace {
+    std::atomic<unsigned int> numTimingInstances(0);
+
+    // the timer names are written as JSON strings
+    std::string escapeJSON(const std::string &str) {
+        std::ostringstream out;
+        for (char c: str) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(c) << std::dec;
+            } else {
+                out << c;
+            }
+        }
+        return out.str();
+    }
+}
+
 //////////////////////////////////////////////////////////////////////
 // default constructor
 Timing::Timing():
     TimerList(),
-    TimerMap()
+    TimerMap(),
+    tracing_m(false),
+    traceCapacity_m(0),
+    traceStep_m(-1),
+    traceFileCreated_m(false),
+    traceId_m(++ numTimingInstances)
 { }
 
 
@@ -63,7 +91,12 @@ Timing::TimerRef Timing::getTimer(const char *nm) {
 void Timing::startTimer(TimerRef t) {
     if (t >= TimerList.size())
         return;
-    TimerList[t]->start();
+    TimerInfo *tptr = TimerList[t].get();
+    if (tracing_m && !tptr->running) {
+        tptr->traceStart = getTraceTime();
+        tptr->traceStep = traceStep_m;
+    }
+    tptr->start();
 }
 
 
@@ -72,7 +105,11 @@ void Timing::startTimer(TimerRef t) {
 void Timing::stopTimer(TimerRef t) {
     if (t >= TimerList.size())
         return;
-    TimerList[t]->stop();
+    TimerInfo *tptr = TimerList[t].get();
+    if (tracing_m && tptr->running) {
+        traceInterval(*tptr, getTraceTime());
+    }
+    tptr->stop();
 }
 
 
@@ -247,6 +284,125 @@ void Timing::print(const std::string &fn, const std::map<std::string, unsigned i
     delete timer_stream;
 }
 
+//////////////////////////////////////////////////////////////////////
+// start recording the intervals of the timers; the size of the buffers
+// and the origin of the time are fixed by the first call
+void Timing::enableTracing(size_t numEvents) {
+    if (numEvents == 0) {
+        disableTracing();
+        return;
+    }
+
+    if (traceCapacity_m == 0) {
+        // align the origins of the nodes as good as possible
+        Ippl::Comm->barrier();
+        traceOrigin_m = std::chrono::steady_clock::now();
+        traceCapacity_m = numEvents;
+    }
+    tracing_m = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// stop recording, the recorded intervals are kept until writeTrace
+void Timing::disableTracing() {
+    tracing_m = false;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// get the ring buffer of the calling thread, create it on first use
+Timing::TraceBuffer *Timing::getTraceBuffer() {
+    thread_local TraceBuffer *buffer = nullptr;
+    thread_local unsigned int owner = 0;
+    if (owner != traceId_m) {
+        std::lock_guard<std::mutex> lock(traceMutex_m);
+        traceBuffers_m.emplace_back(new TraceBuffer());
+        buffer = traceBuffers_m.back().get();
+        buffer->events.resize(traceCapacity_m);
+        buffer->numRecorded = 0;
+        buffer->numWritten = 0;
+        buffer->thread = traceBuffers_m.size() - 1;
+        buffer->nameWritten = false;
+        owner = traceId_m;
+    }
+    return buffer;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// record the interval of a timer which is being stopped, the oldest
+// events are overwritten if the buffer is full
+void Timing::traceInterval(const TimerInfo &info, double stop) {
+    TraceBuffer *buffer = getTraceBuffer();
+    TraceEvent &event = buffer->events[buffer->numRecorded % traceCapacity_m];
+    event.start = info.traceStart;
+    event.duration = stop - info.traceStart;
+    event.step = info.traceStep;
+    event.timer = info.indx;
+    ++ buffer->numRecorded;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// append the recorded intervals in the Chrome trace event format to
+// basename-<node>.json. The file is a JSON array whose closing bracket
+// is omitted, which the trace viewers accept, such that the events can
+// be written periodically.
+void Timing::writeTrace(const std::string &basename) {
+    if (traceCapacity_m == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(traceMutex_m);
+
+    std::vector<std::string> names(TimerList.size());
+    for (const auto &timer: TimerList) {
+        names[timer->indx] = escapeJSON(timer->name);
+    }
+
+    const int node = Ippl::myNode();
+    std::string fn = basename + "-" + std::to_string(node) + ".json";
+    std::ofstream out(fn, traceFileCreated_m ? std::ios::app : std::ios::out);
+    out << std::setprecision(15);
+    if (!traceFileCreated_m) {
+        out << "[\n"
+            << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << node
+            << ", \"tid\": 0, \"args\": {\"name\": \"node " << node << "\"}},\n"
+            << "{\"name\": \"process_sort_index\", \"ph\": \"M\", \"pid\": " << node
+            << ", \"tid\": 0, \"args\": {\"sort_index\": " << node << "}},\n";
+        traceFileCreated_m = true;
+    }
+
+    for (auto &buffer: traceBuffers_m) {
+        if (!buffer->nameWritten) {
+            out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << node
+                << ", \"tid\": " << buffer->thread
+                << ", \"args\": {\"name\": \"thread " << buffer->thread << "\"}},\n";
+            buffer->nameWritten = true;
+        }
+
+        size_t first = buffer->numWritten;
+        if (buffer->numRecorded - first > traceCapacity_m) {
+            first = buffer->numRecorded - traceCapacity_m;
+            out << "{\"name\": \"" << buffer->numRecorded - buffer->numWritten - traceCapacity_m
+                << " events lost\", \"ph\": \"i\", \"s\": \"t\", \"pid\": " << node
+                << ", \"tid\": " << buffer->thread
+                << ", \"ts\": " << buffer->events[first % traceCapacity_m].start << "},\n";
+        }
+        for (size_t i = first; i < buffer->numRecorded; ++ i) {
+            const TraceEvent &event = buffer->events[i % traceCapacity_m];
+            out << "{\"name\": \"" << names[event.timer] << "\", \"cat\": \"timer\", \"ph\": \"X\""
+                << ", \"pid\": " << node
+                << ", \"tid\": " << buffer->thread
+                << ", \"ts\": " << event.start
+                << ", \"dur\": " << event.duration
+                << ", \"args\": {\"step\": " << event.step << "}},\n";
+        }
+        buffer->numWritten = buffer->numRecorded;
+    }
+}
+
+
 IpplTimings::IpplTimings() { }
 IpplTimings::~IpplTimings() { }
 
@@ -33,15 +33,32 @@
  *  4) print out the results:
  *     IpplTimings::print();
  *
+ *  Optionally the timers can record a timeline:
+ *     IpplTimings::enableTracing(numEvents);
+ *  Every time a timer is stopped an event with the begin and the duration
+ *  of the interval, the thread and the step set with
+ *  IpplTimings::setTraceStep is recorded into a ring buffer of the calling
+ *  thread, which keeps the last numEvents events. The size of the buffers
+ *  is fixed by the first call. IpplTimings::disableTracing() stops the
+ *  recording.
+ *     IpplTimings::writeTrace(basename);
+ *  appends the recorded events to the file basename-<node>.json in the
+ *  Chrome trace format, which can be viewed with chrome://tracing or
+ *  https://ui.perfetto.dev. When tracing is disabled the only overhead is
+ *  a test of a flag in startTimer and stopTimer.
+ *
  *************************************************************************/
 
 // include files
 #include "Utility/Timer.h"
 #include "Utility/my_auto_ptr.h"
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <limits>
 #include <stack>
 
@@ -57,7 +74,8 @@ public:
     typedef unsigned int TimerRef;
 
     // constructor
-    IpplTimerInfo() : name(""), cpuTime(0.0), wallTime(0.0), indx(std::numeric_limits<TimerRef>::max()) {
+    IpplTimerInfo() : name(""), cpuTime(0.0), wallTime(0.0), indx(std::numeric_limits<TimerRef>::max()),
+                      traceStart(0.0), traceStep(-1) {
         clear();
     }
 
@@ -114,6 +132,11 @@ public:
 
     // an index value for this timer
     TimerRef indx;
+
+    // begin of the running interval [us] and the step at that time, only
+    // set if tracing is enabled
+    double traceStart;
+    long long traceStep;
 };
 
 struct Timing
@@ -142,9 +165,10 @@ struct Timing
     // clear a timer, by turning it off and throwing away its time
     void clearTimer(TimerRef);
 
-    // return a TimerInfo struct by asking for the name
+    // return a TimerInfo struct by asking for the name, 0 if there is none
     TimerInfo *infoTimer(const char *nm) {
-        return TimerMap[std::string(nm)];
+        TimerMap_t::iterator loc = TimerMap.find(std::string(nm));
+        return loc == TimerMap.end() ? 0 : loc->second;
     }
 
     // print the results to standard out
@@ -154,17 +178,68 @@ struct Timing
     void print(const std::string &fn,
                const std::map<std::string, unsigned int> &problemSize);
 
+    // record the intervals of the timers, keep the last numEvents events
+    // per thread; 0 stops the recording
+    void enableTracing(size_t numEvents);
+
+    // stop recording the intervals of the timers
+    void disableTracing();
+
+    // the step which is attached to the recorded intervals
+    void setTraceStep(long long step) {
+        traceStep_m = step;
+    }
+
+    // append the recorded intervals to basename-<node>.json; has to be
+    // called while no other thread starts or stops timers
+    void writeTrace(const std::string &basename);
+
 
     // type of storage for list of TimerInfo
     typedef std::vector<my_auto_ptr<TimerInfo> > TimerList_t;
     typedef std::map<std::string, TimerInfo *> TimerMap_t;
 
 private:
+    struct TraceEvent {
+        double start;       // [us] since tracing was enabled
+        double duration;    // [us]
+        long long step;
+        TimerRef timer;
+    };
+
+    // ring buffer of one thread; only the owning thread writes to it
+    struct TraceBuffer {
+        std::vector<TraceEvent> events;
+        size_t numRecorded;
+        size_t numWritten;
+        unsigned int thread;
+        bool nameWritten;
+    };
+
+    double getTraceTime() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                         traceOrigin_m).count();
+    }
+
+    void traceInterval(const TimerInfo &info, double stop);
+    TraceBuffer *getTraceBuffer();
+
     // a list of timer info structs
     TimerList_t TimerList;
 
     // a map of timers, keyed by string
     TimerMap_t TimerMap;
+
+    bool tracing_m;
+    size_t traceCapacity_m;
+    long long traceStep_m;
+    std::chrono::steady_clock::time_point traceOrigin_m;
+    std::vector<std::unique_ptr<TraceBuffer> > traceBuffers_m;
+    std::mutex traceMutex_m;
+    bool traceFileCreated_m;
+
+    // identifies this instance in the thread local cache of the buffers
+    unsigned int traceId_m;
 };
 
 
@@ -198,7 +273,7 @@ public:
         instance->clearTimer(t);
     }
 
-    // return a TimerInfo struct by asking for the name
+    // return a TimerInfo struct by asking for the name, 0 if there is none
     static TimerInfo *infoTimer(const char *nm) {
         return instance->infoTimer(nm);
     }
@@ -214,6 +289,27 @@ public:
         instance->print(fn, problemSize);
     }
 
+    // record the intervals of the timers, keep the last numEvents events
+    // per thread; 0 stops the recording
+    static void enableTracing(size_t numEvents) {
+        instance->enableTracing(numEvents);
+    }
+
+    // stop recording the intervals of the timers
+    static void disableTracing() {
+        instance->disableTracing();
+    }
+
+    // the step which is attached to the recorded intervals
+    static void setTraceStep(long long step) {
+        instance->setTraceStep(step);
+    }
+
+    // append the recorded intervals to basename-<node>.json
+    static void writeTrace(const std::string &basename) {
+        instance->writeTrace(basename);
+    }
+
     static void stash();
     static void pop();
 
@@ -0,0 +1,162 @@
+// -*- C++ -*-
+/***************************************************************************
+ *
+ * The IPPL Framework
+ *
+ * This program was prepared by PSI.
+ * All rights in the program are reserved by PSI.
+ * Neither PSI nor the author(s)
+ * makes any warranty, express or implied, or assumes any liability or
+ * responsibility for the use of this software
+ *
+ *
+ ***************************************************************************/
+
+/***************************************************************************
+
+Compares the serial cloud-in-cell scatter of ParticleAttrib with the
+threaded, tiled scatter of IntCICTiled. The charge of randomly distributed
+particles is deposited a number of times with one thread (serial path) and
+with all available threads (tiled path), once computing the mesh
+information from the positions and once using the interpolation cache.
+The timings and the largest deviation of the charge densities are printed.
+
+Usage:
+
+ OMP_NUM_THREADS=8 mpirun -np 1 scatter-tiled-bench 64 64 64 1000000 10 --commlib mpi --info 5
+
+***************************************************************************/
+
+#include "Ippl.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+const unsigned Dim = 3;
+
+typedef ParticleSpatialLayout<double,Dim>                  playout_t;
+typedef playout_t::SingleParticlePos_t                     Vector_t;
+typedef UniformCartesian<Dim,double>                       Mesh_t;
+typedef Cell                                               Center_t;
+typedef CenteredFieldLayout<Dim, Mesh_t, Center_t>         FieldLayout_t;
+typedef Field<double, Dim, Mesh_t, Center_t>               Field_t;
+typedef IntCIC                                             IntrplCIC_t;
+typedef CacheDataCIC<double, Dim>                          Cache_t;
+
+class ChargedParticles : public IpplParticleBase<playout_t> {
+public:
+    ParticleAttrib<double>  qm;
+    ParticleAttrib<Cache_t> cache;
+
+    ChargedParticles(playout_t* pl):
+        IpplParticleBase<playout_t>(pl)
+    {
+        this->addAttribute(qm);
+        this->addAttribute(cache);
+    }
+};
+
+// deposit the charge nLoop times, either with one or with all threads
+void deposit(ChargedParticles& P, Field_t& rho, Field_t& rhoCached,
+             int nThreads, int nLoop, const std::string& label) {
+
+    IpplTimings::TimerRef scatterTimer = IpplTimings::getTimer(("scatter " + label).c_str());
+    IpplTimings::TimerRef cachedTimer = IpplTimings::getTimer(("scatter cached " + label).c_str());
+
+#ifdef _OPENMP
+    omp_set_num_threads(nThreads);
+#else
+    (void)nThreads;
+#endif
+
+    for (int i = 0; i < nLoop; ++i) {
+        rho = 0.0;
+        IpplTimings::startTimer(scatterTimer);
+        P.qm.scatter(rho, P.R, IntrplCIC_t());
+        IpplTimings::stopTimer(scatterTimer);
+    }
+
+    rhoCached = 0.0;
+    P.qm.scatter(rhoCached, P.R, IntrplCIC_t(), P.cache);
+    for (int i = 0; i < nLoop; ++i) {
+        rhoCached = 0.0;
+        IpplTimings::startTimer(cachedTimer);
+        P.qm.scatter(rhoCached, IntrplCIC_t(), P.cache);
+        IpplTimings::stopTimer(cachedTimer);
+    }
+}
+
+int main(int argc, char *argv[]){
+    Ippl ippl(argc, argv);
+    Inform msg(argv[0]);
+
+    if (argc < 6) {
+        msg << "usage: " << argv[0] << " nx ny nz np nloop" << endl;
+        return 1;
+    }
+
+    Vektor<int,Dim> nr;
+    for (unsigned d = 0; d < Dim; ++d)
+        nr[d] = atoi(argv[d + 1]);
+    const size_t totalP = atol(argv[4]);
+    const int nLoop = atoi(argv[5]);
+
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+
+    NDIndex<Dim> domain;
+    e_dim_tag decomp[Dim];
+    for (unsigned d = 0; d < Dim; ++d) {
+        domain[d] = Index(nr[d] + 1);
+        decomp[d] = (d == Dim - 1 ? PARALLEL : SERIAL);
+    }
+
+    Mesh_t mesh(domain);
+    FieldLayout_t FL(mesh, decomp);
+    playout_t* PL = new playout_t(FL, mesh);
+    ChargedParticles P(PL);
+
+    Field_t rhoSerial, rhoTiled, rhoSerialCached, rhoTiledCached;
+    rhoSerial.initialize(mesh, FL, GuardCellSizes<Dim>(1));
+    rhoTiled.initialize(mesh, FL, GuardCellSizes<Dim>(1));
+    rhoSerialCached.initialize(mesh, FL, GuardCellSizes<Dim>(1));
+    rhoTiledCached.initialize(mesh, FL, GuardCellSizes<Dim>(1));
+
+    // particles are created on every node and distributed by update()
+    const size_t localP = totalP / Ippl::getNodes();
+    std::mt19937_64 rng(42 + Ippl::myNode());
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    P.create(localP);
+    for (size_t i = 0; i < localP; ++i) {
+        for (unsigned d = 0; d < Dim; ++d)
+            P.R[i](d) = 0.5 + (nr[d] - 1) * uniform(rng);
+        P.qm[i] = 1.0;
+    }
+    P.update();
+
+    msg << "grid " << nr << ", " << totalP << " particles, "
+        << maxThreads << " threads" << endl;
+
+    deposit(P, rhoSerial, rhoSerialCached, 1, nLoop, "serial");
+    deposit(P, rhoTiled, rhoTiledCached, maxThreads, nLoop, "tiled");
+
+    double qSerial = sum(rhoSerial);
+    double diff = max(fabs(rhoTiled - rhoSerial));
+    double diffCached = max(fabs(rhoTiledCached - rhoSerialCached));
+
+    msg << "total charge " << qSerial << endl;
+    msg << "max |rho_tiled - rho_serial| = " << diff << endl;
+    msg << "max |rho_tiled - rho_serial| (cached) = " << diffCached << endl;
+
+    IpplTimings::print();
+
+    return 0;
+}
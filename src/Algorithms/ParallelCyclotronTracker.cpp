@@ -81,6 +81,7 @@
 #include "Utilities/OpalException.h"
 #include "Utilities/Options.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -127,6 +128,7 @@ ParallelCyclotronTracker::ParallelCyclotronTracker(const Beamline& beamline,
     , initialLocalNum_m(bunch->getLocalNum())
     , initialTotalNum_m(bunch->getTotalNum())
     , opalRing_m(nullptr)
+    , fieldFunction_m{this}
     , itsStepper_mp(nullptr)
     , mode_m(TrackingMode::UNDEFINED)
     , stepper_m(timeintegrator)
@@ -171,31 +173,33 @@ ParallelCyclotronTracker::~ParallelCyclotronTracker() {
 void ParallelCyclotronTracker::bgf_main_collision_test() {
     if (!bgf_m) return;
 
-    Inform msg("bgf_main_collision_test ");
-
     /**
      *Here we check if a particle is outside the domain, flag it for deletion
      */
-
-    Vector_t intecoords = 0.0;
+    const size_t localNum = itsBunch_m->getLocalNum();
+    if (localNum == 0) return;
 
     // This has to match the dT in the rk4 pusher
     double dtime = itsBunch_m->getdT() * getHarmonicNumber();
 
-    int triId = 0;
-    for (size_t i = 0; i < itsBunch_m->getLocalNum(); i++) {
-        int res = bgf_m->partInside(itsBunch_m->R[i], itsBunch_m->P[i],
-                                    dtime, intecoords, triId);
-        if (res >= 0) {
-            lossDs_m->addParticle(OpalParticle(itsBunch_m->ID[i],
-                                               itsBunch_m->R[i], itsBunch_m->P[i],
-                                               itsBunch_m->getT(),
-                                               itsBunch_m->Q[i], itsBunch_m->M[i]),
-                                  std::make_pair(turnnumber_m, itsBunch_m->bunchNum[i]));
-            itsBunch_m->Bin[i] = -1;
-            *gmsgALL << level4 << "* Particle " << itsBunch_m->ID[i]
-                     << " lost on boundary geometry" << endl;
-        }
+    const ParticleAttrib<Vector_t>& R = itsBunch_m->R;
+    const ParticleAttrib<Vector_t>& P = itsBunch_m->P;
+    std::vector<size_t> lost;
+    std::vector<Vector_t> intecoords;
+    std::vector<int> triIds;
+    bgf_m->partInside(localNum, &R[0], &P[0], dtime, lost, intecoords, triIds);
+
+    for (size_t i: lost) {
+        lossDs_m->addParticle(OpalParticle(itsBunch_m->ID[i],
+                                           itsBunch_m->R[i], itsBunch_m->P[i],
+                                           itsBunch_m->getT(),
+                                           itsBunch_m->Q[i], itsBunch_m->M[i]),
+                              std::make_pair(turnnumber_m, itsBunch_m->bunchNum[i]));
+        itsBunch_m->Bin[i] = -1;
+    }
+    if (!lost.empty()) {
+        *gmsgALL << level4 << "* " << lost.size()
+                 << " particle(s) lost on boundary geometry" << endl;
     }
 }
 
@@ -1174,17 +1178,10 @@ void ParallelCyclotronTracker::execute() {
     DumpFields::writeFields((((*FieldDimensions.begin())->second).second));
     DumpEMFields::writeFields((((*FieldDimensions.begin())->second).second));
 
-    function_t func = std::bind(&ParallelCyclotronTracker::getFieldsAtPoint,
-                                this,
-                                std::placeholders::_1,
-                                std::placeholders::_2,
-                                std::placeholders::_3,
-                                std::placeholders::_4);
-
     switch ( stepper_m ) {
         case Steppers::TimeIntegrator::LF2: {
             *gmsg << "* 2nd order Leap-Frog integrator" << endl;
-            itsStepper_mp.reset(new LF2<function_t>(func));
+            itsStepper_mp.reset(new LF2<function_t>(fieldFunction_m));
             break;
         }
         case Steppers::TimeIntegrator::MTS: {
@@ -1194,7 +1191,7 @@ void ParallelCyclotronTracker::execute() {
         case Steppers::TimeIntegrator::RK4:
         default: {
             *gmsg << "* 4th order Runge-Kutta integrator" << endl;
-            itsStepper_mp.reset(new RK4<function_t>(func));
+            itsStepper_mp.reset(new RK4<function_t>(fieldFunction_m));
             break;
         }
     }
@@ -1446,6 +1443,35 @@ bool ParallelCyclotronTracker::getFieldsAtPoint(const double& t, const size_t& P
 }
 
 
+void ParallelCyclotronTracker::getFieldsAtPoints(const double& t, const size_t* indices, size_t n,
+                                                 Vector_t* Efield, Vector_t* Bfield,
+                                                 bool* outOfBound) {
+
+    std::vector<Vector_t> R(n), P(n);
+    std::vector<double> times(n, t);
+    for (size_t k = 0; k < n; ++k) {
+        R[k] = itsBunch_m->R[indices[k]];
+        P[k] = itsBunch_m->P[indices[k]];
+    }
+
+    beamline_list::iterator sindex = FieldDimensions.begin();
+    (((*sindex)->second).second)->applyBatch(indices, n, R.data(), P.data(), times.data(),
+                                             Efield, Bfield, outOfBound);
+
+    const bool hasFieldSolver = itsBunch_m->hasFieldSolver();
+    for (size_t k = 0; k < n; ++k) {
+        Bfield[k] *= Units::kG2T;
+        Efield[k] *= Units::kV2V / Units::mm2m;
+
+        // Don't do for reference particle
+        const size_t Pindex = indices[k];
+        if (hasFieldSolver && itsBunch_m->ID[Pindex] != 0) {
+            Efield[k] += itsBunch_m->Ef[Pindex];
+            Bfield[k] += itsBunch_m->Bf[Pindex];
+        }
+    }
+}
+
 /**
  *
  *
@@ -1635,6 +1661,13 @@ void ParallelCyclotronTracker::repartition() {
         Ippl::Comm->barrier();
         IpplTimings::stopTimer(BinRepartTimer_m);
     }
+
+    // sort after the repartition such that the particles received from
+    // other nodes are put in order as well
+    if (mode_m == TrackingMode::BUNCH &&
+        Options::sortFreq > 0 && (step_m % Options::sortFreq) == 0) {
+        itsBunch_m->sortSpatially();
+    }
 }
 
 void ParallelCyclotronTracker::globalToLocal(ParticleAttrib<Vector_t>& particleVectors,
@@ -2870,6 +2903,9 @@ std::tuple<double, double, double> ParallelCyclotronTracker::initializeTracking_
     *gmsg << "* Single particle trajectory dump frequency is set to " << Options::sptDumpFreq << endl;
     *gmsg << "* The frequency to solve space charge fields is set to " << setup_m.scSolveFreq << endl;
     *gmsg << "* The repartition frequency is set to " << Options::repartFreq << endl;
+    if (Options::sortFreq > 0) {
+        *gmsg << "* The particle sort frequency is set to " << Options::sortFreq << endl;
+    }
 
     switch ( mode_m ) {
         case TrackingMode::SEO: {
@@ -3151,22 +3187,33 @@ void ParallelCyclotronTracker::bunchMode_m(double& t, const double dt, bool& fin
 
     IpplTimings::startTimer(IntegrationTimer_m);
 
-    for (size_t i = 0; i < itsBunch_m->getLocalNum(); i++) {
+    // the particles are integrated in blocks, the gap crossing is checked
+    // after each block
+    const size_t blockSize = Stepper<function_t>::blockSize_m;
+    const size_t localNum = itsBunch_m->getLocalNum();
+    Vector_t Rold[blockSize]; // [x,y,z]    (m)
+    Vector_t Pold[blockSize]; // [px,py,pz] (beta*gamma)
+    for (size_t first = 0; first < localNum; first += blockSize) {
+        const size_t last = std::min(first + blockSize, localNum);
 
         // used for gap crossing checking
-        Vector_t Rold = itsBunch_m->R[i]; // [x,y,z]    (m)
-        Vector_t Pold = itsBunch_m->P[i]; // [px,py,pz] (beta*gamma)
+        for (size_t i = first; i < last; i++) {
+            Rold[i - first] = itsBunch_m->R[i];
+            Pold[i - first] = itsBunch_m->P[i];
+        }
 
         // Integrate for one step in the lab Cartesian frame (absolute value).
-        itsStepper_mp->advance(itsBunch_m, i, t, dt);
+        itsStepper_mp->advanceBlock(itsBunch_m, first, last, t, dt);
 
-        // If gap crossing happens, do momenta kicking (not if gap crossing just happened)
-        if (itsBunch_m->cavityGapCrossed[i] == true) {
-            itsBunch_m->cavityGapCrossed[i] = false;
-        } else {
-            gapCrossKick_m(i, t, dt, Rold, Pold);
+        for (size_t i = first; i < last; i++) {
+            // If gap crossing happens, do momenta kicking (not if gap crossing just happened)
+            if (itsBunch_m->cavityGapCrossed[i] == true) {
+                itsBunch_m->cavityGapCrossed[i] = false;
+            } else {
+                gapCrossKick_m(i, t, dt, Rold[i - first], Pold[i - first]);
+            }
+            flagNeedUpdate |= (itsBunch_m->Bin[i] < 0);
         }
-        flagNeedUpdate |= (itsBunch_m->Bin[i] < 0);
     }
 
     IpplTimings::stopTimer(IntegrationTimer_m);
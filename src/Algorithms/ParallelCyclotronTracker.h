@@ -267,6 +267,10 @@ private:
 
     void GenericTracker();
     bool getFieldsAtPoint(const double& t, const size_t& Pindex, Vector_t& Efield, Vector_t& Bfield);
+    /// getFieldsAtPoint for the n particles indices[0], ..., indices[n - 1],
+    /// the field map is evaluated with one call of Component::applyBatch
+    void getFieldsAtPoints(const double& t, const size_t* indices, size_t n,
+                           Vector_t* Efield, Vector_t* Bfield, bool* outOfBound);
 
     /*
       Local Variables both used by the integration methods
@@ -342,6 +346,7 @@ private:
     Vector_t calcMeanP() const;
 
     void repartition(); // Do repartition between nodes if step_m is multiple of Options::repartFreq
+                        // and sort the particles if step_m is multiple of Options::sortFreq
 
     // Transform the x- and y-parts of a particle attribute (position, momentum, fields) from the
     // global reference frame to the local reference frame.
@@ -449,10 +454,23 @@ private:
     // cyclotron
     double getHarmonicNumber() const;
 
-    typedef std::function<bool(const double&,
-                               const size_t&,
-                               Vector_t&,
-                               Vector_t&)> function_t;
+    // calls getFieldsAtPoint; a named type instead of std::function such
+    // that the steppers can inline the field evaluation
+    struct function_t {
+        ParallelCyclotronTracker* tracker_m;
+
+        bool operator()(const double& t, const size_t& Pindex,
+                        Vector_t& Efield, Vector_t& Bfield) const {
+            return tracker_m->getFieldsAtPoint(t, Pindex, Efield, Bfield);
+        }
+
+        void operator()(const double& t, const size_t* indices, size_t n,
+                        Vector_t* Efield, Vector_t* Bfield, bool* outOfBound) const {
+            tracker_m->getFieldsAtPoints(t, indices, n, Efield, Bfield, outOfBound);
+        }
+    };
+
+    function_t fieldFunction_m;
 
     std::unique_ptr< Stepper<function_t> > itsStepper_mp;
 
@@ -21,14 +21,17 @@
 //
 #include "Algorithms/ParallelTTracker.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <fstream>
 #include <limits>
+#include <memory>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "AbsBeamline/Monitor.h"
 #include "AbstractObjects/OpalData.h"
@@ -57,6 +60,30 @@ extern Inform* gmsg;
 
 class PartData;
 
+namespace {
+    // combine the packed bunch states of two ranks: the first six entries
+    // are the minima and the negated maxima of the positions, the others
+    // are sums
+    void combineBunchState(void* in, void* inout, int* len, MPI_Datatype*) {
+        const double* a = static_cast<const double*>(in);
+        double* b = static_cast<double*>(inout);
+        for (int i = 0; i < 6; ++ i) {
+            b[i] = std::min(a[i], b[i]);
+        }
+        for (int i = 6; i < *len; ++ i) {
+            b[i] += a[i];
+        }
+    }
+
+    MPI_Op getBunchStateOp() {
+        static MPI_Op op = MPI_OP_NULL;
+        if (op == MPI_OP_NULL) {
+            MPI_Op_create(&combineBunchState, 1, &op);
+        }
+        return op;
+    }
+}
+
 ParallelTTracker::ParallelTTracker(const Beamline &beamline,
                                    const PartData &reference,
                                    bool revBeam,
@@ -80,7 +107,12 @@ ParallelTTracker::ParallelTTracker(const Beamline &beamline,
     fieldEvaluationTimer_m(IpplTimings::getTimer("External field eval")),
     BinRepartTimer_m(IpplTimings::getTimer("Binaryrepart")),
     WakeFieldTimer_m(IpplTimings::getTimer("WakeField")),
-    particleMatterStatus_m(false)
+    particleMatterStatus_m(false),
+    bunchState_m(),
+    bunchStateShift_m(0.0),
+    bunchStateRequest_m(MPI_REQUEST_NULL),
+    subcycling_m(),
+    mts_m()
 {}
 
 ParallelTTracker::ParallelTTracker(const Beamline &beamline,
@@ -92,7 +124,8 @@ ParallelTTracker::ParallelTTracker(const Beamline &beamline,
                                    const std::vector<unsigned long long> &maxSteps,
                                    double zstart,
                                    const std::vector<double> &zstop,
-                                   const std::vector<double> &dt):
+                                   const std::vector<double> &dt,
+                                   unsigned int numSubsteps):
     Tracker(beamline, bunch, reference, revBeam, revTrack),
     itsDataSink_m(&ds),
     itsOpalBeamline_m(beamline.getOrigin3D(), beamline.getInitialDirection()),
@@ -112,10 +145,15 @@ ParallelTTracker::ParallelTTracker(const Beamline &beamline,
     fieldEvaluationTimer_m(IpplTimings::getTimer("External field eval")),
     BinRepartTimer_m(IpplTimings::getTimer("Binaryrepart")),
     WakeFieldTimer_m(IpplTimings::getTimer("WakeField")),
-    particleMatterStatus_m(false)
+    particleMatterStatus_m(false),
+    bunchState_m(),
+    bunchStateShift_m(0.0),
+    bunchStateRequest_m(MPI_REQUEST_NULL),
+    subcycling_m(),
+    mts_m(numSubsteps)
 {
     for (unsigned int i = 0; i < zstop.size(); ++ i) {
-        stepSizes_m.push_back(dt[i], zstop[i], maxSteps[i]);
+        stepSizes_m.push_back(dt[i], zstop[i], maxSteps[i], numSubsteps);
     }
 
     stepSizes_m.sortAscendingZStop();
@@ -282,6 +320,9 @@ void ParallelTTracker::execute() {
 
     setOptionalVariables();
 
+    subcycling_m = SpaceChargeSubcycling(Options::scSolveFreq, Options::scSolveTol);
+    subcycling_m.attach(itsBunch_m);
+
     globalEOL_m = false;
     wakeStatus_m = false;
     deletedParticles_m = false;
@@ -291,18 +332,26 @@ void ParallelTTracker::execute() {
         dtCurrentTrack_m = stepSizes_m.getdT();
         changeDT(back_track);
 
-        for (; step < trackSteps; ++ step) {
-            Vector_t rmin(0.0), rmax(0.0);
-            if (itsBunch_m->getTotalNum() > 0) {
-                itsBunch_m->get_bounds(rmin, rmax);
-            }
+        mts_m.setFirstStep(step);
 
+        for (; step < trackSteps; ++ step) {
             timeIntegration1(pusher);
 
+            startBunchStateReduction();
             itsBunch_m->Ef = Vector_t(0.0);
             itsBunch_m->Bf = Vector_t(0.0);
-
-            computeSpaceChargeFields(step);
+            finishBunchStateReduction();
+
+            if (mts_m.isSelfFieldStep(step)) {
+                computeSpaceChargeFields(mts_m.getSelfFieldStep(step));
+                if (mts_m.getNumSubsteps() > 1) {
+                    // multiple time stepping: the kick of the middle substep
+                    // applies the impulse of the self fields of the full
+                    // time step, the other substeps only see the external
+                    // fields
+                    scaleSelfFields(mts_m.getSelfFieldWeight());
+                }
+            }
 
             selectDT(back_track);
             emitParticles(step);
@@ -358,6 +407,9 @@ void ParallelTTracker::execute() {
 
     msg << level2 << "Dump phase space of last step" << endl;
 
+    // the phase space file is complete when the tracking ends
+    H5PartWrapper::flushAsyncWrites();
+
     itsOpalBeamline_m.switchElementsOff();
 
     OPALTimer::Timer myt3;
@@ -413,13 +465,31 @@ void ParallelTTracker::timeIntegration2(BorisPusher & pusher) {
     pushParticles(pusher);
 
     const unsigned int localNum = itsBunch_m->getLocalNum();
+    const double dT = itsBunch_m->getdT();
+    double* dt = itsBunch_m->dt.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
     for (unsigned int i = 0; i < localNum; ++ i) {
-        itsBunch_m->dt[i] = itsBunch_m->getdT();
+        dt[i] = dT;
     }
 
     IpplTimings::stopTimer(timeIntegrationTimer2_m);
 }
 
+void ParallelTTracker::scaleSelfFields(double weight) {
+    const unsigned int localNum = itsBunch_m->getLocalNum();
+    Vector_t* Ef = itsBunch_m->Ef.data();
+    Vector_t* Bf = itsBunch_m->Bf.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (unsigned int i = 0; i < localNum; ++ i) {
+        Ef[i] *= weight;
+        Bf[i] *= weight;
+    }
+}
+
 void ParallelTTracker::selectDT(bool backTrack) {
 
     if (itsBunch_m->getIfBeamEmitting()) {
@@ -462,11 +532,15 @@ void ParallelTTracker::emitParticles(long long step) {
                                      externalB);
         itsBunch_m->emitParticles(externalE(2));
 
-        itsBunch_m->updateNumTotal();
-        numParticlesInSimulation_m = itsBunch_m->getTotalNum();
         itsBunch_m->switchOffUnitlessPositions(true);
 
         transformBunch(refToGun.inverted());
+
+        // the new particles change the bounds and the number of particles
+        startBunchStateReduction();
+        finishBunchStateReduction();
+        itsBunch_m->setTotalNum(bunchState_m.totalNum);
+        numParticlesInSimulation_m = bunchState_m.totalNum;
     }
 
     if (step > minStepforReBin_m) {
@@ -481,10 +555,21 @@ void ParallelTTracker::computeSpaceChargeFields(unsigned long long step) {
         return;
     }
 
-    itsBunch_m->calcBeamParameters();
-    Quaternion alignment = getQuaternion(itsBunch_m->get_pmean(), Vector_t({0, 0, 1}));
+    Quaternion alignment = getQuaternion(bunchState_m.meanP, Vector_t({0, 0, 1}));
     CoordinateSystemTrafo beamToReferenceCSTrafo(Vector_t({0, 0, pathLength_m}), alignment.conjugate());
     CoordinateSystemTrafo referenceToBeamCSTrafo = beamToReferenceCSTrafo.inverted();
+
+    // getIfBeamEmitting is a collective, avoid it if the fields are solved
+    // in every step
+    if (subcycling_m.isEnabled() &&
+        !subcycling_m.isSolveDue(step, itsBunch_m->getIfBeamEmitting(), repartFreq_m,
+                                 bunchState_m.rrms, bunchState_m.meanGamma)) {
+        // reuse the fields of the last solve, they are stored in the frame
+        // of the beam and hence follow the direction of the mean momentum
+        subcycling_m.restoreFields(itsBunch_m, beamToReferenceCSTrafo);
+        return;
+    }
+
     const unsigned int localNum1 = itsBunch_m->getLocalNum();
     for (unsigned int i = 0; i < localNum1; ++ i) {
         itsBunch_m->R[i] = referenceToBeamCSTrafo.transformTo(itsBunch_m->R[i]);
@@ -492,10 +577,14 @@ void ParallelTTracker::computeSpaceChargeFields(unsigned long long step) {
 
     itsBunch_m->boundp();
 
-    if (step % repartFreq_m + 1 == repartFreq_m) {
+    if (SpaceChargeSubcycling::isRepartitionStep(step, repartFreq_m)) {
         doBinaryRepartition();
     }
 
+    if (SpaceChargeSubcycling::isSortStep(step)) {
+        itsBunch_m->sortSpatially();
+    }
+
     if (itsBunch_m->weHaveEnergyBins()) {
         itsBunch_m->calcGammas();
         itsBunch_m->resetInterpolationCache();
@@ -504,18 +593,20 @@ void ParallelTTracker::computeSpaceChargeFields(unsigned long long step) {
                  binNumber < itsBunch_m->getNumberOfEnergyBins(); ++binNumber) {
 
             itsBunch_m->setBinCharge(binNumber);
-            itsBunch_m->setGlobalMeanR(itsBunch_m->get_centroid());
+            itsBunch_m->setGlobalMeanR(bunchState_m.meanR);
             itsBunch_m->computeSelfFields(binNumber);
             itsBunch_m->Q = Q_back;
 
         }
 
     } else {
-        itsBunch_m->setGlobalMeanR(itsBunch_m->get_centroid());
+        itsBunch_m->setGlobalMeanR(bunchState_m.meanR);
         itsBunch_m->computeSelfFields();
     }
 
     const unsigned int localNum2 = itsBunch_m->getLocalNum();
+    subcycling_m.storeFields(itsBunch_m, step, bunchState_m.rrms, bunchState_m.meanGamma);
+
     for (unsigned int i = 0; i < localNum2; ++ i) {
         itsBunch_m->R[i] = beamToReferenceCSTrafo.transformTo(itsBunch_m->R[i]);
         itsBunch_m->Ef[i] = beamToReferenceCSTrafo.rotateTo(itsBunch_m->Ef[i]);
@@ -524,14 +615,92 @@ void ParallelTTracker::computeSpaceChargeFields(unsigned long long step) {
 }
 
 
+void ParallelTTracker::startBunchStateReduction() {
+    double* buffer = bunchStateBuffer_m;
+    double rmin[3], negRmax[3], sums[10];
+    std::fill(rmin, rmin + 3, std::numeric_limits<double>::max());
+    std::fill(negRmax, negRmax + 3, std::numeric_limits<double>::max());
+    std::fill(sums, sums + 10, 0.0);
+
+    // the positions are summed about the mean of the last step, or the
+    // reference particle at the start, to avoid the cancellation in
+    // <x^2> - <x>^2; z is of the order of the path length
+    if (bunchState_m.totalNum > 0) {
+        bunchStateShift_m = bunchState_m.meanR;
+    } else {
+        bunchStateShift_m = Vector_t({0.0, 0.0, pathLength_m});
+    }
+    const Vector_t shift = bunchStateShift_m;
+
+    // const access, the non-const operator[] marks the attributes as dirty
+    const ParticleAttrib<Vector_t>& R = itsBunch_m->R;
+    const ParticleAttrib<Vector_t>& P = itsBunch_m->P;
+    const size_t localNum = itsBunch_m->getLocalNum();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(min: rmin[:3], negRmax[:3]) reduction(+: sums[:10])
+#endif
+    for (size_t i = 0; i < localNum; ++ i) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            rmin[d] = std::min(rmin[d], R[i](d));
+            negRmax[d] = std::min(negRmax[d], -R[i](d));
+            const double dr = R[i](d) - shift(d);
+            sums[d] += dr;
+            sums[3 + d] += P[i](d);
+            sums[6 + d] += dr * dr;
+        }
+        sums[9] += Util::getGamma(P[i]);
+    }
+
+    std::copy(rmin, rmin + 3, buffer);
+    std::copy(negRmax, negRmax + 3, buffer + 3);
+    std::copy(sums, sums + 10, buffer + 6);
+    buffer[16] = localNum;
+
+    MPI_Iallreduce(MPI_IN_PLACE, buffer, bunchStateSize_s, MPI_DOUBLE,
+                   getBunchStateOp(), Ippl::getComm(), &bunchStateRequest_m);
+}
+
+
+void ParallelTTracker::finishBunchStateReduction() {
+    MPI_Wait(&bunchStateRequest_m, MPI_STATUS_IGNORE);
+
+    const double* buffer = bunchStateBuffer_m;
+    bunchState_m.totalNum = static_cast<size_t>(buffer[16]);
+    if (bunchState_m.totalNum == 0) {
+        bunchState_m.rmin = Vector_t(0.0);
+        bunchState_m.rmax = Vector_t(0.0);
+        bunchState_m.meanR = Vector_t(0.0);
+        bunchState_m.meanP = Vector_t(0.0);
+        bunchState_m.rrms = Vector_t(0.0);
+        bunchState_m.meanGamma = 1.0;
+        return;
+    }
+
+    const double perParticle = 1.0 / bunchState_m.totalNum;
+    for (unsigned int d = 0; d < 3; ++ d) {
+        bunchState_m.rmin(d) = buffer[d];
+        bunchState_m.rmax(d) = -buffer[3 + d];
+        const double meanDr = buffer[6 + d] * perParticle;
+        bunchState_m.meanR(d) = bunchStateShift_m(d) + meanDr;
+        bunchState_m.meanP(d) = buffer[9 + d] * perParticle;
+        bunchState_m.rrms(d) = std::sqrt(std::max(0.0, buffer[12 + d] * perParticle -
+                                                  std::pow(meanDr, 2)));
+    }
+    bunchState_m.meanGamma = buffer[15] * perParticle;
+
+    // replaces calcBeamParameters() in every step; the SAAMG solver resizes
+    // its mesh according to these bounds
+    itsBunch_m->setBounds(bunchState_m.rmin, bunchState_m.rmax);
+}
+
+
 void ParallelTTracker::computeExternalFields(OrbitThreader &oth) {
     IpplTimings::startTimer(fieldEvaluationTimer_m);
     Inform msg("ParallelTTracker ", *gmsg);
     const unsigned int localNum = itsBunch_m->getLocalNum();
     bool locPartOutOfBounds = false, globPartOutOfBounds = false;
-    Vector_t rmin(0.0), rmax(0.0);
-    if (itsBunch_m->getTotalNum() > 0)
-        itsBunch_m->get_bounds(rmin, rmax);
+    const Vector_t& rmin = bunchState_m.rmin;
+    const Vector_t& rmax = bunchState_m.rmax;
     IndexMap::value_t elements;
 
     try {
@@ -541,6 +710,17 @@ void ParallelTTracker::computeExternalFields(OrbitThreader &oth) {
         return;
     }
 
+    // buffers for the particles which are still alive, in the frame of
+    // the current element
+    std::vector<size_t> indices;
+    std::vector<Vector_t> localR, localP, localE, localB;
+    std::vector<double> localT;
+    std::unique_ptr<bool[]> outOfBounds(new bool[localNum]);
+    indices.reserve(localNum);
+    localR.reserve(localNum);
+    localP.reserve(localNum);
+    localT.reserve(localNum);
+
     IndexMap::value_t::const_iterator it = elements.begin();
     const IndexMap::value_t::const_iterator end = elements.end();
 
@@ -551,28 +731,54 @@ void ParallelTTracker::computeExternalFields(OrbitThreader &oth) {
 
         (*it)->setCurrentSCoordinate(pathLength_m + rmin(2));
 
+        indices.clear();
         for (unsigned int i = 0; i < localNum; ++ i) {
             if (itsBunch_m->Bin[i] < 0) continue;
+            indices.push_back(i);
+        }
 
-            itsBunch_m->R[i] = refToLocalCSTrafo.transformTo(itsBunch_m->R[i]);
-            itsBunch_m->P[i] = refToLocalCSTrafo.rotateTo(itsBunch_m->P[i]);
-            double &dt = itsBunch_m->dt[i];
-
-            Vector_t localE(0.0), localB(0.0);
-
-            if ((*it)->apply(i, itsBunch_m->getT() + 0.5 * dt, localE, localB)) {
-                itsBunch_m->R[i] = localToRefCSTrafo.transformTo(itsBunch_m->R[i]);
-                itsBunch_m->P[i] = localToRefCSTrafo.rotateTo(itsBunch_m->P[i]);
-                itsBunch_m->Bin[i] = -1;
+        const size_t numActive = indices.size();
+        localR.resize(numActive);
+        localP.resize(numActive);
+        localT.resize(numActive);
+        const Vector_t* R = itsBunch_m->R.data();
+        const Vector_t* P = itsBunch_m->P.data();
+        const double* dt = itsBunch_m->dt.data();
+        const double t = itsBunch_m->getT();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (size_t k = 0; k < numActive; ++ k) {
+            const size_t i = indices[k];
+            localR[k] = refToLocalCSTrafo.transformTo(R[i]);
+            localP[k] = refToLocalCSTrafo.rotateTo(P[i]);
+            localT[k] = t + 0.5 * dt[i];
+        }
+        localE.assign(numActive, Vector_t(0.0));
+        localB.assign(numActive, Vector_t(0.0));
+
+        (*it)->applyBatch(indices.data(), numActive,
+                          localR.data(), localP.data(), localT.data(),
+                          localE.data(), localB.data(),
+                          outOfBounds.get());
+
+        int* bin = itsBunch_m->Bin.data();
+        Vector_t* Ef = itsBunch_m->Ef.data();
+        Vector_t* Bf = itsBunch_m->Bf.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(||: locPartOutOfBounds)
+#endif
+        for (size_t k = 0; k < numActive; ++ k) {
+            const size_t i = indices[k];
+            if (outOfBounds[k]) {
+                bin[i] = -1;
                 locPartOutOfBounds = true;
 
                 continue;
             }
 
-            itsBunch_m->R[i] = localToRefCSTrafo.transformTo(itsBunch_m->R[i]);
-            itsBunch_m->P[i] = localToRefCSTrafo.rotateTo(itsBunch_m->P[i]);
-            itsBunch_m->Ef[i] += localToRefCSTrafo.rotateTo(localE);
-            itsBunch_m->Bf[i] += localToRefCSTrafo.rotateTo(localB);
+            Ef[i] += localToRefCSTrafo.rotateTo(localE[k]);
+            Bf[i] += localToRefCSTrafo.rotateTo(localB[k]);
         }
     }
 
@@ -588,6 +794,10 @@ void ParallelTTracker::computeExternalFields(OrbitThreader &oth) {
 
     size_t ne = 0;
     if (globPartOutOfBounds) {
+        if (Options::remotePartDel > 0) {
+            // boundp_destroyT uses the moments of the bunch
+            itsBunch_m->calcBeamParameters();
+        }
         if (itsBunch_m->hasFieldSolver()) {
             ne = itsBunch_m->boundp_destroyT();
         } else {
@@ -673,9 +883,7 @@ void ParallelTTracker::computeWakefield(IndexMap::value_t &elements) {
                 wakeStatus_m = true;
             }
 
-            if (!itsBunch_m->hasFieldSolver()) itsBunch_m->calcBeamParameters();
-
-            Quaternion alignment = getQuaternion(itsBunch_m->get_pmean(), Vector_t({0, 0, 1}));
+            Quaternion alignment = getQuaternion(bunchState_m.meanP, Vector_t({0, 0, 1}));
             CoordinateSystemTrafo referenceToBeamCSTrafo(Vector_t(0.0), alignment);
             CoordinateSystemTrafo beamToReferenceCSTrafo = referenceToBeamCSTrafo.inverted();
 
@@ -684,6 +892,7 @@ void ParallelTTracker::computeWakefield(IndexMap::value_t &elements) {
                 itsBunch_m->P[i] = referenceToBeamCSTrafo.rotateTo(itsBunch_m->P[i]);
                 itsBunch_m->Ef[i] = referenceToBeamCSTrafo.rotateTo(itsBunch_m->Ef[i]);
             }
+            itsBunch_m->invalidateLongitudinalProfile();
 
             wfInstance->apply(itsBunch_m);
 
@@ -997,12 +1206,6 @@ void ParallelTTracker::writePhaseSpace(const long long /*step*/, bool psDump, bo
     Vector_t externalE, externalB;
     Vector_t FDext[2];  // FDext = {BHead, EHead, BRef, ERef, BTail, ETail}.
 
-    // Sample fields at (xmin, ymin, zmin), (xmax, ymax, zmax) and the centroid location. We
-    // are sampling the electric and magnetic fields at the back, front and
-    // center of the beam.
-    Vector_t rmin, rmax;
-    itsBunch_m->get_bounds(rmin, rmax);
-
     if (psDump || statDump) {
         externalB = Vector_t(0.0);
         externalE = Vector_t(0.0);
@@ -24,6 +24,8 @@
 
 #include "Algorithms/Tracker.h"
 #include "Steppers/BorisPusher.h"
+#include "Steppers/MultipleTimeStepping.h"
+#include "Steppers/SpaceChargeSubcycling.h"
 #include "Structure/DataSink.h"
 #include "Algorithms/StepSizeConfig.h"
 
@@ -86,6 +88,10 @@ public:
     //  The particle bunch tracked is taken from [b]bunch[/b].
     //  If [b]revBeam[/b] is true, the beam runs from s = C to s = 0.
     //  If [b]revTrack[/b] is true, we track against the beam.
+    //  If [b]numSubsteps[/b] is larger than 1, the multiple time stepping
+    //  integrator is used: the external fields are integrated with
+    //  [b]numSubsteps[/b] substeps per time step [b]dt[/b], the self fields
+    //  are applied once per time step. [b]numSubsteps[/b] has to be odd.
     explicit ParallelTTracker(const Beamline &bl,
                               PartBunchBase<double, 3> *bunch,
                               DataSink &ds,
@@ -95,7 +101,8 @@ public:
                               const std::vector<unsigned long long> &maxSTEPS,
                               double zstart,
                               const std::vector<double> &zstop,
-                              const std::vector<double> &dt);
+                              const std::vector<double> &dt,
+                              unsigned int numSubsteps = 1);
 
 
     virtual ~ParallelTTracker();
@@ -229,9 +236,44 @@ private:
     std::set<ParticleMatterInteractionHandler*> activeParticleMatterInteractionHandlers_m;
     bool particleMatterStatus_m;
 
+    /*
+      Global quantities of the bunch which are needed by several parts of
+      one integration step. They are computed in one pass over the local
+      particles and reduced with a single packed allreduce, see
+      startBunchStateReduction() and finishBunchStateReduction(). The
+      positions are in the reference frame.
+    */
+    struct BunchState {
+        Vector_t rmin;
+        Vector_t rmax;
+        Vector_t meanR;
+        Vector_t meanP;
+        Vector_t rrms;
+        double meanGamma;
+        size_t totalNum;
+    };
+    BunchState bunchState_m;
+
+    // minima and maxima of the positions, sums of the positions, momenta,
+    // squared positions and Lorentz factors and the number of particles;
+    // the positions are summed relative to bunchStateShift_m
+    static constexpr int bunchStateSize_s = 17;
+    double bunchStateBuffer_m[bunchStateSize_s];
+    Vector_t bunchStateShift_m;
+    MPI_Request bunchStateRequest_m;
+
+    // schedule of the space charge solves, in between the stored fields are
+    // reused, see SCSOLVEFREQ and SCSOLVETOL
+    SpaceChargeSubcycling subcycling_m;
+
+    // schedule of the self fields if the multiple time stepping integrator
+    // is used
+    MultipleTimeStepping mts_m;
+
     /********************** END VARIABLES ***********************************/
 
     void kickParticles(const BorisPusher &pusher);
+    void scaleSelfFields(double weight);
     void pushParticles(const BorisPusher &pusher);
     void updateReferenceParticle(const BorisPusher &pusher);
 
@@ -258,6 +300,8 @@ private:
     void computeUndulator(IndexMap::value_t &elements);
 #endif
     void computeSpaceChargeFields(unsigned long long step);
+    void startBunchStateReduction();
+    void finishBunchStateReduction();
     // void prepareOpalBeamlineSections();
     void dumpStats(long long step, bool psDump, bool statDump);
     void setOptionalVariables();
@@ -363,15 +407,30 @@ inline void ParallelTTracker::visitVacuum(const Vacuum &vac) {
 
 inline void ParallelTTracker::kickParticles(const BorisPusher &pusher) {
     int localNum = itsBunch_m->getLocalNum();
+    const Vector_t* R = itsBunch_m->R.data();
+    Vector_t* P = itsBunch_m->P.data();
+    const Vector_t* Ef = itsBunch_m->Ef.data();
+    const Vector_t* Bf = itsBunch_m->Bf.data();
+    const double* dt = itsBunch_m->dt.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
     for (int i = 0; i < localNum; ++i)
-        pusher.kick(itsBunch_m->R[i], itsBunch_m->P[i], itsBunch_m->Ef[i], itsBunch_m->Bf[i], itsBunch_m->dt[i]);
+        pusher.kick(R[i], P[i], Ef[i], Bf[i], dt[i]);
 }
 
 inline void ParallelTTracker::pushParticles(const BorisPusher &pusher) {
     itsBunch_m->switchToUnitlessPositions(true);
 
-    for (unsigned int i = 0; i < itsBunch_m->getLocalNum(); ++i) {
-        pusher.push(itsBunch_m->R[i], itsBunch_m->P[i], itsBunch_m->dt[i]);
+    int localNum = itsBunch_m->getLocalNum();
+    Vector_t* R = itsBunch_m->R.data();
+    const Vector_t* P = itsBunch_m->P.data();
+    const double* dt = itsBunch_m->dt.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < localNum; ++i) {
+        pusher.push(R[i], P[i], dt[i]);
     }
     itsBunch_m->switchOffUnitlessPositions(true);
 }
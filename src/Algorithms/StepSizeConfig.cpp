@@ -112,7 +112,7 @@ double StepSizeConfig::getdT() const {
                             "iterator is at end of list of configurations");
     }
 
-    return std::get<0>(*it_m);
+    return std::get<0>(*it_m) / std::get<3>(*it_m);
 }
 
 double StepSizeConfig::getZStop() const {
@@ -130,25 +130,34 @@ unsigned long StepSizeConfig::getNumSteps() const {
                             "iterator is at end of list of configurations");
     }
 
-    return std::get<2>(*it_m);
+    return std::get<2>(*it_m) * std::get<3>(*it_m);
+}
+
+unsigned int StepSizeConfig::getNumSubsteps() const {
+    if (reachedEnd()) {
+        throw OpalException("StepSizeConfig::getNumSubsteps",
+                            "iterator is at end of list of configurations");
+    }
+
+    return std::get<3>(*it_m);
 }
 
 unsigned long long StepSizeConfig::getMaxSteps() const {
     unsigned long long maxSteps = 0;
     for (const auto& config: configurations_m) {
-        maxSteps += std::get<2>(config);
+        maxSteps += std::get<2>(config) * std::get<3>(config);
     }
 
     return maxSteps;
 }
 
 unsigned long long StepSizeConfig::getNumStepsFinestResolution() const {
-    double minTimeStep = std::get<0>(configurations_m.front());
+    double minTimeStep = std::get<0>(configurations_m.front()) / std::get<3>(configurations_m.front());
     unsigned long long totalNumSteps = 0;
 
     for (const auto& config: configurations_m) {
-        const double &dt = std::get<0>(config);
-        const unsigned long &numSteps = std::get<2>(config);
+        const double dt = std::get<0>(config) / std::get<3>(config);
+        const unsigned long numSteps = std::get<2>(config) * std::get<3>(config);
 
         if (minTimeStep > dt) {
             totalNumSteps = std::ceil(totalNumSteps * minTimeStep / dt);
@@ -162,10 +171,11 @@ unsigned long long StepSizeConfig::getNumStepsFinestResolution() const {
 }
 
 double StepSizeConfig::getMinTimeStep() const {
-    double minTimeStep = std::get<0>(configurations_m.front());
+    double minTimeStep = std::get<0>(configurations_m.front()) / std::get<3>(configurations_m.front());
     for (const auto& config: configurations_m) {
-        if (minTimeStep > std::get<0>(config)) {
-            minTimeStep = std::get<0>(config);
+        const double dt = std::get<0>(config) / std::get<3>(config);
+        if (minTimeStep > dt) {
+            minTimeStep = dt;
         }
     }
 
@@ -181,6 +191,7 @@ void StepSizeConfig::print(Inform &out) const {
         << std::setw(20) << "dt [ns] "
         << std::setw(20) << "zStop [m] "
         << std::setw(20) << "num Steps [1]"
+        << std::setw(20) << "num Substeps [1]"
         << endl;
 
     for (auto it = configurations_m.begin();
@@ -195,6 +206,7 @@ void StepSizeConfig::print(Inform &out) const {
         out << std::setw(20) << std::get<0>(*it)
             << std::setw(20) << std::get<1>(*it)
             << std::setw(20) << std::get<2>(*it)
+            << std::setw(20) << std::get<3>(*it)
             << endl;
     }
 }
@@ -2,6 +2,8 @@
 // Class StepSizeConfig
 //
 // This class stores tuples of time step sizes, path length range limits and limit of number of step sizes.
+// For the multiple time stepping integrator each tuple additionally holds the number of substeps of the
+// external fields per time step; getdT() and getNumSteps() refer to the substeps.
 //
 // Copyright (c) 2019 - 2021, Christof Metzger-Kraus
 //
@@ -23,6 +25,7 @@
 #include "Structure/ValueRange.h"
 #include "Utility/Inform.h"
 
+#include <algorithm>
 #include <list>
 #include <tuple>
 
@@ -36,7 +39,8 @@ public:
 
     void push_back(double dt,
                    double zstop,
-                   unsigned long numSteps);
+                   unsigned long numSteps,
+                   unsigned int numSubsteps = 1);
 
     void sortAscendingZStop();
 
@@ -65,6 +69,8 @@ public:
 
     unsigned long getNumSteps() const;
 
+    unsigned int getNumSubsteps() const;
+
     unsigned long long getMaxSteps() const;
 
     unsigned long long getNumStepsFinestResolution() const;
@@ -78,7 +84,7 @@ public:
     ValueRange<double> getPathLengthRange() const;
 
 private:
-    typedef std::tuple<double, double, unsigned long> entry_t;
+    typedef std::tuple<double, double, unsigned long, unsigned int> entry_t;
     typedef std::list<entry_t> container_t;
 
     container_t configurations_m;
@@ -100,8 +106,9 @@ StepSizeConfig::StepSizeConfig(const StepSizeConfig &right):
 inline
 void StepSizeConfig::push_back(double dt,
                                double zstop,
-                               unsigned long numSteps) {
-    configurations_m.push_back(std::make_tuple(dt, zstop, numSteps));
+                               unsigned long numSteps,
+                               unsigned int numSubsteps) {
+    configurations_m.push_back(std::make_tuple(dt, zstop, numSteps, std::max(numSubsteps, 1u)));
 }
 
 inline
@@ -30,6 +30,7 @@
 #include "Utility/Inform.h"
 #include "Utility/IpplInfo.h"
 #include "Utility/IpplMemoryUsage.h"
+#include "Utility/IpplTimings.h"
 
 #include <array>
 #include <cstddef>
@@ -38,6 +39,10 @@
 #include <limits>
 #include <string_view>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 extern Inform* gmsg;
 extern Inform* gmsgALL;
 
@@ -55,11 +60,17 @@ namespace {
         PSDUMPFREQ,
         STATDUMPFREQ,
         PSDUMPEACHTURN,
+        ASYNCPSDUMP,
         PSDUMPFRAME,
+        PSDUMPPRECISION,
+        PSDUMPSUBSAMPLE,
+        PSDUMPCHUNKSIZE,
         SPTDUMPFREQ,
         REPARTFREQ,
+        SORTFREQ,
         REBINFREQ,
         SCSOLVEFREQ,
+        SCSOLVETOL,
         MTSSUBSTEPS,
         REMOTEPARTDEL,
         RHODUMP,
@@ -86,12 +97,17 @@ namespace {
         AMR_REGRID_FREQ,
 #endif
         MEMORYDUMP,
+        TRACETIMERS,
+        PERFDUMP,
         HALOSHIFT,
         DELPARTFREQ,
         MINBINEMITTED,
         MINSTEPFORREBIN,
         COMPUTEPERCENTILES,
         DUMPBEAMMATRIX,
+        CACHEFIELDMAPS,
+        CACHEGEOMETRY,
+        NUMTHREADS,
 	SIZE
     };
 }
@@ -139,13 +155,30 @@ Option::Option():
                                "turn ,only aviable for OPAL-cycl, its default value is false",
                                psDumpEachTurn);
 
+    itsAttr[ASYNCPSDUMP] = Attributes::makeBool
+                           ("ASYNCPSDUMP", "If true, the phase space of OPAL-t is written "
+                            "by a background thread while the tracking continues. Needs "
+                            "MPI_THREAD_MULTIPLE, i.e. OPAL has to be started with "
+                            "--mpithreadmultiple, its default value is false",
+                            asyncPsDump);
+
     itsAttr[SCSOLVEFREQ] = Attributes::makeReal
                            ("SCSOLVEFREQ", "The frequency to solve space charge fields. its default value is 1");
 
+    itsAttr[SCSOLVETOL] = Attributes::makeReal
+                          ("SCSOLVETOL", "If positive, the space charge fields are solved "
+                           "before SCSOLVEFREQ steps have passed when the rms beam size or the "
+                           "mean Lorentz factor have changed by more than this fraction since "
+                           "the last solve (OPAL-T only). Zero, the default, "
+                           "switches the criterion off");
+
     itsAttr[MTSSUBSTEPS] = Attributes::makeReal
                            ("MTSSUBSTEPS", "How many small timesteps "
                             "are inside the large timestep used in multiple "
-                            "time stepping (MTS) integrator");
+                            "time stepping (MTS) integrator. In OPAL-T the "
+                            "external fields are integrated with the small "
+                            "timesteps, the self fields with the large one; "
+                            "the number has to be odd");
 
     itsAttr[REMOTEPARTDEL] = Attributes::makeReal
                              ("REMOTEPARTDEL", "Artifically delete the remote particle "
@@ -162,6 +195,24 @@ Option::Option():
                             "frame of the reference particle 0. Only available for "
                             "OPAL-cycl.", {"BUNCH_MEAN", "REFERENCE", "GLOBAL"}, "GLOBAL");
 
+    itsAttr[PSDUMPPRECISION] = Attributes::makePredefinedString
+                               ("PSDUMPPRECISION", "Precision of the positions, momenta and "
+                                "fields in the h5 file. If 'SINGLE' they are stored as 32 bit "
+                                "floating point numbers, charge and mass are always stored in "
+                                "double precision.", {"DOUBLE", "SINGLE"}, "DOUBLE");
+
+    itsAttr[PSDUMPSUBSAMPLE] = Attributes::makeReal
+                               ("PSDUMPSUBSAMPLE", "Only the particles whose ID is a multiple "
+                                "of PSDUMPSUBSAMPLE are written to the h5 file. When restarting "
+                                "from such a file the macro charge (OPAL-cycl: and mass) of "
+                                "the particles is scaled accordingly, its default value is 1.",
+                                psDumpSubsample);
+
+    itsAttr[PSDUMPCHUNKSIZE] = Attributes::makeReal
+                               ("PSDUMPCHUNKSIZE", "If positive the particle data in the h5 file "
+                                "are stored in chunks of PSDUMPCHUNKSIZE particles instead of "
+                                "contiguously, its default value is 0.", psDumpChunkSize);
+
     itsAttr[SPTDUMPFREQ] = Attributes::makeReal
                            ("SPTDUMPFREQ", "The frequency to dump single "
                             "particle trajectory of particles with ID = 0 & 1, "
@@ -172,6 +223,11 @@ Option::Option():
                            "for better load balance between nodes, its "
                            "default value is " + std::to_string(repartFreq) + ".", repartFreq);
 
+    itsAttr[SORTFREQ] = Attributes::makeReal
+                        ("SORTFREQ", "The frequency to sort the particles along a space-filling "
+                         "curve (Morton order) for better memory locality; 0 disables "
+                         "the sorting, its default value is " + std::to_string(sortFreq) + ".", sortFreq);
+
     itsAttr[MINBINEMITTED] = Attributes::makeReal
                              ("MINBINEMITTED", "The number of bins that have to be emitted before the bins are squashed into "
                               "a single bin; the default value is " + std::to_string(minBinEmitted) + ".", minBinEmitted);
@@ -274,6 +330,20 @@ Option::Option():
     itsAttr[MEMORYDUMP] = Attributes::makeBool
                           ("MEMORYDUMP", "If true, write memory to SDDS file", memoryDump);
 
+    itsAttr[TRACETIMERS] = Attributes::makeReal
+                           ("TRACETIMERS", "If positive, the intervals of the timers are recorded "
+                            "with the step, keeping this many of the last intervals per thread. "
+                            "They are written to timing-trace-<rank>.json in the Chrome trace "
+                            "format at the end of every TRACK. The number of intervals is fixed "
+                            "by the first positive value, 0 stops the recording. Default: 0",
+                            traceTimers);
+
+    itsAttr[PERFDUMP] = Attributes::makeBool
+                        ("PERFDUMP", "If true, write the wall time per step of the phases of a "
+                         "step, the particles per processor, the data sent when swapping "
+                         "particles and the particle pushes per second to an SDDS file "
+                         "together with the statistics", perfDump);
+
     itsAttr[HALOSHIFT] = Attributes::makeReal
                          ("HALOSHIFT", "Constant parameter to shift halo value (default: 0.0)", haloShift);
 
@@ -292,6 +362,24 @@ Option::Option():
                                   ("DUMPBEAMMATRIX", "Flag to control whether to write  "
                                    "the 6-dimensional beam matrix (upper triangle only) "
                                    "to stat file. Default: false", dumpBeamMatrix);
+
+    itsAttr[CACHEFIELDMAPS] = Attributes::makeBool
+                              ("CACHEFIELDMAPS", "If true, 3D field maps are converted once into "
+                               "a binary cache file in the data directory which is shared by all "
+                               "processes of a node via memory mapping. Default: false", cacheFieldmaps);
+
+    itsAttr[CACHEGEOMETRY] = Attributes::makeBool
+                             ("CACHEGEOMETRY", "If true, the search structure and the oriented "
+                              "triangles of a GEOMETRY are stored in a cache file next to the "
+                              "geometry file and reused as long as the content of the geometry "
+                              "file and the attributes of the GEOMETRY don't change. Default: false",
+                              cacheGeometry);
+
+    itsAttr[NUMTHREADS] = Attributes::makeReal
+                          ("NUMTHREADS", "The number of OpenMP threads per MPI process used for "
+                           "the particle push, the field evaluation and the gather in OPAL-T. "
+                           "Requires OPAL to be built with OpenMP. Default: 0, i.e. the OpenMP default",
+                           numThreads);
     
     registerOwnership(AttributeHandler::STATEMENT);
 
@@ -309,12 +397,20 @@ Option::Option(const std::string& name, Option* parent):
     Attributes::setReal(itsAttr[PSDUMPFREQ], psDumpFreq);
     Attributes::setReal(itsAttr[STATDUMPFREQ], statDumpFreq);
     Attributes::setBool(itsAttr[PSDUMPEACHTURN], psDumpEachTurn);
+    Attributes::setBool(itsAttr[ASYNCPSDUMP], asyncPsDump);
     Attributes::setPredefinedString(itsAttr[PSDUMPFRAME], getDumpFrameString(psDumpFrame));
+    Attributes::setPredefinedString(itsAttr[PSDUMPPRECISION], getDumpPrecisionString(psDumpPrecision));
+    Attributes::setReal(itsAttr[PSDUMPSUBSAMPLE], psDumpSubsample);
+    Attributes::setReal(itsAttr[PSDUMPCHUNKSIZE], psDumpChunkSize);
     Attributes::setReal(itsAttr[SPTDUMPFREQ], sptDumpFreq);
     Attributes::setReal(itsAttr[SCSOLVEFREQ], scSolveFreq);
+    if (scSolveTol > 0.0) {
+        Attributes::setReal(itsAttr[SCSOLVETOL], scSolveTol);
+    }
     Attributes::setReal(itsAttr[MTSSUBSTEPS], mtsSubsteps);
     Attributes::setReal(itsAttr[REMOTEPARTDEL], remotePartDel);
     Attributes::setReal(itsAttr[REPARTFREQ], repartFreq);
+    Attributes::setReal(itsAttr[SORTFREQ], sortFreq);
     Attributes::setReal(itsAttr[MINBINEMITTED], minBinEmitted);
     Attributes::setReal(itsAttr[MINSTEPFORREBIN], minStepForRebin);
     Attributes::setReal(itsAttr[REBINFREQ], rebinFreq);
@@ -342,10 +438,15 @@ Option::Option(const std::string& name, Option* parent):
     Attributes::setReal(itsAttr[AMR_REGRID_FREQ], amrRegridFreq);
 #endif
     Attributes::setBool(itsAttr[MEMORYDUMP], memoryDump);
+    Attributes::setReal(itsAttr[TRACETIMERS], traceTimers);
+    Attributes::setBool(itsAttr[PERFDUMP], perfDump);
     Attributes::setReal(itsAttr[HALOSHIFT], haloShift);
     Attributes::setReal(itsAttr[DELPARTFREQ], delPartFreq);
     Attributes::setBool(itsAttr[COMPUTEPERCENTILES], computePercentiles);
     Attributes::setBool(itsAttr[DUMPBEAMMATRIX],dumpBeamMatrix);
+    Attributes::setBool(itsAttr[CACHEFIELDMAPS], cacheFieldmaps);
+    Attributes::setBool(itsAttr[CACHEGEOMETRY], cacheGeometry);
+    Attributes::setReal(itsAttr[NUMTHREADS], numThreads);
 }
 
 
@@ -365,6 +466,7 @@ void Option::execute() {
     mtrace         = Attributes::getBool(itsAttr[TRACE]);
     warn           = Attributes::getBool(itsAttr[WARN]);
     psDumpEachTurn = Attributes::getBool(itsAttr[PSDUMPEACHTURN]);
+    asyncPsDump    = Attributes::getBool(itsAttr[ASYNCPSDUMP]);
     remotePartDel  = Attributes::getReal(itsAttr[REMOTEPARTDEL]);
     rhoDump        = Attributes::getBool(itsAttr[RHODUMP]);
     ebDump         = Attributes::getBool(itsAttr[EBDUMP]);
@@ -393,12 +495,27 @@ void Option::execute() {
     delPartFreq    = Attributes::getReal(itsAttr[DELPARTFREQ]);
     computePercentiles = Attributes::getBool(itsAttr[COMPUTEPERCENTILES]);
     dumpBeamMatrix     = Attributes::getBool(itsAttr[DUMPBEAMMATRIX]);
+    cacheFieldmaps     = Attributes::getBool(itsAttr[CACHEFIELDMAPS]);
+    cacheGeometry      = Attributes::getBool(itsAttr[CACHEGEOMETRY]);
     if ( memoryDump ) {
         IpplMemoryUsage::IpplMemory_p memory = IpplMemoryUsage::getInstance(
                 IpplMemoryUsage::Unit::GB, false);
         memory->sample();
     }
 
+    perfDump       = Attributes::getBool(itsAttr[PERFDUMP]);
+    double numTraceEvents = Attributes::getReal(itsAttr[TRACETIMERS]);
+    if (numTraceEvents < 0.0) {
+        throw OpalException("Option::execute",
+                            "The attribute \"TRACETIMERS\" has to be non-negative");
+    }
+    traceTimers = numTraceEvents;
+    if (traceTimers > 0) {
+        IpplTimings::enableTracing(traceTimers);
+    } else {
+        IpplTimings::disableTracing();
+    }
+
     /// note: rangen is used only for the random number generator in the OPAL language
     ///       not for the distributions
 
@@ -413,6 +530,7 @@ void Option::execute() {
     IpplInfo::Warn->on(warn);
 
     handlePsDumpFrame(Attributes::getString(itsAttr[PSDUMPFRAME]));
+    handlePsDumpPrecision(Attributes::getString(itsAttr[PSDUMPPRECISION]));
 
     /// note: rangen is used only for the random number generator in the OPAL language
     ///       not for the distributions
@@ -430,6 +548,22 @@ void Option::execute() {
             psDumpFreq = std::numeric_limits<int>::max();
     }
 
+    if (itsAttr[PSDUMPSUBSAMPLE]) {
+        psDumpSubsample = int(Attributes::getReal(itsAttr[PSDUMPSUBSAMPLE]));
+        if (psDumpSubsample < 1) {
+            throw OpalException("Option::execute",
+                                "The attribute \"PSDUMPSUBSAMPLE\" has to be positive");
+        }
+    }
+
+    if (itsAttr[PSDUMPCHUNKSIZE]) {
+        psDumpChunkSize = int(Attributes::getReal(itsAttr[PSDUMPCHUNKSIZE]));
+        if (psDumpChunkSize < 0) {
+            throw OpalException("Option::execute",
+                                "The attribute \"PSDUMPCHUNKSIZE\" has to be non-negative");
+        }
+    }
+
     if (itsAttr[STATDUMPFREQ]) {
         statDumpFreq = int(Attributes::getReal(itsAttr[STATDUMPFREQ]));
         if (statDumpFreq==0)
@@ -442,6 +576,15 @@ void Option::execute() {
             sptDumpFreq = std::numeric_limits<int>::max();
     }
 
+    if (itsAttr[SCSOLVETOL]) {
+        double tolerance = Attributes::getReal(itsAttr[SCSOLVETOL]);
+        if (tolerance < 0.0) {
+            throw OpalException("Option::execute",
+                                "The attribute \"SCSOLVETOL\" has to be non-negative");
+        }
+        scSolveTol = tolerance;
+    }
+
     if (itsAttr[SCSOLVEFREQ]) {
         scSolveFreq = int(Attributes::getReal(itsAttr[SCSOLVEFREQ]));
         scSolveFreq = ( scSolveFreq < 1 ) ? 1 : scSolveFreq;
@@ -455,6 +598,14 @@ void Option::execute() {
         repartFreq = int(Attributes::getReal(itsAttr[REPARTFREQ]));
     }
 
+    if (itsAttr[SORTFREQ]) {
+        sortFreq = int(Attributes::getReal(itsAttr[SORTFREQ]));
+        if (sortFreq < 0) {
+            throw OpalException("Option::execute",
+                                "The attribute \"SORTFREQ\" has to be non-negative");
+        }
+    }
+
     if (itsAttr[MINBINEMITTED]) {
         minBinEmitted = int(Attributes::getReal(itsAttr[MINBINEMITTED]));
     }
@@ -499,6 +650,23 @@ void Option::execute() {
         beamHaloBoundary = 0;
     }
 
+    numThreads = int(Attributes::getReal(itsAttr[NUMTHREADS]));
+    if (numThreads < 0) {
+        throw OpalException("Option::execute",
+                            "The attribute \"NUMTHREADS\" has to be non-negative");
+    }
+    if (numThreads > 0) {
+        // 0 keeps the number of threads chosen by OpenMP
+#ifdef _OPENMP
+        omp_set_num_threads(numThreads);
+#else
+        if (numThreads > 1) {
+            WARNMSG(level2 << "OPAL was built without OpenMP, "
+                    << "the attribute \"NUMTHREADS\" is ignored" << endl);
+        }
+#endif
+    }
+
     if (itsAttr[CLOTUNEONLY]) {
         cloTuneOnly = bool(Attributes::getBool(itsAttr[CLOTUNEONLY]));
     } else {
@@ -532,6 +700,19 @@ std::string Option::getDumpFrameString(const DumpFrame& df) noexcept {
     return std::string(Util::enumToString(df, dumpFrameMap, "GLOBAL"));
 }
 
+constexpr std::array<std::pair<DumpPrecision, std::string_view>, 2> dumpPrecisionMap {{
+    {DumpPrecision::DOUBLE, "DOUBLE"},
+    {DumpPrecision::SINGLE, "SINGLE"}
+}};
+
+void Option::handlePsDumpPrecision(std::string_view dumpPrecisionName) noexcept {
+    psDumpPrecision = Util::stringToEnum(dumpPrecisionName, dumpPrecisionMap, DumpPrecision::DOUBLE);
+}
+
+std::string Option::getDumpPrecisionString(const DumpPrecision& dp) noexcept {
+    return std::string(Util::enumToString(dp, dumpPrecisionMap, "DOUBLE"));
+}
+
 void Option::update(const std::vector<Attribute>& othersAttributes) {
     for (int i = 0; i < SIZE; ++ i) {
         itsAttr[i] = othersAttributes[i];
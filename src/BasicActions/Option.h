@@ -41,6 +41,9 @@ private:
     void handlePsDumpFrame(std::string_view dumpFrameName) noexcept;
     static std::string getDumpFrameString(const DumpFrame& df) noexcept;
 
+    void handlePsDumpPrecision(std::string_view dumpPrecisionName) noexcept;
+    static std::string getDumpPrecisionString(const DumpPrecision& dp) noexcept;
+
     using Object::update;
     void update(const std::vector<Attribute>&);
 
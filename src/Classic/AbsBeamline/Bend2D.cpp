@@ -177,6 +177,19 @@ bool Bend2D::apply(const Vector_t &R,
 
 }
 
+void Bend2D::applyBatch(const size_t */*indices*/,
+                        size_t n,
+                        const Vector_t *R,
+                        const Vector_t *P,
+                        const double *t,
+                        Vector_t *E,
+                        Vector_t *B,
+                        bool *outOfBounds) {
+    for (size_t k = 0; k < n; ++ k) {
+        outOfBounds[k] = Bend2D::apply(R[k], P[k], t[k], E[k], B[k]);
+    }
+}
+
 bool Bend2D::applyToReferenceParticle(const Vector_t &R,
                                     const Vector_t &P,
                                     const double &t,
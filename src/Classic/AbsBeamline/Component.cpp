@@ -118,6 +118,29 @@ bool Component::apply(const Vector_t &R,
     return false;
 }
 
+void Component::applyBatch(const size_t *indices,
+                           size_t n,
+                           const Vector_t *R,
+                           const Vector_t *P,
+                           const double *t,
+                           Vector_t *E,
+                           Vector_t *B,
+                           bool *outOfBounds) {
+    // apply(i, ...) expects the coordinates of the particle in the frame
+    // of the element in the bunch
+    for (size_t k = 0; k < n; ++ k) {
+        const size_t i = indices[k];
+        const Vector_t refR = RefPartBunch_m->R[i];
+        const Vector_t refP = RefPartBunch_m->P[i];
+
+        RefPartBunch_m->R[i] = R[k];
+        RefPartBunch_m->P[i] = P[k];
+        outOfBounds[k] = apply(i, t[k], E[k], B[k]);
+        RefPartBunch_m->R[i] = refR;
+        RefPartBunch_m->P[i] = refP;
+    }
+}
+
 bool Component::applyToReferenceParticle(const Vector_t &R,
                                          const Vector_t &/*P*/,
                                          const double &/*t*/,
@@ -109,6 +109,21 @@ public:
                        Vector_t &E,
                        Vector_t &B);
 
+    /// Apply the field to a batch of particles.
+    //  [b]indices[/b] are the indices of the [b]n[/b] particles in the bunch,
+    //  [b]R[/b] and [b]P[/b] their coordinates in the frame of the element and
+    //  [b]t[/b] the times. The fields are added to [b]E[/b] and [b]B[/b] and
+    //  [b]outOfBounds[/b] receives what apply() would return. The default
+    //  implementation calls apply(i, t, E, B) for each particle.
+    virtual void applyBatch(const size_t *indices,
+                            size_t n,
+                            const Vector_t *R,
+                            const Vector_t *P,
+                            const double *t,
+                            Vector_t *E,
+                            Vector_t *B,
+                            bool *outOfBounds);
+
     virtual bool applyToReferenceParticle(const Vector_t &R,
                                           const Vector_t &P,
                                           const double &t,
@@ -43,6 +43,7 @@
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <memory>
 
 #define CHECK_CYC_FSCANF_EOF(arg) if (arg == EOF)\
 throw GeneralClassicException("Cyclotron::getFieldFromFile",\
@@ -70,6 +71,7 @@ Cyclotron::Cyclotron(const Cyclotron& right):
     zinit_m(right.zinit_m),
     pzinit_m(right.pzinit_m),
     spiralFlag_m(right.spiralFlag_m),
+    fieldTable_m(right.fieldTable_m),
     trimCoilThreshold_m(right.trimCoilThreshold_m),
     typeName_m(right.typeName_m),
     harm_m(right.harm_m),
@@ -87,7 +89,8 @@ Cyclotron::Cyclotron(const Cyclotron& right):
 }
 
 Cyclotron::Cyclotron(const std::string& name):
-    Component(name) {
+    Component(name),
+    fieldTable_m(false) {
 }
 
 Cyclotron::~Cyclotron() {
@@ -176,6 +179,14 @@ bool Cyclotron::getSpiralFlag() const {
     return spiralFlag_m;
 }
 
+void Cyclotron::setFieldTable(bool fieldTable) {
+    fieldTable_m = fieldTable;
+}
+
+bool Cyclotron::getFieldTable() const {
+    return fieldTable_m;
+}
+
 void Cyclotron::setFieldMapFN(const std::string& f) {
     fmapfn_m = f;
 }
@@ -448,8 +459,33 @@ bool Cyclotron::apply(const size_t& id, const double& t, Vector_t& E, Vector_t&
 bool Cyclotron::apply(const Vector_t& R, const Vector_t& /*P*/,
                       const double& t, Vector_t& E, Vector_t& B) {
 
+    const double tet = computeAzimuth(R);
+
+    // Necessary for gap phase output -DW
+    if ( 0 <= tet && tet <= (Physics::pi / 4) ) waitingGap_m = 1;
+
+    // dB_{z}/dr, dB_{z}/dtheta, B_{z}
+    double brint = 0.0, btint = 0.0, bzint = 0.0;
+
+    const double rad = std::hypot(R[0],R[1]);
+    if ( this->interpolate(rad, tet, brint, btint, bzint) ) {
+        applyMidplaneField(R, rad, tet, brint, btint, bzint, B);
+    } else {
+        return true;
+    }
+
+    applyRFField(R, t, tet, E, B);
+    return false;
+}
+
+double Cyclotron::computeAzimuth(const Vector_t& R) const {
     double tet = 0.0;
-    if (std::abs(R[0]) < 1.0E-10) {
+    if (fieldTable_m) {
+        tet = std::atan2(R[1], R[0]);
+        if (tet < 0.0) {
+            tet += Physics::two_pi;
+        }
+    } else if (std::abs(R[0]) < 1.0E-10) {
         if (R[1] >= 0.0) {
             tet = Physics::pi / 2.0;
         } else {
@@ -465,36 +501,33 @@ bool Cyclotron::apply(const Vector_t& R, const Vector_t& /*P*/,
         }
     }
 
-    // Necessary for gap phase output -DW
-    if ( 0 <= tet && tet <= (Physics::pi / 4) ) waitingGap_m = 1;
-
-    // dB_{z}/dr, dB_{z}/dtheta, B_{z}
-    double brint = 0.0, btint = 0.0, bzint = 0.0;
-
-    const double rad = std::hypot(R[0],R[1]);
-    if ( this->interpolate(rad, tet, brint, btint, bzint) ) {
+    return tet;
+}
 
-        /* Br */
-        double br = - brint * R[2];
+void Cyclotron::applyMidplaneField(const Vector_t& R, const double& rad, const double& tet,
+                                   const double& brint, const double& btint,
+                                   const double& bzint, Vector_t& B) {
+    /* Br */
+    double br = - brint * R[2];
 
-        /* Btheta */
-        double bt = - btint / rad * R[2];
+    /* Btheta */
+    double bt = - btint / rad * R[2];
 
-        /* Bz */
-        double bz = - bzint;
+    /* Bz */
+    double bz = - bzint;
 
-        this->applyTrimCoil(rad, R[2], tet, br, bz);
+    this->applyTrimCoil(rad, R[2], tet, br, bz);
 
-        /* Br Btheta -> Bx By */
-        B[0] = br * std::cos(tet) - bt * std::sin(tet);
-        B[1] = br * std::sin(tet) + bt * std::cos(tet);
-        B[2] = bz;
-    } else {
-        return true;
-    }
+    /* Br Btheta -> Bx By */
+    B[0] = br * std::cos(tet) - bt * std::sin(tet);
+    B[1] = br * std::sin(tet) + bt * std::cos(tet);
+    B[2] = bz;
+}
 
+void Cyclotron::applyRFField(const Vector_t& R, const double& t,
+                             const double& tet, Vector_t& E, Vector_t& B) {
     if (fieldType_m != BFieldType::SYNCHRO && fieldType_m != BFieldType::BANDRF) {
-        return false;
+        return;
     }
 
     //The RF field is supposed to be sampled on a cartesian grid
@@ -575,7 +608,6 @@ bool Cyclotron::apply(const Vector_t& R, const Vector_t& /*P*/,
             ++rffci, ++rfvci;
         }
     }
-    return false;
 }
 
 void Cyclotron::apply(const double& rad, const double& z,
@@ -585,6 +617,81 @@ void Cyclotron::apply(const double& rad, const double& z,
     this->applyTrimCoil(rad, z, tet_rad, br, bz);
 }
 
+size_t Cyclotron::apply(size_t n, const double* rad, const double* z,
+                        const double* tet_rad, double* br,
+                        double* bt, double* bz, bool* isInside) {
+    this->interpolate(n, rad, tet_rad, br, bt, bz, isInside);
+    size_t numOutside = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!isInside[i]) {
+            br[i] = bt[i] = bz[i] = 0.0;
+            ++numOutside;
+            continue;
+        }
+        this->applyTrimCoil(rad[i], z[i], tet_rad[i], br[i], bz[i]);
+    }
+    return numOutside;
+}
+
+void Cyclotron::applyBatch(const size_t* indices,
+                           size_t n,
+                           const Vector_t* R,
+                           const Vector_t* P,
+                           const double* t,
+                           Vector_t* E,
+                           Vector_t* B,
+                           bool* outOfBounds) {
+
+    std::vector<double> rad(n), tet(n), brint(n), btint(n), bzint(n);
+    std::unique_ptr<bool[]> isInside(new bool[n]);
+    for (size_t k = 0; k < n; ++k) {
+        rad[k] = std::hypot(R[k](0), R[k](1));
+        tet[k] = computeAzimuth(R[k]);
+    }
+
+    // the midplane field of the whole batch, the remaining steps are the
+    // same as in apply(i, t, E, B) and done in the order of the particles
+    this->interpolate(n, rad.data(), tet.data(),
+                      brint.data(), btint.data(), bzint.data(), isInside.get());
+
+    for (size_t k = 0; k < n; ++k) {
+        const size_t id = indices[k];
+        const double zpos = R[k](2);
+
+        bool flagNeedUpdate = false;
+        if (zpos > maxz_m || zpos < minz_m || rad[k] > maxr_m || rad[k] < minr_m) {
+            flagNeedUpdate = true;
+            *gmsgALL << level4 << getName() << ": Particle " << id
+                     << " out of the global aperture of cyclotron!" << endl;
+            *gmsgALL << level4 << getName()
+                     << ": Coords: "<< R[k] << " m"  << endl;
+
+        } else {
+            // Necessary for gap phase output -DW
+            if ( 0 <= tet[k] && tet[k] <= (Physics::pi / 4) ) waitingGap_m = 1;
+
+            if (isInside[k]) {
+                applyMidplaneField(R[k], rad[k], tet[k], brint[k], btint[k], bzint[k], B[k]);
+                applyRFField(R[k], t[k], tet[k], E[k], B[k]);
+            } else {
+                flagNeedUpdate = true;
+                *gmsgALL << level4 << getName() << ": Particle "<< id
+                         << " out of the field map boundary!" << endl;
+                *gmsgALL << level4 << getName()
+                         << ": Coords: "<< R[k] << " m" << endl;
+            }
+        }
+
+        if (flagNeedUpdate) {
+            lossDs_m->addParticle(OpalParticle(id, R[k], P[k],
+                                               t[k], RefPartBunch_m->Q[id], RefPartBunch_m->M[id]),
+                                  std::make_pair(0, RefPartBunch_m->bunchNum[id]));
+            RefPartBunch_m->Bin[id] = -1;
+        }
+        outOfBounds[k] = flagNeedUpdate;
+    }
+}
+
 void Cyclotron::finalise() {
     online_m = false;
     lossDs_m->save();
@@ -714,6 +821,10 @@ bool Cyclotron::interpolate(const double& rad,
                             double& btint,
                             double& bzint) {
 
+    if (fieldTable_m) {
+        return interpolateFromTable(rad, tet_rad, brint, btint, bzint);
+    }
+
     const double xir = (rad - BP_m.rmin_m) / BP_m.delr_m;
 
     // ir : the number of path whose radius is less than the 4 points of cell which surround the particle.
@@ -791,6 +902,97 @@ bool Cyclotron::interpolate(const double& rad,
 }
 
 
+void Cyclotron::interpolate(size_t n,
+                            const double* rad,
+                            const double* tet_rad,
+                            double* brint,
+                            double* btint,
+                            double* bzint,
+                            bool* isInside) {
+    if (fieldTable_m) {
+        for (size_t i = 0; i < n; ++i) {
+            isInside[i] = interpolateFromTable(rad[i], tet_rad[i], brint[i], btint[i], bzint[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            isInside[i] = interpolate(rad[i], tet_rad[i], brint[i], btint[i], bzint[i]);
+        }
+    }
+}
+
+
+// Same bilinear interpolation as in interpolate, the azimuth is reduced to
+// the period of the map without fmod and the conversion to degrees.
+bool Cyclotron::interpolateFromTable(const double& rad,
+                                     const double& tet_rad,
+                                     double& brint,
+                                     double& btint,
+                                     double& bzint) const {
+
+    const double xir = (rad - BP_m.rmin_m) * BTable_m.invDelr_m;
+    const int ir = (int)xir;
+    const double wr1 = xir - (double)ir;
+    const double wr2 = 1.0 - wr1;
+
+    const double tet_map = tet_rad - std::floor(tet_rad / BTable_m.period_m) * BTable_m.period_m;
+    const double xit = tet_map * BTable_m.invDtet_m;
+    const int it = (int)xit;
+    const double wt1 = xit - (double)it;
+    const double wt2 = 1.0 - wt1;
+
+    const int r1t1 = it + BTable_m.offset_m + BTable_m.stride_m * ir;
+    const int r2t2 = r1t1 + BTable_m.stride_m + 1;
+    if ((r1t1 < 0) || (r2t2 >= Bfield_m.ntot_m)) {
+        return false;
+    }
+
+    constexpr int nv = BFieldTable::valuesPerNode_m;
+    const double* r1t1Node = &BTable_m.nodes_m[nv * r1t1];
+    const double* r1t2Node = r1t1Node + nv;
+    const double* r2t1Node = r1t1Node + nv * BTable_m.stride_m;
+    const double* r2t2Node = r2t1Node + nv;
+
+    double values[3];
+    for (int k = 0; k < 3; ++k) {
+        values[k] = r1t1Node[k] * wr2 * wt2 +
+                    r2t1Node[k] * wr1 * wt2 +
+                    r1t2Node[k] * wr2 * wt1 +
+                    r2t2Node[k] * wr1 * wt1;
+    }
+    bzint = values[0];
+    brint = values[1];
+    btint = values[2];
+
+    return true;
+}
+
+
+void Cyclotron::buildFieldTable() {
+    constexpr int nv = BFieldTable::valuesPerNode_m;
+    BTable_m.nodes_m.assign(nv * Bfield_m.ntot_m, 0.0);
+    for (int i = 0; i < Bfield_m.ntot_m; ++i) {
+        BTable_m.nodes_m[nv * i]     = Bfield_m.bfld_m[i];
+        BTable_m.nodes_m[nv * i + 1] = Bfield_m.dbr_m[i];
+        BTable_m.nodes_m[nv * i + 2] = Bfield_m.dbt_m[i];
+    }
+
+    // see interpolate for the index of the nodes
+    if (fieldType_m != BFieldType::FFABF) {
+        BTable_m.stride_m = Bfield_m.ntet_m + 1;
+        BTable_m.offset_m = 0;
+    } else {
+        BTable_m.stride_m = Bfield_m.ntetS_m;
+        BTable_m.offset_m = 1;
+    }
+
+    BTable_m.invDelr_m = 1.0 / BP_m.delr_m;
+    BTable_m.invDtet_m = 1.0 / (BP_m.dtet_m * Units::deg2rad);
+    BTable_m.period_m = Physics::two_pi / symmetry_m;
+
+    *gmsg << "* Precomputed field table with " << Bfield_m.ntot_m << " nodes" << endl;
+}
+
+
 void Cyclotron::read(const double& scaleFactor) {
     if (typeName_m.empty()) {
         throw GeneralClassicException("Cyclotron::read",
@@ -843,6 +1045,10 @@ void Cyclotron::read(const double& scaleFactor) {
 
     // calculate the remaining derivatives
     getdiffs();
+
+    if (fieldTable_m) {
+        buildFieldTable();
+    }
 }
 
 // evaluate other derivative of magnetic field.
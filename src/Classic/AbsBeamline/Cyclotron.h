@@ -29,6 +29,10 @@
 #include "AbsBeamline/Component.h"
 #include "Fields/Definitions.h"
 
+#ifdef WITH_UNIT_TESTS
+#include <gtest/gtest_prod.h>
+#endif
+
 #include <string>
 #include <vector>
 
@@ -77,6 +81,23 @@ struct BPositions {
     double Bfact_m;
 };
 
+// The quantities needed by Cyclotron::interpolate, B_z, dB_z/dr and
+// dB_z/dtheta, interleaved per node of the field map such that the four
+// nodes of a cell are read from two contiguous pieces of memory
+struct BFieldTable {
+    // four values per node, the last one is padding
+    static constexpr int valuesPerNode_m = 4;
+    std::vector<double> nodes_m;
+
+    // the node (ir, it) has the index it + offset_m + stride_m * ir
+    int stride_m;
+    int offset_m;
+
+    double invDelr_m;   // [1/m]
+    double invDtet_m;   // [1/rad]
+    double period_m;    // azimuthal period of the map [rad]
+};
+
 class Cyclotron: public Component {
 
 public:
@@ -188,6 +209,9 @@ public:
     void setSpiralFlag(bool spiral_flag);
     virtual bool getSpiralFlag() const;
 
+    void setFieldTable(bool fieldTable);
+    virtual bool getFieldTable() const;
+
     virtual bool apply(const size_t& id, const double& t, Vector_t& E, Vector_t& B);
 
     virtual bool apply(const Vector_t& R, const Vector_t& P, const double& t, Vector_t& E, Vector_t& B);
@@ -196,6 +220,25 @@ public:
                        const double& tet_rad, double& br,
                        double& bt, double& bz);
 
+    /// Same as apply(rad[i], z[i], tet_rad[i], br[i], bt[i], bz[i]) for
+    /// i = 0, ..., n - 1. isInside[i] is false if point i is outside of the
+    /// field map, its field is set to zero then. Returns the number of
+    /// points outside of the field map.
+    size_t apply(size_t n, const double* rad, const double* z,
+                 const double* tet_rad, double* br,
+                 double* bt, double* bz, bool* isInside);
+
+    /// The midplane field is interpolated for the whole batch, see
+    /// interpolate(n, ...); otherwise the same as apply(i, t, E, B).
+    virtual void applyBatch(const size_t* indices,
+                            size_t n,
+                            const Vector_t* R,
+                            const Vector_t* P,
+                            const double* t,
+                            Vector_t* E,
+                            Vector_t* B,
+                            bool* outOfBounds);
+
     virtual void initialise(PartBunchBase<double, 3>* bunch, double& startField, double& endField);
 
     virtual void initialise(PartBunchBase<double, 3>* bunch, const double& scaleFactor);
@@ -213,6 +256,16 @@ public:
                      double& bt,
                      double& bz);
 
+    /// Same as interpolate for n points, isInside[i] is the return value
+    /// for point i
+    void interpolate(size_t n,
+                     const double* rad,
+                     const double* tet_rad,
+                     double* br,
+                     double* bt,
+                     double* bz,
+                     bool* isInside);
+
     void read(const double& scaleFactor);
 
     void writeOutputFieldFiles();
@@ -225,6 +278,16 @@ private:
     /// Apply trim coils (calculate field contributions)
     void applyTrimCoil_m(const double r, const double z, const double tet_rad, double* br, double* bz);
 
+    /// Azimuth of R in [0, 2 pi) as used for the field map
+    double computeAzimuth(const Vector_t& R) const;
+    /// B from the interpolated midplane quantities and the trim coils
+    void applyMidplaneField(const Vector_t& R, const double& rad, const double& tet,
+                            const double& brint, const double& btint,
+                            const double& bzint, Vector_t& B);
+    /// Add the RF fields of SYNCHRO and BANDRF
+    void applyRFField(const Vector_t& R, const double& t, const double& tet,
+                      Vector_t& E, Vector_t& B);
+
 
 protected:
     void   getdiffs();
@@ -232,6 +295,11 @@ protected:
 
     void   initR(double rmin, double dr, int nrad);
 
+    /// Fill BTable_m from Bfield_m and BP_m
+    void   buildFieldTable();
+    bool   interpolateFromTable(const double& rad, const double& tet_rad,
+                                double& brint, double& btint, double& bzint) const;
+
     void   getFieldFromFile_Ring(const double& scaleFactor);
     void   getFieldFromFile_Carbon(const double& scaleFactor);
     void   getFieldFromFile_CYCIAE(const double& scaleFactor);
@@ -264,6 +332,7 @@ private:
     double pzinit_m;
 
     bool spiralFlag_m;
+    bool fieldTable_m; /**< Interpolate the B-field from BTable_m*/
     double trimCoilThreshold_m; /**< B-field threshold for applying trim coil*/
 
     std::string typeName_m; /**< Name of the TYPE parameter in cyclotron*/
@@ -297,12 +366,19 @@ private:
     // Necessary for quick and dirty phase output -DW
     int waitingGap_m = 1;
 
+#ifdef WITH_UNIT_TESTS
+    FRIEND_TEST(CyclotronTest, ApplyBatch);
+#endif
+
 protected:
     // object of Matrices including magnetic field map and its derivates
     BfieldData Bfield_m;
 
     // object of parameters about the map grid
     BPositions BP_m;
+
+    // interleaved copy of the field map, only if fieldTable_m is set
+    BFieldTable BTable_m;
 };
 
 #endif // CLASSIC_Cyclotron_HH
@@ -296,6 +296,33 @@ bool Multipole::apply(const Vector_t &R, const Vector_t &, const double &, Vecto
     return false;
 }
 
+void Multipole::applyBatch(const size_t */*indices*/,
+                           size_t n,
+                           const Vector_t *R,
+                           const Vector_t */*P*/,
+                           const double */*t*/,
+                           Vector_t *E,
+                           Vector_t *B,
+                           bool *outOfBounds) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t k = 0; k < n; ++ k) {
+        outOfBounds[k] = false;
+        if (R[k](2) < 0.0 || R[k](2) > getElementLength()) continue;
+        if (!isInsideTransverse(R[k])) {
+            outOfBounds[k] = getFlagDeleteOnTransverseExit();
+            continue;
+        }
+
+        Vector_t Ef(0.0), Bf(0.0);
+        computeField(R[k], Ef, Bf);
+
+        E[k] += Ef;
+        B[k] += Bf;
+    }
+}
+
 bool Multipole::applyToReferenceParticle(const Vector_t &R, const Vector_t &, const double &, Vector_t &E, Vector_t &B) {
     if(R(2) < 0.0 || R(2) > getElementLength()) return false;
     if (!isInsideTransverse(R)) return true;
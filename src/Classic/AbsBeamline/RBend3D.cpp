@@ -27,6 +27,7 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <vector>
 
 extern Inform *gmsg;
 
@@ -80,6 +81,27 @@ bool RBend3D::apply(const Vector_t &R, const Vector_t &/*P*/, const  double &/*t
     return false;
 }
 
+void RBend3D::applyBatch(const size_t */*indices*/,
+                         size_t n,
+                         const Vector_t *R,
+                         const Vector_t */*P*/,
+                         const double */*t*/,
+                         Vector_t */*E*/,
+                         Vector_t *B,
+                         bool *outOfBounds) {
+    std::vector<Vector_t> tmpR(n), tmpE(n, Vector_t(0.0)), tmpB(n, Vector_t(0.0));
+    for (size_t k = 0; k < n; ++ k) {
+        tmpR[k] = Vector_t({R[k](0), R[k](1), R[k](2) - startField_m});
+    }
+
+    fieldmap_m->getFieldstrengthBatch(tmpR.data(), n, tmpE.data(), tmpB.data(), outOfBounds);
+
+    for (size_t k = 0; k < n; ++ k) {
+        outOfBounds[k] = false;
+        B[k] += (fieldAmplitude_m + fieldAmplitudeError_m) * tmpB[k];
+    }
+}
+
 bool RBend3D::applyToReferenceParticle(const Vector_t &R, const Vector_t &/*P*/, const  double &/*t*/, Vector_t &/*E*/, Vector_t &B) {
     const Vector_t tmpR({R(0), R(1), R(2) - startField_m});
     Vector_t tmpE(0.0), tmpB(0.0);
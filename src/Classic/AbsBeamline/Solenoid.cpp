@@ -26,6 +26,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 extern Inform *gmsg;
 
@@ -101,6 +103,47 @@ bool Solenoid::apply(const Vector_t &R, const Vector_t &/*P*/, const  double &/*
     return false;
 }
 
+void Solenoid::applyBatch(const size_t */*indices*/,
+                          size_t n,
+                          const Vector_t *R,
+                          const Vector_t */*P*/,
+                          const double */*t*/,
+                          Vector_t */*E*/,
+                          Vector_t *B,
+                          bool *outOfBounds) {
+    // gather the particles within the field and evaluate the field map
+    // for all of them at once
+    std::vector<size_t> inside;
+    std::vector<Vector_t> insideR;
+    inside.reserve(n);
+    insideR.reserve(n);
+    for (size_t k = 0; k < n; ++ k) {
+        outOfBounds[k] = false;
+        if (R[k](2) >= startField_m
+            && R[k](2) < startField_m + getElementLength()) {
+            inside.push_back(k);
+            insideR.push_back(R[k]);
+        }
+    }
+
+    const size_t numInside = inside.size();
+    std::vector<Vector_t> tmpE(numInside, Vector_t(0.0)), tmpB(numInside, Vector_t(0.0));
+    std::unique_ptr<bool[]> fieldmapOutOfBounds(new bool[numInside]);
+    myFieldmap_m->getFieldstrengthBatch(insideR.data(), numInside,
+                                        tmpE.data(), tmpB.data(),
+                                        fieldmapOutOfBounds.get());
+
+    for (size_t j = 0; j < numInside; ++ j) {
+        const size_t k = inside[j];
+        if (fieldmapOutOfBounds[j]) {
+            outOfBounds[k] = getFlagDeleteOnTransverseExit();
+            continue;
+        }
+
+        B[k] += (scale_m + scaleError_m) * tmpB[j];
+    }
+}
+
 bool Solenoid::applyToReferenceParticle(const Vector_t &R, const Vector_t &/*P*/, const  double &/*t*/, Vector_t &/*E*/, Vector_t &B) {
 
     if (R(2) >= startField_m
@@ -137,6 +137,22 @@ bool TravelingWave::apply(const Vector_t& R,
     return false;
 }
 
+void TravelingWave::applyBatch(const size_t* /*indices*/,
+                               size_t n,
+                               const Vector_t* R,
+                               const Vector_t* P,
+                               const double* t,
+                               Vector_t* E,
+                               Vector_t* B,
+                               bool* outOfBounds) {
+    // the entry, core and exit regions map to different positions within
+    // the field map; evaluate particle by particle but without going
+    // through the bunch
+    for (size_t k = 0; k < n; ++ k) {
+        outOfBounds[k] = TravelingWave::apply(R[k], P[k], t[k], E[k], B[k]);
+    }
+}
+
 bool TravelingWave::applyToReferenceParticle(const Vector_t& R,
                                              const Vector_t& /*P*/,
                                              const double& t, Vector_t& E,
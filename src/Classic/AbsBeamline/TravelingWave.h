@@ -59,6 +59,15 @@ public:
 
     virtual bool apply(const Vector_t& R, const Vector_t& P, const double& t, Vector_t& E, Vector_t& B) override;
 
+    virtual void applyBatch(const size_t* indices,
+                            size_t n,
+                            const Vector_t* R,
+                            const Vector_t* P,
+                            const double* t,
+                            Vector_t* E,
+                            Vector_t* B,
+                            bool* outOfBounds) override;
+
     virtual bool applyToReferenceParticle(const Vector_t& R, const Vector_t& P, const double& t, Vector_t& E, Vector_t& B) override;
 
     virtual void initialise(PartBunchBase<double, 3>* bunch, double& startField, double& endField) override;
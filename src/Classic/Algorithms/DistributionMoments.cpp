@@ -30,6 +30,9 @@
 
 #include <boost/numeric/conversion/cast.hpp>
 
+#include <algorithm>
+#include <limits>
+
 extern Inform* gmsg;
 
 const double DistributionMoments::percentileOneSigmaNormalDist_m = std::erf(1 / sqrt(2));
@@ -260,14 +263,13 @@ void DistributionMoments::computePercentiles(const InputIt & first, const InputI
 }
 
 /** Computes the percentile and the range of all local particles that are contained therein.
- *  In a first step the container globalAccumulatedHistogram is looped through until accumulated
- *  histogram value exceeds the required number of particles. The percentile then is between the
- *  boundaries of the last histogram bin before the loop stopped. Then all particle coordinates
- *  that are between the boundaries of this bin are communicated acros all nodes and sorted.
- *  The exact percentile is then determined by counting the n smallest coordinates such that
- *  the total number of partiles results is equal to 'numRequiredParticles'. In accordance with
+ *  In a first step the container globalAccumulatedHistogram is looped through until the accumulated
+ *  histogram value reaches the required number of particles. The particle that completes the
+ *  percentile then is between the boundaries of this histogram bin. It is determined by a
+ *  distributed selection among the particles of this bin, see selectGlobally; only the particles
+ *  of this bin are searched and no particle coordinates are communicated. In accordance with
  *  matlab (?) the percentile is the midpoint between the last particle within the percentile and
- *  tje first particle outside. Finally each node determines which of its particles are contained
+ *  the first particle outside. Finally each node determines which of its particles are contained
  *  in the percentile.
  *
  *  To determine the histogram, the coordinates should not be used directly. Instead, the
@@ -275,7 +277,7 @@ void DistributionMoments::computePercentiles(const InputIt & first, const InputI
  *  so that the percentile values are similar to the standard deviation.
 
  * @param begin: begin of a container containing the one dimensional phase space of all local
- *               particles.
+ *               particles, sorted by |x - <x>|.
  * @param end:   end of the container.
  * @param globalAccumulatedHistogram: container with partial sum of histogram values of position
  *                                    coordinates summed up across all nodes. The first value
@@ -296,45 +298,112 @@ DistributionMoments::determinePercentilesDetail(const DistributionMoments::itera
                                                 unsigned int dimension,
                                                 int numRequiredParticles) const {
     unsigned int numBins = globalAccumulatedHistogram.size() / 3;
-    double percentile = 0.0;
-    iterator_t endPercentile = end;
-    for (unsigned int i = 1; i < numBins; ++ i) {
-        unsigned int idx = dimension * numBins + i;
-        if (globalAccumulatedHistogram[idx] > numRequiredParticles) {
-            iterator_t beginBin = begin + localAccumulatedHistogram[idx - 1];
-            iterator_t endBin = begin + localAccumulatedHistogram[idx];
-            unsigned int numMissingParticles = numRequiredParticles - globalAccumulatedHistogram[idx - 1];
-            unsigned int shift = 2;
-            while (numMissingParticles == 0) {
-                beginBin = begin + localAccumulatedHistogram[idx - shift];
-                numMissingParticles = numRequiredParticles - globalAccumulatedHistogram[idx - shift];
-                ++ shift;
-            }
+    unsigned int offset = dimension * numBins;
+    // the first particle outside of the percentile has to exist
+    if (numRequiredParticles <= 0 ||
+        globalAccumulatedHistogram[offset + numBins - 1] <= numRequiredParticles) {
+        return std::make_pair(0.0, end);
+    }
+
+    unsigned int idx = offset + 1;
+    while (globalAccumulatedHistogram[idx] < numRequiredParticles) {
+        ++ idx;
+    }
 
-            std::vector<unsigned int> numParticlesInBin(Ippl::getNodes() + 1);
-            numParticlesInBin[Ippl::myNode() + 1] = endBin - beginBin;
-            allreduce(&(numParticlesInBin[1]), Ippl::getNodes(), std::plus<unsigned int>());
-            std::partial_sum(numParticlesInBin.begin(), numParticlesInBin.end(), numParticlesInBin.begin());
-
-            std::vector<double> positions(numParticlesInBin.back());
-            std::transform(beginBin, endBin, positions.begin() + numParticlesInBin[Ippl::myNode()],
-                           [&dimension, this](Vektor<double, 2> const& particle)
-                           { return std::abs(particle[0] - meanR_m[dimension]); });
-            allreduce(&(positions[0]), positions.size(), std::plus<double>());
-            std::sort(positions.begin(), positions.end());
-
-            percentile = (*(positions.begin() + numMissingParticles - 1)
-                          + *(positions.begin() + numMissingParticles)) / 2;
-            for (iterator_t it = beginBin; it != endBin; ++ it) {
-                if (std::abs((*it)[0] - meanR_m[dimension]) > percentile) {
-                    return std::make_pair(percentile, it);
-                }
+    auto distance = [&dimension, this](Vektor<double, 2> const& particle)
+                    { return std::abs(particle[0] - meanR_m[dimension]); };
+
+    // last particle within the percentile
+    double lastInside = selectGlobally(begin + localAccumulatedHistogram[idx - 1],
+                                       begin + localAccumulatedHistogram[idx],
+                                       dimension,
+                                       numRequiredParticles - globalAccumulatedHistogram[idx - 1]);
+
+    // first particle outside of the percentile; it either has the same distance as the last
+    // particle inside or it is the particle with the smallest distance beyond
+    iterator_t endInside = std::upper_bound(begin, end, lastInside,
+                                            [&distance](double value, Vektor<double, 2> const& particle)
+                                            { return value < distance(particle); });
+    double data[] = {static_cast<double>(endInside - begin),
+                     endInside != end ? distance(*endInside) : std::numeric_limits<double>::max()};
+    allreduce(&(data[0]), 1, std::plus<double>());
+    allreduce(&(data[1]), 1, std::less<double>());
+    double firstOutside = (data[0] > numRequiredParticles ? lastInside : data[1]);
+
+    double percentile = (lastInside + firstOutside) / 2;
+    iterator_t endPercentile = std::upper_bound(begin, end, percentile,
+                                                [&distance](double value, Vektor<double, 2> const& particle)
+                                                { return value < distance(particle); });
+    return std::make_pair(percentile, endPercentile);
+}
+
+/** Distributed quickselect of the particle with the given rank, in terms of |x - <x>|, among the
+ *  particles in [first, last) of all nodes. The local ranges have to be sorted. In each iteration
+ *  every node contributes the median of its remaining range and the number of particles therein;
+ *  the weighted median of these medians is used as pivot. At least a quarter of the remaining
+ *  particles is discarded per iteration, hence the number of iterations grows logarithmically
+ *  with the number of particles in the ranges and each iteration communicates O(nodes) values.
+ *
+ * @param first: begin of the local range.
+ * @param last:  end of the local range.
+ * @param dimension: dimension of the one dimensional phase space.
+ * @param rank: rank of the requested particle among the particles in the ranges of all nodes,
+ *              starting with 1.
+ * @return: |x - <x>| of the requested particle.
+ */
+double DistributionMoments::selectGlobally(iterator_t first, iterator_t last,
+                                           unsigned int dimension, unsigned int rank) const {
+    auto distance = [&dimension, this](Vektor<double, 2> const& particle)
+                    { return std::abs(particle[0] - meanR_m[dimension]); };
+
+    const unsigned int numNodes = Ippl::getNodes();
+    std::vector<double> medians(2 * numNodes);
+    while (true) {
+        std::fill(medians.begin(), medians.end(), 0.0);
+        if (first != last) {
+            medians[2 * Ippl::myNode()] = distance(*(first + (last - first) / 2));
+            medians[2 * Ippl::myNode() + 1] = last - first;
+        }
+        allreduce(medians.data(), medians.size(), std::plus<double>());
+
+        std::vector<std::pair<double, double>> weightedMedians;
+        double numRemaining = 0.0;
+        for (unsigned int node = 0; node < numNodes; ++ node) {
+            if (medians[2 * node + 1] > 0.0) {
+                weightedMedians.emplace_back(medians[2 * node], medians[2 * node + 1]);
+                numRemaining += medians[2 * node + 1];
+            }
+        }
+        std::sort(weightedMedians.begin(), weightedMedians.end());
+        double pivot = weightedMedians.back().first;
+        double accumulated = 0.0;
+        for (const auto& median: weightedMedians) {
+            accumulated += median.second;
+            if (2 * accumulated >= numRemaining) {
+                pivot = median.first;
+                break;
             }
-            endPercentile = endBin;
-            break;
+        }
+
+        iterator_t beginPivot = std::lower_bound(first, last, pivot,
+                                                 [&distance](Vektor<double, 2> const& particle, double value)
+                                                 { return distance(particle) < value; });
+        iterator_t endPivot = std::upper_bound(beginPivot, last, pivot,
+                                               [&distance](double value, Vektor<double, 2> const& particle)
+                                               { return value < distance(particle); });
+        double counts[] = {static_cast<double>(beginPivot - first),
+                           static_cast<double>(endPivot - first)};
+        allreduce(&(counts[0]), 2, std::plus<double>());
+
+        if (rank <= counts[0]) {
+            last = beginPivot;
+        } else if (rank <= counts[1]) {
+            return pivot;
+        } else {
+            rank -= static_cast<unsigned int>(counts[1]);
+            first = endPivot;
         }
     }
-    return std::make_pair(percentile, endPercentile);
 }
 
 double DistributionMoments::computeNormalizedEmittance(const DistributionMoments::iterator_t& begin,
@@ -91,6 +91,8 @@ private:
                                                              const std::vector<int>& localAccumulatedHistogram,
                                                              unsigned int dimension,
                                                              int numRequiredParticles) const;
+    double selectGlobally(iterator_t first, iterator_t last,
+                          unsigned int dimension, unsigned int rank) const;
     double computeNormalizedEmittance(const iterator_t& begin, const iterator_t& end) const;
     void fillMembers(std::vector<double> const&);
     void reset();
@@ -104,9 +104,13 @@ void PartBunch::computeSelfFields(int binNumber) {
                                              true);
             }
             interpolationCacheSet_m = true;
+            IpplTimings::startTimer(scatterTimer_m);
             this->Q.scatter(this->rho_m, this->R, IntrplCIC_t(), interpolationCache_m);
+            IpplTimings::stopTimer(scatterTimer_m);
         } else {
+            IpplTimings::startTimer(scatterTimer_m);
             this->Q.scatter(this->rho_m, IntrplCIC_t(), interpolationCache_m);
+            IpplTimings::stopTimer(scatterTimer_m);
         }
 
         this->Q /= this->dt;
@@ -179,7 +183,9 @@ void PartBunch::computeSelfFields(int binNumber) {
         /// cached information about where the particles are relative to the
         /// field, since the particles have not moved since this the most recent
         /// scatter operation.
+        IpplTimings::startTimer(gatherTimer_m);
         Eftmp.gather(eg_m, IntrplCIC_t(), interpolationCache_m);
+        IpplTimings::stopTimer(gatherTimer_m);
         //Eftmp.gather(eg_m, this->R, IntrplCIC_t());
 
         /** Magnetic field in x and y direction induced by the electric field.
@@ -274,7 +280,9 @@ void PartBunch::computeSelfFields(int binNumber) {
         /// cached information about where the particles are relative to the
         /// field, since the particles have not moved since this the most recent
         /// scatter operation.
+        IpplTimings::startTimer(gatherTimer_m);
         Eftmp.gather(eg_m, IntrplCIC_t(), interpolationCache_m);
+        IpplTimings::stopTimer(gatherTimer_m);
         //Eftmp.gather(eg_m, this->R, IntrplCIC_t());
 
         /** Magnetic field in x and y direction induced by the image charge electric field. Note that beta will have
@@ -357,7 +365,9 @@ void PartBunch::computeSelfFields() {
 
         //scatter charges onto grid
         this->Q *= this->dt;
+        IpplTimings::startTimer(scatterTimer_m);
         this->Q.scatter(this->rho_m, this->R, IntrplCIC_t());
+        IpplTimings::stopTimer(scatterTimer_m);
         this->Q /= this->dt;
         this->rho_m /= getdT();
 
@@ -442,7 +452,9 @@ void PartBunch::computeSelfFields() {
         // cached information about where the particles are relative to the
         // field, since the particles have not moved since this the most recent
         // scatter operation.
+        IpplTimings::startTimer(gatherTimer_m);
         Ef.gather(eg_m, this->R,  IntrplCIC_t());
+        IpplTimings::stopTimer(gatherTimer_m);
 
         if(fs_m->getFieldSolverType() == FieldSolverType::P3M) {
             fs_m->solver_m->calculatePairForces(this,gammaz);
@@ -498,7 +510,9 @@ void PartBunch::computeSelfFields_cycl(double gamma) {
         resizeMesh();
 
         /// scatter particles charge onto grid.
+        IpplTimings::startTimer(scatterTimer_m);
         this->Q.scatter(this->rho_m, this->R, IntrplCIC_t());
+        IpplTimings::stopTimer(scatterTimer_m);
 
         /// Lorentz transformation
         /// In particle rest frame, the longitudinal length (y for cyclotron) enlarged
@@ -575,7 +589,9 @@ void PartBunch::computeSelfFields_cycl(double gamma) {
 #endif
 
         /// interpolate electric field at particle positions.
+        IpplTimings::startTimer(gatherTimer_m);
         Ef.gather(eg_m, this->R,  IntrplCIC_t());
+        IpplTimings::stopTimer(gatherTimer_m);
 
 
         
@@ -640,7 +656,9 @@ void PartBunch::computeSelfFields_cycl(int bin) {
         resizeMesh();
 
         /// scatter particles charge onto grid.
+        IpplTimings::startTimer(scatterTimer_m);
         this->Q.scatter(this->rho_m, this->R, IntrplCIC_t());
+        IpplTimings::stopTimer(scatterTimer_m);
 
         /// Lorentz transformation
         /// In particle rest frame, the longitudinal length (y for cyclotron) enlarged
@@ -717,7 +735,9 @@ void PartBunch::computeSelfFields_cycl(int bin) {
 #endif
 
         /// Interpolate electric field at particle positions.
+        IpplTimings::startTimer(gatherTimer_m);
         Eftmp.gather(eg_m, this->R,  IntrplCIC_t());
+        IpplTimings::stopTimer(gatherTimer_m);
 
         
         
@@ -159,6 +159,36 @@ public:
     void calcLineDensity(unsigned int nBins, std::vector<double>& lineDensity,
                          std::pair<double, double>& meshInfo);
 
+    /// Bounds and longitudinal line density (not normalized) of the bunch
+    struct LongitudinalProfile {
+        Vector_t rmin;
+        Vector_t rmax;
+        std::vector<double> lineDensity;
+        /// lower end of the first bin and width of the bins
+        double zmin = 0.0;
+        double hz = 0.0;
+
+        /// the profile is valid for this time, track step, number of
+        /// particles and number of bins
+        double t = 0.0;
+        long long step = -1;
+        size_t totalNum = 0;
+        unsigned int nBins = 0;
+    };
+
+    /** \brief Bounds and line density with nBins bins of the bunch
+
+        The particles are deposited in one threaded pass, the bounds and
+        the line density are reduced with one collective each. The result
+        is cached and reused as long as time, track step, number of particles
+        and nBins don't change, hence all wake functions and diagnostics
+        of a step share it. The positions must not be changed in between
+        without calling invalidateLongitudinalProfile.
+    */
+    const LongitudinalProfile& getLongitudinalProfile(unsigned int nBins);
+
+    void invalidateLongitudinalProfile();
+
     void setBeamFrequency(double v);
 
     /*
@@ -196,6 +226,10 @@ public:
 
     void get_bounds(Vector_t& rmin, Vector_t& rmax) const;
 
+    // store global bounds which were computed outside of the bunch, e.g.
+    // together with other quantities in the tracker
+    void setBounds(const Vector_t& rmin, const Vector_t& rmax);
+
     void getLocalBounds(Vector_t& rmin, Vector_t& rmax) const;
 
     std::pair<Vector_t, double> getBoundingSphere();
@@ -487,6 +521,17 @@ public:
 
     virtual void swap(unsigned int i, unsigned int j);
 
+    /// Register Efsc and Bfsc with the particles. They are only needed if
+    /// OPAL-T reuses the space charge fields between solves (SCSOLVEFREQ > 1).
+    void enableSpaceChargeFieldStorage();
+    bool hasSpaceChargeFieldStorage() const;
+
+    /// Sort the local particles along a Morton (Z-order) curve through their
+    /// bounding box such that particles close in space are close in memory.
+    /// All attributes are permuted in one pass. The first local particle keeps
+    /// its position since it serves as reference in some output routines.
+    void sortSpatially();
+
     /*
        Mesh and Field Layout related functions
      */
@@ -581,6 +626,8 @@ public:
     ParticleAttrib< Vector_t >     Eftmp;  // e field vector for gun simulations
 
     ParticleAttrib< Vector_t >     Bf;     // b field vector
+    ParticleAttrib< Vector_t >     Efsc;   // space-charge e field of the last solve in the beam frame, see enableSpaceChargeFieldStorage
+    ParticleAttrib< Vector_t >     Bfsc;   // space-charge b field of the last solve in the beam frame, see enableSpaceChargeFieldStorage
     ParticleAttrib< int >          Bin;    // holds the bin in which the particle is in, if zero particle is marked for deletion
     ParticleAttrib< double >       dt;     // holds the dt timestep for particle
     ParticleAttrib< ParticleType > PType;  // particle names
@@ -622,10 +669,14 @@ protected:
     IpplTimings::TimerRef boundpBoundsTimer_m;
     IpplTimings::TimerRef boundpUpdateTimer_m;
     IpplTimings::TimerRef statParamTimer_m;
+    IpplTimings::TimerRef sortTimer_m;
 
     IpplTimings::TimerRef histoTimer_m;
     /// timer for selfField calculation
     IpplTimings::TimerRef selfFieldTimer_m;
+    /// timers for the charge deposition and the field interpolation
+    IpplTimings::TimerRef scatterTimer_m;
+    IpplTimings::TimerRef gatherTimer_m;
 
     const PartData* reference;
 
@@ -723,8 +774,13 @@ protected:
     Distribution *dist_m;
     DistributionMoments momentsComputer_m;
 
+    /// cached by getLongitudinalProfile
+    LongitudinalProfile longitudinalProfile_m;
+
     // flag to tell if we are a DC-beam
     bool dcBeam_m;
+    // Efsc and Bfsc are registered with the particles
+    bool spaceChargeFieldStorage_m;
     double periodLength_m;
     std::shared_ptr<AbstractParticle<T, Dim> > pbase_m;
 };
@@ -32,8 +32,12 @@
 #include "Utilities/SwitcherError.h"
 #include "Utilities/Util.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 extern Inform* gmsg;
 
@@ -77,6 +81,7 @@ PartBunchBase<T, Dim>::PartBunchBase(AbstractParticle<T, Dim>* pb, const PartDat
       globalPartPerNode_m(nullptr),
       dist_m(nullptr),
       dcBeam_m(false),
+      spaceChargeFieldStorage_m(false),
       periodLength_m(Physics::c / 1e9),
       pbase_m(pb)
 {
@@ -471,38 +476,74 @@ template <class T, unsigned Dim>
 void PartBunchBase<T, Dim>::calcLineDensity(unsigned int nBins,
                                             std::vector<double>& lineDensity,
                                             std::pair<double, double>& meshInfo) {
-    Vector_t rmin, rmax;
-    get_bounds(rmin, rmax);
+    const LongitudinalProfile& profile = getLongitudinalProfile(nBins);
+
+    lineDensity = profile.lineDensity;
+    meshInfo.first = profile.zmin;
+    meshInfo.second = profile.hz;
+}
 
+
+template <class T, unsigned Dim>
+const typename PartBunchBase<T, Dim>::LongitudinalProfile&
+PartBunchBase<T, Dim>::getLongitudinalProfile(unsigned int nBins) {
     if (nBins < 2) {
         Vektor<int, 3>/*NDIndex<3>*/ grid;
         this->updateDomainLength(grid);
         nBins = grid[2];
     }
 
-    double length = rmax(2) - rmin(2);
-    double zmin = rmin(2) - dh_m * length, zmax = rmax(2) + dh_m * length;
+    LongitudinalProfile& profile = longitudinalProfile_m;
+    if (profile.nBins == nBins &&
+        profile.t == getT() &&
+        profile.step == getGlobalTrackStep() &&
+        profile.totalNum == getTotalNum()) {
+        return profile;
+    }
+
+    get_bounds(profile.rmin, profile.rmax);
+
+    double length = profile.rmax(2) - profile.rmin(2);
+    double zmin = profile.rmin(2) - dh_m * length, zmax = profile.rmax(2) + dh_m * length;
     double hz = (zmax - zmin) / (nBins - 2);
     double perMeter = 1.0 / hz;//(zmax - zmin);
     zmin -= hz;
 
-    lineDensity.resize(nBins, 0.0);
-    std::fill(lineDensity.begin(), lineDensity.end(), 0.0);
+    profile.lineDensity.assign(nBins, 0.0);
+    double* lineDensity = profile.lineDensity.data();
 
-    const unsigned int lN = getLocalNum();
-    for (unsigned int i = 0; i < lN; ++ i) {
-        const double z = R[i](2) - 0.5 * hz;
+    // const access, the non-const operator[] marks the attributes as dirty
+    const ParticleAttrib<Vector_t>& pos = R;
+    const ParticleAttrib<double>& charge = Q;
+    const size_t lN = getLocalNum();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+: lineDensity[:nBins])
+#endif
+    for (size_t i = 0; i < lN; ++ i) {
+        const double z = pos[i](2) - 0.5 * hz;
         unsigned int idx = (z - zmin) / hz;
         double tau = (z - zmin) / hz - idx;
 
-        lineDensity[idx] += Q[i] * (1.0 - tau) * perMeter;
-        lineDensity[idx + 1] += Q[i] * tau * perMeter;
+        lineDensity[idx] += charge[i] * (1.0 - tau) * perMeter;
+        lineDensity[idx + 1] += charge[i] * tau * perMeter;
     }
 
-    reduce(&(lineDensity[0]), &(lineDensity[0]) + nBins, &(lineDensity[0]), OpAddAssign());
+    MPI_Allreduce(MPI_IN_PLACE, lineDensity, nBins, MPI_DOUBLE, MPI_SUM, Ippl::getComm());
 
-    meshInfo.first = zmin;
-    meshInfo.second = hz;
+    profile.zmin = zmin;
+    profile.hz = hz;
+    profile.t = getT();
+    profile.step = getGlobalTrackStep();
+    profile.totalNum = getTotalNum();
+    profile.nBins = nBins;
+
+    return profile;
+}
+
+
+template <class T, unsigned Dim>
+void PartBunchBase<T, Dim>::invalidateLongitudinalProfile() {
+    longitudinalProfile_m.nBins = 0;
 }
 
 
@@ -893,6 +934,13 @@ void PartBunchBase<T, Dim>::get_bounds(Vector_t& rmin, Vector_t& rmax) const {
 }
 
 
+template <class T, unsigned Dim>
+void PartBunchBase<T, Dim>::setBounds(const Vector_t& rmin, const Vector_t& rmax) {
+    rmin_m = rmin;
+    rmax_m = rmax;
+}
+
+
 template <class T, unsigned Dim>
 void PartBunchBase<T, Dim>::getLocalBounds(Vector_t& rmin, Vector_t& rmax) const {
     const size_t localNum = getLocalNum();
@@ -1400,6 +1448,7 @@ void PartBunchBase<T, Dim>::setLocalTrackStep(long long n) {
 template <class T, unsigned Dim>
 void PartBunchBase<T, Dim>::incTrackSteps() {
     globalTrackStep_m++; localTrackStep_m++;
+    IpplTimings::setTraceStep(globalTrackStep_m);
 }
 
 
@@ -1822,6 +1871,22 @@ void PartBunchBase<T, Dim>::resetInterpolationCache(bool /*clearCache*/) {
 
 }
 
+template <class T, unsigned Dim>
+void PartBunchBase<T, Dim>::enableSpaceChargeFieldStorage() {
+    if (spaceChargeFieldStorage_m) return;
+
+    pbase_m->addAttribute(Efsc);
+    pbase_m->addAttribute(Bfsc);
+    Efsc.create(getLocalNum());
+    Bfsc.create(getLocalNum());
+    spaceChargeFieldStorage_m = true;
+}
+
+template <class T, unsigned Dim>
+bool PartBunchBase<T, Dim>::hasSpaceChargeFieldStorage() const {
+    return spaceChargeFieldStorage_m;
+}
+
 template <class T, unsigned Dim>
 void PartBunchBase<T, Dim>::swap(unsigned int i, unsigned int j) {
     if (i >= getLocalNum() || j >= getLocalNum() || i == j) return;
@@ -1834,6 +1899,10 @@ void PartBunchBase<T, Dim>::swap(unsigned int i, unsigned int j) {
     std::swap(Ef[i], Ef[j]);
     std::swap(Eftmp[i], Eftmp[j]);
     std::swap(Bf[i], Bf[j]);
+    if (spaceChargeFieldStorage_m) {
+        std::swap(Efsc[i], Efsc[j]);
+        std::swap(Bfsc[i], Bfsc[j]);
+    }
     std::swap(Bin[i], Bin[j]);
     std::swap(dt[i], dt[j]);
     std::swap(PType[i], PType[j]);
@@ -1862,6 +1931,62 @@ void PartBunchBase<T, Dim>::setBCForDCBeam() {
 }
 
 
+template <class T, unsigned Dim>
+void PartBunchBase<T, Dim>::sortSpatially() {
+    const size_t localNum = getLocalNum();
+    if (localNum < 3) return;
+
+    IpplTimings::startTimer(sortTimer_m);
+
+    Vector_t rmin, rmax;
+    getLocalBounds(rmin, rmax);
+
+    // quantize the positions with the number of bits per direction that fit
+    // into a 64 bit key and interleave the bits, most significant first
+    const unsigned int bits = 64 / Dim;
+    const double maxCoordinate = double((uint64_t(1) << bits) - 1);
+    Vector_t scale;
+    for (unsigned int d = 0; d < Dim; ++ d) {
+        scale(d) = (rmax(d) > rmin(d)? maxCoordinate / (rmax(d) - rmin(d)): 0.0);
+    }
+
+    const ParticlePos_t& pos = R;
+    std::vector<std::pair<uint64_t, long> > keys(localNum - 1);
+    const long numKeys = keys.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < numKeys; ++ i) {
+        uint64_t coordinate[Dim];
+        for (unsigned int d = 0; d < Dim; ++ d) {
+            coordinate[d] = uint64_t((pos[i + 1](d) - rmin(d)) * scale(d));
+        }
+        uint64_t key = 0;
+        for (int b = bits - 1; b >= 0; -- b) {
+            for (unsigned int d = 0; d < Dim; ++ d) {
+                key = (key << 1) | ((coordinate[d] >> b) & 1);
+            }
+        }
+        keys[i] = std::make_pair(key, i + 1);
+    }
+
+    // ties are resolved by the index, the result is therefore deterministic
+    std::sort(keys.begin(), keys.end());
+
+    ParticleAttribBase::SortList_t order(localNum);
+    order[0] = 0;
+    for (long i = 0; i < numKeys; ++ i) {
+        order[i + 1] = keys[i].second;
+    }
+    pbase_m->permute(order);
+
+    // the cached mesh information refers to the old order
+    resetInterpolationCache();
+
+    IpplTimings::stopTimer(sortTimer_m);
+}
+
+
 template <class T, unsigned Dim>
 void PartBunchBase<T, Dim>::updateFields(const Vector_t& /*hr*/, const Vector_t& /*origin*/) {
 }
@@ -1889,7 +2014,10 @@ void PartBunchBase<T, Dim>::setup(AbstractParticle<T, Dim>* pb) {
     boundpBoundsTimer_m = IpplTimings::getTimer("Boundingbox-bounds");
     boundpUpdateTimer_m = IpplTimings::getTimer("Boundingbox-update");
     statParamTimer_m    = IpplTimings::getTimer("Compute Statistics");
+    sortTimer_m         = IpplTimings::getTimer("Sort particles");
     selfFieldTimer_m    = IpplTimings::getTimer("SelfField total");
+    scatterTimer_m      = IpplTimings::getTimer("SF: Scatter");
+    gatherTimer_m       = IpplTimings::getTimer("SF: Gather");
 
     histoTimer_m        = IpplTimings::getTimer("Histogram");
 
@@ -8,18 +8,14 @@
 #include "Utilities/Options.h"
 #include "Utilities/Util.h"
 
+#include <algorithm>
 #include <fstream>
 #include <ios>
 
 
 _FM3DDynamic::_FM3DDynamic(const std::string& filename):
     _Fieldmap(filename),
-    FieldstrengthEz_m(nullptr),
-    FieldstrengthEx_m(nullptr),
-    FieldstrengthEy_m(nullptr),
-    FieldstrengthBz_m(nullptr),
-    FieldstrengthBx_m(nullptr),
-    FieldstrengthBy_m(nullptr)
+    Fieldstrength_m(nullptr)
 {
 
     std::string tmpString;
@@ -54,7 +50,12 @@ _FM3DDynamic::_FM3DDynamic(const std::string& filename):
         parsing_passed = parsing_passed &&
                          interpretLine<double, double, unsigned int>(file, zbegin_m, zend_m, num_gridpz_m);
 
-        for(unsigned long i = 0; (i < (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1)) && parsing_passed; ++ i) {
+        // the grid data needn't be validated if they have been cached before
+        const bool cached = parsing_passed &&
+                            FieldmapCache::hasValidCache(Filename_m, 6,
+                                                         (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1));
+
+        for(unsigned long i = 0; !cached && (i < (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1)) && parsing_passed; ++ i) {
             parsing_passed = parsing_passed &&
                              interpretLine<double>(file,
                                                     tmpDouble,
@@ -66,7 +67,7 @@ _FM3DDynamic::_FM3DDynamic(const std::string& filename):
         }
 
         parsing_passed = parsing_passed &&
-                         interpreteEOF(file);
+                         (cached || interpreteEOF(file));
 
         file.close();
 
@@ -112,85 +113,20 @@ FM3DDynamic _FM3DDynamic::create(const std::string& filename)
 }
 
 void _FM3DDynamic::readMap() {
-    if(FieldstrengthEz_m == nullptr) {
-
-    	std::ifstream in(Filename_m.c_str());
-        std::string tmpString;
+    if(Fieldstrength_m == nullptr) {
         const size_t totalSize = num_gridpx_m * num_gridpy_m * num_gridpz_m;
 
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-
-        FieldstrengthEz_m = new double[totalSize];
-        FieldstrengthEx_m = new double[totalSize];
-        FieldstrengthEy_m = new double[totalSize];
-        FieldstrengthBz_m = new double[totalSize];
-        FieldstrengthBx_m = new double[totalSize];
-        FieldstrengthBy_m = new double[totalSize];
-
-        long ii = 0;
-        for(unsigned int i = 0; i < num_gridpx_m; ++ i) {
-            for(unsigned int j = 0; j < num_gridpy_m; ++ j) {
-                for(unsigned int k = 0; k < num_gridpz_m; ++ k) {
-                    interpretLine<double>(in,
-                                           FieldstrengthEx_m[ii],
-                                           FieldstrengthEy_m[ii],
-                                           FieldstrengthEz_m[ii],
-                                           FieldstrengthBx_m[ii],
-                                           FieldstrengthBy_m[ii],
-                                           FieldstrengthBz_m[ii]);
-                    ++ ii;
-                }
-            }
-        }
-        in.close();
-
-        const unsigned int deltaX = num_gridpy_m * num_gridpz_m;
-        const unsigned int deltaY = num_gridpz_m;
-        double Ezmax = 0.0;
-
-        if (normalize_m) {
-            int index_x = static_cast<int>(ceil(-xbegin_m / hx_m));
-            double lever_x = index_x * hx_m + xbegin_m;
-            if(lever_x > 0.5) {
-                -- index_x;
-            }
-
-            int index_y = static_cast<int>(ceil(-ybegin_m / hy_m));
-            double lever_y = index_y * hy_m + ybegin_m;
-            if(lever_y > 0.5) {
-                -- index_y;
-            }
-
-
-            ii = index_x * deltaX + index_y * deltaY;
-            for(unsigned int i = 0; i < num_gridpz_m; i++) {
-                if(std::abs(FieldstrengthEz_m[ii]) > Ezmax) {
-                    Ezmax = std::abs(FieldstrengthEz_m[ii]);
-                }
-                ++ ii;
-            }
-        } else {
-            Ezmax = 1.0;
-        }
-
-        for(unsigned long i = 0; i < totalSize; ++ i) {
+        cache_m.reset(new FieldmapCache(Filename_m, 6, totalSize));
+        cache_m->load([this](double *data) { readASCIIMap(data); });
 
-            FieldstrengthEx_m[i] *= Units::MVpm2Vpm / Ezmax;
-            FieldstrengthEy_m[i] *= Units::MVpm2Vpm / Ezmax;
-            FieldstrengthEz_m[i] *= Units::MVpm2Vpm / Ezmax;
-            FieldstrengthBx_m[i] *= Physics::mu_0 / Ezmax;
-            FieldstrengthBy_m[i] *= Physics::mu_0 / Ezmax;
-            FieldstrengthBz_m[i] *= Physics::mu_0 / Ezmax;
-        }
+        Fieldstrength_m = cache_m->getData();
 
         INFOMSG(level3 << typeset_msg("read in fieldmap '" + Filename_m  + "'", "info") << "\n"
                 << endl);
 
         if (Options::ebDump) {
+            const unsigned int deltaX = num_gridpy_m * num_gridpz_m;
+            const unsigned int deltaY = num_gridpz_m;
             std::vector<Vector_t> ef(num_gridpz_m * num_gridpy_m * num_gridpx_m, 0.0);
             std::vector<Vector_t> bf(ef);
             unsigned long l = 0;
@@ -199,13 +135,9 @@ void _FM3DDynamic::readMap() {
                 for (unsigned long j = 0; j < num_gridpy_m; ++ j) {
                     const unsigned long index_y = j * deltaY;
                     for (unsigned long i = 0; i < num_gridpx_m; ++ i) {
-                        const unsigned long index = i * deltaX + index_y + index_z;
-                        ef[l] = Vector_t({FieldstrengthEx_m[index],
-                                         FieldstrengthEy_m[index],
-                                         FieldstrengthEz_m[index]});
-                        bf[l] = Vector_t({FieldstrengthBx_m[index],
-                                         FieldstrengthBy_m[index],
-                                         FieldstrengthBz_m[index]});
+                        const double *node = Fieldstrength_m + 6 * (i * deltaX + index_y + index_z);
+                        ef[l] = Vector_t({node[0], node[1], node[2]});
+                        bf[l] = Vector_t({node[3], node[4], node[5]});
                         ++ l;
                     }
                 }
@@ -222,25 +154,88 @@ void _FM3DDynamic::readMap() {
     }
 }
 
+void _FM3DDynamic::readASCIIMap(double *data) {
+    std::ifstream in(Filename_m.c_str());
+    std::string tmpString;
+    const size_t totalSize = num_gridpx_m * num_gridpy_m * num_gridpz_m;
+
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+
+    long ii = 0;
+    for(unsigned int i = 0; i < num_gridpx_m; ++ i) {
+        for(unsigned int j = 0; j < num_gridpy_m; ++ j) {
+            for(unsigned int k = 0; k < num_gridpz_m; ++ k) {
+                double *node = data + 6 * ii;
+                interpretLine<double>(in,
+                                       node[0],
+                                       node[1],
+                                       node[2],
+                                       node[3],
+                                       node[4],
+                                       node[5]);
+                ++ ii;
+            }
+        }
+    }
+    in.close();
+
+    const unsigned int deltaX = num_gridpy_m * num_gridpz_m;
+    const unsigned int deltaY = num_gridpz_m;
+    double Ezmax = 0.0;
+
+    if (normalize_m) {
+        int index_x = static_cast<int>(ceil(-xbegin_m / hx_m));
+        double lever_x = index_x * hx_m + xbegin_m;
+        if(lever_x > 0.5) {
+            -- index_x;
+        }
+
+        int index_y = static_cast<int>(ceil(-ybegin_m / hy_m));
+        double lever_y = index_y * hy_m + ybegin_m;
+        if(lever_y > 0.5) {
+            -- index_y;
+        }
+
+
+        ii = index_x * deltaX + index_y * deltaY;
+        for(unsigned int i = 0; i < num_gridpz_m; i++) {
+            if(std::abs(data[6 * ii + 2]) > Ezmax) {
+                Ezmax = std::abs(data[6 * ii + 2]);
+            }
+            ++ ii;
+        }
+    } else {
+        Ezmax = 1.0;
+    }
+
+    for(unsigned long i = 0; i < totalSize; ++ i) {
+        double *node = data + 6 * i;
+
+        node[0] *= Units::MVpm2Vpm / Ezmax;
+        node[1] *= Units::MVpm2Vpm / Ezmax;
+        node[2] *= Units::MVpm2Vpm / Ezmax;
+        node[3] *= Physics::mu_0 / Ezmax;
+        node[4] *= Physics::mu_0 / Ezmax;
+        node[5] *= Physics::mu_0 / Ezmax;
+    }
+}
+
 void _FM3DDynamic::freeMap() {
-    if(FieldstrengthEz_m != nullptr) {
-        delete[] FieldstrengthEz_m;
-        delete[] FieldstrengthEx_m;
-        delete[] FieldstrengthEy_m;
-        delete[] FieldstrengthBz_m;
-        delete[] FieldstrengthBx_m;
-        delete[] FieldstrengthBy_m;
-
-        FieldstrengthEz_m = nullptr;
-        FieldstrengthEx_m = nullptr;
-        FieldstrengthEy_m = nullptr;
-        FieldstrengthBz_m = nullptr;
-        FieldstrengthBx_m = nullptr;
-        FieldstrengthBy_m = nullptr;
+    if(Fieldstrength_m != nullptr) {
+        cache_m.reset();
+
+        Fieldstrength_m = nullptr;
     }
 }
 
-bool _FM3DDynamic::getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B) const {
+bool _FM3DDynamic::getStencil(const Vector_t &R,
+                              unsigned long &index,
+                              double (&weight)[8],
+                              bool &outOfBounds) const {
     const unsigned int index_x = static_cast<int>(std::floor((R(0) - xbegin_m) / hx_m));
     const double lever_x = (R(0) - xbegin_m) / hx_m - index_x;
 
@@ -251,73 +246,110 @@ bool _FM3DDynamic::getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B)
     const double lever_z = (R(2) - zbegin_m) / hz_m - index_z;
 
     if(index_z >= num_gridpz_m - 2) {
+        outOfBounds = false;
         return false;
     }
 
     if(index_x >= num_gridpx_m - 2|| index_y >= num_gridpy_m - 2) {
-        return true;
+        outOfBounds = true;
+        return false;
     }
-    const unsigned int deltaX = num_gridpy_m * num_gridpz_m;
-    const unsigned int deltaY = num_gridpz_m;
-    const unsigned int deltaZ = 1;
-
-    const unsigned long index1 = index_x * deltaX + index_y * deltaY + index_z * deltaZ;
-
-    E(0) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEx_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEx_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthEx_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthEx_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthEx_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthEx_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthEx_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthEx_m[index1 + deltaX + deltaY + deltaZ];
-
-    E(1) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEy_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEy_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthEy_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthEy_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthEy_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthEy_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthEy_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthEy_m[index1 + deltaX + deltaY + deltaZ];
-
-    E(2) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEz_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthEz_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthEz_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthEz_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthEz_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthEz_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthEz_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthEz_m[index1 + deltaX + deltaY + deltaZ];
-
-    B(0) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBx_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBx_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthBx_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthBx_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthBx_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthBx_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthBx_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthBx_m[index1 + deltaX + deltaY + deltaZ];
-
-    B(1) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBy_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBy_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthBy_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthBy_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthBy_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthBy_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthBy_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthBy_m[index1 + deltaX + deltaY + deltaZ];
-
-    B(2) += (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBz_m[index1                           ]
-        + lever_x           * (1.0 - lever_y) * (1.0 - lever_z) * FieldstrengthBz_m[index1 + deltaX                  ]
-        + (1.0 - lever_x)   * lever_y         * (1.0 - lever_z) * FieldstrengthBz_m[index1 +          deltaY         ]
-        + lever_x           * lever_y         * (1.0 - lever_z) * FieldstrengthBz_m[index1 + deltaX + deltaY         ]
-        + (1.0 - lever_x)   * (1.0 - lever_y) * lever_z         * FieldstrengthBz_m[index1 +                   deltaZ]
-        + lever_x           * (1.0 - lever_y) * lever_z         * FieldstrengthBz_m[index1 + deltaX +          deltaZ]
-        + (1.0 - lever_x)   * lever_y         * lever_z         * FieldstrengthBz_m[index1 +          deltaY + deltaZ]
-        + lever_x           * lever_y         * lever_z         * FieldstrengthBz_m[index1 + deltaX + deltaY + deltaZ];
 
-    return false;
+    index = (static_cast<unsigned long>(index_x) * num_gridpy_m + index_y) * num_gridpz_m + index_z;
+
+    weight[0] = (1.0 - lever_x) * (1.0 - lever_y) * (1.0 - lever_z);
+    weight[1] = lever_x         * (1.0 - lever_y) * (1.0 - lever_z);
+    weight[2] = (1.0 - lever_x) * lever_y         * (1.0 - lever_z);
+    weight[3] = lever_x         * lever_y         * (1.0 - lever_z);
+    weight[4] = (1.0 - lever_x) * (1.0 - lever_y) * lever_z;
+    weight[5] = lever_x         * (1.0 - lever_y) * lever_z;
+    weight[6] = (1.0 - lever_x) * lever_y         * lever_z;
+    weight[7] = lever_x         * lever_y         * lever_z;
+
+    outOfBounds = false;
+    return true;
+}
+
+void _FM3DDynamic::interpolate(unsigned long index,
+                               const double (&weight)[8],
+                               Vector_t &E, Vector_t &B) const {
+    // the six components of a grid point are contiguous, such that the
+    // loop over the components below can be vectorized
+    const unsigned long deltaX = 6ul * num_gridpy_m * num_gridpz_m;
+    const unsigned long deltaY = 6ul * num_gridpz_m;
+    const unsigned long deltaZ = 6ul;
+
+    const double *corner0 = Fieldstrength_m + 6 * index;
+    const double *corner1 = corner0 + deltaX;
+    const double *corner2 = corner0 +          deltaY;
+    const double *corner3 = corner0 + deltaX + deltaY;
+    const double *corner4 = corner0 +                   deltaZ;
+    const double *corner5 = corner0 + deltaX +          deltaZ;
+    const double *corner6 = corner0 +          deltaY + deltaZ;
+    const double *corner7 = corner0 + deltaX + deltaY + deltaZ;
+
+    double field[6];
+    for (unsigned int c = 0; c < 6; ++ c) {
+        field[c] = weight[0] * corner0[c]
+            + weight[1] * corner1[c]
+            + weight[2] * corner2[c]
+            + weight[3] * corner3[c]
+            + weight[4] * corner4[c]
+            + weight[5] * corner5[c]
+            + weight[6] * corner6[c]
+            + weight[7] * corner7[c];
+    }
+
+    E(0) += field[0];
+    E(1) += field[1];
+    E(2) += field[2];
+    B(0) += field[3];
+    B(1) += field[4];
+    B(2) += field[5];
+}
+
+bool _FM3DDynamic::getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B) const {
+    unsigned long index;
+    double weight[8];
+    bool outOfBounds;
+
+    if (getStencil(R, index, weight, outOfBounds)) {
+        interpolate(index, weight, E, B);
+    }
+
+    return outOfBounds;
+}
+
+void _FM3DDynamic::getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                         Vector_t *E, Vector_t *B,
+                                         bool *outOfBounds) const {
+    // compute the stencils of a block of particles first and gather the
+    // field data afterwards; keeps the arithmetic and the memory accesses
+    // in separate loops. The blocks are independent of each other.
+    constexpr size_t blockSize = 16;
+    const long numBlocks = (n + blockSize - 1) / blockSize;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long block = 0; block < numBlocks; ++ block) {
+        unsigned long index[blockSize];
+        double weight[blockSize][8];
+        bool inside[blockSize];
+
+        const size_t begin = block * blockSize;
+        const size_t end = std::min(begin + blockSize, n);
+
+        for (size_t i = begin; i < end; ++ i) {
+            inside[i - begin] = getStencil(R[i], index[i - begin], weight[i - begin], outOfBounds[i]);
+        }
+
+        for (size_t i = begin; i < end; ++ i) {
+            if (inside[i - begin]) {
+                interpolate(index[i - begin], weight[i - begin], E[i], B[i]);
+            }
+        }
+    }
 }
 
 bool _FM3DDynamic::getFieldDerivative(const Vector_t &/*R*/, Vector_t &/*E*/, Vector_t &/*B*/, const DiffDirection &/*dir*/) const {
@@ -365,7 +397,7 @@ void _FM3DDynamic::getOnaxisEz(std::vector<std::pair<double, double> > & F) {
     unsigned int ii = (index_y + index_x * num_gridpy_m) * num_gridpz_m;
     for(unsigned int i = 0; i < num_gridpz_m; ++ i) {
         F[i].first = hz_m * i;
-        F[i].second = FieldstrengthEz_m[ii ++] / 1e6;
+        F[i].second = Fieldstrength_m[6 * (ii ++) + 2] / 1e6;
     }
 
     auto opal = OpalData::getInstance();
@@ -2,6 +2,9 @@
 #define CLASSIC_FIELDMAP3DDYNAMIC_HH
 
 #include "Fields/Fieldmap.h"
+#include "Fields/FieldmapCache.h"
+
+#include <memory>
 
 class _FM3DDynamic: public _Fieldmap {
 
@@ -9,6 +12,9 @@ public:
     virtual ~_FM3DDynamic();
 
     virtual bool getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B) const;
+    virtual void getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                       Vector_t *E, Vector_t *B,
+                                       bool *outOfBounds) const;
     virtual void getFieldDimensions(double &zBegin, double &zEnd) const;
     virtual void getFieldDimensions(double &xIni, double &xFinal, double &yIni, double &yFinal, double &zIni, double &zFinal) const;
     virtual bool getFieldDerivative(const Vector_t &R, Vector_t &E, Vector_t &B, const DiffDirection &dir) const;
@@ -27,12 +33,19 @@ private:
     virtual void readMap();
     virtual void freeMap();
 
-    double *FieldstrengthEz_m;    /**< 3D array with Ez */
-    double *FieldstrengthEx_m;    /**< 3D array with Ex */
-    double *FieldstrengthEy_m;    /**< 3D array with Ey */
-    double *FieldstrengthBz_m;    /**< 3D array with Bz */
-    double *FieldstrengthBx_m;    /**< 3D array with Bx */
-    double *FieldstrengthBy_m;    /**< 3D array with By */
+    void readASCIIMap(double *data);
+
+    /// Computes the index of the lower corner of the grid cell containing R
+    /// and the weights of its eight corners. Returns false if no field has
+    /// to be added; outOfBounds is set as getFieldstrength would return it.
+    bool getStencil(const Vector_t &R, unsigned long &index,
+                    double (&weight)[8], bool &outOfBounds) const;
+    void interpolate(unsigned long index, const double (&weight)[8],
+                     Vector_t &E, Vector_t &B) const;
+
+    std::unique_ptr<FieldmapCache> cache_m; /**< owns the storage of the field components */
+
+    const double *Fieldstrength_m;      /**< 3D array with interleaved Ex, Ey, Ez, Bx, By, Bz */
 
     double frequency_m;
 
@@ -97,7 +97,23 @@ bool _FM3DH5Block::getFieldstrength (
     if (!isInside(R)) {
         return true;
     }
-    E += interpolateTrilinearly (FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, R);
-    B += interpolateTrilinearly (FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m, R);
+    const Stencil stencil = getStencil (R);
+    E += interpolateTrilinearly (
+        FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, stencil);
+    B += interpolateTrilinearly (
+        FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m, stencil);
+
     return false;
 }
+
+void _FM3DH5Block::getFieldstrengthBatch (
+    const Vector_t* R,
+    size_t n,
+    Vector_t* E,
+    Vector_t* B,
+    bool* outOfBounds
+    ) const {
+    interpolateBatch (
+        FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m,
+        R, n, E, B, outOfBounds);
+}
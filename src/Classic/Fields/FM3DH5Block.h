@@ -29,6 +29,11 @@ public:
     virtual bool getFieldstrength (
         const Vector_t &R, Vector_t &E, Vector_t &B) const;
 
+    virtual void getFieldstrengthBatch (
+        const Vector_t *R, size_t n,
+        Vector_t *E, Vector_t *B,
+        bool *outOfBounds) const;
+
     virtual ~_FM3DH5Block (
         );
 
@@ -21,6 +21,8 @@
 #include "Physics/Physics.h"
 #include "Utilities/GeneralClassicException.h"
 
+#include <algorithm>
+
 void _FM3DH5BlockBase::openFileMPIOCollective (
     const std::string& filename
     ) {
@@ -158,60 +160,108 @@ void _FM3DH5BlockBase::closeFile (void) {
     }
 }
 
-double _FM3DH5BlockBase::getWeightedData (
-    const std::vector<double>& data,
-    const IndexTriplet& idx,
-    unsigned short corner
+_FM3DH5BlockBase::Stencil _FM3DH5BlockBase::getStencil (
+    const Vector_t& X
     ) const {
-    unsigned short switchX = ((corner & HX) >> 2);
-    unsigned short switchY = ((corner & HY) >> 1);
-    unsigned short switchZ =  (corner & HZ);
-    double factorX = 0.5 + (1 - 2 * switchX) * (0.5 - idx.weight(0));
-    double factorY = 0.5 + (1 - 2 * switchY) * (0.5 - idx.weight(1));
-    double factorZ = 0.5 + (1 - 2 * switchZ) * (0.5 - idx.weight(2));
+    static const unsigned short corners[8] = {
+        LX|LY|LZ, LX|LY|HZ, LX|HY|LZ, LX|HY|HZ,
+        HX|LY|LZ, HX|LY|HZ, HX|HY|LZ, HX|HY|HZ
+    };
+
+    IndexTriplet idx = getIndex (X);
+    Stencil stencil;
+    for (unsigned int n = 0; n < 8; ++ n) {
+        unsigned short switchX = ((corners[n] & HX) >> 2);
+        unsigned short switchY = ((corners[n] & HY) >> 1);
+        unsigned short switchZ =  (corners[n] & HZ);
+        double factorX = 0.5 + (1 - 2 * switchX) * (0.5 - idx.weight(0));
+        double factorY = 0.5 + (1 - 2 * switchY) * (0.5 - idx.weight(1));
+        double factorZ = 0.5 + (1 - 2 * switchZ) * (0.5 - idx.weight(2));
 
-    unsigned long i = idx.i + switchX, j = idx.j + switchY, k = idx.k + switchZ;
+        stencil.weight[n] = factorX * factorY * factorZ;
+        stencil.index[n] = getIndex (idx.i + switchX, idx.j + switchY, idx.k + switchZ);
+    }
 
-    return factorX * factorY * factorZ * data[getIndex(i, j, k)];
+    return stencil;
 }
 
 Vector_t _FM3DH5BlockBase::interpolateTrilinearly (
     const std::vector<double>& field_strength_x,
     const std::vector<double>& field_strength_y,
     const std::vector<double>& field_strength_z,
-    const Vector_t& X
+    const Stencil& stencil
     ) const {
-    IndexTriplet idx = getIndex (X);
+    const std::vector<double>* field_strength[3] = {
+        &field_strength_x, &field_strength_y, &field_strength_z
+    };
+    const unsigned long* index = stencil.index;
+    const double* weight = stencil.weight;
     Vector_t result{0.0};
 
-    result[0] = (getWeightedData(field_strength_x, idx, LX|LY|LZ) +
-                 getWeightedData(field_strength_x, idx, LX|LY|HZ) +
-                 getWeightedData(field_strength_x, idx, LX|HY|LZ) +
-                 getWeightedData(field_strength_x, idx, LX|HY|HZ) +
-                 getWeightedData(field_strength_x, idx, HX|LY|LZ) +
-                 getWeightedData(field_strength_x, idx, HX|LY|HZ) +
-                 getWeightedData(field_strength_x, idx, HX|HY|LZ) +
-                 getWeightedData(field_strength_x, idx, HX|HY|HZ));
+    for (unsigned int c = 0; c < 3; ++ c) {
+        const double* data = field_strength[c]->data();
+        result[c] = (weight[0] * data[index[0]] +
+                     weight[1] * data[index[1]] +
+                     weight[2] * data[index[2]] +
+                     weight[3] * data[index[3]] +
+                     weight[4] * data[index[4]] +
+                     weight[5] * data[index[5]] +
+                     weight[6] * data[index[6]] +
+                     weight[7] * data[index[7]]);
+    }
 
-    result[1] = (getWeightedData(field_strength_y, idx, LX|LY|LZ) +
-                 getWeightedData(field_strength_y, idx, LX|LY|HZ) +
-                 getWeightedData(field_strength_y, idx, LX|HY|LZ) +
-                 getWeightedData(field_strength_y, idx, LX|HY|HZ) +
-                 getWeightedData(field_strength_y, idx, HX|LY|LZ) +
-                 getWeightedData(field_strength_y, idx, HX|LY|HZ) +
-                 getWeightedData(field_strength_y, idx, HX|HY|LZ) +
-                 getWeightedData(field_strength_y, idx, HX|HY|HZ));
+    return result;
+}
 
-    result[2] = (getWeightedData(field_strength_z, idx, LX|LY|LZ) +
-                 getWeightedData(field_strength_z, idx, LX|LY|HZ) +
-                 getWeightedData(field_strength_z, idx, LX|HY|LZ) +
-                 getWeightedData(field_strength_z, idx, LX|HY|HZ) +
-                 getWeightedData(field_strength_z, idx, HX|LY|LZ) +
-                 getWeightedData(field_strength_z, idx, HX|LY|HZ) +
-                 getWeightedData(field_strength_z, idx, HX|HY|LZ) +
-                 getWeightedData(field_strength_z, idx, HX|HY|HZ));
+Vector_t _FM3DH5BlockBase::interpolateTrilinearly (
+    const std::vector<double>& field_strength_x,
+    const std::vector<double>& field_strength_y,
+    const std::vector<double>& field_strength_z,
+    const Vector_t& X
+    ) const {
+    return interpolateTrilinearly (
+        field_strength_x, field_strength_y, field_strength_z, getStencil (X));
+}
 
-    return result;
+void _FM3DH5BlockBase::interpolateBatch (
+    const std::vector<double>& field_strength_x,
+    const std::vector<double>& field_strength_y,
+    const std::vector<double>& field_strength_z,
+    const Vector_t* R,
+    size_t n,
+    Vector_t* E,
+    Vector_t* B,
+    bool* outOfBounds
+    ) const {
+    // compute the stencils of a block of points first and gather the
+    // field data afterwards. The blocks are independent of each other.
+    constexpr size_t blockSize = 16;
+    const long numBlocks = (n + blockSize - 1) / blockSize;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long block = 0; block < numBlocks; ++ block) {
+        Stencil stencil[blockSize];
+
+        const size_t begin = block * blockSize;
+        const size_t end = std::min (begin + blockSize, n);
+
+        for (size_t i = begin; i < end; ++ i) {
+            outOfBounds[i] = !isInside (R[i]);
+            if (!outOfBounds[i]) {
+                stencil[i - begin] = getStencil (R[i]);
+            }
+        }
+
+        for (size_t i = begin; i < end; ++ i) {
+            if (outOfBounds[i]) continue;
+            E[i] += interpolateTrilinearly (
+                FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, stencil[i - begin]);
+            B[i] += interpolateTrilinearly (
+                field_strength_x, field_strength_y, field_strength_z, stencil[i - begin]);
+        }
+    }
 }
 
 void _FM3DH5BlockBase::getInfo (Inform* msg) {
@@ -221,10 +221,24 @@ protected:
         return idx;
     }
 
-    double getWeightedData (
-        const std::vector<double>& data,
-        const IndexTriplet& idx,
-        unsigned short corner) const;
+    /*
+      Indices and weights of the eight corners of the grid cell
+      containing X. They are computed once per point and shared by
+      all interpolated components.
+    */
+    struct Stencil {
+        unsigned long index[8];
+        double weight[8];
+    };
+
+    Stencil getStencil (
+        const Vector_t& X) const;
+
+    Vector_t interpolateTrilinearly (
+        const std::vector<double>&,
+        const std::vector<double>&,
+        const std::vector<double>&,
+        const Stencil& stencil) const;
 
     Vector_t interpolateTrilinearly (
         const std::vector<double>&,
@@ -232,6 +246,21 @@ protected:
         const std::vector<double>&,
         const Vector_t& X) const;
 
+    /*
+      Evaluates the electric field and the field stored in
+      field_strength_{x,y,z} at n points, see
+      _Fieldmap::getFieldstrengthBatch.
+    */
+    void interpolateBatch (
+        const std::vector<double>& field_strength_x,
+        const std::vector<double>& field_strength_y,
+        const std::vector<double>& field_strength_z,
+        const Vector_t* R,
+        size_t n,
+        Vector_t* E,
+        Vector_t* B,
+        bool* outOfBounds) const;
+
     enum : unsigned short {
         LX = 0,  // low X
         LY = 0,  // low Y
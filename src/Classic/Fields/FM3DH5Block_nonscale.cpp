@@ -110,10 +110,23 @@ bool _FM3DH5Block_nonscale::getFieldstrength (
     if (!isInside(R)) {
         return true;
     }
+    const Stencil stencil = getStencil (R);
     E += interpolateTrilinearly (
-        FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, R);
+        FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, stencil);
     B += interpolateTrilinearly (
-        FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m, R);
+        FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m, stencil);
 
     return false;
 }
+
+void _FM3DH5Block_nonscale::getFieldstrengthBatch (
+    const Vector_t* R,
+    size_t n,
+    Vector_t* E,
+    Vector_t* B,
+    bool* outOfBounds
+    ) const {
+    interpolateBatch (
+        FieldstrengthHx_m, FieldstrengthHy_m, FieldstrengthHz_m,
+        R, n, E, B, outOfBounds);
+}
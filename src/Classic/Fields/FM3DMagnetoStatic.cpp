@@ -5,15 +5,14 @@
 #include "Utilities/GeneralClassicException.h"
 #include "Utilities/Util.h"
 
+#include <algorithm>
 #include <fstream>
 #include <ios>
 
 
 _FM3DMagnetoStatic::_FM3DMagnetoStatic(const std::string& filename):
     _Fieldmap(filename),
-    FieldstrengthBz_m(nullptr),
-    FieldstrengthBx_m(nullptr),
-    FieldstrengthBy_m(nullptr) {
+    Fieldstrength_m(nullptr) {
 
     std::string tmpString;
     double tmpDouble;
@@ -45,7 +44,12 @@ _FM3DMagnetoStatic::_FM3DMagnetoStatic(const std::string& filename):
         parsing_passed = parsing_passed &&
                          interpretLine<double, double, unsigned int>(file, zbegin_m, zend_m, num_gridpz_m);
 
-        for(unsigned long i = 0; (i < (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1)) && parsing_passed; ++ i) {
+        // the grid data needn't be validated if they have been cached before
+        const bool cached = parsing_passed &&
+                            FieldmapCache::hasValidCache(Filename_m, 3,
+                                                         (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1));
+
+        for(unsigned long i = 0; !cached && (i < (num_gridpz_m + 1) * (num_gridpx_m + 1) * (num_gridpy_m + 1)) && parsing_passed; ++ i) {
             parsing_passed = parsing_passed &&
                              interpretLine<double>(file,
                                                     tmpDouble,
@@ -54,7 +58,7 @@ _FM3DMagnetoStatic::_FM3DMagnetoStatic(const std::string& filename):
         }
 
         parsing_passed = parsing_passed &&
-                         interpreteEOF(file);
+                         (cached || interpreteEOF(file));
 
         file.close();
 
@@ -95,69 +99,68 @@ FM3DMagnetoStatic _FM3DMagnetoStatic::create(const std::string& filename)
 }
 
 void _FM3DMagnetoStatic::readMap() {
-    if(FieldstrengthBz_m == nullptr) {
-
-    	std::ifstream in(Filename_m.c_str());
-        std::string tmpString;
+    if(Fieldstrength_m == nullptr) {
         const size_t totalSize = num_gridpx_m * num_gridpy_m * num_gridpz_m;
 
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-        getLine(in, tmpString);
-
-        FieldstrengthBz_m = new double[totalSize];
-        FieldstrengthBx_m = new double[totalSize];
-        FieldstrengthBy_m = new double[totalSize];
-
-        long ii = 0;
-        for(unsigned int i = 0; i < num_gridpx_m; ++ i) {
-            for(unsigned int j = 0; j < num_gridpy_m; ++ j) {
-                for(unsigned int k = 0; k < num_gridpz_m; ++ k) {
-                    interpretLine<double>(in,
-                                           FieldstrengthBx_m[ii],
-                                           FieldstrengthBy_m[ii],
-                                           FieldstrengthBz_m[ii]);
-                    ++ ii;
-                }
-            }
-        }
-        in.close();
+        cache_m.reset(new FieldmapCache(Filename_m, 3, totalSize));
+        cache_m->load([this](double *data) { readASCIIMap(data); });
+
+        Fieldstrength_m = cache_m->getData();
+
+        INFOMSG(level3 << typeset_msg("read in fieldmap '" + Filename_m  + "'", "info") << "\n"
+                << endl);
+    }
+}
 
-        if (normalize_m) {
-            double Bymax = 0.0;
-            // find maximum field
-            unsigned int centerX = static_cast<unsigned int>(std::round(-xbegin_m / hx_m));
-            unsigned int centerY = static_cast<unsigned int>(std::round(-ybegin_m / hy_m));
+void _FM3DMagnetoStatic::readASCIIMap(double *data) {
+    std::ifstream in(Filename_m.c_str());
+    std::string tmpString;
+    const size_t totalSize = num_gridpx_m * num_gridpy_m * num_gridpz_m;
+
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+    getLine(in, tmpString);
+
+    long ii = 0;
+    for(unsigned int i = 0; i < num_gridpx_m; ++ i) {
+        for(unsigned int j = 0; j < num_gridpy_m; ++ j) {
             for(unsigned int k = 0; k < num_gridpz_m; ++ k) {
-                double By = FieldstrengthBy_m[getIndex(centerX, centerY, k)];
-                if(std::abs(By) > Bymax) {
-                    Bymax = std::abs(By);
-                }
+                double *node = data + 3 * ii;
+                interpretLine<double>(in,
+                                       node[0],
+                                       node[1],
+                                       node[2]);
+                ++ ii;
             }
-
-            // normalize field
-            for(size_t i = 0; i < totalSize; ++ i) {
-                FieldstrengthBx_m[i] /= Bymax;
-                FieldstrengthBy_m[i] /= Bymax;
-                FieldstrengthBz_m[i] /= Bymax;
+        }
+    }
+    in.close();
+
+    if (normalize_m) {
+        double Bymax = 0.0;
+        // find maximum field
+        unsigned int centerX = static_cast<unsigned int>(std::round(-xbegin_m / hx_m));
+        unsigned int centerY = static_cast<unsigned int>(std::round(-ybegin_m / hy_m));
+        for(unsigned int k = 0; k < num_gridpz_m; ++ k) {
+            double Bycenter = data[3 * getIndex(centerX, centerY, k) + 1];
+            if(std::abs(Bycenter) > Bymax) {
+                Bymax = std::abs(Bycenter);
             }
         }
 
-        INFOMSG(level3 << typeset_msg("read in fieldmap '" + Filename_m  + "'", "info") << "\n"
-                << endl);
+        // normalize field
+        for(size_t i = 0; i < 3 * totalSize; ++ i) {
+            data[i] /= Bymax;
+        }
     }
 }
 
 void _FM3DMagnetoStatic::freeMap() {
-    if(FieldstrengthBz_m != nullptr) {
-        delete[] FieldstrengthBz_m;
-        delete[] FieldstrengthBx_m;
-        delete[] FieldstrengthBy_m;
-
-        FieldstrengthBz_m = nullptr;
-        FieldstrengthBx_m = nullptr;
-        FieldstrengthBy_m = nullptr;
+    if(Fieldstrength_m != nullptr) {
+        cache_m.reset();
+
+        Fieldstrength_m = nullptr;
     }
 }
 
@@ -171,49 +174,83 @@ bool _FM3DMagnetoStatic::getFieldstrength(const Vector_t &R, Vector_t &/*E*/, Ve
     return false;
 }
 
+void _FM3DMagnetoStatic::getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                               Vector_t */*E*/, Vector_t *B,
+                                               bool *outOfBounds) const {
+    // compute the indices and weights of a block of particles first and
+    // gather the field data afterwards. The blocks are independent of each
+    // other.
+    constexpr size_t blockSize = 16;
+    const long numBlocks = (n + blockSize - 1) / blockSize;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long block = 0; block < numBlocks; ++ block) {
+        IndexTriplet idx[blockSize];
+
+        const size_t begin = block * blockSize;
+        const size_t end = std::min(begin + blockSize, n);
+
+        for (size_t i = begin; i < end; ++ i) {
+            outOfBounds[i] = !isInside(R[i]);
+            if (!outOfBounds[i]) {
+                idx[i - begin] = getIndex(R[i]);
+            }
+        }
+
+        for (size_t i = begin; i < end; ++ i) {
+            if (!outOfBounds[i]) {
+                B[i] += interpolateTrilinearly(idx[i - begin]);
+            }
+        }
+    }
+}
+
 Vector_t _FM3DMagnetoStatic::interpolateTrilinearly(const Vector_t &X) const {
-    IndexTriplet idx = getIndex(X);
-    Vector_t B(0.0);
+    return interpolateTrilinearly(getIndex(X));
+}
+
+Vector_t _FM3DMagnetoStatic::interpolateTrilinearly(const IndexTriplet &idx) const {
+    static const unsigned short corners[8] = {LX|LY|LZ, LX|LY|HZ, LX|HY|LZ, LX|HY|HZ,
+                                              HX|LY|LZ, HX|LY|HZ, HX|HY|LZ, HX|HY|HZ};
 
-    B(0) = (getWeightedData(FieldstrengthBx_m, idx, LX|LY|LZ) +
-            getWeightedData(FieldstrengthBx_m, idx, LX|LY|HZ) +
-            getWeightedData(FieldstrengthBx_m, idx, LX|HY|LZ) +
-            getWeightedData(FieldstrengthBx_m, idx, LX|HY|HZ) +
-            getWeightedData(FieldstrengthBx_m, idx, HX|LY|LZ) +
-            getWeightedData(FieldstrengthBx_m, idx, HX|LY|HZ) +
-            getWeightedData(FieldstrengthBx_m, idx, HX|HY|LZ) +
-            getWeightedData(FieldstrengthBx_m, idx, HX|HY|HZ));
-
-    B(1) = (getWeightedData(FieldstrengthBy_m, idx, LX|LY|LZ) +
-            getWeightedData(FieldstrengthBy_m, idx, LX|LY|HZ) +
-            getWeightedData(FieldstrengthBy_m, idx, LX|HY|LZ) +
-            getWeightedData(FieldstrengthBy_m, idx, LX|HY|HZ) +
-            getWeightedData(FieldstrengthBy_m, idx, HX|LY|LZ) +
-            getWeightedData(FieldstrengthBy_m, idx, HX|LY|HZ) +
-            getWeightedData(FieldstrengthBy_m, idx, HX|HY|LZ) +
-            getWeightedData(FieldstrengthBy_m, idx, HX|HY|HZ));
-
-    B(2) = (getWeightedData(FieldstrengthBz_m, idx, LX|LY|LZ) +
-            getWeightedData(FieldstrengthBz_m, idx, LX|LY|HZ) +
-            getWeightedData(FieldstrengthBz_m, idx, LX|HY|LZ) +
-            getWeightedData(FieldstrengthBz_m, idx, LX|HY|HZ) +
-            getWeightedData(FieldstrengthBz_m, idx, HX|LY|LZ) +
-            getWeightedData(FieldstrengthBz_m, idx, HX|LY|HZ) +
-            getWeightedData(FieldstrengthBz_m, idx, HX|HY|LZ) +
-            getWeightedData(FieldstrengthBz_m, idx, HX|HY|HZ));
+    // the three components of a grid point are contiguous
+    double weight[8];
+    const double *node[8];
+    for (unsigned int n = 0; n < 8; ++ n) {
+        weight[n] = getWeight(idx, corners[n]);
+        node[n] = Fieldstrength_m + 3 * getIndex(idx, corners[n]);
+    }
+
+    Vector_t B(0.0);
+    for (unsigned int c = 0; c < 3; ++ c) {
+        B(c) = (weight[0] * node[0][c] +
+                weight[1] * node[1][c] +
+                weight[2] * node[2][c] +
+                weight[3] * node[3][c] +
+                weight[4] * node[4][c] +
+                weight[5] * node[5][c] +
+                weight[6] * node[6][c] +
+                weight[7] * node[7][c]);
+    }
 
     return B;
 }
 
-double _FM3DMagnetoStatic::getWeightedData(double *data, const IndexTriplet &idx, unsigned short corner) const {
+double _FM3DMagnetoStatic::getWeight(const IndexTriplet &idx, unsigned short corner) const {
     unsigned short switchX = ((corner & HX) >> 2), switchY = ((corner & HY) >> 1), switchZ = (corner & HZ);
     double factorX = 0.5 + (1 - 2 * switchX) * (0.5 - idx.weight(0));
     double factorY = 0.5 + (1 - 2 * switchY) * (0.5 - idx.weight(1));
     double factorZ = 0.5 + (1 - 2 * switchZ) * (0.5 - idx.weight(2));
 
-    unsigned long i = idx.i + switchX, j = idx.j + switchY, k = idx.k + switchZ;
+    return factorX * factorY * factorZ;
+}
+
+unsigned long _FM3DMagnetoStatic::getIndex(const IndexTriplet &idx, unsigned short corner) const {
+    unsigned short switchX = ((corner & HX) >> 2), switchY = ((corner & HY) >> 1), switchZ = (corner & HZ);
 
-    return factorX * factorY * factorZ * data[getIndex(i, j, k)];
+    return getIndex(idx.i + switchX, idx.j + switchY, idx.k + switchZ);
 }
 
 bool _FM3DMagnetoStatic::getFieldDerivative(const Vector_t &/*R*/, Vector_t &/*E*/, Vector_t &/*B*/, const DiffDirection &/*dir*/) const {
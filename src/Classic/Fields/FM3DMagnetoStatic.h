@@ -2,6 +2,9 @@
 #define CLASSIC_FIELDMAP3DMAGNETOSTATIC_HH
 
 #include "Fields/Fieldmap.h"
+#include "Fields/FieldmapCache.h"
+
+#include <memory>
 
 class _FM3DMagnetoStatic: public _Fieldmap {
 
@@ -9,6 +12,9 @@ public:
     virtual ~_FM3DMagnetoStatic();
 
     virtual bool getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B) const;
+    virtual void getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                       Vector_t *E, Vector_t *B,
+                                       bool *outOfBounds) const;
     virtual void getFieldDimensions(double &zBegin, double &zEnd) const;
     virtual void getFieldDimensions(double &xIni, double &xFinal, double &yIni, double &yFinal, double &zIni, double &zFinal) const;
     virtual bool getFieldDerivative(const Vector_t &R, Vector_t &E, Vector_t &B, const DiffDirection &dir) const;
@@ -26,6 +32,8 @@ private:
     virtual void readMap();
     virtual void freeMap();
 
+    void readASCIIMap(double *data);
+
     struct IndexTriplet {
         unsigned int i;
         unsigned int j;
@@ -41,8 +49,10 @@ private:
 
     IndexTriplet getIndex(const Vector_t &X) const;
     unsigned long getIndex(unsigned int i, unsigned int j, unsigned int k) const;
+    unsigned long getIndex(const IndexTriplet &idx, unsigned short corner) const;
     Vector_t interpolateTrilinearly(const Vector_t &X) const;
-    double getWeightedData(double *data, const IndexTriplet &idx, unsigned short corner) const;
+    Vector_t interpolateTrilinearly(const IndexTriplet &idx) const;
+    double getWeight(const IndexTriplet &idx, unsigned short corner) const;
 
     enum { LX = 0,  // low X
            LY = 0,  // low Y
@@ -51,9 +61,9 @@ private:
            HY = 2,  // high Y
            HZ = 1}; // high Z
 
-    double *FieldstrengthBz_m;    /**< 3D array with Bz */
-    double *FieldstrengthBx_m;    /**< 3D array with Bx */
-    double *FieldstrengthBy_m;    /**< 3D array with By */
+    std::unique_ptr<FieldmapCache> cache_m; /**< owns the storage of the field components */
+
+    const double *Fieldstrength_m;      /**< 3D array with interleaved Bx, By, Bz */
 
     double xbegin_m;
     double xend_m;
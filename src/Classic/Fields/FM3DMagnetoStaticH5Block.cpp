@@ -94,14 +94,27 @@ bool _FM3DMagnetoStaticH5Block::getFieldstrength (
     if (!isInside(R)) {
         return true;
     }
+    const Stencil stencil = getStencil (R);
     E += interpolateTrilinearly (
-        FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, R);
+        FieldstrengthEx_m, FieldstrengthEy_m, FieldstrengthEz_m, stencil);
     B += interpolateTrilinearly (
-        FieldstrengthBx_m, FieldstrengthBy_m, FieldstrengthBz_m, R);
+        FieldstrengthBx_m, FieldstrengthBy_m, FieldstrengthBz_m, stencil);
 
     return false;
 }
 
+void _FM3DMagnetoStaticH5Block::getFieldstrengthBatch (
+    const Vector_t* R,
+    size_t n,
+    Vector_t* E,
+    Vector_t* B,
+    bool* outOfBounds
+    ) const {
+    interpolateBatch (
+        FieldstrengthBx_m, FieldstrengthBy_m, FieldstrengthBz_m,
+        R, n, E, B, outOfBounds);
+}
+
 double _FM3DMagnetoStaticH5Block::getFrequency (
     ) const {
     return 0.0;
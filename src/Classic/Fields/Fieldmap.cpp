@@ -524,6 +524,14 @@ void _Fieldmap::checkMap(unsigned int accuracy,
     }
 }
 
+void _Fieldmap::getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                      Vector_t *E, Vector_t *B,
+                                      bool *outOfBounds) const {
+    for (size_t i = 0; i < n; ++ i) {
+        outOfBounds[i] = getFieldstrength(R[i], E[i], B[i]);
+    }
+}
+
 void _Fieldmap::setEdgeConstants(const double &/*bendAngle*/, const double &/*entranceAngle*/, const double &/*exitAngle*/)
 {};
 
@@ -74,6 +74,12 @@ public:
 
     // Note: getFieldstrength() returns true if R is outside of the field!
     virtual bool getFieldstrength(const Vector_t &R, Vector_t &E, Vector_t &B) const = 0;
+
+    // Evaluates the field at n positions. E[i] and B[i] are incremented as in
+    // getFieldstrength() and outOfBounds[i] is set to its return value.
+    virtual void getFieldstrengthBatch(const Vector_t *R, size_t n,
+                                       Vector_t *E, Vector_t *B,
+                                       bool *outOfBounds) const;
     virtual bool getFieldDerivative(const Vector_t &R, Vector_t &E, Vector_t &B, const DiffDirection &dir) const = 0;
     virtual void getFieldDimensions(double &zBegin, double &zEnd) const = 0;
     virtual void getFieldDimensions(double &xIni, double &xFinal, double &yIni, double &yFinal, double &zIni, double &zFinal) const = 0;
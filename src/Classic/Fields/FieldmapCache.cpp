@@ -0,0 +1,233 @@
+//
+// Class FieldmapCache
+//   Storage of the grid data of 3D field maps. The data are read once from
+//   the original field map and stored in a binary cache file in the
+//   auxiliary output directory. All processes then map the cache file into
+//   memory, such that processes on the same node share one physical copy
+//   through the page cache. If caching is disabled (see option
+//   CACHEFIELDMAPS) or the cache file cannot be used, the data are kept in
+//   private heap memory.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Fields/FieldmapCache.h"
+
+#include "AbstractObjects/OpalData.h"
+#include "Utilities/Options.h"
+#include "Utilities/Util.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char cacheMagic[8] = "OPALFMC";
+}
+
+FieldmapCache::FieldmapCache(const std::string& fieldmapFile,
+                             unsigned int numComponents,
+                             size_t numGridPoints):
+    fieldmapFile_m(fieldmapFile),
+    cacheFile_m(getCacheFileName(fieldmapFile)),
+    numComponents_m(numComponents),
+    numGridPoints_m(numGridPoints),
+    mapping_m(nullptr),
+    mappingSize_m(0),
+    data_m(nullptr)
+{ }
+
+FieldmapCache::~FieldmapCache() {
+    unmap();
+}
+
+void FieldmapCache::load(const std::function<void(double*)>& reader) {
+    if (data_m != nullptr) return;
+
+    if (!Options::cacheFieldmaps) {
+        heapData_m.resize(numComponents_m * numGridPoints_m);
+        reader(heapData_m.data());
+        data_m = heapData_m.data();
+        return;
+    }
+
+    // purely local: readMap() is called lazily, not necessarily by all
+    // processes at the same time, hence no collective communication here.
+    // Processes that find no cache write it themselves; the file is
+    // replaced atomically, so concurrent writers are harmless
+    if (!hasValidCache(fieldmapFile_m, numComponents_m, numGridPoints_m)) {
+        heapData_m.resize(numComponents_m * numGridPoints_m);
+        reader(heapData_m.data());
+        if (!hasValidCache(fieldmapFile_m, numComponents_m, numGridPoints_m) &&
+            !write(heapData_m.data())) {
+            WARNMSG(level2 << "Couldn't write field map cache '" << cacheFile_m << "'" << endl);
+        }
+    }
+
+    if (map()) {
+        std::vector<double>().swap(heapData_m);
+        return;
+    }
+
+    // fall back to private storage
+    if (heapData_m.empty()) {
+        heapData_m.resize(numComponents_m * numGridPoints_m);
+        reader(heapData_m.data());
+    }
+    data_m = heapData_m.data();
+}
+
+bool FieldmapCache::hasValidCache(const std::string& fieldmapFile,
+                                  unsigned int numComponents,
+                                  size_t numGridPoints) {
+    if (!Options::cacheFieldmaps) return false;
+
+    Header expected = makeHeader(fieldmapFile, numComponents, numGridPoints);
+    Header found;
+    std::string cacheFile = getCacheFileName(fieldmapFile);
+    if (!readHeader(cacheFile, found) || !matches(expected, found)) {
+        return false;
+    }
+
+    std::error_code ec;
+    uintmax_t size = fs::file_size(cacheFile, ec);
+    return !ec && size == dataOffset_m + numComponents * numGridPoints * sizeof(double);
+}
+
+std::string FieldmapCache::getCacheFileName(const std::string& fieldmapFile) {
+    std::error_code ec;
+    fs::path source = fs::weakly_canonical(fieldmapFile, ec);
+    if (ec) source = fs::path(fieldmapFile);
+
+    std::ostringstream name;
+    name << source.stem().string() << "-"
+         << std::hex << std::setw(16) << std::setfill('0')
+         << std::hash<std::string>{}(source.string())
+         << ".fmcache";
+
+    return Util::combineFilePath({
+        OpalData::getInstance()->getAuxiliaryOutputDirectory(),
+        name.str()
+    });
+}
+
+FieldmapCache::Header FieldmapCache::makeHeader(const std::string& fieldmapFile,
+                                                unsigned int numComponents,
+                                                size_t numGridPoints) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, cacheMagic, sizeof(header.magic));
+    header.version = version_m;
+    header.numComponents = numComponents;
+    header.numGridPoints = numGridPoints;
+
+    std::error_code ec;
+    header.sourceSize = fs::file_size(fieldmapFile, ec);
+    if (ec) header.sourceSize = 0;
+    fs::file_time_type mtime = fs::last_write_time(fieldmapFile, ec);
+    header.sourceModificationTime = ec? 0: mtime.time_since_epoch().count();
+
+    return header;
+}
+
+bool FieldmapCache::readHeader(const std::string& cacheFile, Header& header) {
+    std::ifstream in(cacheFile, std::ios::binary);
+    if (!in.good()) return false;
+
+    in.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    return in.good();
+}
+
+bool FieldmapCache::matches(const Header& left, const Header& right) {
+    return (std::memcmp(left.magic, right.magic, sizeof(left.magic)) == 0 &&
+            left.version == right.version &&
+            left.numComponents == right.numComponents &&
+            left.numGridPoints == right.numGridPoints &&
+            left.sourceSize == right.sourceSize &&
+            left.sourceModificationTime == right.sourceModificationTime);
+}
+
+bool FieldmapCache::write(const double* data) const {
+    // write to a temporary file of this process first such that other
+    // processes never see an incomplete cache file
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    std::string tmpFile = cacheFile_m + "." + hostname + "." +
+        std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+        if (!out.good()) return false;
+
+        Header header = makeHeader(fieldmapFile_m, numComponents_m, numGridPoints_m);
+        std::vector<char> padding(dataOffset_m - sizeof(Header), 0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(data), getDataSize());
+        if (!out.good()) return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmpFile, cacheFile_m, ec);
+    if (ec) {
+        fs::remove(tmpFile, ec);
+        return false;
+    }
+    return true;
+}
+
+bool FieldmapCache::map() {
+    int fd = open(cacheFile_m.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat status;
+    size_t fileSize = dataOffset_m + getDataSize();
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) != fileSize) {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    Header expected = makeHeader(fieldmapFile_m, numComponents_m, numGridPoints_m);
+    if (!matches(expected, *static_cast<const Header*>(mapping))) {
+        munmap(mapping, fileSize);
+        return false;
+    }
+
+    mapping_m = mapping;
+    mappingSize_m = fileSize;
+    data_m = reinterpret_cast<const double*>(static_cast<const char*>(mapping) + dataOffset_m);
+
+    return true;
+}
+
+void FieldmapCache::unmap() {
+    if (mapping_m != nullptr) {
+        munmap(mapping_m, mappingSize_m);
+        mapping_m = nullptr;
+        mappingSize_m = 0;
+    }
+    data_m = nullptr;
+}
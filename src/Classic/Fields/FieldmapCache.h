@@ -0,0 +1,123 @@
+//
+// Class FieldmapCache
+//   Storage of the grid data of 3D field maps. The data are read once from
+//   the original field map and stored in a binary cache file in the
+//   auxiliary output directory. Processes then map the cache file into
+//   memory, such that processes on the same node share one physical copy
+//   through the page cache. Loading involves no communication; every process
+//   that finds no valid cache writes it, replacing the file atomically. If caching is disabled (see option
+//   CACHEFIELDMAPS) or the cache file cannot be used, the data are kept in
+//   private heap memory.
+//
+//   The components of a grid point are stored contiguously, i.e. component c
+//   of grid point i is found at i * numComponents + c. This way the
+//   interpolation touches one cache line per corner of a grid cell instead
+//   of one per corner and component.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CLASSIC_FIELDMAPCACHE_H
+#define CLASSIC_FIELDMAPCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class FieldmapCache {
+
+public:
+    FieldmapCache(const std::string& fieldmapFile,
+                  unsigned int numComponents,
+                  size_t numGridPoints);
+
+    ~FieldmapCache();
+
+    FieldmapCache(const FieldmapCache&) = delete;
+    FieldmapCache& operator=(const FieldmapCache&) = delete;
+
+    /// Fill the storage. On a cache miss 'reader' is called with a buffer of
+    /// numComponents * numGridPoints doubles which it has to fill. Local to
+    /// the calling process, may be called lazily from a single process.
+    void load(const std::function<void(double*)>& reader);
+
+    const double* getData() const;
+
+    /// True if the data are memory mapped from the cache file.
+    bool isMapped() const;
+
+    /// True if a cache file matching the field map exists. Can be used to
+    /// skip the validation of the original field map.
+    static bool hasValidCache(const std::string& fieldmapFile,
+                              unsigned int numComponents,
+                              size_t numGridPoints);
+
+    static std::string getCacheFileName(const std::string& fieldmapFile);
+
+private:
+    /// Bump whenever the layout of the cache file changes.
+    static constexpr uint32_t version_m = 2;
+
+    /// Offset of the data within the cache file; page aligned.
+    static constexpr size_t dataOffset_m = 4096;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t numComponents;
+        uint64_t numGridPoints;
+        uint64_t sourceSize;
+        int64_t sourceModificationTime;
+    };
+
+    static Header makeHeader(const std::string& fieldmapFile,
+                             unsigned int numComponents,
+                             size_t numGridPoints);
+    static bool readHeader(const std::string& cacheFile, Header& header);
+    static bool matches(const Header& left, const Header& right);
+
+    bool write(const double* data) const;
+    bool map();
+    void unmap();
+
+    size_t getDataSize() const;
+
+    std::string fieldmapFile_m;
+    std::string cacheFile_m;
+    unsigned int numComponents_m;
+    size_t numGridPoints_m;
+
+    std::vector<double> heapData_m;
+    void* mapping_m;
+    size_t mappingSize_m;
+    const double* data_m;
+};
+
+inline
+const double* FieldmapCache::getData() const {
+    return data_m;
+}
+
+inline
+bool FieldmapCache::isMapped() const {
+    return mapping_m != nullptr;
+}
+
+inline
+size_t FieldmapCache::getDataSize() const {
+    return numComponents_m * numGridPoints_m * sizeof(double);
+}
+
+#endif
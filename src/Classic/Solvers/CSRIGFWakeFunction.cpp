@@ -68,14 +68,22 @@ void CSRIGFWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
         Ez_m[i] = 0.0;
     }
 
-    Vector_t smin, smax;
-    bunch->get_bounds(smin, smax);
+    // bounds of the profile computed in calculateLineDensity
+    const PartBunchBase<double, 3>::LongitudinalProfile& profile =
+        bunch->getLongitudinalProfile(nBins_m);
+    const Vector_t& smin = profile.rmin;
+    const Vector_t& smax = profile.rmax;
+
+    // the tracker doesn't update the moments of the bunch in every step
+    bunch->calcEMean();
+    const double gamma = bunch->get_meanKineticEnergy() / (bunch->getM() * Units::eV2MeV) + 1.0;
+
     double minPathLength = smin(2) + bunch->get_sPos() - FieldBegin_m;
     for (unsigned int i = 1; i < numOfSlices; i++) {
         double pathLengthOfSlice = minPathLength + i * meshSpacing;
         double angleOfSlice = pathLengthOfSlice/bendRadius_m;
         if (angleOfSlice > 0.0 && angleOfSlice <= totalBendAngle_m){
-            calculateGreenFunction(bunch, meshSpacing);
+            calculateGreenFunction(gamma, meshSpacing);
         }
         // convolute with line density
         calculateContributionInside(i, angleOfSlice, meshSpacing);
@@ -149,7 +157,11 @@ void CSRIGFWakeFunction::initialize(const ElementBase* ref) {
 
 void CSRIGFWakeFunction::calculateLineDensity(PartBunchBase<double, 3>* bunch,
                                               std::pair<double, double>& meshInfo) {
-    bunch->calcLineDensity(nBins_m, lineDensity_m, meshInfo);
+    const PartBunchBase<double, 3>::LongitudinalProfile& profile =
+        bunch->getLongitudinalProfile(nBins_m);
+    lineDensity_m.assign(profile.lineDensity.begin(), profile.lineDensity.end());
+    meshInfo.first = profile.zmin;
+    meshInfo.second = profile.hz;
 
     // the following is only needed for after dipole
     std::vector<Filter *>::const_iterator fit;
@@ -160,10 +172,8 @@ void CSRIGFWakeFunction::calculateLineDensity(PartBunchBase<double, 3>* bunch,
     diffOp_m->calc_derivative(dlineDensitydz_m, meshInfo.second);
 }
 
-void CSRIGFWakeFunction::calculateGreenFunction(PartBunchBase<double, 3>* bunch,
-                                                double meshSpacing) {
+void CSRIGFWakeFunction::calculateGreenFunction(double gamma, double meshSpacing) {
     unsigned int numOfSlices = lineDensity_m.size();
-    double gamma = bunch->get_meanKineticEnergy() / (bunch->getM() * Units::eV2MeV)+1.0;
     double xmu_const = 3.0 * gamma * gamma * gamma / (2.0 * bendRadius_m);
     double chi_const = 9.0 / 16.0 * (6.0 - std::log(27.0 / 4.0));
 
@@ -23,6 +23,10 @@
 #include <string>
 #include <vector>
 
+#ifdef WITH_UNIT_TESTS
+#include <gtest/gtest_prod.h>
+#endif
+
 class Filter;
 class ElementBase;
 
@@ -37,11 +41,15 @@ public:
     virtual WakeType getType() const override;
 
 private:
+#ifdef WITH_UNIT_TESTS
+    FRIEND_TEST(CSRIGFWakeFunctionTest, GreenFunctionUsesCurrentEnergy);
+#endif
+
     void calculateLineDensity(PartBunchBase<double, 3>* bunch, std::pair<double, double>& meshInfo);
 
     void calculateContributionInside(size_t sliceNumber, double angleOfSlice, double meshSpacing);
     void calculateContributionAfter(size_t sliceNumber, double angleOfSlice, double meshSpacing);
-    void calculateGreenFunction(PartBunchBase<double, 3>* bunch, double meshSpacing);
+    void calculateGreenFunction(double gamma, double meshSpacing);
     double calcPsi(const double& psiInitial, const double& x, const double& Ds) const;
 
     std::vector<Filter*> filters_m;
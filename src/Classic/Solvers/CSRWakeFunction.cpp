@@ -63,8 +63,11 @@ void CSRWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
         Psi_m.resize(lineDensity_m.size(), 0.0);
     }
 
-    Vector_t smin, smax;
-    bunch->get_bounds(smin, smax);
+    // bounds of the profile computed in calculateLineDensity
+    const PartBunchBase<double, 3>::LongitudinalProfile& profile =
+        bunch->getLongitudinalProfile(nBins_m);
+    const Vector_t& smin = profile.rmin;
+    const Vector_t& smax = profile.rmax;
     double minPathLength = smin(2) + sPos - FieldBegin_m;
     if (sPos + smax(2) < FieldBegin_m) return;
 
@@ -152,7 +155,11 @@ void CSRWakeFunction::initialize(const ElementBase* ref) {
 
 void CSRWakeFunction::calculateLineDensity(PartBunchBase<double, 3>* bunch,
                                            std::pair<double, double>& meshInfo) {
-    bunch->calcLineDensity(nBins_m, lineDensity_m, meshInfo);
+    const PartBunchBase<double, 3>::LongitudinalProfile& profile =
+        bunch->getLongitudinalProfile(nBins_m);
+    lineDensity_m.assign(profile.lineDensity.begin(), profile.lineDensity.end());
+    meshInfo.first = profile.zmin;
+    meshInfo.second = profile.hz;
 
     std::vector<Filter *>::const_iterator fit;
     for (fit = filters_m.begin(); fit != filters_m.end(); ++ fit) {
@@ -19,9 +19,6 @@
 #include "Algorithms/PartBunchBase.h"
 #include "Utilities/GeneralClassicException.h"
 
-#include "gsl/gsl_fft_real.h"
-#include "gsl/gsl_fft_halfcomplex.h"
-
 #include <fstream>
 #include <istream>
 #include <iostream>  // Needed for stream I/O
@@ -38,6 +35,48 @@ const std::map<WakeDirection, std::string> GreenWakeFunction::wakeDirectiontoStr
     {WakeDirection::LONGITUDINAL, "LONGITUDINAL"},
 };
 
+std::map<GreenWakeFunction::WakeKey, std::vector<double>> GreenWakeFunction::wakeCache_s;
+
+GreenWakeFunction::FFTPlan::FFTPlan():
+    N_m(0),
+    real_m(nullptr),
+    halfcomplex_m(nullptr),
+    work_m(nullptr)
+{ }
+
+GreenWakeFunction::FFTPlan::~FFTPlan() {
+    resize(0);
+}
+
+void GreenWakeFunction::FFTPlan::resize(int N) {
+    if (N == N_m) return;
+
+    if (N_m > 0) {
+        gsl_fft_real_wavetable_free(real_m);
+        gsl_fft_halfcomplex_wavetable_free(halfcomplex_m);
+        gsl_fft_real_workspace_free(work_m);
+        real_m = nullptr;
+        halfcomplex_m = nullptr;
+        work_m = nullptr;
+    }
+    N_m = N;
+    if (N_m > 0) {
+        real_m = gsl_fft_real_wavetable_alloc(N_m);
+        halfcomplex_m = gsl_fft_halfcomplex_wavetable_alloc(N_m);
+        work_m = gsl_fft_real_workspace_alloc(N_m);
+    }
+}
+
+void GreenWakeFunction::FFTPlan::forward(double* data, int N) {
+    resize(N);
+    gsl_fft_real_transform(data, 1, N, real_m, work_m);
+}
+
+void GreenWakeFunction::FFTPlan::inverse(double* data, int N) {
+    resize(N);
+    gsl_fft_halfcomplex_inverse(data, 1, N, halfcomplex_m, work_m);
+}
+
 /**
  *
  * @todo        In this code one can only apply either the longitudinal wakefield or the transversal wakefield. One should implement that both wakefields can be applied to the particle beam
@@ -118,17 +157,21 @@ std::pair<int, int> GreenWakeFunction::distrIndices(int vectLen) {
 
 void GreenWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
 
-    Vector_t rmin, rmax;
+    // bounds and line density of the bunch, shared with the other wake
+    // functions of this step
+    const PartBunchBase<double, 3>::LongitudinalProfile& profile =
+        bunch->getLongitudinalProfile(nBins_m);
+    const Vector_t& rmin = profile.rmin;
+    const Vector_t& rmax = profile.rmax;
     double charge = bunch->getChargePerParticle();
     // CKR: was bunch->Q[1] changed it;
     //FIXME: why 1? bunch,getTotalCharge()
     // or bunch->getChargePerParticle()?
     double K = 0; // constant to normalize the lineDensity_m to 1
     double spacing, mindist;
-    std::vector<double> OutEnergy(NBin_m);
+    outEnergy_m.resize(NBin_m);
+    double* OutEnergy = outEnergy_m.data();
 
-    bunch->calcBeamParameters();
-    bunch->get_bounds(rmin, rmax);
     //FIXME IFF: do we have unitless r's here? is that what we want?
 
     mindist = rmin(2);
@@ -149,21 +192,10 @@ void GreenWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
     PAssert(NBin_m > 0);
     spacing /= (NBin_m - 1); //FIXME: why -1? CKR: because grid spacings = grid points - 1
 
-    // Calculate the Wakefield if needed
-    if (FftWField_m.empty()) {
-        FftWField_m.resize(2*NBin_m-1);
-        if (!filename_m.empty()) {
-            setWakeFromFile(NBin_m, spacing);
-        } else {
-            CalcWakeFFT(spacing);
-        }
-    } else if (!constLength_m) {
-        CalcWakeFFT(spacing);
-    }
+    computeWakeField(spacing);
 
-    // Calculate the line density of the particle bunch
-    std::pair<double, double> meshInfo;
-    bunch->calcLineDensity(nBins_m, lineDensity_m, meshInfo);
+    // the line density of the particle bunch is smoothed in place
+    lineDensity_m.assign(profile.lineDensity.begin(), profile.lineDensity.end());
 
 #ifdef ENABLE_WAKE_DEBUG
     *gmsg << "* ************* W A K E ************************************************************ " << endl;
@@ -182,7 +214,7 @@ void GreenWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
     K = 1 / K;
 
     // compute the kick due to the wakefield
-    compEnergy(K, charge, lineDensity_m, OutEnergy.data());
+    compEnergy(K, charge, lineDensity_m, OutEnergy);
 
     // Add the right OutEnergy[i] to all the particles
     //FIXME: can we specify LONG AND TRANS?
@@ -248,7 +280,7 @@ void GreenWakeFunction::apply(PartBunchBase<double, 3>* bunch) {
 }
 
 /**
- * @brief   just a Testfunction!  Calculate the energy of the Wakefunction with the lambda
+ * @brief   Calculate the energy of the Wakefunction with the lambda
  *
  *
  * @param[in]   K a constant
@@ -261,12 +293,9 @@ void GreenWakeFunction::compEnergy(const double K,
                                    const double* lambda,
                                    double* OutEnergy) {
     int N = 2 * NBin_m - 1;
-    // Allocate Space for the zero padded lambda and its Fourier Transformed
-    std::vector<double> pLambda(N);
-
-    gsl_fft_halfcomplex_wavetable *hc;
-    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(N);
-    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(N);
+    // Space for the zero padded lambda and its Fourier Transformed
+    pLambda_m.resize(N);
+    double* pLambda = pLambda_m.data();
 
     // fill the arrays with data
     for (int i = 0; i < NBin_m; i ++) {
@@ -275,8 +304,7 @@ void GreenWakeFunction::compEnergy(const double K,
     }
 
     //FFT of the lambda
-    gsl_fft_real_transform(pLambda.data(), 1, N, real, work);
-    gsl_fft_real_wavetable_free(real);
+    fft_m.forward(pLambda, N);
 
     // convolution -> multiplication in Fourier space
     pLambda[0] *= FftWField_m[0];
@@ -287,9 +315,7 @@ void GreenWakeFunction::compEnergy(const double K,
     }
 
     // inverse transform to get c, the convolution of a and b;
-    hc = gsl_fft_halfcomplex_wavetable_alloc(N);
-
-    gsl_fft_halfcomplex_inverse(pLambda.data(), 1, N, hc, work);
+    fft_m.inverse(pLambda, N);
 
     // Write the result to the output:
     for (int i = 0; i < NBin_m; i ++) {
@@ -300,71 +326,13 @@ void GreenWakeFunction::compEnergy(const double K,
         //      N times your original data
 
     }
-
-
-    gsl_fft_halfcomplex_wavetable_free(hc);
-    gsl_fft_real_workspace_free(work);
 }
 
-/**
- * @brief   Calculate the energy of the Wakefunction with the lambda
- *
- *
- * @param[in]   K a constant
- * @param[in]   charge a constant
- * @param[in]   lambda the distribution of the Particles
- * @param[out]  OutEnergy this is the Output
- *
- */
 void GreenWakeFunction::compEnergy(const double K,
                                    const double charge,
-                                   std::vector<double> lambda,
+                                   const std::vector<double>& lambda,
                                    double* OutEnergy) {
-    int N = 2 * NBin_m - 1;
-    // Allocate Space for the zero padded lambda and its Fourier Transformed
-    std::vector<double> pLambda(N);
-
-    gsl_fft_halfcomplex_wavetable *hc;
-    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(N);
-    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(N);
-
-    // fill the arrays with data
-    for (int i = 0; i < NBin_m; i ++) {
-        pLambda[N-i-1] = 0.0;
-        pLambda[i] = lambda[i];
-    }
-
-    //FFT of the lambda
-    gsl_fft_real_transform(pLambda.data(), 1, N, real, work);
-    gsl_fft_real_wavetable_free(real);
-
-
-    // Convolution -> just a multiplication in Fourier space
-    pLambda[0] *= FftWField_m[0];
-    for (int i = 1; i < N; i += 2) {
-        double temp = pLambda[i];
-        pLambda[i] = FftWField_m[i] * pLambda[i] - FftWField_m[i+1] * pLambda[i+1];
-        pLambda[i+1] = FftWField_m[i] * pLambda[i+1] + FftWField_m[i+1] * temp;
-    }
-
-    // IFFT
-    hc = gsl_fft_halfcomplex_wavetable_alloc(N);
-
-    gsl_fft_halfcomplex_inverse(pLambda.data(), 1, N, hc, work);
-
-    // Write the result to the output:
-    for (int i = 0; i < NBin_m; i ++) {
-        OutEnergy[i] = -charge * K * pLambda[i] / (2.0 * NBin_m) * N; // CKR: I doubt that the multiplication with N is correct,
-        //      put it here to get the same result as with FFTW
-        //      My suspicion: S. Pauli has forgotten that if you
-        //      do an fft followed by an inverse fft you'll get
-        //      N times your original data
-
-    }
-
-
-    gsl_fft_halfcomplex_wavetable_free(hc);
-    gsl_fft_real_workspace_free(work);
+    compEnergy(K, charge, lambda.data(), OutEnergy);
 }
 
 /**
@@ -379,9 +347,6 @@ void GreenWakeFunction::CalcWakeFFT(double spacing) {
     unsigned int N = 1000000;
     int M = 2 * NBin_m - 1;
 
-    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(M);
-    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(M);
-
     const std::pair<int, int> myDist = distrIndices(NBin_m);
     const int lowIndex = myDist.first;
     const int hiIndex  = myDist.second;
@@ -419,7 +384,7 @@ void GreenWakeFunction::CalcWakeFFT(double spacing) {
     }
 #endif
     // calculate the FFT of the Wakefield
-    gsl_fft_real_transform(FftWField_m.data(), 1, M, real, work);
+    fft_m.forward(FftWField_m.data(), M);
 
 
 #ifdef ENABLE_WAKE_TESTS_FFT_OUT
@@ -446,8 +411,6 @@ void GreenWakeFunction::CalcWakeFFT(double spacing) {
     f2.flush();
     f2.close();
 #endif
-    gsl_fft_real_wavetable_free(real);
-    gsl_fft_real_workspace_free(work);
 }
 
 /**
@@ -458,8 +421,6 @@ void GreenWakeFunction::setWakeFromFile(int NBin_m, double spacing) {
     std::string name;
     char temp[256];
     int Np;
-    gsl_fft_real_wavetable *real;
-    gsl_fft_real_workspace *work;
     std::ifstream fs;
 
     fs.open(filename_m.c_str());
@@ -520,13 +481,45 @@ void GreenWakeFunction::setWakeFromFile(int NBin_m, double spacing) {
         FftWField_m[i] = wake[j] + ((wake[j+1] - wake[j]) / (dist[j+1] - dist[j]) * (i * spacing - dist[j]));
     }
 
-    real = gsl_fft_real_wavetable_alloc(NBin_m);
-    work = gsl_fft_real_workspace_alloc(NBin_m);
+    fft_m.forward(FftWField_m.data(), NBin_m);
+}
+
+/**
+ * @brief   Calculates the FFT of the wake if needed. With constant bunch
+ *          length each element computes the wake once, with its own spacing;
+ *          elements using the same wake definition with exactly the same
+ *          spacing share it
+ *
+ * @param[in]   spacing distance between the bins of the line density
+ */
+void GreenWakeFunction::computeWakeField(double spacing) {
+    if (FftWField_m.empty()) {
+        auto cached = (constLength_m ? wakeCache_s.find(getWakeKey(spacing)) : wakeCache_s.end());
+        if (cached != wakeCache_s.end()) {
+            FftWField_m = cached->second;
+        } else {
+            FftWField_m.resize(2*NBin_m-1);
+            if (!filename_m.empty()) {
+                setWakeFromFile(NBin_m, spacing);
+            } else {
+                CalcWakeFFT(spacing);
+            }
+            if (constLength_m) {
+                wakeCache_s[getWakeKey(spacing)] = FftWField_m;
+            }
+        }
+    } else if (!constLength_m) {
+        CalcWakeFFT(spacing);
+    }
+}
 
-    gsl_fft_real_transform(FftWField_m.data(), 1, NBin_m, real, work);
+GreenWakeFunction::WakeKey GreenWakeFunction::getWakeKey(double spacing) const {
+    return WakeKey(getName(), NBin_m, spacing, Z0_m, radius_m, sigma_m, acMode_m, tau_m,
+                   direction_m, filename_m);
+}
 
-    gsl_fft_real_wavetable_free(real);
-    gsl_fft_real_workspace_free(work);
+void GreenWakeFunction::clearWakeCache() {
+    wakeCache_s.clear();
 }
 
 WakeType GreenWakeFunction::getType() const {
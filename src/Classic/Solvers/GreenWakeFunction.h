@@ -23,9 +23,13 @@
 #include "Utility/IpplInfo.h"
 #include "Utility/PAssert.h"
 
+#include "gsl/gsl_fft_halfcomplex.h"
+#include "gsl/gsl_fft_real.h"
+
 #include <complex>
 #include <map>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #ifdef WITH_UNIT_TESTS
@@ -62,11 +66,50 @@ public:
     void setWakeFromFile(int NBin, double spacing);
     virtual WakeType getType() const override;
 
+    /// forget the wakes shared between the elements, e.g. when tracking ends
+    static void clearWakeCache();
+
 private:
 #ifdef WITH_UNIT_TESTS
     FRIEND_TEST(GreenWakeFunctionTest, TestApply);
+    FRIEND_TEST(GreenWakeFunctionTest, TestFFTPlanReuse);
+    FRIEND_TEST(OpalWakeTest, SharedGreenWakeFunction);
 #endif
 
+    /**
+     * @brief   GSL wavetables and workspace of a real FFT. They are allocated
+     *          on the first transform and only reallocated if the length of
+     *          the transform changes.
+     */
+    class FFTPlan {
+
+    public:
+        FFTPlan();
+        ~FFTPlan();
+
+        FFTPlan(const FFTPlan&) = delete;
+        FFTPlan& operator=(const FFTPlan&) = delete;
+
+        /// real to half-complex transform of data[0], ..., data[N-1] in place
+        void forward(double* data, int N);
+        /// inverse half-complex to real transform of data[0], ..., data[N-1] in place
+        void inverse(double* data, int N);
+
+        int getLength() const;
+
+    private:
+        void resize(int N);
+
+        int N_m;
+        gsl_fft_real_wavetable* real_m;
+        gsl_fft_halfcomplex_wavetable* halfcomplex_m;
+        gsl_fft_real_workspace* work_m;
+    };
+
+    /// name of the wake definition, number of bins, spacing of the bins and
+    /// the parameters of the wake
+    typedef std::tuple<std::string, int, double, double, double, double, int, double, WakeDirection, std::string> WakeKey;
+
     class Wake {
 
     public:
@@ -162,6 +205,12 @@ private:
     std::vector<double> lineDensity_m;
     /// FFT of the zero padded wakefield
     std::vector<double>  FftWField_m;
+    /// zero padded line density and its FFT, reused between calls
+    std::vector<double> pLambda_m;
+    /// energy kick per bin, reused between calls
+    std::vector<double> outEnergy_m;
+    /// wavetables and workspace of the FFTs
+    FFTPlan fft_m;
 
     /// divides the particle bunch in NBin slices
     int NBin_m;
@@ -186,9 +235,22 @@ private:
 
     static const std::map<WakeDirection, std::string> wakeDirectiontoString_s;
 
+    /// FFTs of the wakes with constant bunch length, shared by all elements
+    /// using the same wake definition with the same bin spacing
+    static std::map<WakeKey, std::vector<double>> wakeCache_s;
+
+    WakeKey getWakeKey(double spacing) const;
+
+    void computeWakeField(double spacing);
+
     void compEnergy(const double K, const double charge, const double* lambda, double* OutEnergy);
-    void compEnergy(const double K, const double charge, std::vector<double> lambda, double* OutEnergy);
+    void compEnergy(const double K, const double charge, const std::vector<double>& lambda, double* OutEnergy);
     void CalcWakeFFT(double spacing);
     static std::string getWakeDirectionString(const WakeDirection& direction);
 };
+inline
+int GreenWakeFunction::FFTPlan::getLength() const {
+    return N_m;
+}
+
 #endif //GREENWAKEFUNCTION_HH
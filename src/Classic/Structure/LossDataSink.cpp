@@ -21,6 +21,7 @@
 #include "Algorithms/DistributionMoments.h"
 #include "Message/GlobalComm.h"
 #include "OPALconfig.h"
+#include "Structure/H5PartWrapper.h"
 #include "Utilities/GeneralClassicException.h"
 #include "Utilities/Options.h"
 #include "Utilities/Util.h"
@@ -28,6 +29,7 @@
 #include "Utility/IpplInfo.h"
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
 #include <filesystem>
 #include <functional>
@@ -123,6 +125,15 @@ extern Inform* gmsg;
             throw GeneralClassicException(std::string(__func__), ss.str()); \
         }                                                                   \
     }
+#define CHECK_MPIIO(call, what)                                             \
+    {                                                                       \
+        int mpierr = call;                                                  \
+        if (mpierr != MPI_SUCCESS) {                                        \
+            std::stringstream ss;                                           \
+            ss << "failed to " << what << " file " << fileName_m;           \
+            throw GeneralClassicException(std::string(__func__), ss.str()); \
+        }                                                                   \
+    }
 #define CLOSE_FILE()                                                        \
     {                                                                       \
         h5_int64_t h5err = H5CloseFile(H5file_m);                           \
@@ -299,14 +310,27 @@ void LossDataSink::writeHeaderH5() {
     }
 }
 
+void LossDataSink::openASCII(bool truncate) {
+    MPI_Comm comm = Ippl::getComm();
+    CHECK_MPIIO(MPI_File_open(comm, fileName_m.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                              MPI_INFO_NULL, &asciiFile_m),
+                "open");
+    if (truncate) {
+        CHECK_MPIIO(MPI_File_set_size(asciiFile_m, 0), "truncate");
+    }
+    asciiBuffer_m.clear();
+}
+
 void LossDataSink::writeHeaderASCII() {
     bool hasTurn = hasTurnInformations();
     if (Ippl::myNode() == 0) {
-        os_m << "# x (m),  y (m),  z (m),  px ( ),  py ( ),  pz ( ), id";
+        std::ostringstream os;
+        os << "# x (m),  y (m),  z (m),  px ( ),  py ( ),  pz ( ), id";
         if (hasTurn) {
-            os_m << ",  turn ( ), bunchNumber ( )";
+            os << ",  turn ( ), bunchNumber ( )";
         }
-        os_m << ", time (s)" << std::endl;
+        os << ", time (s)\n";
+        asciiBuffer_m += os.str();
     }
 }
 
@@ -346,6 +370,9 @@ void LossDataSink::save(unsigned int numSets, OpalData::OpenMode openMode) {
 
     namespace fs = std::filesystem;
     if (h5hut_mode_m) {
+        // the phase space may be written by a background thread
+        H5PartWrapper::flushAsyncWrites();
+
         fileName_m = outputName_m + std::string(".h5");
         if (openMode == OpalData::OpenMode::WRITE || !fs::exists(fileName_m)) {
             openH5();
@@ -364,13 +391,12 @@ void LossDataSink::save(unsigned int numSets, OpalData::OpenMode openMode) {
     } else {
         fileName_m = outputName_m + std::string(".loss");
         if (openMode == OpalData::OpenMode::WRITE || !fs::exists(fileName_m)) {
-            openASCII();
+            openASCII(true);
             writeHeaderASCII();
         } else {
-            appendASCII();
+            openASCII(false);
         }
         saveASCII();
-        closeASCII();
     }
     *gmsg << level2 << "Save '" << fileName_m << "'" << endl;
 
@@ -419,16 +445,6 @@ void LossDataSink::saveH5(unsigned int setIdx) {
         nLoc     = endIdx - startIdx;
     }
 
-    std::unique_ptr<size_t[]> locN(new size_t[Ippl::getNodes()]);
-    std::unique_ptr<size_t[]> globN(new size_t[Ippl::getNodes()]);
-
-    for (int i = 0; i < Ippl::getNodes(); i++) {
-        globN[i] = locN[i] = 0;
-    }
-
-    locN[Ippl::myNode()] = nLoc;
-    reduce(locN.get(), locN.get() + Ippl::getNodes(), globN.get(), OpAddAssign());
-
     DistributionMoments engine;
     engine.compute(particles_m.begin() + startIdx, particles_m.begin() + endIdx);
 
@@ -550,85 +566,61 @@ void LossDataSink::saveH5(unsigned int setIdx) {
 
 void LossDataSink::saveASCII() {
     /*
-      ASCII output
+      ASCII output, every node formats its own particles and writes them
+      behind the ones of the nodes with lower rank
     */
-    int tag      = Ippl::Comm->next_tag(IPPL_APP_TAG3, IPPL_APP_CYCLE);
     bool hasTurn = hasTurnInformations();
-    if (Ippl::Comm->myNode() == 0) {
-        const unsigned partCount = particles_m.size();
-
-        for (unsigned i = 0; i < partCount; i++) {
-            const OpalParticle& particle = particles_m[i];
-            os_m << particle.getX() << "   ";
-            os_m << particle.getY() << "   ";
-            os_m << particle.getZ() << "   ";
-            os_m << particle.getPx() << "   ";
-            os_m << particle.getPy() << "   ";
-            os_m << particle.getPz() << "   ";
-            os_m << particle.getId() << "   ";
-            if (hasTurn) {
-                os_m << turnNumber_m[i] << "   ";
-                os_m << bunchNumber_m[i] << "   ";
-            }
-            os_m << particle.getTime() << std::endl;
-        }
 
-        int notReceived = Ippl::getNodes() - 1;
-        while (notReceived > 0) {
-            unsigned dataBlocks = 0;
-            int node            = COMM_ANY_NODE;
-            Message* rmsg       = Ippl::Comm->receive_block(node, tag);
-            if (rmsg == 0) {
-                ERRORMSG("LossDataSink: Could not receive from client nodes output." << endl);
-            }
-            notReceived--;
-            rmsg->get(&dataBlocks);
-            rmsg->get(&hasTurn);
-            for (unsigned i = 0; i < dataBlocks; i++) {
-                long id;
-                size_t bunchNum, turn;
-                double rx, ry, rz, px, py, pz, time;
-
-                os_m << (rmsg->get(&rx), rx) << "   ";
-                os_m << (rmsg->get(&ry), ry) << "   ";
-                os_m << (rmsg->get(&rz), rz) << "   ";
-                os_m << (rmsg->get(&px), px) << "   ";
-                os_m << (rmsg->get(&py), py) << "   ";
-                os_m << (rmsg->get(&pz), pz) << "   ";
-                os_m << (rmsg->get(&id), id) << "   ";
-                if (hasTurn) {
-                    os_m << (rmsg->get(&turn), turn) << "   ";
-                    os_m << (rmsg->get(&bunchNum), bunchNum) << "   ";
-                }
-                os_m << (rmsg->get(&time), time) << std::endl;
-            }
-            delete rmsg;
-        }
-    } else {
-        Message* smsg          = new Message();
-        const unsigned msgsize = particles_m.size();
-        smsg->put(msgsize);
-        smsg->put(hasTurn);
-        for (unsigned i = 0; i < msgsize; i++) {
-            const OpalParticle& particle = particles_m[i];
-            smsg->put(particle.getX());
-            smsg->put(particle.getY());
-            smsg->put(particle.getZ());
-            smsg->put(particle.getPx());
-            smsg->put(particle.getPy());
-            smsg->put(particle.getPz());
-            smsg->put(particle.getId());
-            if (hasTurn) {
-                smsg->put(turnNumber_m[i]);
-                smsg->put(bunchNumber_m[i]);
-            }
-            smsg->put(particle.getTime());
-        }
-        bool res = Ippl::Comm->send(smsg, 0, tag);
-        if (!res) {
-            ERRORMSG("LossDataSink Ippl::Comm->send(smsg, 0, tag) failed " << endl);
+    std::ostringstream os;
+    const unsigned partCount = particles_m.size();
+    for (unsigned i = 0; i < partCount; i++) {
+        const OpalParticle& particle = particles_m[i];
+        os << particle.getX() << "   ";
+        os << particle.getY() << "   ";
+        os << particle.getZ() << "   ";
+        os << particle.getPx() << "   ";
+        os << particle.getPy() << "   ";
+        os << particle.getPz() << "   ";
+        os << particle.getId() << "   ";
+        if (hasTurn) {
+            os << turnNumber_m[i] << "   ";
+            os << bunchNumber_m[i] << "   ";
         }
+        os << particle.getTime() << "\n";
+    }
+    asciiBuffer_m += os.str();
+
+    // all nodes have to agree before any collective call, a single node
+    // throwing would leave the others waiting
+    MPI_Comm comm = Ippl::getComm();
+    int tooLarge = (asciiBuffer_m.size() > static_cast<size_t>(INT_MAX));
+    MPI_Allreduce(MPI_IN_PLACE, &tooLarge, 1, MPI_INT, MPI_LOR, comm);
+    if (tooLarge) {
+        asciiBuffer_m = std::string();
+        CHECK_MPIIO(MPI_File_close(&asciiFile_m), "close");
+        throw GeneralClassicException("LossDataSink::saveASCII",
+                                      "too many particles to write to " + fileName_m);
     }
+
+    long long blockSize = asciiBuffer_m.size();
+    long long blockOffset = 0;
+    MPI_Exscan(&blockSize, &blockOffset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (Ippl::myNode() == 0) {
+        // the receive buffer of the first node is undefined
+        blockOffset = 0;
+    }
+
+    MPI_Offset fileSize;
+    CHECK_MPIIO(MPI_File_get_size(asciiFile_m, &fileSize), "get the size of");
+    // the data of the first node may already be written when the others
+    // ask for the size, hence its value is used on all nodes
+    MPI_Bcast(&fileSize, 1, MPI_OFFSET, 0, comm);
+    CHECK_MPIIO(MPI_File_write_at_all(asciiFile_m, fileSize + blockOffset,
+                                      asciiBuffer_m.data(), static_cast<int>(blockSize),
+                                      MPI_CHAR, MPI_STATUS_IGNORE),
+                "write to");
+    CHECK_MPIIO(MPI_File_close(&asciiFile_m), "close");
+    asciiBuffer_m = std::string();
 }
 
 /**
@@ -25,7 +25,8 @@
 
 #include "H5hut.h"
 
-#include <fstream>
+#include <mpi.h>
+
 #include <optional>
 #include <set>
 #include <string>
@@ -75,6 +76,11 @@ enum class CollectionType: unsigned short {
 /*
   - In the destructor we do ALL the file handling
   - h5hut_mode_m defines h5hut or ASCII
+  - Both formats are written collectively by all nodes. In ASCII mode every
+    node formats its own particles and writes them with MPI-IO at the offset
+    given by the exclusive scan of the block sizes. The file is opened,
+    written and closed within save, which is called by all nodes; the
+    destructor doesn't call any collective operation.
  */
 class LossDataSink {
 
@@ -103,31 +109,16 @@ public:
     std::set<SetStatistics> computeStatistics(unsigned int numSets);
 
 private:
-    void openASCII() {
-        if (Ippl::myNode() == 0) {
-            os_m.open(fileName_m.c_str(), std::ios::out);
-        }
-    }
+    // open the ASCII file collectively, truncate it if requested
+    void openASCII(bool truncate);
     void openH5(h5_int32_t mode = H5_O_WRONLY);
 
-    void appendASCII() {
-        if (Ippl::myNode() == 0) {
-            os_m.open(fileName_m.c_str(), std::ios::app);
-        }
-    }
-
     void writeHeaderASCII();
     void writeHeaderH5();
 
     void saveASCII();
     void saveH5(unsigned int setIdx);
 
-    void closeASCII() {
-        if (Ippl::myNode() == 0) {
-            os_m.close();
-        }
-    }
-
     bool hasNoParticlesToDump() const;
     bool hasTurnInformations() const;
 
@@ -141,8 +132,10 @@ private:
     // write either in ASCII or H5hut format
     bool h5hut_mode_m;
 
-    // used to write out data in ASCII mode
-    std::ofstream os_m;
+    // used to write out data in ASCII mode; the buffer holds the formatted
+    // particles of this node during save
+    MPI_File asciiFile_m;
+    std::string asciiBuffer_m;
 
     /// used to write out data in H5hut mode
     h5_file_t H5file_m;
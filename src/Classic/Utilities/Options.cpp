@@ -40,12 +40,22 @@ namespace Options {
 
     bool psDumpEachTurn = false;
 
+    bool asyncPsDump = false;
+
     DumpFrame psDumpFrame = DumpFrame::GLOBAL;
 
+    DumpPrecision psDumpPrecision = DumpPrecision::DOUBLE;
+
+    int psDumpSubsample = 1;
+
+    int psDumpChunkSize = 0;
+
     int sptDumpFreq = 1;
 
     int repartFreq = 10;
 
+    int sortFreq = 0;
+
     int minBinEmitted = 10;
 
     int minStepForRebin = 200;
@@ -54,6 +64,8 @@ namespace Options {
 
     int scSolveFreq = 1;
 
+    double scSolveTol = 0.0;
+
     int mtsSubsteps = 1;
 
     double remotePartDel = 0.0;
@@ -102,6 +114,10 @@ namespace Options {
 
     bool memoryDump = false;
 
+    bool perfDump = false;
+
+    unsigned int traceTimers = 0;
+
     double haloShift = 0.0;
 
     unsigned int delPartFreq = 1;
@@ -110,4 +126,10 @@ namespace Options {
 
     bool dumpBeamMatrix = false;
 
+    bool cacheFieldmaps = false;
+
+    bool cacheGeometry = false;
+
+    int numThreads = 0;
+
 }
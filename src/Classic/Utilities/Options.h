@@ -29,6 +29,11 @@ enum class DumpFrame: unsigned short {
     REFERENCE
 };
 
+enum class DumpPrecision: unsigned short {
+    DOUBLE,
+    SINGLE
+};
+
 namespace Options {
     /// Echo flag.
     //  If true, print an input echo.
@@ -64,18 +69,37 @@ namespace Options {
     //  if true, dump phase space after each turn
     extern bool psDumpEachTurn;
 
+    /// If true, the phase space of OPAL-t is written by a background thread
+    //  while the tracking continues
+    extern bool asyncPsDump;
+
     /// flag to decide in which coordinate frame the phase space will be dumped for OPAL-cycl
     //  - GLOBAL, in Cartesian frame of the global particle
     //  - BUNCH_MEAN, in Cartesian frame of the bunch mean
     //  - REFERENCE, in Cartesian frame of the reference (0) particle
     extern DumpFrame psDumpFrame;
 
+    /// precision of the positions, momenta and fields in the phase space dump
+    extern DumpPrecision psDumpPrecision;
+
+    /// only the particles with ID % psDumpSubsample == 0 are written to the
+    //  phase space dump
+    extern int psDumpSubsample;
+
+    /// number of particles per chunk of the datasets in the phase space
+    //  dump; 0 stores the datasets contiguously
+    extern int psDumpChunkSize;
+
     /// The frequency to dump single particle trajectory of particles with ID = 0 & 1
     extern int sptDumpFreq;
 
     /// The frequency to do particles repartition for better load balance between nodes
     extern int repartFreq;
 
+    /// The frequency to sort the particles of a bunch along a space-filling
+    /// curve for better memory locality; 0 disables the sorting
+    extern int sortFreq;
+
     /// The number of bins that have to be emitted before the bin are squashed into a single bin
     extern int minBinEmitted;
 
@@ -88,6 +112,11 @@ namespace Options {
     /// The frequency to solve space charge fields.
     extern int scSolveFreq;
 
+    /// In OPAL-T the space charge fields are solved before scSolveFreq steps have passed
+    /// if the rms beam size or the mean Lorentz factor have changed by more than this
+    /// fraction since the last solve. 0, the default, disables the criterion.
+    extern double scSolveTol;
+
     // How many small timesteps are inside the large timestep used in multiple time stepping (MTS) integrator
     extern int mtsSubsteps;
 
@@ -156,6 +185,13 @@ namespace Options {
 
     extern bool memoryDump;
 
+    /// If true, write performance information per step to an SDDS file
+    extern bool perfDump;
+
+    /// If positive, the intervals of the timers are recorded, keeping this many of the
+    /// last intervals per thread, and written to timing-trace-<rank>.json
+    extern unsigned int traceTimers;
+
     /// The constant parameter C to shift halo, by < w^4 > / < w^2 > ^2 - C (w=x,y,z)
     extern double haloShift;
 
@@ -166,6 +202,16 @@ namespace Options {
    
     extern bool dumpBeamMatrix;
 
+    /// If true 3D field maps are converted into a binary cache file which is memory mapped
+    extern bool cacheFieldmaps;
+
+    /// If true the search structure of a GEOMETRY and the oriented triangles are
+    /// stored in a cache file next to the geometry file
+    extern bool cacheGeometry;
+
+    /// The number of OpenMP threads per process; 0 leaves the OpenMP default
+    extern int numThreads;
+
 }
 
 #endif // OPAL_Options_HH
@@ -33,6 +33,7 @@
 #include <filesystem>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <utility>
@@ -871,12 +872,23 @@ void ClosedOrbitFinder<Value_type, Size_type, Stepper>::computeOrbitProperties(c
     fidx_m.resize(N_m);
     ds_m.resize(N_m);
 
+    // interpolate magnetic field at all points of the orbit
+    container_type thetas(N_m), bints(N_m), brints(N_m), btints(N_m);
     for (size_type i = 0; i < N_m; ++i) {
-        // interpolate magnetic field
-        cycl_m->apply(r_m[i], vz_m[i], theta, brint, btint, bint);
-        bint  *= invbcon;
-        brint *= invbcon;
-        btint *= invbcon;
+        thetas[i] = theta;
+        // increase angle
+        theta += dtheta_m;
+    }
+    // points of the orbit outside of the field map are not rejected, their
+    // field is zero
+    std::unique_ptr<bool[]> isInside(new bool[N_m]);
+    cycl_m->apply(N_m, r_m.data(), vz_m.data(), thetas.data(),
+                  brints.data(), btints.data(), bints.data(), isInside.get());
+
+    for (size_type i = 0; i < N_m; ++i) {
+        bint  = bints[i] * invbcon;
+        brint = brints[i] * invbcon;
+        btint = btints[i] * invbcon;
 
         // inverse bending radius
         h_m[i] = bint / p;
@@ -892,9 +904,6 @@ void ClosedOrbitFinder<Value_type, Size_type, Stepper>::computeOrbitProperties(c
 
         // path length element
         ds_m[i] = std::hypot(r_m[i] * pr_m[i] / ptheta,r_m[i]) * dtheta_m; // C++11 function
-
-        // increase angle
-        theta += dtheta_m;
     }
 
     // compute average radius
@@ -111,6 +111,10 @@ OpalCyclotron::OpalCyclotron():
     itsAttr[TRIMCOIL] = Attributes::makeStringArray
         ("TRIMCOIL", "List of trim coils");
 
+    itsAttr[FIELDTABLE] = Attributes::makeBool
+        ("FIELDTABLE", "If TRUE, the B-field is interpolated from a table with the field and "
+         "its derivatives stored per node of the fieldmap (default=FALSE)", false);
+
     registerOwnership();
 
     setElement(new CyclotronRep("CYCLOTRON"));
@@ -183,6 +187,7 @@ void OpalCyclotron::update() {
     cycl->setFMHighE(fmHighE);
 
     cycl->setSpiralFlag(spiral_flag);
+    cycl->setFieldTable(Attributes::getBool(itsAttr[FIELDTABLE]));
     cycl->setTrimCoilThreshold(trimCoilThreshold);
 
     cycl->setOutputFN(Attributes::getString(itsAttr[OUTFN]));
@@ -54,6 +54,7 @@ public:
         SPIRAL,             // flag whether or not this is a spiral inflector simulation
         TRIMCOILTHRESHOLD,  // minimum B-field for which trim coils are applied
         TRIMCOIL,           // list of trim coils
+        FIELDTABLE,         // interpolate the B-field from a precomputed table
         SIZE
     };
 
@@ -523,6 +523,8 @@ int opalMain(int argc, char *argv[]) {
     IpplTimings::print(std::string("timing.dat"),
                        OpalData::getInstance()->getProblemCharacteristicValues());
 
+    IpplTimings::writeTrace("timing-trace");
+
     Ippl::Comm->barrier();
     _Fieldmap::clearDictionary();
     OpalData::deleteInstance();
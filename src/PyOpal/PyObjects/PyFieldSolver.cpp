@@ -36,6 +36,9 @@ namespace PyOpal {
             {"BCFFTY", "fft_boundary_y", "", PyOpalObjectNS::PREDEFINED_STRING},
             {"BCFFTZ", "fft_boundary_z", "", PyOpalObjectNS::PREDEFINED_STRING},
             {"GREENSF", "greens_function", "", PyOpalObjectNS::PREDEFINED_STRING},
+            {"FFTLIB", "fft_library", "", PyOpalObjectNS::PREDEFINED_STRING},
+            {"GREENSFTOL", "greens_function_tolerance", "", PyOpalObjectNS::DOUBLE},
+            {"PRUNEDFFT", "pruned_fft", "", PyOpalObjectNS::BOOL},
             {"BBOXINCR", "bounding_box_increase", "", PyOpalObjectNS::DOUBLE},
             {"GEOMETRY", "geometry", "", PyOpalObjectNS::UPPER_CASE_STRING},
             {"ITSOLVER", "iterative_solver", "", PyOpalObjectNS::PREDEFINED_STRING},
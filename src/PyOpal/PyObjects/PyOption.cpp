@@ -33,11 +33,17 @@ namespace PyOpal {
         {"PSDUMPFREQ", "ps_dump_frequency", "", PyOpalObjectNS::DOUBLE},
         {"STATDUMPFREQ", "stat_dump_frequency", "", PyOpalObjectNS::DOUBLE},
         {"SCSOLVEFREQ", "sc_solve_frequency", "", PyOpalObjectNS::DOUBLE},
+        {"SCSOLVETOL", "sc_solve_tolerance", "", PyOpalObjectNS::DOUBLE},
         {"SPTDUMPFREQ", "spt_dump_frequency", "", PyOpalObjectNS::DOUBLE},
         {"MTSSUBSTEPS", "mts_substeps", "", PyOpalObjectNS::DOUBLE},
         {"REMOTEPARTDEL", "remote_particle_delete", "", PyOpalObjectNS::DOUBLE},
+        {"ASYNCPSDUMP", "async_ps_dump", "", PyOpalObjectNS::BOOL},
         {"PSDUMPFRAME", "ps_dump_frame", "", PyOpalObjectNS::PREDEFINED_STRING},
+        {"PSDUMPPRECISION", "ps_dump_precision", "", PyOpalObjectNS::PREDEFINED_STRING},
+        {"PSDUMPSUBSAMPLE", "ps_dump_subsample", "", PyOpalObjectNS::DOUBLE},
+        {"PSDUMPCHUNKSIZE", "ps_dump_chunk_size", "", PyOpalObjectNS::DOUBLE},
         {"REPARTFREQ", "repartition_frequency", "", PyOpalObjectNS::DOUBLE},
+        {"SORTFREQ", "sort_frequency", "", PyOpalObjectNS::DOUBLE},
         {"MINBINEMITTED", "min_bin_emitted", "", PyOpalObjectNS::DOUBLE},
         {"MINSTEPFORREBIN", "min_step_for_rebin", "", PyOpalObjectNS::DOUBLE},
         {"REBINFREQ", "rebin_frequency", "", PyOpalObjectNS::DOUBLE},
@@ -58,6 +64,11 @@ namespace PyOpal {
         {"BEAMHALOBOUNDARY", "beam_halo_boundary", "", PyOpalObjectNS::DOUBLE},
         {"IDEALIZED", "idealized", "", PyOpalObjectNS::BOOL},
         {"LOGBENDTRAJECTORY", "log_bend_trajectory", "", PyOpalObjectNS::BOOL},
+        {"TRACETIMERS", "trace_timers", "", PyOpalObjectNS::DOUBLE},
+        {"PERFDUMP", "perf_dump", "", PyOpalObjectNS::BOOL},
+        {"CACHEFIELDMAPS", "cache_field_maps", "", PyOpalObjectNS::BOOL},
+        {"CACHEGEOMETRY", "cache_geometry", "", PyOpalObjectNS::BOOL},
+        {"NUMTHREADS", "num_threads", "", PyOpalObjectNS::DOUBLE},
         {"VERSION", "version", "", PyOpalObjectNS::DOUBLE}};
 
     namespace PyOptionNS {
@@ -0,0 +1,384 @@
+//
+// Class FFTBackend
+//   Distributed real-to-complex FFT of the doubled grid of the
+//   FFTPoissonSolver.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Solvers/FFTBackend.h"
+
+#include "Utilities/OpalException.h"
+#include "Utility/IpplInfo.h"
+
+#include <algorithm>
+#include <vector>
+
+std::unique_ptr<FFTBackend> FFTBackend::create(const std::string& name,
+                                               bool pruned, const Vektor<int, 3>& nr,
+                                               Mesh_t& mesh, FieldLayout_t& layout,
+                                               Mesh_t& mesh3, FieldLayout_t& layout3) {
+    if (name == "FFTW") {
+#ifdef ENABLE_FFTW
+        return std::unique_ptr<FFTBackend>(new FFTWBackend(mesh, layout));
+#else
+        WARNMSG("FFTBackend::create, OPAL was built without FFTW, using FFTPACK instead" << endl);
+#endif
+    }
+    (void)mesh;
+    if (pruned)
+        return std::unique_ptr<FFTBackend>(new FFTPACKPrunedBackend(nr, layout));
+    return std::unique_ptr<FFTBackend>(new FFTPACKBackend(layout, mesh3, layout3));
+}
+
+
+void FFTBackend::forwardPadded(Field_t& /*octant*/, CxField_t& /*spectrum*/) {
+    throw OpalException("FFTBackend::forwardPadded",
+                        "The FFT backend " + getName() + " has no pruned transforms");
+}
+
+
+void FFTBackend::backwardOctant(CxField_t& /*spectrum*/, Field_t& /*octant*/) {
+    throw OpalException("FFTBackend::backwardOctant",
+                        "The FFT backend " + getName() + " has no pruned transforms");
+}
+
+
+FFTPACKBackend::FFTPACKBackend(FieldLayout_t& layout, Mesh_t& mesh3, FieldLayout_t& layout3):
+    mesh3_m(mesh3),
+    layout3_m(layout3)
+{
+    // create a domain used to indicate to the FFT's how to construct it's
+    // temporary fields.  This is the same as the complex field's domain,
+    // but permuted back to the left.
+    NDIndex<3> tmpdomain = layout3_m.getDomain();
+    NDIndex<3> domainFFTConstruct;
+    for (int i = 0; i < 3; ++ i)
+        domainFFTConstruct[i] = tmpdomain[(i+1) % 3];
+
+    fft_m = std::unique_ptr<FFT_t>(new FFT_t(layout.getDomain(), domainFFTConstruct));
+}
+
+
+void FFTPACKBackend::forward(Field_t& real, CxField_t& spectrum) {
+    // the IPPL FFT normalizes in the forward direction, hence the transform
+    // without normalization is its backward transformation
+    fft_m->transform(-1, real, spectrum);
+}
+
+
+void FFTPACKBackend::backward(CxField_t& spectrum, Field_t& real) {
+    fft_m->transform(+1, spectrum, real);
+}
+
+
+FFTPACKPrunedBackend::FFTPACKPrunedBackend(const Vektor<int, 3>& nr, FieldLayout_t& layout):
+    nr_m(nr)
+{
+    const NDIndex<3>& domain = layout.getDomain();
+    int types[3];
+    normFact_m = 1.0;
+    for (unsigned int d = 0; d < 3; ++ d) {
+        n_m[d] = domain[d].length();
+        types[d] = (d == 0 ? 1 : 0);    // real-to-complex along x, complex-to-complex else
+        normFact_m /= n_m[d];
+    }
+    engine_m.setup(3, types, &n_m[0]);
+
+    kx_m = Index(n_m[0] / 2 + 1);
+    x_m = Index(nr_m[0]);
+    y_m = Index(nr_m[1]);
+    z_m = Index(nr_m[2]);
+    y2_m = Index(n_m[1]);
+    z2_m = Index(n_m[2]);
+    yPad_m = Index(nr_m[1], n_m[1] - 1);
+    zPad_m = Index(nr_m[2], n_m[2] - 1);
+
+    NDIndex<3> domainX, domainY, spectralDomain;
+    domainX[0] = kx_m;
+    domainX[1] = y_m;
+    domainX[2] = z_m;
+    domainY[0] = y2_m;
+    domainY[1] = z_m;
+    domainY[2] = kx_m;
+    spectralDomain[0] = z2_m;
+    spectralDomain[1] = kx_m;
+    spectralDomain[2] = y2_m;
+
+    // the real field shares the layout of the complex one, only the first
+    // nr_m[0] elements of its lines are used
+    makeLayout(domainX, meshX_m, layoutX_m);
+    realX_m.initialize(*meshX_m, *layoutX_m);
+    cplxX_m.initialize(*meshX_m, *layoutX_m);
+
+    makeLayout(domainY, meshY_m, layoutY_m);
+    cplxY_m.initialize(*meshY_m, *layoutY_m);
+
+    makeLayout(spectralDomain, spectralMesh_m, spectralLayout_m);
+
+    // the IPPL FFT compares the bases of the indices, the domain has to be
+    // the one of the spectral layout
+    NDIndex<3> tmpdomain = spectralLayout_m->getDomain();
+    NDIndex<3> domainFFTConstruct;
+    for (int i = 0; i < 3; ++ i)
+        domainFFTConstruct[i] = tmpdomain[(i+1) % 3];
+    fft_m = std::unique_ptr<FFT_t>(new FFT_t(domain, domainFFTConstruct));
+}
+
+
+void FFTPACKPrunedBackend::makeLayout(const NDIndex<3>& domain,
+                                      std::unique_ptr<Mesh_t>& mesh,
+                                      std::unique_ptr<FieldLayout_t>& layout) {
+    NDIndex<3> vertices;
+    for (unsigned int d = 0; d < 3; ++ d)
+        vertices[d] = Index(domain[d].length() + 1);
+    e_dim_tag decomp[3] = {SERIAL, PARALLEL, PARALLEL};
+
+    mesh.reset(new Mesh_t(vertices));
+    layout.reset(new FieldLayout_t(*mesh, decomp));
+}
+
+
+void FFTPACKPrunedBackend::transformLines(CxField_t& f, unsigned int dim, int direction) {
+    for (auto it = f.begin_if(); it != f.end_if(); ++ it) {
+        LField<Complex_t, 3>& lf = *(*it).second;
+        lf.Uncompress();
+
+        Complex_t* data = lf.getP();
+        const int length = lf.size(0);
+        const int numLines = lf.size(1) * lf.size(2);
+        for (int line = 0; line < numLines; ++ line, data += length)
+            engine_m.callFFT(dim, direction, data);
+    }
+}
+
+
+void FFTPACKPrunedBackend::forward(Field_t& real, CxField_t& spectrum) {
+    fft_m->transform(-1, real, spectrum);
+}
+
+
+void FFTPACKPrunedBackend::backward(CxField_t& spectrum, Field_t& real) {
+    fft_m->transform(+1, spectrum, real);
+}
+
+
+void FFTPACKPrunedBackend::forwardPadded(Field_t& octant, CxField_t& spectrum) {
+    // x: real-to-complex on the lines with y and z in the octant; as in the
+    // IPPL FFT the direction of the engine is +1 in all stages
+    realX_m[x_m][y_m][z_m] = octant[x_m][y_m][z_m];
+
+    auto rit = realX_m.begin_if();
+    for (auto cit = cplxX_m.begin_if(); cit != cplxX_m.end_if(); ++ cit, ++ rit) {
+        LField<double, 3>& rlf = *(*rit).second;
+        LField<Complex_t, 3>& clf = *(*cit).second;
+        rlf.Uncompress();
+        clf.Uncompress();
+
+        const double* rdata = rlf.getP();
+        Complex_t* cdata = clf.getP();
+        const int length = clf.size(0);
+        const int numLines = clf.size(1) * clf.size(2);
+        for (int line = 0; line < numLines; ++ line, rdata += length, cdata += length) {
+            // pack the real line, zero padded to n_m[0], into the complex one
+            for (int i = 0; i < length; ++ i) {
+                cdata[i] = Complex_t(2 * i < nr_m[0] ? rdata[2 * i] : 0.0,
+                                     2 * i + 1 < nr_m[0] ? rdata[2 * i + 1] : 0.0);
+            }
+            engine_m.callFFT(0, +1, cdata);
+        }
+    }
+
+    // y: on the lines with z in the octant
+    cplxY_m[y_m][z_m][kx_m] = cplxX_m[kx_m][y_m][z_m];
+    if (nr_m[1] < n_m[1])
+        cplxY_m[yPad_m][z_m][kx_m] = Complex_t(0.0);
+    transformLines(cplxY_m, 1, +1);
+
+    // z: on all lines
+    spectrum[z_m][kx_m][y2_m] = cplxY_m[y2_m][z_m][kx_m];
+    if (nr_m[2] < n_m[2])
+        spectrum[zPad_m][kx_m][y2_m] = Complex_t(0.0);
+    transformLines(spectrum, 2, +1);
+}
+
+
+void FFTPACKPrunedBackend::backwardOctant(CxField_t& spectrum, Field_t& octant) {
+    // z: on all lines, in place
+    transformLines(spectrum, 2, -1);
+
+    // y: on the lines with z in the octant
+    cplxY_m[y2_m][z_m][kx_m] = spectrum[z_m][kx_m][y2_m];
+    transformLines(cplxY_m, 1, -1);
+
+    // x: complex-to-real on the lines with y and z in the octant
+    cplxX_m[kx_m][y_m][z_m] = cplxY_m[y_m][z_m][kx_m];
+
+    auto rit = realX_m.begin_if();
+    for (auto cit = cplxX_m.begin_if(); cit != cplxX_m.end_if(); ++ cit, ++ rit) {
+        LField<double, 3>& rlf = *(*rit).second;
+        LField<Complex_t, 3>& clf = *(*cit).second;
+        rlf.Uncompress();
+        clf.Uncompress();
+
+        double* rdata = rlf.getP();
+        Complex_t* cdata = clf.getP();
+        const int length = clf.size(0);
+        const int numLines = clf.size(1) * clf.size(2);
+        for (int line = 0; line < numLines; ++ line, rdata += length, cdata += length) {
+            engine_m.callFFT(0, -1, cdata);
+            for (int i = 0; i < nr_m[0]; ++ i) {
+                const Complex_t& c = cdata[i / 2];
+                rdata[i] = normFact_m * (i % 2 == 0 ? c.real() : c.imag());
+            }
+        }
+    }
+
+    octant[x_m][y_m][z_m] = realX_m[x_m][y_m][z_m];
+}
+
+
+#ifdef ENABLE_FFTW
+namespace {
+    // pointer to the data of the only LField of field on this node
+    template <class T>
+    T* getLocalData(Field<T, 3, Mesh_t, Center_t>& field) {
+        LField<T, 3>& lf = *(*field.begin_if()).second;
+        lf.Uncompress();
+        return lf.getP();
+    }
+}
+
+
+FFTWBackend::FFTWBackend(Mesh_t& mesh, FieldLayout_t& layout) {
+    static bool fftwInitialized = false;
+    if (!fftwInitialized) {
+        fftw_mpi_init();
+        fftwInitialized = true;
+    }
+
+    MPI_Comm comm = Ippl::getComm();
+    const NDIndex<3>& domain = layout.getDomain();
+    for (unsigned int d = 0; d < 3; ++ d)
+        n_m[2 - d] = domain[d].length();
+    paddedRow_m = 2 * (n_m[2] / 2 + 1);
+    scale_m = 1.0 / (n_m[0] * n_m[1] * n_m[2]);
+
+    ptrdiff_t localZStart, localYStart;
+    ptrdiff_t allocLocal = fftw_mpi_local_size_3d_transposed(n_m[0], n_m[1], n_m[2] / 2 + 1, comm,
+                                                             &localNz_m, &localZStart,
+                                                             &localNy_m, &localYStart);
+
+    realLayout_m.reset(makeSlabLayout(mesh, domain, 2, localZStart, localNz_m));
+    real_m.initialize(mesh, *realLayout_m);
+
+    NDIndex<3> spectralDomain, spectralVertices;
+    spectralDomain[0] = Index(n_m[2] / 2 + 1);
+    spectralDomain[1] = Index(n_m[0]);
+    spectralDomain[2] = Index(n_m[1]);
+    for (unsigned int d = 0; d < 3; ++ d)
+        spectralVertices[d] = Index(spectralDomain[d].length() + 1);
+    spectralMesh_m.reset(new Mesh_t(spectralVertices));
+    spectralLayout_m.reset(makeSlabLayout(*spectralMesh_m, spectralDomain, 2,
+                                          localYStart, localNy_m));
+
+    // the real data is padded to a multiple of complex numbers in the
+    // fastest dimension, also for out-of-place transforms
+    rbuf_m = fftw_alloc_real(2 * allocLocal);
+    cbuf_m = fftw_alloc_complex(allocLocal);
+
+    forwardPlan_m = fftw_mpi_plan_dft_r2c_3d(n_m[0], n_m[1], n_m[2], rbuf_m, cbuf_m, comm,
+                                             FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+    backwardPlan_m = fftw_mpi_plan_dft_c2r_3d(n_m[0], n_m[1], n_m[2], cbuf_m, rbuf_m, comm,
+                                              FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
+}
+
+
+FFTWBackend::~FFTWBackend() {
+    fftw_destroy_plan(forwardPlan_m);
+    fftw_destroy_plan(backwardPlan_m);
+    fftw_free(rbuf_m);
+    fftw_free(cbuf_m);
+}
+
+
+FieldLayout_t* FFTWBackend::makeSlabLayout(Mesh_t& mesh, const NDIndex<3>& domain,
+                                           unsigned int dim,
+                                           ptrdiff_t first, ptrdiff_t length) {
+    const int nodes = Ippl::getNodes();
+    long local[2] = {static_cast<long>(first), static_cast<long>(length)};
+    std::vector<long> slabs(2 * nodes);
+    MPI_Allgather(local, 2, MPI_LONG, &slabs[0], 2, MPI_LONG, Ippl::getComm());
+
+    std::vector<NDIndex<3> > vnodes;
+    std::vector<int> owners;
+    for (int p = 0; p < nodes; ++ p) {
+        if (slabs[2 * p + 1] == 0) continue;
+
+        NDIndex<3> slab = domain;
+        slab[dim] = Index(slabs[2 * p], slabs[2 * p] + slabs[2 * p + 1] - 1);
+        vnodes.push_back(slab);
+        owners.push_back(p);
+    }
+
+    return new FieldLayout_t(mesh,
+                             &vnodes[0], &vnodes[0] + vnodes.size(),
+                             &owners[0], &owners[0] + owners.size());
+}
+
+
+void FFTWBackend::forward(Field_t& real, CxField_t& spectrum) {
+    // redistribute into the z slabs of FFTW
+    real_m = real;
+
+    if (localNz_m > 0) {
+        const double* src = getLocalData(real_m);
+        for (ptrdiff_t row = 0; row < localNz_m * n_m[1]; ++ row) {
+            std::copy(src + row * n_m[2], src + (row + 1) * n_m[2],
+                      rbuf_m + row * paddedRow_m);
+        }
+    }
+
+    fftw_execute(forwardPlan_m);
+
+    if (localNy_m > 0) {
+        const std::complex<double>* src = reinterpret_cast<std::complex<double>*>(cbuf_m);
+        std::copy(src, src + localNy_m * n_m[0] * (n_m[2] / 2 + 1),
+                  getLocalData(spectrum));
+    }
+}
+
+
+void FFTWBackend::backward(CxField_t& spectrum, Field_t& real) {
+    // the complex-to-real transform destroys its input, hence the spectrum
+    // is always copied
+    if (localNy_m > 0) {
+        const std::complex<double>* src = getLocalData(spectrum);
+        std::copy(src, src + localNy_m * n_m[0] * (n_m[2] / 2 + 1),
+                  reinterpret_cast<std::complex<double>*>(cbuf_m));
+    }
+
+    fftw_execute(backwardPlan_m);
+
+    if (localNz_m > 0) {
+        double* dst = getLocalData(real_m);
+        for (ptrdiff_t row = 0; row < localNz_m * n_m[1]; ++ row) {
+            const double* src = rbuf_m + row * paddedRow_m;
+            for (ptrdiff_t i = 0; i < n_m[2]; ++ i)
+                dst[row * n_m[2] + i] = scale_m * src[i];
+        }
+    }
+
+    real = real_m;
+}
+#endif
@@ -0,0 +1,232 @@
+//
+// Class FFTBackend
+//   Distributed real-to-complex FFT of the doubled grid of the
+//   FFTPoissonSolver. The solver only multiplies spectra point-wise, hence
+//   each backend is free to choose the index order and the distribution of
+//   the spectrum; the complex fields have to be defined on the mesh and
+//   layout returned by getSpectralMesh() and getSpectralLayout().
+//
+//   The forward transform is not normalized, the backward transform divides
+//   by the number of grid points. The backends are created once when the
+//   solver sets up its fields and keep their plans for the whole run.
+//
+//   FFTPACK: the IPPL FFT (default, always available)
+//   FFTW:    FFTW3-MPI with slab decomposition along z, only if OPAL was
+//            built with ENABLE_FFTW
+//
+//   In the Hockney scheme the charge density vanishes outside of the lower
+//   octant [0, nr) of the doubled grid and only this octant of the
+//   potential is used. Backends for which hasPrunedTransforms() is true
+//   provide transforms which skip the lines that are zero on input of the
+//   forward transform and the lines that aren't needed on output of the
+//   backward transform (FFTPACKPrunedBackend).
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef OPAL_FFT_BACKEND_H
+#define OPAL_FFT_BACKEND_H
+
+#include "Algorithms/PBunchDefs.h"
+
+#include "FFT/FFT.h"
+
+#include <complex>
+#include <memory>
+#include <string>
+
+#ifdef ENABLE_FFTW
+#include <fftw3-mpi.h>
+#endif
+
+class FFTBackend {
+public:
+    typedef Field<std::complex<double>, 3, Mesh_t, Center_t> CxField_t;
+
+    virtual ~FFTBackend() { }
+
+    /// Transform real into spectrum without normalization
+    virtual void forward(Field_t& real, CxField_t& spectrum) = 0;
+
+    /// Transform spectrum into real, divided by the number of grid points;
+    /// the spectrum may be overwritten
+    virtual void backward(CxField_t& spectrum, Field_t& real) = 0;
+
+    virtual bool hasPrunedTransforms() const { return false; }
+
+    /// Same as forward for the field on the doubled grid which equals
+    /// octant on [0, nr) and vanishes elsewhere
+    virtual void forwardPadded(Field_t& octant, CxField_t& spectrum);
+
+    /// Same as backward, but only [0, nr) of the result is computed and
+    /// stored in octant
+    virtual void backwardOctant(CxField_t& spectrum, Field_t& octant);
+
+    virtual Mesh_t& getSpectralMesh() = 0;
+    virtual FieldLayout_t& getSpectralLayout() = 0;
+
+    virtual std::string getName() const = 0;
+
+    /// Create the backend with the given name for real fields on layout;
+    /// mesh3 and layout3 are the permuted complex mesh and layout used by
+    /// the IPPL FFT. Falls back to FFTPACK if the requested backend is not
+    /// available in this build. If pruned is true and the backend supports
+    /// it, the pruned transforms for the octant [0, nr) are set up.
+    static std::unique_ptr<FFTBackend> create(const std::string& name,
+                                              bool pruned, const Vektor<int, 3>& nr,
+                                              Mesh_t& mesh, FieldLayout_t& layout,
+                                              Mesh_t& mesh3, FieldLayout_t& layout3);
+};
+
+
+class FFTPACKBackend: public FFTBackend {
+public:
+    typedef FFT<RCTransform, 3, double> FFT_t;
+
+    FFTPACKBackend(FieldLayout_t& layout, Mesh_t& mesh3, FieldLayout_t& layout3);
+
+    virtual void forward(Field_t& real, CxField_t& spectrum);
+    virtual void backward(CxField_t& spectrum, Field_t& real);
+
+    virtual Mesh_t& getSpectralMesh() { return mesh3_m; }
+    virtual FieldLayout_t& getSpectralLayout() { return layout3_m; }
+
+    virtual std::string getName() const { return "FFTPACK"; }
+
+private:
+    Mesh_t& mesh3_m;
+    FieldLayout_t& layout3_m;
+
+    std::unique_ptr<FFT_t> fft_m;
+};
+
+
+// The transforms are done dimension by dimension with the FFTPACK engine
+// of IPPL, in the same order and with the same conventions as the IPPL
+// FFT. Before each stage the data is transposed such that the transformed
+// dimension is serial and first; only the lines which aren't zero (forward)
+// or which are needed later on (backward) are transformed. The spectrum is
+// stored in the order (z, x, y) like the one of the IPPL FFT.
+class FFTPACKPrunedBackend: public FFTBackend {
+public:
+    typedef FFT<RCTransform, 3, double> FFT_t;
+
+    FFTPACKPrunedBackend(const Vektor<int, 3>& nr, FieldLayout_t& layout);
+
+    virtual void forward(Field_t& real, CxField_t& spectrum);
+    virtual void backward(CxField_t& spectrum, Field_t& real);
+
+    virtual bool hasPrunedTransforms() const { return true; }
+    virtual void forwardPadded(Field_t& octant, CxField_t& spectrum);
+    virtual void backwardOctant(CxField_t& spectrum, Field_t& octant);
+
+    virtual Mesh_t& getSpectralMesh() { return *spectralMesh_m; }
+    virtual FieldLayout_t& getSpectralLayout() { return *spectralLayout_m; }
+
+    virtual std::string getName() const { return "FFTPACK (pruned)"; }
+
+private:
+    typedef std::complex<double> Complex_t;
+
+    // mesh and layout with one cell per element of domain, first dimension
+    // serial and the others parallel
+    void makeLayout(const NDIndex<3>& domain,
+                    std::unique_ptr<Mesh_t>& mesh, std::unique_ptr<FieldLayout_t>& layout);
+
+    // apply the 1D transform of dimension dim of the engine to all lines
+    // along the first dimension of f
+    void transformLines(CxField_t& f, unsigned int dim, int direction);
+
+    // number of real grid points of the doubled grid and of the octant
+    Vektor<int, 3> n_m;
+    Vektor<int, 3> nr_m;
+    double normFact_m;
+
+    // indices of the complex x dimension, of the octant and of the doubled
+    // grid, and of the padding of the octant in y and z
+    Index kx_m;
+    Index x_m, y_m, z_m;
+    Index y2_m, z2_m;
+    Index yPad_m, zPad_m;
+
+    // stage x: (x, y, z) on the octant in y and z
+    std::unique_ptr<Mesh_t> meshX_m;
+    std::unique_ptr<FieldLayout_t> layoutX_m;
+    Field_t realX_m;
+    CxField_t cplxX_m;
+
+    // stage y: (y, z, x), doubled in y
+    std::unique_ptr<Mesh_t> meshY_m;
+    std::unique_ptr<FieldLayout_t> layoutY_m;
+    CxField_t cplxY_m;
+
+    // stage z and spectrum: (z, x, y), doubled in y and z
+    std::unique_ptr<Mesh_t> spectralMesh_m;
+    std::unique_ptr<FieldLayout_t> spectralLayout_m;
+
+    FFTPACK<double> engine_m;
+
+    // full transforms, for fields which don't vanish outside of the octant
+    std::unique_ptr<FFT_t> fft_m;
+};
+
+
+#ifdef ENABLE_FFTW
+class FFTWBackend: public FFTBackend {
+public:
+    FFTWBackend(Mesh_t& mesh, FieldLayout_t& layout);
+
+    ~FFTWBackend();
+
+    virtual void forward(Field_t& real, CxField_t& spectrum);
+    virtual void backward(CxField_t& spectrum, Field_t& real);
+
+    virtual Mesh_t& getSpectralMesh() { return *spectralMesh_m; }
+    virtual FieldLayout_t& getSpectralLayout() { return *spectralLayout_m; }
+
+    virtual std::string getName() const { return "FFTW"; }
+
+private:
+    // layout with one vnode per node, the local domain of node p is
+    // [first[p], first[p] + length[p]) along dimension dim; nodes with
+    // length zero get no vnode
+    static FieldLayout_t* makeSlabLayout(Mesh_t& mesh, const NDIndex<3>& domain,
+                                         unsigned int dim,
+                                         ptrdiff_t first, ptrdiff_t length);
+
+    // FFTW sizes in row-major order, i.e. (nz, ny, nx)
+    ptrdiff_t n_m[3];
+    // number of doubles in a padded row of the real data
+    ptrdiff_t paddedRow_m;
+    ptrdiff_t localNz_m;
+    ptrdiff_t localNy_m;
+    double scale_m;
+
+    // real data distributed as FFTW expects it, slabs along z
+    std::unique_ptr<FieldLayout_t> realLayout_m;
+    Field_t real_m;
+
+    // the spectrum is kept transposed, i.e. (ny, nz, nx / 2 + 1) in
+    // row-major order and distributed along y; this saves the global
+    // transposes back to the original order
+    std::unique_ptr<Mesh_t> spectralMesh_m;
+    std::unique_ptr<FieldLayout_t> spectralLayout_m;
+
+    double* rbuf_m;
+    fftw_complex* cbuf_m;
+    fftw_plan forwardPlan_m;
+    fftw_plan backwardPlan_m;
+};
+#endif
+
+#endif
@@ -19,6 +19,8 @@
 #include "BasicActions/Option.h"
 #include "Utilities/Options.h"
 #include "Utilities/Util.h"
+
+#include <cmath>
 #include <fstream>
 
 extern Inform *gmsg;
@@ -47,7 +49,13 @@ struct SpecializedGreensFunction<3> {
 // constructor
 
 
-FFTPoissonSolver::FFTPoissonSolver(Mesh_t *mesh, FieldLayout_t *fl, std::string greensFunction, std::string bcz):
+FFTPoissonSolver::FFTPoissonSolver(Mesh_t *mesh, FieldLayout_t *fl, std::string greensFunction, std::string bcz,
+                                   std::string fftLib, double greensTolerance, bool prunedFFT):
+    greensTolerance_m(greensTolerance),
+    greensHits_m(0),
+    greensMisses_m(0),
+    fftLib_m(fftLib),
+    prunedFFT_m(prunedFFT),
     mesh_m(mesh),
     layout_m(fl),
     mesh2_m(nullptr),
@@ -68,6 +76,11 @@ FFTPoissonSolver::FFTPoissonSolver(Mesh_t *mesh, FieldLayout_t *fl, std::string
 
 
 FFTPoissonSolver::FFTPoissonSolver(PartBunch &beam, std::string greensFunction):
+    greensTolerance_m(0.0),
+    greensHits_m(0),
+    greensMisses_m(0),
+    fftLib_m("FFTPACK"),
+    prunedFFT_m(false),
     mesh_m(&beam.getMesh()),
     layout_m(&beam.getFieldLayout()),
     mesh2_m(nullptr),
@@ -152,7 +165,6 @@ void FFTPoissonSolver::initializeFields() {
 
     rho2_m.initialize(*mesh2_m, *layout2_m);
 
-    NDIndex<3> tmpdomain;
     // Create the domain for the transformed (complex) fields.  Do this by
     // taking the domain from the doubled mesh, permuting it to the right, and
     // setting the 2nd dimension to have n/2 + 1 elements.
@@ -168,9 +180,15 @@ void FFTPoissonSolver::initializeFields() {
     mesh3_m = std::unique_ptr<Mesh_t>(new Mesh_t(domain3_m));
     layout3_m = std::unique_ptr<FieldLayout_t>(new FieldLayout_t(*mesh3_m, decomp2));
 
-    rho2tr_m.initialize(*mesh3_m, *layout3_m);
-    imgrho2tr_m.initialize(*mesh3_m, *layout3_m);
-    grntr_m.initialize(*mesh3_m, *layout3_m);
+    // create the FFT backend; the complex fields are laid out as it requires
+    fft_m = FFTBackend::create(fftLib_m, prunedFFT_m, nr_m,
+                               *mesh2_m, *layout2_m, *mesh3_m, *layout3_m);
+    prunedFFT_m = prunedFFT_m && fft_m->hasPrunedTransforms();
+
+    rho2tr_m.initialize(fft_m->getSpectralMesh(), fft_m->getSpectralLayout());
+    imgrho2tr_m.initialize(fft_m->getSpectralMesh(), fft_m->getSpectralLayout());
+    grntr_m.initialize(fft_m->getSpectralMesh(), fft_m->getSpectralLayout());
+    imggrntr_m.initialize(fft_m->getSpectralMesh(), fft_m->getSpectralLayout());
 
     // helper field for sin
     greentr_m.initialize(*mesh3_m, *layout3_m);
@@ -183,16 +201,6 @@ void FFTPoissonSolver::initializeFields() {
 
     tmpgreen_m.initialize(*mesh4_m, *layout4_m);
 
-    // create a domain used to indicate to the FFT's how to construct it's
-    // temporary fields.  This is the same as the complex field's domain,
-    // but permuted back to the left.
-    tmpdomain = layout3_m->getDomain();
-    for (int i = 0; i < 3; ++ i)
-        domainFFTConstruct_m[i] = tmpdomain[(i+1) % 3];
-
-    // create the FFT object
-    fft_m = std::unique_ptr<FFT_t>(new FFT_t(layout2_m->getDomain(), domainFFTConstruct_m));
-
     // these are fields that are used for calculating the Green's function.
     // they eliminate some calculation at each time-step.
     for (int i = 0; i < 3; ++ i) {
@@ -211,18 +219,13 @@ void FFTPoissonSolver::initializeFields() {
 
 void FFTPoissonSolver::computePotential(Field_t &rho, Vector_t hr, double zshift) {
 
-    // use grid of complex doubled in both dimensions
-    // and store rho in lower left quadrant of doubled grid
-    rho2_m = 0.0;
-
-    rho2_m[domain_m] = rho[domain_m];
-
     // needed in greens function
     hr_m = hr;
+
     // FFT double-sized charge density
-    // we do a backward transformation so that we dont have to account for the normalization factor
-    // that is used in the forward transformation of the IPPL FFT
-    fft_m->transform(-1, rho2_m, rho2tr_m);
+    // the forward transformation is not normalized, the normalization factor
+    // is applied in the backward transformation
+    transformChargeDensity(rho);
 
     // must be called if the mesh size has changed
     // have to check if we can do G with h = (1,1,1)
@@ -232,17 +235,28 @@ void FFTPoissonSolver::computePotential(Field_t &rho, Vector_t hr, double zshift
     // The minus sign is due to image charge.
     // Convolute transformed charge density with shifted green's function.
     IpplTimings::startTimer(GreensFunctionTimer_m);
-    shiftedIntGreensFunction(zshift);
+    if (reuseGreensFunction(imgGrnKey_m, zshift)) {
+        ++ greensHits_m;
+    } else {
+        ++ greensMisses_m;
+        shiftedIntGreensFunction(zshift);
+        INFOMSG(level3 << "* Green's function computed " << greensMisses_m
+                << " times, reused " << greensHits_m << " times" << endl);
+    }
     IpplTimings::stopTimer(GreensFunctionTimer_m);
 
     // Multiply transformed charge density and
     // transformed Green's function. Don't divide
     // by (2*nx_m)*(2*ny_m), as Ryne does; this
-    // normalization is done in POOMA's fft routine.
-    imgrho2tr_m = - rho2tr_m * grntr_m;
+    // normalization is done in the backward FFT.
+    imgrho2tr_m = - rho2tr_m * imggrntr_m;
 
     // Inverse FFT to find image charge potential, rho2_m equals the electrostatic potential.
-    fft_m->transform(+1, imgrho2tr_m, rho2_m);
+    // Only the lower octant of rho2_m is used below.
+    if (prunedFFT_m)
+        fft_m->backwardOctant(imgrho2tr_m, rho2_m);
+    else
+        fft_m->backward(imgrho2tr_m, rho2_m);
 
     // Re-use rho to store image potential. Flip z coordinate since this is a mirror image.
     Index I = nr_m[0];
@@ -261,45 +275,84 @@ void FFTPoissonSolver::computePotential(Field_t &rho, Vector_t hr) {
 
     IpplTimings::startTimer(ComputePotential_m);
 
-    // use grid of complex doubled in both dimensions
-    // and store rho in lower left quadrant of doubled grid
-    rho2_m = 0.0;
-
-    rho2_m[domain_m] = rho[domain_m];
-
     // needed in greens function
     hr_m = hr;
 
     // FFT double-sized charge density
-    // we do a backward transformation so that we dont have to account for the normalization factor
-    // that is used in the forward transformation of the IPPL FFT
-    fft_m->transform(-1, rho2_m, rho2tr_m);
+    // the forward transformation is not normalized, the normalization factor
+    // is applied in the backward transformation
+    transformChargeDensity(rho);
 
     // must be called if the mesh size has changed
     // have to check if we can do G with h = (1,1,1)
     // and rescale later
     IpplTimings::startTimer(GreensFunctionTimer_m);
-    if(integratedGreens_m)
-        integratedGreensFunction();
-    else
-        greensFunction();
+    if (reuseGreensFunction(grnKey_m, 0.0)) {
+        ++ greensHits_m;
+    } else {
+        ++ greensMisses_m;
+        if(integratedGreens_m)
+            integratedGreensFunction();
+        else
+            greensFunction();
+        INFOMSG(level3 << "* Green's function computed " << greensMisses_m
+                << " times, reused " << greensHits_m << " times" << endl);
+    }
     IpplTimings::stopTimer(GreensFunctionTimer_m);
     // multiply transformed charge density
     // and transformed Green function
     // Don't divide by (2*nx_m)*(2*ny_m), as Ryne does;
-    // this normalization is done in POOMA's fft routine.
+    // this normalization is done in the backward FFT.
     rho2tr_m *= grntr_m;
 
     // inverse FFT, rho2_m equals to the electrostatic potential
-    fft_m->transform(+1, rho2tr_m, rho2_m);
-    // end convolution
-
     // back to physical grid
     // reuse the charge density field to store the electrostatic potential
-    rho[domain_m] = rho2_m[domain_m];
+    if (prunedFFT_m) {
+        fft_m->backwardOctant(rho2tr_m, rho);
+    } else {
+        fft_m->backward(rho2tr_m, rho2_m);
+        rho[domain_m] = rho2_m[domain_m];
+    }
+    // end convolution
     IpplTimings::stopTimer(ComputePotential_m);
 }
 
+void FFTPoissonSolver::transformChargeDensity(Field_t &rho) {
+    if (prunedFFT_m) {
+        // the zero padding is implied, the transforms of zero lines are skipped
+        fft_m->forwardPadded(rho, rho2tr_m);
+        return;
+    }
+
+    // use grid of complex doubled in both dimensions
+    // and store rho in lower left quadrant of doubled grid
+    rho2_m = 0.0;
+
+    rho2_m[domain_m] = rho[domain_m];
+
+    fft_m->forward(rho2_m, rho2tr_m);
+}
+
+bool FFTPoissonSolver::reuseGreensFunction(GreensFunctionKey &key, double shift) {
+    // hr_m and the shift are the same on all nodes, hence all nodes take
+    // the same decision
+    bool reuse = key.valid_m;
+    for (unsigned int d = 0; d < 3 && reuse; ++ d) {
+        reuse = (key.nr_m[d] == nr_m[d] &&
+                 std::abs(hr_m[d] - key.hr_m[d]) <= greensTolerance_m * key.hr_m[d]);
+    }
+    reuse = reuse && std::abs(shift - key.shift_m) <= greensTolerance_m * key.hr_m[2];
+
+    if (!reuse) {
+        key.valid_m = true;
+        key.hr_m = hr_m;
+        key.nr_m = nr_m;
+        key.shift_m = shift;
+    }
+    return reuse;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // calculate the FFT of the Green's function for the given field
 void FFTPoissonSolver::greensFunction() {
@@ -312,9 +365,9 @@ void FFTPoissonSolver::greensFunction() {
     // The next step is to FFT it.
     // FFT of Green's function
 
-    // we do a backward transformation so that we dont have to account for the normalization factor
-    // that is used in the forward transformation of the IPPL FFT
-    fft_m->transform(-1, rho2_m, grntr_m);
+    // the forward transformation is not normalized, the normalization factor
+    // is applied in the backward transformation
+    fft_m->forward(rho2_m, grntr_m);
 }
 
 /** If the beam has a longitudinal size >> transverse size the
@@ -397,7 +450,7 @@ void FFTPoissonSolver::integratedGreensFunction() {
 
     mirrorRhoField();
 
-    fft_m->transform(-1, rho2_m, grntr_m);
+    fft_m->forward(rho2_m, grntr_m);
 
 }
 
@@ -493,7 +546,7 @@ void FFTPoissonSolver::shiftedIntGreensFunction(double zshift) {
 
     mirrorRhoField(tmpgreen_m);
 
-    fft_m->transform(-1, rho2_m, grntr_m);
+    fft_m->forward(rho2_m, imggrntr_m);
 }
 
 void FFTPoissonSolver::mirrorRhoField() {
@@ -551,6 +604,9 @@ void FFTPoissonSolver::mirrorRhoField(Field_t & ggrn2) {
 Inform &FFTPoissonSolver::print(Inform &os) const {
     os << "* ************* F F T P o i s s o n S o l v e r ************************************ " << endl;
     os << "* h " << hr_m << '\n';
+    os << "* FFT " << fft_m->getName() << '\n';
+    os << "* Green's function tolerance " << greensTolerance_m
+       << ", reused " << greensHits_m << " times, computed " << greensMisses_m << " times" << '\n';
     os << "* ********************************************************************************** " << endl;
     return os;
 }
@@ -31,8 +31,7 @@
 #include <memory>
 //////////////////////////////////////////////////////////////
 #include "PoissonSolver.h"
-
-#include "FFT/FFT.h"
+#include "FFTBackend.h"
 
 class PartBunch;
 
@@ -40,12 +39,18 @@ class PartBunch;
 
 class FFTPoissonSolver : public PoissonSolver {
 public:
-    typedef FFT<RCTransform, 3, double>              FFT_t;
-
     // constructor and destructor
     FFTPoissonSolver(PartBunch &bunch, std::string greensFuntion);
 
-    FFTPoissonSolver(Mesh_t *mesh, FieldLayout_t *fl, std::string greensFunction, std::string bcz);
+    // fftLib selects the FFT backend, see FFTBackend; the transformed
+    // Green's functions are reused as long as the mesh spacings (and the
+    // shift of the image charges) differ by less than greensTolerance
+    // relative to the ones they were computed for; prunedFFT skips the
+    // transforms of the zero padding of the doubled grid if the backend
+    // supports it
+    FFTPoissonSolver(Mesh_t *mesh, FieldLayout_t *fl, std::string greensFunction, std::string bcz,
+                     std::string fftLib = "FFTPACK", double greensTolerance = 0.0,
+                     bool prunedFFT = false);
 
     ~FFTPoissonSolver();
 
@@ -65,7 +70,7 @@ public:
     /// compute the integrated Green function as described in <A HREF="http://prst-ab.aps.org/abstract/PRSTAB/v9/i4/e044204">Three-dimensional quasistatic model for high brightness beam dynamics simulation</A> by Qiang et al.
     void integratedGreensFunction();
 
-    /// compute the shifted integrated Green function as described in <A HREF="http://prst-ab.aps.org/abstract/PRSTAB/v9/i4/e044204">Three-dimensional quasistatic model for high brightness beam dynamics simulation</A> by Qiang et al.
+    /// compute the shifted integrated Green function and put it in imggrntr_m, as described in <A HREF="http://prst-ab.aps.org/abstract/PRSTAB/v9/i4/e044204">Three-dimensional quasistatic model for high brightness beam dynamics simulation</A> by Qiang et al.
     void shiftedIntGreensFunction(double zshift);
 
     double getXRangeMin(unsigned short /*level*/) {return 1.0;}
@@ -78,7 +83,23 @@ public:
 
     Inform &print(Inform &os) const;
 private:
+    // parameters of a transformed Green's function
+    struct GreensFunctionKey {
+        bool valid_m = false;
+        Vector_t hr_m;
+        Vektor<int, 3> nr_m;
+        double shift_m = 0.0;
+    };
+
     void initializeFields();
+
+    // true if the Green's function described by key can be used for the
+    // current mesh and the given shift, otherwise key is set to them
+    bool reuseGreensFunction(GreensFunctionKey &key, double shift);
+
+    // transform rho, zero padded to the doubled grid, into rho2tr_m
+    void transformChargeDensity(Field_t &rho);
+
     void mirrorRhoField() FIELDASSIGNOPTIMIZATION;
     void mirrorRhoField(Field_t & ggrn2);// FIELDASSIGNOPTIMIZATION;
 
@@ -89,20 +110,33 @@ private:
     Field_t greentr_m;
 
     // rho2tr_m is the Fourier transformed charge-density field
-    // domain3_m and mesh3_ are used
+    // spectral mesh and layout of fft_m are used
     CxField_t rho2tr_m;
     CxField_t imgrho2tr_m;
 
     // grntr_m is the Fourier transformed Green's function
-    // domain3_m and mesh3_ are used
+    // spectral mesh and layout of fft_m are used
     CxField_t grntr_m;
 
+    // imggrntr_m is the Fourier transformed shifted Green's function for
+    // the image charges, kept apart from grntr_m such that both are reused
+    CxField_t imggrntr_m;
+
+    // parameters of grntr_m and imggrntr_m
+    GreensFunctionKey grnKey_m;
+    GreensFunctionKey imgGrnKey_m;
+    double greensTolerance_m;
+    unsigned long greensHits_m;
+    unsigned long greensMisses_m;
+
     // Fields used to eliminate excess calculation in greensFunction()
     // mesh2_m and layout2_m are used
     IField_t grnIField_m[3];
 
-    // the FFT object
-    std::unique_ptr<FFT_t> fft_m;
+    // the FFT backend, created once in initializeFields()
+    std::string fftLib_m;
+    bool prunedFFT_m;
+    std::unique_ptr<FFTBackend> fft_m;
 
     // mesh and layout objects for rho_m
     Mesh_t *mesh_m;
@@ -130,8 +164,6 @@ private:
     NDIndex<3> domain2_m;            // doubled gridsize (2*Nx,2*Ny,2*Nz)
     NDIndex<3> domain3_m;            // field for the complex values of the RC transformation
     NDIndex<3> domain4_m;
-    // (2*Nx,Ny,2*Nz)
-    NDIndex<3> domainFFTConstruct_m;
 
     // mesh spacing and size values
     Vector_t hr_m;
@@ -0,0 +1,91 @@
+//
+// Class MultipleTimeStepping
+//   Schedule of the multiple time stepping (MTS) integrator of OPAL-T. The
+//   external fields are integrated with numSubsteps substeps per time step.
+//   The self fields are computed in the middle substep and applied with the
+//   impulse of the full time step, half of it before and half of it after
+//   the rotation of the momenta in the Boris kick of this substep.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef MULTIPLETIMESTEPPING_H
+#define MULTIPLETIMESTEPPING_H
+
+#include "Utilities/OpalException.h"
+
+class MultipleTimeStepping {
+
+public:
+    /// With one substep the integrator is the single-rate Boris scheme. The
+    /// number of substeps has to be odd, otherwise the self fields aren't
+    /// applied in the middle of the time step.
+    explicit MultipleTimeStepping(unsigned int numSubsteps = 1);
+
+    unsigned int getNumSubsteps() const;
+
+    /// the substeps of the current track section are counted from step
+    void setFirstStep(unsigned long long step);
+
+    /// true if the self fields have to be computed in the substep step
+    bool isSelfFieldStep(unsigned long long step) const;
+
+    /// the number of the time step which contains the substep step
+    unsigned long long getSelfFieldStep(unsigned long long step) const;
+
+    /// factor for the self fields such that the kick with the substep
+    /// applies the impulse of the full time step
+    double getSelfFieldWeight() const;
+
+private:
+    unsigned int numSubsteps_m;
+    unsigned long long firstStep_m;
+};
+
+inline
+MultipleTimeStepping::MultipleTimeStepping(unsigned int numSubsteps):
+    numSubsteps_m(numSubsteps),
+    firstStep_m(0)
+{
+    if (numSubsteps_m % 2 == 0) {
+        throw OpalException("MultipleTimeStepping::MultipleTimeStepping",
+                            "The number of substeps \"MTSSUBSTEPS\" has to be odd");
+    }
+}
+
+inline
+unsigned int MultipleTimeStepping::getNumSubsteps() const {
+    return numSubsteps_m;
+}
+
+inline
+void MultipleTimeStepping::setFirstStep(unsigned long long step) {
+    firstStep_m = step;
+}
+
+inline
+bool MultipleTimeStepping::isSelfFieldStep(unsigned long long step) const {
+    return (step - firstStep_m) % numSubsteps_m == numSubsteps_m / 2;
+}
+
+inline
+unsigned long long MultipleTimeStepping::getSelfFieldStep(unsigned long long step) const {
+    return step / numSubsteps_m;
+}
+
+inline
+double MultipleTimeStepping::getSelfFieldWeight() const {
+    return numSubsteps_m;
+}
+
+#endif
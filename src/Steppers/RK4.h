@@ -35,6 +35,31 @@ private:
                      const double& t,
                      const double dt,
                      Arguments& ... args) const;
+
+    /// Same arithmetic as doAdvance_m; the stages are done for all particles
+    /// of the block at once, the coordinates and derivatives are stored per
+    /// component (structure of arrays)
+    void doAdvanceBlock_m(PartBunchBase<double, 3>* bunch,
+                          const size_t& first,
+                          const size_t& last,
+                          const double& t,
+                          const double dt,
+                          bool* isGood,
+                          Arguments& ... args) const;
+
+    /// derivatives of the active particles of the block, y and yp are
+    /// indexed [component][particle - first]; particles that are out of
+    /// bound are deactivated
+    void derivateBlock_m(PartBunchBase<double, 3>* bunch,
+                         const size_t& first,
+                         const size_t& last,
+                         double (*y)[Stepper<FieldFunction, Arguments...>::blockSize_m],
+                         const double& t,
+                         double (*yp)[Stepper<FieldFunction, Arguments...>::blockSize_m],
+                         const double* qtom,
+                         bool* isActive,
+                         Arguments& ... args) const;
+
     /**
      * 
      *
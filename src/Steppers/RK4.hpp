@@ -89,6 +89,172 @@ bool RK4<FieldFunction, Arguments ...>::doAdvance_m(PartBunchBase<double, 3>* bu
 }
 
 
+template <typename FieldFunction, typename ... Arguments>
+void RK4<FieldFunction, Arguments ...>::doAdvanceBlock_m(PartBunchBase<double, 3>* bunch,
+                                                         const size_t& first,
+                                                         const size_t& last,
+                                                         const double& t,
+                                                         const double dt,
+                                                         bool* isGood,
+                                                         Arguments& ... args) const
+{
+    constexpr size_t B = Stepper<FieldFunction, Arguments...>::blockSize_m;
+    const size_t n = last - first;
+
+    double x[6][B];
+    double deriv1[6][B];
+    double deriv2[6][B];
+    double deriv3[6][B];
+    double deriv4[6][B];
+    double xtemp[6][B];
+    double qtom[B];
+
+    for (size_t k = 0; k < n; ++k) {
+        const size_t i = first + k;
+        for (int j = 0; j < 3; ++j) {
+            x[j][k]     = bunch->R[i](j);
+            x[j + 3][k] = bunch->P[i](j);
+        }
+        qtom[k] = bunch->Q[i] / (bunch->M[i] * mass_coeff);   // m^2/s^2/GV
+        isGood[k] = true;
+    }
+
+    // Evaluate f1 = f(x,t).
+    derivateBlock_m(bunch, first, last, x, t, deriv1, qtom, isGood, args ...);
+
+    // Evaluate f2 = f( x+dt*f1/2, t+dt/2 ).
+    const double half_dt = 0.5 * dt;
+    const double t_half = t + half_dt;
+
+    for (int j = 0; j < 6; ++j) {
+        for (size_t k = 0; k < n; ++k) {
+            xtemp[j][k] = x[j][k] + half_dt * deriv1[j][k];
+        }
+    }
+
+    derivateBlock_m(bunch, first, last, xtemp, t_half, deriv2, qtom, isGood, args ...);
+
+    // Evaluate f3 = f( x+dt*f2/2, t+dt/2 ).
+    for (int j = 0; j < 6; ++j) {
+        for (size_t k = 0; k < n; ++k) {
+            xtemp[j][k] = x[j][k] + half_dt * deriv2[j][k];
+        }
+    }
+
+    derivateBlock_m(bunch, first, last, xtemp, t_half, deriv3, qtom, isGood, args ...);
+
+    // Evaluate f4 = f( x+dt*f3, t+dt ).
+    double t_full = t + dt;
+    for (int j = 0; j < 6; ++j) {
+        for (size_t k = 0; k < n; ++k) {
+            xtemp[j][k] = x[j][k] + dt * deriv3[j][k];
+        }
+    }
+
+    derivateBlock_m(bunch, first, last, xtemp, t_full, deriv4, qtom, isGood, args ...);
+
+    // Return x(t+dt) computed from fourth-order R-K. Particles that were
+    // out of bound keep the position of the failed stage, as in doAdvance_m
+    for (size_t k = 0; k < n; ++k) {
+        if (!isGood[k]) {
+            continue;
+        }
+        const size_t i = first + k;
+        for (int j = 0; j < 3; ++j) {
+            bunch->R[i](j) = x[j][k] + dt / 6.*(deriv1[j][k] + deriv4[j][k] +
+                                                2.*(deriv2[j][k] + deriv3[j][k]));
+            bunch->P[i](j) = x[j + 3][k] + dt / 6.*(deriv1[j + 3][k] + deriv4[j + 3][k] +
+                                                    2.*(deriv2[j + 3][k] + deriv3[j + 3][k]));
+        }
+    }
+}
+
+
+template <typename FieldFunction, typename ... Arguments>
+void RK4<FieldFunction, Arguments ...>::derivateBlock_m(PartBunchBase<double, 3>* bunch,
+                                                        const size_t& first,
+                                                        const size_t& last,
+                                                        double (*y)[Stepper<FieldFunction, Arguments...>::blockSize_m],
+                                                        const double& t,
+                                                        double (*yp)[Stepper<FieldFunction, Arguments...>::blockSize_m],
+                                                        const double* qtom,
+                                                        bool* isActive,
+                                                        Arguments& ... args) const
+{
+    constexpr size_t B = Stepper<FieldFunction, Arguments...>::blockSize_m;
+    const size_t n = last - first;
+
+    // the field evaluation reads the position from the bunch
+    double E[3][B];
+    double Bf[3][B];
+    if constexpr (hasBlockFieldFunction<FieldFunction>::value && sizeof...(Arguments) == 0) {
+        // all active particles with one call of the field function
+        size_t indices[B];
+        size_t position[B];
+        Vector_t externalE[B];
+        Vector_t externalB[B];
+        bool outOfBound[B];
+        size_t numActive = 0;
+        for (size_t k = 0; k < n; ++k) {
+            if (isActive[k]) {
+                const size_t i = first + k;
+                bunch->R[i] = Vector_t({y[0][k], y[1][k], y[2][k]});
+                indices[numActive] = i;
+                position[numActive] = k;
+                externalE[numActive] = Vector_t({0.0, 0.0, 0.0});
+                externalB[numActive] = Vector_t({0.0, 0.0, 0.0});
+                ++numActive;
+            }
+            for (int j = 0; j < 3; ++j) {
+                E[j][k]  = 0.0;
+                Bf[j][k] = 0.0;
+            }
+        }
+
+        this->fieldfunc_m(t, indices, numActive, externalE, externalB, outOfBound);
+
+        for (size_t l = 0; l < numActive; ++l) {
+            const size_t k = position[l];
+            isActive[k] = !outOfBound[l];
+            for (int j = 0; j < 3; ++j) {
+                E[j][k]  = externalE[l](j);
+                Bf[j][k] = externalB[l](j);
+            }
+        }
+    } else {
+        for (size_t k = 0; k < n; ++k) {
+            Vector_t externalE = Vector_t({0.0, 0.0, 0.0});
+            Vector_t externalB = Vector_t({0.0, 0.0, 0.0});
+            if (isActive[k]) {
+                const size_t i = first + k;
+                bunch->R[i] = Vector_t({y[0][k], y[1][k], y[2][k]});
+                isActive[k] = !this->fieldfunc_m(t, i, externalE, externalB, args ...);
+            }
+            for (int j = 0; j < 3; ++j) {
+                E[j][k]  = externalE(j);
+                Bf[j][k] = externalB(j);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < n; ++k) {
+        double tempgamma = std::sqrt(1 + (y[3][k] * y[3][k] + y[4][k] * y[4][k] + y[5][k] * y[5][k]));
+
+        yp[0][k] = Physics::c / tempgamma * y[3][k];
+        yp[1][k] = Physics::c / tempgamma * y[4][k];
+        yp[2][k] = Physics::c / tempgamma * y[5][k];
+
+        yp[3][k] = (E[0][k] / Physics::c  + (Bf[2][k] * y[4][k] - Bf[1][k] * y[5][k]) / tempgamma) * qtom[k]; // [1/ns]
+        yp[4][k] = (E[1][k] / Physics::c  - (Bf[2][k] * y[3][k] - Bf[0][k] * y[5][k]) / tempgamma) * qtom[k]; // [1/ns];
+        yp[5][k] = (E[2][k] / Physics::c  + (Bf[1][k] * y[3][k] - Bf[0][k] * y[4][k]) / tempgamma) * qtom[k]; // [1/ns];
+
+        yp[3][k] /= Units::ns2s;
+        yp[4][k] /= Units::ns2s;
+        yp[5][k] /= Units::ns2s;
+    }
+}
+
+
 template <typename FieldFunction, typename ... Arguments>
 bool RK4<FieldFunction, Arguments ...>::derivate_m(PartBunchBase<double, 3>* bunch,
                                                    double* y,
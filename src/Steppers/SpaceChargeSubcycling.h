@@ -0,0 +1,183 @@
+//
+// Class SpaceChargeSubcycling
+//   Schedule of the space charge solves of OPAL-T if the solver is not called
+//   in every step (SCSOLVEFREQ > 1). After a solve the self fields are stored
+//   in the frame of the beam in the particle attributes Efsc and Bfsc of the
+//   bunch. Until the next solve they are rotated into the reference frame with
+//   the current direction of the mean momentum. The attributes are only
+//   registered with the bunch if the fields are reused.
+//
+//   A solve is forced if particles are emitted, since the new particles have
+//   no stored fields, and in steps where the particles are repartitioned or
+//   sorted since both are done together with the solve. With a tolerance
+//   (SCSOLVETOL) the solve is also done earlier if the rms beam size or the
+//   mean Lorentz factor have changed by more than this fraction.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef SPACECHARGESUBCYCLING_H
+#define SPACECHARGESUBCYCLING_H
+
+#include "Algorithms/CoordinateSystemTrafo.h"
+#include "Algorithms/PartBunchBase.h"
+#include "Utilities/Options.h"
+
+#include <cmath>
+
+class SpaceChargeSubcycling {
+
+public:
+    /// With a solve frequency of one the fields are solved in every step and
+    /// nothing is stored.
+    explicit SpaceChargeSubcycling(int solveFrequency = 1,
+                                   double solveTolerance = 0.0);
+
+    bool isEnabled() const;
+
+    /// Register the storage of the fields with the bunch if they are reused.
+    void attach(PartBunchBase<double, 3>* bunch) const;
+
+    /// true if the particles are repartitioned in step
+    static bool isRepartitionStep(unsigned long long step, unsigned int repartFreq);
+
+    /// true if the particles are sorted in step, see SORTFREQ
+    static bool isSortStep(unsigned long long step);
+
+    /// true if the space charge fields have to be solved in step; rrms and
+    /// meanGamma are the rms beam size and the mean Lorentz factor of step
+    bool isSolveDue(unsigned long long step,
+                    bool isEmitting,
+                    unsigned int repartFreq,
+                    const Vector_t& rrms,
+                    double meanGamma) const;
+
+    /// Store the fields Ef and Bf of the bunch in the frame of the beam right
+    /// after the solve of step.
+    void storeFields(PartBunchBase<double, 3>* bunch,
+                     unsigned long long step,
+                     const Vector_t& rrms,
+                     double meanGamma);
+
+    /// Set Ef and Bf of the bunch to the stored fields in the reference frame.
+    void restoreFields(PartBunchBase<double, 3>* bunch,
+                       const CoordinateSystemTrafo& beamToReference) const;
+
+private:
+    int solveFrequency_m;
+    double solveTolerance_m;
+
+    long long lastSolveStep_m;
+    Vector_t lastSolveRrms_m;
+    double lastSolveGamma_m;
+};
+
+inline
+SpaceChargeSubcycling::SpaceChargeSubcycling(int solveFrequency,
+                                             double solveTolerance):
+    solveFrequency_m(solveFrequency),
+    solveTolerance_m(solveTolerance),
+    lastSolveStep_m(-1),
+    lastSolveRrms_m(0.0),
+    lastSolveGamma_m(0.0)
+{ }
+
+inline
+bool SpaceChargeSubcycling::isEnabled() const {
+    return solveFrequency_m > 1;
+}
+
+inline
+void SpaceChargeSubcycling::attach(PartBunchBase<double, 3>* bunch) const {
+    if (isEnabled()) {
+        bunch->enableSpaceChargeFieldStorage();
+    }
+}
+
+inline
+bool SpaceChargeSubcycling::isRepartitionStep(unsigned long long step, unsigned int repartFreq) {
+    return step % repartFreq + 1 == repartFreq;
+}
+
+inline
+bool SpaceChargeSubcycling::isSortStep(unsigned long long step) {
+    return Options::sortFreq > 0 && (step + 1) % Options::sortFreq == 0;
+}
+
+inline
+bool SpaceChargeSubcycling::isSolveDue(unsigned long long step,
+                                       bool isEmitting,
+                                       unsigned int repartFreq,
+                                       const Vector_t& rrms,
+                                       double meanGamma) const {
+    if (!isEnabled() ||
+        lastSolveStep_m < 0 ||
+        step - lastSolveStep_m >= (unsigned long long)solveFrequency_m) {
+        return true;
+    }
+
+    if (isEmitting ||
+        isRepartitionStep(step, repartFreq) ||
+        isSortStep(step)) {
+        return true;
+    }
+
+    if (solveTolerance_m > 0.0) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            if (std::abs(rrms(d) - lastSolveRrms_m(d)) > solveTolerance_m * lastSolveRrms_m(d)) {
+                return true;
+            }
+        }
+        if (std::abs(meanGamma - lastSolveGamma_m) > solveTolerance_m * lastSolveGamma_m) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline
+void SpaceChargeSubcycling::storeFields(PartBunchBase<double, 3>* bunch,
+                                        unsigned long long step,
+                                        const Vector_t& rrms,
+                                        double meanGamma) {
+    if (!isEnabled()) return;
+
+    const size_t localNum = bunch->getLocalNum();
+    for (size_t i = 0; i < localNum; ++ i) {
+        bunch->Efsc[i] = bunch->Ef[i];
+        bunch->Bfsc[i] = bunch->Bf[i];
+    }
+    lastSolveStep_m = step;
+    lastSolveRrms_m = rrms;
+    lastSolveGamma_m = meanGamma;
+}
+
+inline
+void SpaceChargeSubcycling::restoreFields(PartBunchBase<double, 3>* bunch,
+                                          const CoordinateSystemTrafo& beamToReference) const {
+    const size_t localNum = bunch->getLocalNum();
+    Vector_t* Ef = bunch->Ef.data();
+    Vector_t* Bf = bunch->Bf.data();
+    const Vector_t* Efsc = bunch->Efsc.data();
+    const Vector_t* Bfsc = bunch->Bfsc.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < localNum; ++ i) {
+        Ef[i] = beamToReference.rotateTo(Efsc[i]);
+        Bf[i] = beamToReference.rotateTo(Bfsc[i]);
+    }
+}
+
+#endif
@@ -21,7 +21,11 @@
 #include "Algorithms/PartBunchBase.h"
 #include "Algorithms/Vektor.h"
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <type_traits>
+#include <utility>
 
 /*!
  * @precondition The field function has to return a
@@ -30,13 +34,36 @@
  *  - int       specifying the i-th particle
  *  - Vector_t  specifying the electric field
  *  - Vector_t  specifying the magnetic field
+ *
+ * FieldFunction is a template parameter, a function object of a named type
+ * lets the compiler inline the field evaluation into the integrator.
+ *
+ * A field function may in addition evaluate several particles at once,
+ * (double t, const size_t* indices, size_t n, Vector_t* E, Vector_t* B,
+ * bool* outOfBound), see hasBlockFieldFunction. The block integrators use
+ * it if there are no further arguments.
  */
 
+template <typename FieldFunction, typename = void>
+struct hasBlockFieldFunction : std::false_type { };
+
+template <typename FieldFunction>
+struct hasBlockFieldFunction<FieldFunction, std::void_t<decltype(
+    std::declval<const FieldFunction&>()(std::declval<const double&>(),
+                                         std::declval<const size_t*>(),
+                                         std::declval<size_t>(),
+                                         std::declval<Vector_t*>(),
+                                         std::declval<Vector_t*>(),
+                                         std::declval<bool*>()))>> : std::true_type { };
+
 template <typename FieldFunction, typename ... Arguments>
 class Stepper {
     
 public:
     
+    /// maximal number of particles per call of doAdvanceBlock_m
+    static constexpr size_t blockSize_m = 64;
+
     Stepper(const FieldFunction& fieldfunc) : fieldfunc_m(fieldfunc) { }
     
     virtual bool advance(PartBunchBase<double, 3>* bunch,
@@ -47,6 +74,66 @@ public:
     {
         bool isGood = doAdvance_m(bunch, i, t, dt, args...);
 
+        return markIfBad_m(bunch, i, isGood);
+    };
+
+    /*!
+     * Advance the particles [first, last) by one step. Same as calling
+     * advance for each of them but the particles are handed to the
+     * integrator in blocks of blockSize_m.
+     *
+     * @returns true if any of the particles was marked as lost
+     */
+    bool advanceBlock(PartBunchBase<double, 3>* bunch,
+                      const size_t& first,
+                      const size_t& last,
+                      const double& t,
+                      const double dt,
+                      Arguments& ... args) const
+    {
+        bool isGood[blockSize_m];
+        bool anyBad = false;
+        for (size_t begin = first; begin < last; begin += blockSize_m) {
+            const size_t end = std::min(begin + blockSize_m, last);
+            doAdvanceBlock_m(bunch, begin, end, t, dt, isGood, args...);
+            for (size_t i = begin; i < end; ++i) {
+                anyBad |= markIfBad_m(bunch, i, isGood[i - begin]);
+            }
+        }
+        return anyBad;
+    }
+
+    virtual ~Stepper() {};
+
+protected:
+    const FieldFunction& fieldfunc_m;
+
+private:
+    virtual bool doAdvance_m(PartBunchBase<double, 3>* bunch,
+                             const size_t& i,
+                             const double& t,
+                             const double dt,
+                             Arguments& ... args) const = 0;
+
+    /// at most blockSize_m particles, isGood[i - first] is the result of
+    /// doAdvance_m for particle i
+    virtual void doAdvanceBlock_m(PartBunchBase<double, 3>* bunch,
+                                  const size_t& first,
+                                  const size_t& last,
+                                  const double& t,
+                                  const double dt,
+                                  bool* isGood,
+                                  Arguments& ... args) const
+    {
+        for (size_t i = first; i < last; ++i) {
+            isGood[i - first] = doAdvance_m(bunch, i, t, dt, args...);
+        }
+    }
+
+    bool markIfBad_m(PartBunchBase<double, 3>* bunch,
+                     const size_t& i,
+                     bool isGood) const
+    {
         bool isNaN = false;
         for (int j = 0; j < 3; ++j) {
             if (std::isnan(bunch->R[i](j)) ||
@@ -63,18 +150,7 @@ public:
             bunch->Bin[i] = -1;
         }
         return isBad;
-    };
-    virtual ~Stepper() {};
-
-protected:
-    const FieldFunction& fieldfunc_m;
-
-private:
-    virtual bool doAdvance_m(PartBunchBase<double, 3>* bunch,
-                             const size_t& i,
-                             const double& t,
-                             const double dt,
-                             Arguments& ... args) const = 0;
+    }
 };
 
 #endif
@@ -21,11 +21,18 @@
 #include "Structure/BoundaryGeometry.h"
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstdint>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <system_error>
+
+#include <unistd.h>
 
 #include "H5hut.h"
 #include <cfloat>
@@ -335,7 +342,7 @@ Vector_t get_min_extent (std::vector<Vector_t>& coords) {
 */
 static void write_voxel_mesh (
     std::string fname,
-    const std::unordered_map< int, std::unordered_set<int> >& ids,
+    const std::vector<int>& ids,
     const Vector_t& hr_m,
     const Vektor<int,3>& nr,
     const Vector_t& origin
@@ -357,8 +364,7 @@ static void write_voxel_mesh (
     of << "POINTS " << numpoints << " float" << std::endl;
 
     const auto nr0_times_nr1 = nr[0] * nr[1];
-    for (auto& elem: ids) {
-        auto id = elem.first;
+    for (auto id: ids) {
         int k = (id - 1) / nr0_times_nr1;
         int rest = (id - 1) % nr0_times_nr1;
         int j = rest / nr[0];
@@ -947,7 +953,8 @@ static inline double computeArea (
 
 BoundaryGeometry::BoundaryGeometry() :
     Definition (
-        SIZE, "GEOMETRY", "The \"GEOMETRY\" statement defines the beam pipe geometry.") {
+        SIZE, "GEOMETRY", "The \"GEOMETRY\" statement defines the beam pipe geometry."),
+    accelerator_m (GeometryAccelerator::BVH) {
 
     itsAttr[FGEOM] = Attributes::makeString
         ("FGEOM",
@@ -1023,6 +1030,13 @@ BoundaryGeometry::BoundaryGeometry() :
     itsAttr[INSIDEPOINT] = Attributes::makeRealArray
         ("INSIDEPOINT", "A point inside the geometry");
 
+    itsAttr[ACCELERATOR] = Attributes::makePredefinedString
+        ("ACCELERATOR",
+         "Search structure for the intersection tests with the boundary: "
+         "a bounding volume hierarchy (BVH) or the voxel mesh (VOXEL)",
+         {"BVH", "VOXEL"},
+         "BVH");
+
     registerOwnership(AttributeHandler::STATEMENT);
 
     BoundaryGeometry* defGeometry = clone ("UNNAMED_GEOMETRY");
@@ -1052,7 +1066,8 @@ BoundaryGeometry::BoundaryGeometry() :
 BoundaryGeometry::BoundaryGeometry(
     const std::string& name,
     BoundaryGeometry* parent
-    ) : Definition (name, parent) {
+    ) : Definition (name, parent),
+        accelerator_m (GeometryAccelerator::BVH) {
     gsl_rng_env_setup();
     randGen_m = gsl_rng_alloc(gsl_rng_default);
 
@@ -1441,9 +1456,13 @@ BoundaryGeometry::fastIsInside (
     }
 #endif
     const Vector_t v = reference_pt - P;
-    const int N = std::ceil (magnitude (v) / std::min ({voxelMesh_m.sizeOfVoxel [0],
-                                              voxelMesh_m.sizeOfVoxel [1],
-                                              voxelMesh_m.sizeOfVoxel [2]}));
+    // the BVH query doesn't depend on the length of the segment, with the
+    // voxel mesh the segment is divided into segments of about voxel size
+    const int N = (accelerator_m == GeometryAccelerator::BVH ?
+                   1 :
+                   std::ceil (magnitude (v) / std::min ({voxelMesh_m.sizeOfVoxel [0],
+                                                        voxelMesh_m.sizeOfVoxel [1],
+                                                        voxelMesh_m.sizeOfVoxel [2]})));
     const Vector_t v_ = v / N;
     Vector_t P0 = P;
     Vector_t P1 = P + v_;
@@ -1582,42 +1601,116 @@ BoundaryGeometry::mapPoint2Voxel (
 }
 
 
+inline std::pair<const int*, const int*>
+BoundaryGeometry::getVoxelTriangles (
+    const int voxel_id
+    ) const {
+    const auto it = std::lower_bound (
+        voxelMesh_m.voxelIds.begin (), voxelMesh_m.voxelIds.end (), voxel_id);
+    if (it == voxelMesh_m.voxelIds.end () || *it != voxel_id) {
+        return std::make_pair (nullptr, nullptr);
+    }
+    const size_t n = it - voxelMesh_m.voxelIds.begin ();
+    const int* triangles = voxelMesh_m.triangleIds.data ();
+    return std::make_pair (triangles + voxelMesh_m.offsets[n],
+                           triangles + voxelMesh_m.offsets[n + 1]);
+}
+
 inline void
 BoundaryGeometry::computeMeshVoxelization (void) {
 
-    for (unsigned int triangle_id = 0; triangle_id < Triangles_m.size(); triangle_id++) {
-        Vector_t v1 = getPoint (triangle_id, 1);
-        Vector_t v2 = getPoint (triangle_id, 2);
-        Vector_t v3 = getPoint (triangle_id, 3);
-        Vector_t bbox_min = {
-            std::min({v1[0], v2[0], v3[0]}),
-            std::min({v1[1], v2[1], v3[1]}),
-            std::min({v1[2], v2[2], v3[2]}) };
-        Vector_t bbox_max = {
-            std::max({v1[0], v2[0], v3[0]}),
-            std::max({v1[1], v2[1], v3[1]}),
-            std::max({v1[2], v2[2], v3[2]}) };
-        int i_min, j_min, k_min;
-        int i_max, j_max, k_max;
-        mapPoint2VoxelIndices (bbox_min, i_min, j_min, k_min);
-        mapPoint2VoxelIndices (bbox_max, i_max, j_max, k_max);
+    /*
+      The triangles are distributed in contiguous blocks over the cores and
+      within a core over the threads. Every thread collects pairs of voxel
+      ID and ID of an intersecting triangle, the pairs of all cores are
+      gathered and sorted by voxel ID afterwards to get the compressed
+      sparse row format.
+    */
+    const size_t num_triangles = Triangles_m.size ();
+    const size_t first = num_triangles * Ippl::myNode () / Ippl::getNodes ();
+    const size_t last = num_triangles * (Ippl::myNode () + 1) / Ippl::getNodes ();
+
+    std::vector<std::pair<int, int>> local_voxel_triangles;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        std::vector<std::pair<int, int>> thread_voxel_triangles;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256) nowait
+#endif
+        for (size_t triangle_id = first; triangle_id < last; triangle_id++) {
+            Vector_t v1 = getPoint (triangle_id, 1);
+            Vector_t v2 = getPoint (triangle_id, 2);
+            Vector_t v3 = getPoint (triangle_id, 3);
+            Vector_t bbox_min = {
+                std::min({v1[0], v2[0], v3[0]}),
+                std::min({v1[1], v2[1], v3[1]}),
+                std::min({v1[2], v2[2], v3[2]}) };
+            Vector_t bbox_max = {
+                std::max({v1[0], v2[0], v3[0]}),
+                std::max({v1[1], v2[1], v3[1]}),
+                std::max({v1[2], v2[2], v3[2]}) };
+            // the bounding box of a triangle is always inside the voxel
+            // mesh, hence no need for the range check of mapPoint2VoxelIndices
+            // which isn't thread safe
+            int ijk_min[3], ijk_max[3];
+            for (int d = 0; d < 3; d++) {
+                ijk_min[d] = std::floor ((bbox_min[d] - voxelMesh_m.minExtent[d]) / voxelMesh_m.sizeOfVoxel[d]);
+                ijk_max[d] = std::floor ((bbox_max[d] - voxelMesh_m.minExtent[d]) / voxelMesh_m.sizeOfVoxel[d]);
+            }
 
-        for (int i = i_min; i <= i_max; i++) {
-            for (int j = j_min; j <= j_max; j++) {
-                for (int k = k_min; k <= k_max; k++) {
-                    // test if voxel (i,j,k) has an intersection with triangle
-                    if (intersectTriangleVoxel (triangle_id, i, j, k) == INSIDE) {
-                        auto id = mapVoxelIndices2ID (i, j, k);
-                        voxelMesh_m.ids [id].insert (triangle_id);
+            for (int i = ijk_min[0]; i <= ijk_max[0]; i++) {
+                for (int j = ijk_min[1]; j <= ijk_max[1]; j++) {
+                    for (int k = ijk_min[2]; k <= ijk_max[2]; k++) {
+                        // test if voxel (i,j,k) has an intersection with triangle
+                        if (intersectTriangleVoxel (triangle_id, i, j, k) == INSIDE) {
+                            auto id = mapVoxelIndices2ID (i, j, k);
+                            thread_voxel_triangles.emplace_back (id, triangle_id);
+                        }
                     }
                 }
             }
+        } // for_each triangle
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        local_voxel_triangles.insert (local_voxel_triangles.end (),
+                                      thread_voxel_triangles.begin (),
+                                      thread_voxel_triangles.end ());
+    }
+
+    // gather the pairs of all cores, a pair of ints matches MPI_2INT
+    int num_local = local_voxel_triangles.size ();
+    std::vector<int> counts (Ippl::getNodes ());
+    MPI_Allgather (&num_local, 1, MPI_INT, counts.data (), 1, MPI_INT, Ippl::getComm ());
+    std::vector<int> displacements (Ippl::getNodes (), 0);
+    for (int node = 1; node < Ippl::getNodes (); node++) {
+        displacements[node] = displacements[node - 1] + counts[node - 1];
+    }
+    std::vector<std::pair<int, int>> voxel_triangles (displacements.back () + counts.back ());
+    MPI_Allgatherv (local_voxel_triangles.data (), num_local, MPI_2INT,
+                    voxel_triangles.data (), counts.data (), displacements.data (), MPI_2INT,
+                    Ippl::getComm ());
+    std::vector<std::pair<int, int>> ().swap (local_voxel_triangles);
+
+    std::sort (voxel_triangles.begin (), voxel_triangles.end ());
+    voxelMesh_m.voxelIds.clear ();
+    voxelMesh_m.offsets.clear ();
+    voxelMesh_m.triangleIds.clear ();
+    voxelMesh_m.triangleIds.reserve (voxel_triangles.size ());
+    for (const auto& elem: voxel_triangles) {
+        if (voxelMesh_m.voxelIds.empty () || voxelMesh_m.voxelIds.back () != elem.first) {
+            voxelMesh_m.voxelIds.push_back (elem.first);
+            voxelMesh_m.offsets.push_back (voxelMesh_m.triangleIds.size ());
         }
-    } // for_each triangle
+        voxelMesh_m.triangleIds.push_back (elem.second);
+    }
+    voxelMesh_m.offsets.push_back (voxelMesh_m.triangleIds.size ());
     *gmsg << level2 << "* Mesh voxelization done" << endl;
 
     // write voxel mesh into VTK file
-    if (Ippl::myNode() == 0 && Options::enableVTK) {
+    if (Ippl::myNode() == 0 && Options::enableVTK && !h5FileName_m.empty ()) {
         std::string vtkFileName = Util::combineFilePath({
             OpalData::getInstance()->getAuxiliaryOutputDirectory(),
             "testBBox.vtk"
@@ -1638,7 +1731,7 @@ BoundaryGeometry::computeMeshVoxelization (void) {
 
         if (writeVTK) {
             write_voxel_mesh (vtkFileName,
-                              voxelMesh_m.ids,
+                              voxelMesh_m.voxelIds,
                               voxelMesh_m.sizeOfVoxel,
                               voxelMesh_m.nr_m,
                               voxelMesh_m.minExtent);
@@ -1646,7 +1739,284 @@ BoundaryGeometry::computeMeshVoxelization (void) {
     }
 }
 
+/*
+  Geometry cache
+
+  The cache file starts with the key returned by makeCacheKey(), followed
+  by the oriented triangles, the point inside the geometry and the search
+  structure of the selected ACCELERATOR. It is written next to the geometry
+  file, such that all runs using this geometry can use it, or, if this
+  isn't possible, into the auxiliary output directory.
+*/
+static const char geometry_cache_magic[8] = "OPALBGC";
+static const uint32_t geometry_cache_version = 1;
+
+template <class T>
+static void write_cache_value (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*>(&value), sizeof (T));
+}
+
+template <class T>
+static bool read_cache_value (std::istream& in, T& value) {
+    in.read (reinterpret_cast<char*>(&value), sizeof (T));
+    return in.good ();
+}
+
+template <class T>
+static void write_cache_vector (std::ostream& out, const std::vector<T>& v) {
+    write_cache_value (out, (uint64_t)v.size ());
+    out.write (reinterpret_cast<const char*>(v.data ()), v.size () * sizeof (T));
+}
+
+template <class T>
+static bool read_cache_vector (std::istream& in, std::vector<T>& v) {
+    uint64_t size = 0;
+    if (!read_cache_value (in, size) ||
+        size * sizeof (T) > (uint64_t)in.rdbuf ()->in_avail ()) {
+        return false;
+    }
+    v.resize (size);
+    in.read (reinterpret_cast<char*>(v.data ()), size * sizeof (T));
+    return in.good ();
+}
+
+// FNV-1a hash of the content of a file
+static uint64_t hash_file (const std::string& fname) {
+    uint64_t hash = 14695981039346656037ull;
+    std::ifstream in (fname, std::ios::binary);
+    std::vector<char> buffer (1 << 20);
+    while (in) {
+        in.read (buffer.data (), buffer.size ());
+        for (std::streamsize i = 0; i < in.gcount (); i++) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+static std::vector<std::string> get_cache_file_names (const std::string& h5FileName) {
+    const std::filesystem::path geometry (h5FileName);
+    return {
+        h5FileName + ".bgcache",
+        Util::combineFilePath ({
+            OpalData::getInstance ()->getAuxiliaryOutputDirectory (),
+            geometry.filename ().string () + ".bgcache"
+        })
+    };
+}
+
+std::string
+BoundaryGeometry::makeCacheKey () {
+    uint64_t file_hash = 0;
+    if (Ippl::myNode () == 0) {
+        file_hash = hash_file (h5FileName_m);
+    }
+    MPI_Bcast (&file_hash, 1, MPI_UINT64_T, 0, Ippl::getComm ());
+
+    std::ostringstream key;
+    key.write (geometry_cache_magic, sizeof (geometry_cache_magic));
+    write_cache_value (key, geometry_cache_version);
+    write_cache_value (key, file_hash);
+    write_cache_value (key, (uint64_t)Points_m.size ());
+    write_cache_value (key, (uint64_t)Triangles_m.size ());
+    for (int attr: {XSCALE, YSCALE, ZSCALE, XYZSCALE, ZSHIFT}) {
+        write_cache_value (key, Attributes::getReal (itsAttr[attr]));
+    }
+    write_cache_value (key, (uint32_t)accelerator_m);
+    write_cache_vector (key, Attributes::getRealArray (itsAttr[INSIDEPOINT]));
+
+    return key.str ();
+}
+
+bool
+BoundaryGeometry::readCache (const std::string& key) {
+    // the file is read on the first core and broadcast to all others
+    std::string buffer;
+    if (Ippl::myNode () == 0) {
+        for (const std::string& fname: get_cache_file_names (h5FileName_m)) {
+            std::ifstream in (fname, std::ios::binary);
+            if (!in.good ()) continue;
+
+            std::string content ((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+            if (content.size () > key.size () && content.compare (0, key.size (), key) == 0) {
+                *gmsg << level2 << "* Reading geometry cache '" << fname << "'" << endl;
+                buffer.swap (content);
+                break;
+            }
+        }
+    }
+    uint64_t size = (buffer.size () <= INT_MAX ? buffer.size () : 0);
+    MPI_Bcast (&size, 1, MPI_UINT64_T, 0, Ippl::getComm ());
+    if (size == 0) {
+        return false;
+    }
+    buffer.resize (size);
+    MPI_Bcast (&buffer[0], size, MPI_CHAR, 0, Ippl::getComm ());
+
+    std::istringstream in (buffer);
+    std::string ().swap (buffer);
+    in.seekg (key.size ());
+
+    std::vector<std::array<unsigned int,4>> triangles;
+    uint32_t have_inside_point = 0;
+    Vector_t inside_point;
+    bool ok = (read_cache_vector (in, triangles) &&
+               triangles.size () == Triangles_m.size () &&
+               read_cache_value (in, have_inside_point) &&
+               read_cache_value (in, inside_point));
+    if (ok && accelerator_m == GeometryAccelerator::BVH) {
+        ok = bvh_m.read (in);
+    } else if (ok) {
+        ok = (read_cache_vector (in, voxelMesh_m.voxelIds) &&
+              read_cache_vector (in, voxelMesh_m.offsets) &&
+              read_cache_vector (in, voxelMesh_m.triangleIds) &&
+              voxelMesh_m.offsets.size () == voxelMesh_m.voxelIds.size () + 1);
+    }
+    if (!ok) {
+        *gmsg << level2 << "* Geometry cache is corrupt, ignoring it" << endl;
+        return false;
+    }
+
+    Triangles_m.swap (triangles);
+    haveInsidePoint_m = (have_inside_point != 0);
+    insidePoint_m = inside_point;
+    return true;
+}
+
+void
+BoundaryGeometry::writeCache (const std::string& key) const {
+    if (Ippl::myNode () != 0) return;
+
+    for (const std::string& fname: get_cache_file_names (h5FileName_m)) {
+        // write to a temporary file first such that other runs never see
+        // an incomplete cache file
+        const std::string tmp_fname = fname + ".tmp" + std::to_string (getpid ());
+        std::error_code ec;
+        {
+            std::ofstream out (tmp_fname, std::ios::binary | std::ios::trunc);
+            if (!out.good ()) continue;
+
+            out.write (key.data (), key.size ());
+            write_cache_vector (out, Triangles_m);
+            write_cache_value (out, (uint32_t)haveInsidePoint_m);
+            write_cache_value (out, insidePoint_m);
+            if (accelerator_m == GeometryAccelerator::BVH) {
+                bvh_m.write (out);
+            } else {
+                write_cache_vector (out, voxelMesh_m.voxelIds);
+                write_cache_vector (out, voxelMesh_m.offsets);
+                write_cache_vector (out, voxelMesh_m.triangleIds);
+            }
+            if (!out.good ()) {
+                out.close ();
+                std::filesystem::remove (tmp_fname, ec);
+                continue;
+            }
+        }
+        std::filesystem::rename (tmp_fname, fname, ec);
+        if (ec) {
+            std::filesystem::remove (tmp_fname, ec);
+            continue;
+        }
+        *gmsg << level2 << "* Geometry cache written to '" << fname << "'" << endl;
+        return;
+    }
+    WARNMSG (level2 << "Couldn't write the cache of geometry '" << h5FileName_m << "'" << endl);
+}
+
 void BoundaryGeometry::initialize () {
+    *gmsg << level2 << "* Initializing Boundary Geometry..." << endl;
+    IpplTimings::startTimer (Tinitialize_m);
+
+    readMesh ();
+    initializeMesh ();
+
+    IpplTimings::stopTimer (Tinitialize_m);
+}
+
+void BoundaryGeometry::initialize (
+    const std::vector<Vector_t>& points,
+    const std::vector<std::array<unsigned int,4>>& triangles
+    ) {
+    *gmsg << level2 << "* Initializing Boundary Geometry..." << endl;
+    IpplTimings::startTimer (Tinitialize_m);
+
+    h5FileName_m.clear ();
+    Points_m = points;
+    Triangles_m = triangles;
+    initializeMesh ();
+
+    IpplTimings::stopTimer (Tinitialize_m);
+}
+
+void BoundaryGeometry::readMesh () {
+    if (!std::filesystem::exists(h5FileName_m)) {
+        throw OpalException("BoundaryGeometry::initialize",
+                            "Failed to open file '" + h5FileName_m +
+                            "', please check if it exists");
+    }
+
+    double xscale = Attributes::getReal(itsAttr[XSCALE]);
+    double yscale = Attributes::getReal(itsAttr[YSCALE]);
+    double zscale = Attributes::getReal(itsAttr[ZSCALE]);
+    double xyzscale = Attributes::getReal(itsAttr[XYZSCALE]);
+    double zshift = (double)(Attributes::getReal (itsAttr[ZSHIFT]));
+
+    h5_int64_t rc;
+#if defined (NDEBUG)
+    (void)rc;
+#endif
+    rc = H5SetErrorHandler (H5AbortErrorhandler);
+    PAssert (rc != H5_ERR);
+    H5SetVerbosityLevel (1);
+
+    h5_prop_t props = H5CreateFileProp ();
+    MPI_Comm comm = Ippl::getComm();
+    H5SetPropFileMPIOCollective (props, &comm);
+    h5_file_t f = H5OpenFile (h5FileName_m.c_str(), H5_O_RDONLY, props);
+    H5CloseProp (props);
+
+    h5t_mesh_t* m = nullptr;
+    H5FedOpenTriangleMesh (f, "0", &m);
+    H5FedSetLevel (m, 0);
+
+    auto numTriangles = H5FedGetNumElementsTotal (m);
+    Triangles_m.resize (numTriangles);
+
+    // iterate over all co-dim 0 entities, i.e. elements
+    h5_loc_id_t local_id;
+    int i = 0;
+    h5t_iterator_t* iter = H5FedBeginTraverseEntities (m, 0);
+    while ((local_id = H5FedTraverseEntities (iter)) >= 0) {
+        h5_loc_id_t local_vids[4];
+        H5FedGetVertexIndicesOfEntity (m, local_id, local_vids);
+        PointID (i, 0) = 0;
+        PointID (i, 1) = local_vids[0];
+        PointID (i, 2) = local_vids[1];
+        PointID (i, 3) = local_vids[2];
+        i++;
+    }
+    H5FedEndTraverseEntities (iter);
+
+    // loop over all vertices
+    int num_points = H5FedGetNumVerticesTotal (m);
+    Points_m.reserve (num_points);
+    for (i = 0; i < num_points; i++) {
+        h5_float64_t P[3];
+        H5FedGetVertexCoordsByIndex (m, i, P);
+        Points_m.push_back (Vector_t ({
+            P[0] * xyzscale * xscale,
+            P[1] * xyzscale * yscale,
+            P[2] * xyzscale * zscale + zshift}));
+    }
+    H5FedCloseMesh (m);
+    H5CloseFile (f);
+    *gmsg << level2 << "* Reading mesh done" << endl;
+}
+
+void BoundaryGeometry::initializeMesh () {
 
     class Local {
 
@@ -1902,19 +2272,27 @@ Change orientation if diff is:
                 bg->maxExtent_m[0] * (1.1 + gsl_rng_uniform(bg->randGen_m)),
                 bg->maxExtent_m[1] * (1.1 + gsl_rng_uniform(bg->randGen_m)),
                 bg->maxExtent_m[2] * (1.1 + gsl_rng_uniform(bg->randGen_m))});
-
-            std::vector<Vector_t> intersection_points;
-            //int num_intersections = 0;
-
-            for (unsigned int triangle_id = 0; triangle_id < bg->Triangles_m.size(); triangle_id++) {
+            // all cores have to use the same reference point
+            MPI_Bcast (&y[0], 3, MPI_DOUBLE, 0, Ippl::getComm ());
+
+            // the triangles are distributed in blocks over the cores and
+            // the threads
+            const size_t num_triangles = bg->Triangles_m.size ();
+            const size_t first = num_triangles * Ippl::myNode () / Ippl::getNodes ();
+            const size_t last = num_triangles * (Ippl::myNode () + 1) / Ippl::getNodes ();
+            long num_intersections = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+: num_intersections)
+#endif
+            for (size_t triangle_id = first; triangle_id < last; triangle_id++) {
                 Vector_t result;
                 if (bg->intersectLineTriangle (SEGMENT, x, y, triangle_id, result)) {
-                    intersection_points.push_back (result);
-                    //num_intersections++;
+                    num_intersections++;
                 }
             }
+            MPI_Allreduce (MPI_IN_PLACE, &num_intersections, 1, MPI_LONG, MPI_SUM, Ippl::getComm ());
             IpplTimings::stopTimer (bg->TisInside_m);
-            return ((intersection_points.size () % 2) == 1);
+            return ((num_intersections % 2) == 1);
         }
 
         // helper for function  makeTriangleNormalInwardPointing()
@@ -2025,93 +2403,51 @@ Change orientation if diff is:
     };
 
     debugFlags_m = 0;
-    *gmsg << level2 << "* Initializing Boundary Geometry..." << endl;
-    IpplTimings::startTimer (Tinitialize_m);
-
-    if (!std::filesystem::exists(h5FileName_m)) {
-        throw OpalException("BoundaryGeometry::initialize",
-                            "Failed to open file '" + h5FileName_m +
-                            "', please check if it exists");
-    }
-
-    double xscale = Attributes::getReal(itsAttr[XSCALE]);
-    double yscale = Attributes::getReal(itsAttr[YSCALE]);
-    double zscale = Attributes::getReal(itsAttr[ZSCALE]);
-    double xyzscale = Attributes::getReal(itsAttr[XYZSCALE]);
-    double zshift = (double)(Attributes::getReal (itsAttr[ZSHIFT]));
-
-    h5_int64_t rc;
-#if defined (NDEBUG)
-    (void)rc;
-#endif
-    rc = H5SetErrorHandler (H5AbortErrorhandler);
-    PAssert (rc != H5_ERR);
-    H5SetVerbosityLevel (1);
-
-    h5_prop_t props = H5CreateFileProp ();
-    MPI_Comm comm = Ippl::getComm();
-    H5SetPropFileMPIOCollective (props, &comm);
-    h5_file_t f = H5OpenFile (h5FileName_m.c_str(), H5_O_RDONLY, props);
-    H5CloseProp (props);
-
-    h5t_mesh_t* m = nullptr;
-    H5FedOpenTriangleMesh (f, "0", &m);
-    H5FedSetLevel (m, 0);
-
-    auto numTriangles = H5FedGetNumElementsTotal (m);
-    Triangles_m.resize (numTriangles);
-
-    // iterate over all co-dim 0 entities, i.e. elements
-    h5_loc_id_t local_id;
-    int i = 0;
-    h5t_iterator_t* iter = H5FedBeginTraverseEntities (m, 0);
-    while ((local_id = H5FedTraverseEntities (iter)) >= 0) {
-        h5_loc_id_t local_vids[4];
-        H5FedGetVertexIndicesOfEntity (m, local_id, local_vids);
-        PointID (i, 0) = 0;
-        PointID (i, 1) = local_vids[0];
-        PointID (i, 2) = local_vids[1];
-        PointID (i, 3) = local_vids[2];
-        i++;
-    }
-    H5FedEndTraverseEntities (iter);
-
-    // loop over all vertices
-    int num_points = H5FedGetNumVerticesTotal (m);
-    Points_m.reserve (num_points);
-    for (i = 0; i < num_points; i++) {
-        h5_float64_t P[3];
-        H5FedGetVertexCoordsByIndex (m, i, P);
-        Points_m.push_back (Vector_t ({
-            P[0] * xyzscale * xscale,
-            P[1] * xyzscale * yscale,
-            P[2] * xyzscale * zscale + zshift}));
-    }
-    H5FedCloseMesh (m);
-    H5CloseFile (f);
-    *gmsg << level2 << "* Reading mesh done" << endl;
 
     Local::computeGeometryInterval (this);
-    computeMeshVoxelization ();
-    haveInsidePoint_m = false;
-    std::vector<double> pt = Attributes::getRealArray (itsAttr[INSIDEPOINT]);
-    if (!pt.empty()) {
-        if (pt.size () != 3) {
-            throw OpalException (
-                "BoundaryGeometry::initialize()",
-                "Dimension of INSIDEPOINT must be 3");
+    accelerator_m = getAccelerator ();
+
+    // a mesh which isn't read from a file can't be cached
+    const bool use_cache = Options::cacheGeometry && !h5FileName_m.empty ();
+    std::string cache_key;
+    bool from_cache = false;
+    if (use_cache) {
+        cache_key = makeCacheKey ();
+        from_cache = readCache (cache_key);
+    }
+    if (!from_cache) {
+        if (accelerator_m == GeometryAccelerator::BVH) {
+            bvh_m.build (Points_m, Triangles_m);
+            *gmsg << level2 << "* Bounding volume hierarchy built done" << endl;
+        } else {
+            computeMeshVoxelization ();
         }
-        /* test whether this point is inside */
-        insidePoint_m = {pt[0], pt[1], pt[2]};
-        bool is_inside = isInside (insidePoint_m);
-        if (is_inside == false) {
-            throw OpalException (
-                "BoundaryGeometry::initialize()",
-                "INSIDEPOINT is not inside the geometry");
+        haveInsidePoint_m = false;
+        std::vector<double> pt = Attributes::getRealArray (itsAttr[INSIDEPOINT]);
+        if (!pt.empty()) {
+            if (pt.size () != 3) {
+                throw OpalException (
+                    "BoundaryGeometry::initialize()",
+                    "Dimension of INSIDEPOINT must be 3");
+            }
+            /* test whether this point is inside */
+            insidePoint_m = {pt[0], pt[1], pt[2]};
+            bool is_inside = isInside (insidePoint_m);
+            if (is_inside == false) {
+                throw OpalException (
+                    "BoundaryGeometry::initialize()",
+                    "INSIDEPOINT is not inside the geometry");
+            }
+            haveInsidePoint_m = true;
+        } else {
+            haveInsidePoint_m = findInsidePoint();
+        }
+
+        Local::makeTriangleNormalInwardPointing (this);
+
+        if (use_cache) {
+            writeCache (cache_key);
         }
-        haveInsidePoint_m = true;
-    } else {
-        haveInsidePoint_m = findInsidePoint();
     }
     if (haveInsidePoint_m == true) {
         *gmsg << level2 << "* using as point inside the geometry: ("
@@ -2122,8 +2458,6 @@ Change orientation if diff is:
         *gmsg << level2 << "* no point inside the geometry found!" << endl;
     }
 
-    Local::makeTriangleNormalInwardPointing (this);
-
     TriNormals_m.resize (Triangles_m.size());
     TriAreas_m.resize (Triangles_m.size());
 
@@ -2140,7 +2474,6 @@ Change orientation if diff is:
 
     *gmsg << *this << endl;
     Ippl::Comm->barrier();
-    IpplTimings::stopTimer (Tinitialize_m);
 }
 
 /*
@@ -2171,6 +2504,43 @@ BoundaryGeometry::intersectTinyLineSegmentBoundary (
               << endl;
     }
 #endif
+    double tmin = 1.1;
+    int num_intersections = 0;
+
+    if (accelerator_m == GeometryAccelerator::BVH) {
+        /*
+          every triangle is in exactly one leaf of the BVH, hence each
+          candidate is tested once
+        */
+        bvh_m.forEachCandidate (P, Q, [&](int test_id) {
+                testSegmentTriangle (P, Q, test_id,
+                                     num_intersections, tmin,
+                                     intersect_pt, triangle_id);
+            });
+        return num_intersections;
+    }
+
+    std::vector<int> triangle_ids;
+    collectVoxelTriangles (P, Q, triangle_ids);
+
+    /*
+      test all triangles intersecting with one of the above voxels
+      if there is more than one intersection, return closest
+    */
+    for (const int test_id: triangle_ids) {
+        testSegmentTriangle (P, Q, test_id,
+                             num_intersections, tmin,
+                             intersect_pt, triangle_id);
+    }                   // end for all triangles
+    return num_intersections;
+}
+
+void
+BoundaryGeometry::collectVoxelTriangles (
+    const Vector_t& P,
+    const Vector_t& Q,
+    std::vector<int>& triangle_ids
+    ) {
     const Vector_t v_ = Q - P;
     const Ray r = Ray (P, v_);
     const Vector_t bbox_min = {
@@ -2187,9 +2557,6 @@ BoundaryGeometry::intersectTinyLineSegmentBoundary (
     mapPoint2VoxelIndices (bbox_min, i_min, j_min, k_min);
     mapPoint2VoxelIndices (bbox_max, i_max, j_max, k_max);
 
-    Vector_t tmp_intersect_pt = Q;
-    double tmin = 1.1;
-
     /*
       Triangles can - and in many cases do - intersect with more than one
       voxel.  If we loop over all voxels intersecting with the line segment
@@ -2203,7 +2570,6 @@ BoundaryGeometry::intersectTinyLineSegmentBoundary (
 
       The first solution is implemented here.
      */
-    std::unordered_set<int> triangle_ids;
     for (int i = i_min; i <= i_max; i++) {
         for (int j = j_min; j <= j_max; j++) {
             for (int k = k_min; k <= k_max; k++) {
@@ -2229,78 +2595,78 @@ BoundaryGeometry::intersectTinyLineSegmentBoundary (
                   the to be tested triangles.
                  */
                 const int voxel_id = mapVoxelIndices2ID (i, j, k);
-                const auto triangles_intersecting_voxel =
-                    voxelMesh_m.ids.find (voxel_id);
-                if (triangles_intersecting_voxel != voxelMesh_m.ids.end()) {
-                    triangle_ids.insert (
-                        triangles_intersecting_voxel->second.begin(),
-                        triangles_intersecting_voxel->second.end());
-                }
+                const auto triangles_intersecting_voxel = getVoxelTriangles (voxel_id);
+                triangle_ids.insert (triangle_ids.end (),
+                                     triangles_intersecting_voxel.first,
+                                     triangles_intersecting_voxel.second);
             }
         }
     }
-    /*
-      test all triangles intersecting with one of the above voxels
-      if there is more than one intersection, return closest
-    */
-    int num_intersections = 0;
-    int tmp_intersect_result = 0;
-
-    for (auto it = triangle_ids.begin ();
-         it != triangle_ids.end ();
-         it++) {
+    std::sort (triangle_ids.begin (), triangle_ids.end ());
+    triangle_ids.erase (std::unique (triangle_ids.begin (), triangle_ids.end ()),
+                        triangle_ids.end ());
+}
 
-        tmp_intersect_result = intersectLineTriangle (
-            LINE,
-            P, Q,
-            *it,
-            tmp_intersect_pt);
+void
+BoundaryGeometry::testSegmentTriangle (
+    const Vector_t& P,
+    const Vector_t& Q,
+    const int test_id,
+    int& num_intersections,
+    double& tmin,
+    Vector_t& intersect_pt,
+    int& triangle_id
+    ) {
+    Vector_t tmp_intersect_pt = Q;
+    const int tmp_intersect_result = intersectLineTriangle (
+        LINE,
+        P, Q,
+        test_id,
+        tmp_intersect_pt);
 #ifdef ENABLE_DEBUG
-        if (debugFlags_m & debug_intersectTinyLineSegmentBoundary) {
-            *gmsg << "* " << __func__ << ": "
-                  << "  Test triangle: " << *it
-                  << "  intersect: " << tmp_intersect_result
-                  << getPoint(*it,1)
-                  << getPoint(*it,2)
-                  << getPoint(*it,3)
-                  << endl;
-        }
+    if (debugFlags_m & debug_intersectTinyLineSegmentBoundary) {
+        *gmsg << "* " << __func__ << ": "
+              << "  Test triangle: " << test_id
+              << "  intersect: " << tmp_intersect_result
+              << getPoint(test_id,1)
+              << getPoint(test_id,2)
+              << getPoint(test_id,3)
+              << endl;
+    }
 #endif
-        switch (tmp_intersect_result) {
-        case 0:                     // no intersection
-        case 2:                     // both points are outside
-        case 4:                     // both points are inside
-            break;
-        case 1:                     // line and triangle are in same plane
-        case 3:                     // unique intersection in segment
-            double t;
-            if (cmp::eq_zero(Q[0] - P[0]) == false) {
-                t = (tmp_intersect_pt[0] - P[0]) / (Q[0] - P[0]);
-            } else if (cmp::eq_zero(Q[1] - P[1]) == false) {
-                t = (tmp_intersect_pt[1] - P[1]) / (Q[1] - P[1]);
-            } else {
-                t = (tmp_intersect_pt[2] - P[2]) / (Q[2] - P[2]);
-            }
-            num_intersections++;
-            if (t < tmin) {
+    switch (tmp_intersect_result) {
+    case 0:                     // no intersection
+    case 2:                     // both points are outside
+    case 4:                     // both points are inside
+        break;
+    case 1:                     // line and triangle are in same plane
+    case 3:                     // unique intersection in segment
+        double t;
+        if (cmp::eq_zero(Q[0] - P[0]) == false) {
+            t = (tmp_intersect_pt[0] - P[0]) / (Q[0] - P[0]);
+        } else if (cmp::eq_zero(Q[1] - P[1]) == false) {
+            t = (tmp_intersect_pt[1] - P[1]) / (Q[1] - P[1]);
+        } else {
+            t = (tmp_intersect_pt[2] - P[2]) / (Q[2] - P[2]);
+        }
+        num_intersections++;
+        if (t < tmin) {
 #ifdef ENABLE_DEBUG
-                if (debugFlags_m & debug_intersectTinyLineSegmentBoundary) {
-                    *gmsg << "* " << __func__ << ": "
-                          << "  set triangle"
-                          << endl;
-                }
-#endif
-                tmin = t;
-                intersect_pt = tmp_intersect_pt;
-                triangle_id = (*it);
+            if (debugFlags_m & debug_intersectTinyLineSegmentBoundary) {
+                *gmsg << "* " << __func__ << ": "
+                      << "  set triangle"
+                      << endl;
             }
-            break;
-        case -1:                    // triangle is degenerated
-            PAssert (tmp_intersect_result != -1);
-            exit (42);              // terminate even if NDEBUG is set
+#endif
+            tmin = t;
+            intersect_pt = tmp_intersect_pt;
+            triangle_id = test_id;
         }
-    }                   // end for all triangles
-    return num_intersections;
+        break;
+    case -1:                    // triangle is degenerated
+        PAssert (tmp_intersect_result != -1);
+        exit (42);              // terminate even if NDEBUG is set
+    }
 }
 
 /*
@@ -2327,6 +2693,22 @@ BoundaryGeometry::intersectLineSegmentBoundary (
 #endif
     triangle_id = -1;
 
+    if (accelerator_m == GeometryAccelerator::BVH) {
+        // the BVH query doesn't depend on the length of the segment
+        const int intersect_result = intersectTinyLineSegmentBoundary (
+            P0, P1, intersect_pt, triangle_id);
+#ifdef ENABLE_DEBUG
+        if (debugFlags_m & debug_intersectLineSegmentBoundary) {
+            *gmsg << "* " << __func__ << ": "
+                  << "  result=" << intersect_result
+                  << "  intersection pt: " << intersect_pt
+                  << endl;
+            debugFlags_m = saved_flags;
+        }
+#endif
+        return intersect_result;
+    }
+
     const Vector_t v = P1 - P0;
     int intersect_result = 0;
     int n = 0;
@@ -2432,6 +2814,80 @@ BoundaryGeometry::partInside (
     return ret;
 }
 
+size_t
+BoundaryGeometry::partInside (
+    const size_t n,                     // [in] number of particles
+    const Vector_t* r,                  // [in] particle positions
+    const Vector_t* v,                  // [in] momenta
+    const double dt,                    // [in]
+    std::vector<size_t>& hit_indices,   // [out] particles hitting the boundary
+    std::vector<Vector_t>& intersect_pts, // [out] intersections with boundary
+    std::vector<int>& triangle_ids      // [out] intersected triangles
+    ) {
+    IpplTimings::startTimer (TPartInside_m);
+
+    hit_indices.clear ();
+    intersect_pts.clear ();
+    triangle_ids.clear ();
+
+    /*
+      First pass: compute the positions in the next time step and reject
+      the particles at rest and the segments which don't overlap the
+      bounding box of the geometry. The loop is kept free of branches such
+      that it can be vectorized.
+    */
+    const double cdt = Physics::c * dt;
+    std::vector<Vector_t> P1 (n);
+    std::vector<unsigned char> is_candidate (n);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (size_t i = 0; i < n; ++ i) {
+        const double v2 = v[i][0] * v[i][0] + v[i][1] * v[i][1] + v[i][2] * v[i][2];
+        const double scale = cdt / std::sqrt (1.0 + v2);
+        bool overlaps = (v2 > 0.0);
+        for (unsigned int d = 0; d < 3; ++ d) {
+            const double x0 = r[i][d];
+            const double x1 = x0 + scale * v[i][d];
+            P1[i][d] = x1;
+            overlaps &= (std::max (x0, x1) >= minExtent_m[d]) & (std::min (x0, x1) <= maxExtent_m[d]);
+        }
+        is_candidate[i] = overlaps;
+    }
+
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < n; ++ i) {
+        if (is_candidate[i]) candidates.push_back (i);
+    }
+
+    /*
+      Second pass: query the search structure for the remaining segments.
+      The queries only read the geometry. With the voxel mesh a warning is
+      written for segments outside of the voxel mesh, hence only the BVH
+      queries are run in parallel.
+    */
+    const size_t num_candidates = candidates.size ();
+    std::vector<Vector_t> candidate_pts (num_candidates);
+    std::vector<int> candidate_ids (num_candidates, -1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (accelerator_m == GeometryAccelerator::BVH)
+#endif
+    for (size_t k = 0; k < num_candidates; ++ k) {
+        const size_t i = candidates[k];
+        intersectTinyLineSegmentBoundary (r[i], P1[i], candidate_pts[k], candidate_ids[k]);
+    }
+
+    for (size_t k = 0; k < num_candidates; ++ k) {
+        if (candidate_ids[k] < 0) continue;
+        hit_indices.push_back (candidates[k]);
+        intersect_pts.push_back (candidate_pts[k]);
+        triangle_ids.push_back (candidate_ids[k]);
+    }
+
+    IpplTimings::stopTimer (TPartInside_m);
+    return hit_indices.size ();
+}
+
 void
 BoundaryGeometry::writeGeomToVtk (std::string fn) {
     std::ofstream of;
@@ -2493,9 +2949,16 @@ BoundaryGeometry::printInfo (Inform& os) const {
        << "* Geometry bounds(m) Max =  " << maxExtent_m << '\n'
        << "*                    Min =  " << minExtent_m << '\n'
        << "* Geometry length(m)        " << maxExtent_m - minExtent_m << '\n'
-       << "* Resolution of voxel mesh  " << voxelMesh_m.nr_m << '\n'
-       << "* Size of voxel             " << voxelMesh_m.sizeOfVoxel << '\n'
-       << "* Number of voxels in mesh  " << voxelMesh_m.ids.size () << endl;
+       << "* ACCELERATOR               " << Attributes::getString (itsAttr[ACCELERATOR]) << '\n';
+    if (accelerator_m == GeometryAccelerator::BVH) {
+        os << "* Number of BVH nodes       " << bvh_m.getNumNodes () << '\n'
+           << "* Number of BVH leaves      " << bvh_m.getNumLeaves () << '\n'
+           << "* Depth of BVH              " << bvh_m.getDepth () << endl;
+    } else {
+        os << "* Resolution of voxel mesh  " << voxelMesh_m.nr_m << '\n'
+           << "* Size of voxel             " << voxelMesh_m.sizeOfVoxel << '\n'
+           << "* Number of voxels in mesh  " << voxelMesh_m.voxelIds.size () << endl;
+    }
     os << "* ********************************************************************************** " << endl;
     return os;
 }
@@ -38,6 +38,7 @@ class ElementBase;
 
 #include "AbstractObjects/Definition.h"
 #include "Attributes/Attributes.h"
+#include "Structure/TriangleBVH.h"
 #include "Utilities/Util.h"
 #include "Utility/IpplTimings.h"
 #include "Utility/PAssert.h"
@@ -46,7 +47,7 @@ class ElementBase;
 
 #include <array>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 enum class Topology: unsigned short {
@@ -55,6 +56,11 @@ enum class Topology: unsigned short {
     ELLIPTIC
 };
 
+enum class GeometryAccelerator: unsigned short {
+    BVH,
+    VOXEL
+};
+
 class BoundaryGeometry : public Definition {
 
 public:
@@ -82,6 +88,15 @@ public:
 
     void initialize ();
 
+    /**
+       Initialize the geometry with the mesh given by points and triangles
+       instead of the mesh of the file FGEOM. The coordinates are in meters,
+       XSCALE, YSCALE, ZSCALE, XYZSCALE and ZSHIFT aren't applied.
+    */
+    void initialize (
+        const std::vector<Vector_t>& points,
+        const std::vector<std::array<unsigned int,4>>& triangles);
+
     int partInside (
         const Vector_t& r,
         const Vector_t& v,
@@ -89,6 +104,24 @@ public:
         Vector_t& intecoords,
         int& triId);
 
+    /**
+       Bulk collision test for the particles r[i], v[i], i < n, moving for
+       the time dt. The indices of the particles which hit the boundary in
+       the next time step are returned in hitIndices, the intersection
+       points and the IDs of the hit triangles at the same positions in
+       intecoords and triIds. Segments which don't overlap the bounding box
+       of the geometry are rejected before the search structure is queried.
+       Returns the number of particles which hit the boundary.
+    */
+    size_t partInside (
+        const size_t n,
+        const Vector_t* r,
+        const Vector_t* v,
+        const double dt,
+        std::vector<size_t>& hitIndices,
+        std::vector<Vector_t>& intecoords,
+        std::vector<int>& triIds);
+
     Inform& printInfo (
         Inform& os) const;
 
@@ -98,6 +131,14 @@ public:
         return Attributes::getString(itsAttr[FGEOM]);
     }
 
+    inline GeometryAccelerator getAccelerator() const {
+        static const std::unordered_map<std::string, GeometryAccelerator> stringAccelerator_s = {
+            {"BVH",   GeometryAccelerator::BVH},
+            {"VOXEL", GeometryAccelerator::VOXEL}
+        };
+        return stringAccelerator_s.at(Attributes::getString(itsAttr[ACCELERATOR]));
+    }
+
     inline Topology getTopology() const {
         static const std::unordered_map<std::string, Topology> stringTopology_s = {
             {"RECTANGULAR", Topology::RECTANGULAR},
@@ -224,6 +265,27 @@ private:
         int&
         );
 
+    // collect the triangles of the voxels intersecting the line segment
+    // from P to Q into triangle_ids, without duplicates
+    void collectVoxelTriangles (
+        const Vector_t& P,
+        const Vector_t& Q,
+        std::vector<int>& triangle_ids
+        );
+
+    // test the line through P and Q against the triangle; if the
+    // intersection is in the segment the counter is incremented and, if it
+    // is closer to P than tmin, tmin, intersect_pt and triangle_id are set
+    void testSegmentTriangle (
+        const Vector_t& P,
+        const Vector_t& Q,
+        const int test_id,
+        int& num_intersections,
+        double& tmin,
+        Vector_t& intersect_pt,
+        int& triangle_id
+        );
+
     int intersectLineSegmentBoundary (
         const Vector_t& P0,
         const Vector_t& P1,
@@ -231,6 +293,16 @@ private:
         int& triangle_id
         );
 
+    /*
+      Cache of the search structure, the oriented triangles and the point
+      inside the geometry, see option CACHEGEOMETRY. The key identifies the
+      content of the geometry file and all attributes the cached data
+      depend on.
+    */
+    std::string makeCacheKey ();
+    bool readCache (const std::string& key);
+    void writeCache (const std::string& key) const;
+
     std::string h5FileName_m;           // H5hut filename
 
     std::vector<Vector_t> Points_m;     // geometry point coordinates
@@ -248,11 +320,18 @@ private:
         Vector_t maxExtent;
         Vector_t sizeOfVoxel;
         Vektor<int, 3> nr_m;            // number of intervals of geometry in X,Y,Z direction
-        std::unordered_map<int,         // map voxel IDs ->
-            std::unordered_set<int>> ids; // intersecting triangles
 
+        // map voxel IDs -> intersecting triangles in compressed sparse row
+        // format: voxelIds is sorted, the triangles intersecting voxel
+        // voxelIds[n] are triangleIds[offsets[n]], ..., triangleIds[offsets[n+1] - 1]
+        std::vector<int> voxelIds;
+        std::vector<unsigned int> offsets;
+        std::vector<int> triangleIds;
     } voxelMesh_m;
 
+    GeometryAccelerator accelerator_m;
+    TriangleBVH bvh_m;                  // used if ACCELERATOR=BVH
+
     int debugFlags_m;
 
     bool haveInsidePoint_m;
@@ -295,6 +374,10 @@ private:
     inline Vector_t mapPoint2Voxel (const Vector_t&);
     inline void computeMeshVoxelization (void);
 
+    void readMesh ();                   // read the mesh of the file FGEOM
+    void initializeMesh ();             // search structure, normals and areas
+    inline std::pair<const int*, const int*> getVoxelTriangles (const int voxel_id) const;
+
     enum {
         FGEOM,    // file holding the geometry
         LENGTH,   // length of elliptic tube or boxcorner
@@ -311,6 +394,7 @@ private:
         YSCALE,   // Multiplicative scaling factor for y-coordinates
         ZSCALE,   // Multiplicative scaling factor for z-coordinates
         INSIDEPOINT,
+        ACCELERATOR, // BVH or VOXEL, the search structure of the intersection tests
         SIZE
     };
 };
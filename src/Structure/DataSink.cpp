@@ -35,6 +35,7 @@
 #include "Structure/BoundaryGeometry.h"
 #include "Structure/H5PartWrapper.h"
 #include "Structure/LBalWriter.h"
+#include "Structure/PerfWriter.h"
 #include "Utilities/Options.h"
 #include "Utilities/Timer.h"
 #include "Utilities/Util.h"
@@ -300,6 +301,12 @@ void DataSink::init(bool restart, H5PartWrapper* h5wrapper, short numBunch) {
 #endif
     }
 
+    if ( Options::perfDump ) {
+        sddsWriter_m.push_back(
+            sddsWriter_t(new PerfWriter(fn + std::string(".perf"), restart))
+        );
+    }
+
     if ( isMultiBunch_m ) {
         initMultiBunchDump(numBunch);
     }
@@ -78,6 +78,9 @@ namespace {
         BCFFTY,     // boundary condition in y [FFT + AMR_MG only]
         BCFFTZ,     // boundary condition in z [FFT + AMR_MG only]
         GREENSF,    // holds greensfunction to be used [FFT + P3M only]
+        FFTLIB,     // FFT backend [FFT only]
+        GREENSFTOL, // relative change of the mesh spacing up to which the Green's function is reused [FFT only]
+        PRUNEDFFT,  // skip the transforms of the zero padding [FFT only]
         BBOXINCR,   // how much the boundingbox is increased
         GEOMETRY,   // geometry of boundary [SAAMG only]
         ITSOLVER,   // iterative solver [SAAMG + AMR_MG]
@@ -173,6 +176,21 @@ FieldSolver::FieldSolver():
                                                          {"STANDARD", "INTEGRATED"},
                                                          "INTEGRATED");
 
+    itsAttr[FFTLIB] = Attributes::makePredefinedString("FFTLIB",
+                                                       "FFT backend of the open boundary FFT solver.",
+                                                       {"FFTPACK", "FFTW"},
+                                                       "FFTPACK");
+
+    itsAttr[GREENSFTOL] = Attributes::makeReal("GREENSFTOL",
+                                               "Relative change of the mesh spacing up to which "
+                                               "the transformed Green's function is reused.",
+                                               0.0);
+
+    itsAttr[PRUNEDFFT] = Attributes::makeBool("PRUNEDFFT",
+                                              "True, the FFTs skip the zero padded part of the "
+                                              "doubled grid (FFTPACK only).",
+                                              false);
+
     itsAttr[BBOXINCR] = Attributes::makeReal("BBOXINCR",
                                              "Increase of bounding box in % ",
                                              2.0);
@@ -540,7 +558,15 @@ void FieldSolver::initSolver(PartBunchBase<double, 3>* b) {
             fsName_m = "FFTBOX";
             fsType_m = FieldSolverType::FFTBOX;
         } else {
-            solver_m = new FFTPoissonSolver(mesh_m, FL_m, greens, bcz);
+            double greensTol = Attributes::getReal(itsAttr[GREENSFTOL]);
+            if (greensTol < 0.0) {
+                throw OpalException("FieldSolver::initSolver",
+                                    "The attribute \"GREENSFTOL\" must not be negative");
+            }
+            solver_m = new FFTPoissonSolver(mesh_m, FL_m, greens, bcz,
+                                            Attributes::getString(itsAttr[FFTLIB]),
+                                            greensTol,
+                                            Attributes::getBool(itsAttr[PRUNEDFFT]));
             itsBunch_m->set_meshEnlargement(Attributes::getReal(itsAttr[BBOXINCR]) / 100.0);
         }
     } else if (fsType_m == FieldSolverType::P3M) {
@@ -605,7 +631,10 @@ Inform& FieldSolver::printInfo(Inform& os) const {
            << "* ALPHA        " << Attributes::getReal(itsAttr[ALPHA]) << '\n'
            << "* GREENSF      " << Attributes::getString(itsAttr[GREENSF]) << endl;
     } else if (fsType_m == FieldSolverType::FFT) {
-        os << "* GREENSF      " << Attributes::getString(itsAttr[GREENSF]) << endl;
+        os << "* GREENSF      " << Attributes::getString(itsAttr[GREENSF]) << '\n'
+           << "* FFTLIB       " << Attributes::getString(itsAttr[FFTLIB]) << '\n'
+           << "* GREENSFTOL   " << Attributes::getReal(itsAttr[GREENSFTOL]) << '\n'
+           << "* PRUNEDFFT    " << Attributes::getBool(itsAttr[PRUNEDFFT]) << endl;
     } else if (fsType_m == FieldSolverType::SAAMG) {
         os << "* GEOMETRY     " << Attributes::getString(itsAttr[GEOMETRY]) << '\n'
            << "* ITSOLVER     " << Attributes::getString(itsAttr[ITSOLVER]) << '\n'
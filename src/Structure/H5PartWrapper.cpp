@@ -13,8 +13,10 @@
 
 #include "Message/Communicate.h"
 #include "Message/Message.h"
+#include "Utility/IpplInfo.h"
 #include "Utility/PAssert.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
@@ -27,13 +29,20 @@ namespace {
 }
 
 std::string H5PartWrapper::copyFilePrefix_m = ".copy";
+std::set<H5PartWrapper*> H5PartWrapper::asyncWrappers_m;
 
 H5PartWrapper::H5PartWrapper(const std::string &fileName, h5_int32_t flags):
     file_m(0),
     fileName_m(fileName),
     predecessorOPALFlavour_m("NOT SET"),
     numSteps_m(0),
-    startedFromExistingFile_m(false)
+    startedFromExistingFile_m(false),
+    singlePrecision_m(false),
+    subsampleFactor_m(1),
+    comm_m(Ippl::getComm()),
+    asyncPending_m(0),
+    maxAsyncPending_m(0),
+    stopAsync_m(false)
 {
     open(flags);
 }
@@ -43,7 +52,13 @@ H5PartWrapper::H5PartWrapper(const std::string &fileName, int restartStep, std::
     fileName_m(fileName),
     predecessorOPALFlavour_m("NOT SET"),
     numSteps_m(0),
-    startedFromExistingFile_m(true)
+    startedFromExistingFile_m(true),
+    singlePrecision_m(false),
+    subsampleFactor_m(1),
+    comm_m(Ippl::getComm()),
+    asyncPending_m(0),
+    maxAsyncPending_m(0),
+    stopAsync_m(false)
 {
     if (sourceFile.empty()) {
         sourceFile = fileName_m;
@@ -55,12 +70,13 @@ H5PartWrapper::H5PartWrapper(const std::string &fileName, int restartStep, std::
 }
 
 H5PartWrapper::~H5PartWrapper() {
+    stopAsyncWrites();
     close();
 }
 
 void H5PartWrapper::close() {
     if (file_m) {
-        Ippl::Comm->barrier();
+        MPI_Barrier(comm_m);
 
         REPORTONERROR(H5CloseFile(file_m));
 
@@ -72,7 +88,7 @@ void H5PartWrapper::open(h5_int32_t flags) {
     close();
 
     h5_prop_t props = H5CreateFileProp ();
-    MPI_Comm comm = Ippl::getComm();
+    MPI_Comm comm = comm_m;
     h5_err_t h5err = H5SetPropFileMPIOCollective (props, &comm);
 #if defined (NDEBUG)
     (void)h5err;
@@ -83,10 +99,168 @@ void H5PartWrapper::open(h5_int32_t flags) {
     H5CloseProp (props);
 }
 
+void H5PartWrapper::writeDumpReductionAttributes(bool singlePrecision, h5_int64_t subsample) {
+    h5_int64_t precision = (singlePrecision ? 32 : 64);
+    WRITESTEPATTRIB(Int64, file_m, "DumpPrecision", &precision, 1);
+    WRITESTEPATTRIB(Int64, file_m, "SubsampleFactor", &subsample, 1);
+}
+
+void H5PartWrapper::readDumpReductionAttributes() {
+    singlePrecision_m = false;
+    if (H5HasStepAttrib(file_m, "DumpPrecision") > 0) {
+        h5_int64_t precision;
+        READSTEPATTRIB(Int64, file_m, "DumpPrecision", &precision);
+        singlePrecision_m = (precision == 32);
+    }
+
+    subsampleFactor_m = 1;
+    if (H5HasStepAttrib(file_m, "SubsampleFactor") > 0) {
+        READSTEPATTRIB(Int64, file_m, "SubsampleFactor", &subsampleFactor_m);
+    }
+    if (subsampleFactor_m > 1) {
+        INFOMSG("H5PartWrapper: the step was written with PSDUMPSUBSAMPLE = " << subsampleFactor_m
+                << ", the macro charge and mass of the particles are scaled accordingly" << endl);
+    }
+}
+
+void H5PartWrapper::writeFloatData(const char* name, const h5_float64_t* data,
+                                   size_t numParticles, bool singlePrecision) {
+    if (!singlePrecision) {
+        WRITEDATA(Float64, file_m, name, data);
+        return;
+    }
+
+    f32Buffer_m.resize(numParticles);
+    std::copy(data, data + numParticles, f32Buffer_m.begin());
+    WRITEDATA(Float32, file_m, name, f32Buffer_m.data());
+}
+
+void H5PartWrapper::setChunkSize(size_t numLocalParticles, h5_int64_t chunkSize) {
+    if (chunkSize <= 0) return;
+
+    // HDF5 rejects chunks which are larger than the dataset
+    unsigned long long numParticles = numLocalParticles;
+    MPI_Allreduce(MPI_IN_PLACE, &numParticles, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm_m);
+    if (numParticles == 0) return;
+
+    const h5_size_t size = std::min<h5_size_t>(chunkSize, numParticles);
+    REPORTONERROR(H5PartSetChunkSize(file_m, size));
+}
+
+void H5PartWrapper::readFloatData(const char* name, h5_float64_t* data, size_t numParticles) {
+    if (!singlePrecision_m) {
+        READDATA(Float64, file_m, name, data);
+        return;
+    }
+
+    f32Buffer_m.resize(numParticles);
+    READDATA(Float32, file_m, name, f32Buffer_m.data());
+    std::copy(f32Buffer_m.begin(), f32Buffer_m.end(), data);
+}
+
+bool H5PartWrapper::startAsyncWrites(unsigned int maxQueued) {
+    int threadLevel;
+    MPI_Query_thread(&threadLevel);
+    if (threadLevel < MPI_THREAD_MULTIPLE) {
+        return false;
+    }
+
+    MPI_Comm_dup(Ippl::getComm(), &comm_m);
+    maxAsyncPending_m = std::max(maxQueued, 1u);
+    stopAsync_m = false;
+    asyncThread_m = std::thread(&H5PartWrapper::runAsyncWrites, this);
+    asyncWrappers_m.insert(this);
+
+    return true;
+}
+
+void H5PartWrapper::waitForAsyncSlot() {
+    std::unique_lock<std::mutex> lock(asyncMutex_m);
+    asyncCondition_m.wait(lock, [this]() { return asyncPending_m < maxAsyncPending_m; });
+}
+
+void H5PartWrapper::enqueueAsyncWrite(std::function<void()> write) {
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_m);
+        asyncQueue_m.push_back(std::move(write));
+        ++ asyncPending_m;
+    }
+    asyncCondition_m.notify_all();
+}
+
+void H5PartWrapper::runAsyncWrites() {
+    while (true) {
+        std::function<void()> write;
+        {
+            std::unique_lock<std::mutex> lock(asyncMutex_m);
+            asyncCondition_m.wait(lock, [this]() { return stopAsync_m || !asyncQueue_m.empty(); });
+            if (asyncQueue_m.empty()) return;
+
+            write = std::move(asyncQueue_m.front());
+            asyncQueue_m.pop_front();
+        }
+
+        try {
+            write();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(asyncMutex_m);
+            if (!asyncError_m) asyncError_m = std::current_exception();
+        }
+        // release the data of the step before the slot is freed
+        write = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex_m);
+            -- asyncPending_m;
+        }
+        asyncCondition_m.notify_all();
+    }
+}
+
+void H5PartWrapper::flush() {
+    if (!hasAsyncWrites()) return;
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(asyncMutex_m);
+        asyncCondition_m.wait(lock, [this]() { return asyncPending_m == 0; });
+        std::swap(error, asyncError_m);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void H5PartWrapper::flushAsyncWrites() {
+    for (H5PartWrapper* wrapper: asyncWrappers_m) {
+        wrapper->flush();
+    }
+}
+
+void H5PartWrapper::stopAsyncWrites() {
+    if (!hasAsyncWrites()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_m);
+        stopAsync_m = true;
+    }
+    asyncCondition_m.notify_all();
+    asyncThread_m.join();
+    asyncWrappers_m.erase(this);
+
+    if (asyncError_m) {
+        ERRORMSG("H5PartWrapper: writing the phase space to " << fileName_m << " failed" << endl);
+        asyncError_m = nullptr;
+    }
+
+    close();
+    MPI_Comm_free(&comm_m);
+    comm_m = Ippl::getComm();
+}
+
 void H5PartWrapper::storeCavityInformation() {
     /// Write number of Cavities with autophase information
     h5_int64_t nAutoPhaseCavities = OpalData::getInstance()->getNumberOfMaxPhases();
     h5_int64_t nFormerlySavedAutoPhaseCavities = 0;
+    flush();
     bool fileWasClosed = (file_m == 0);
 
     if (nAutoPhaseCavities == 0) return;
@@ -12,12 +12,23 @@
 template <class T, unsigned Dim>
 class PartBunchBase;
 
+#include "Utilities/Options.h"
 #include "Utility/IpplInfo.h"
 
 #include "H5hut.h"
 
+#include <mpi.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define REPORTONERROR(rc) H5PartWrapper::reportOnError(rc, __FILE__, __LINE__)
 #define READFILEATTRIB(type, file, name, value) REPORTONERROR(H5ReadFileAttrib##type(file, name, value));
@@ -49,6 +60,13 @@ public:
     void storeCavityInformation();
 
     size_t getNumParticles() const;
+
+    /// Wait until all steps queued for the background thread are written
+    void flush();
+
+    /// Flush all wrappers which write asynchronously; has to be called
+    /// before other H5 files are accessed, HDF5 isn't thread safe
+    static void flushAsyncWrites();
 protected:
     H5PartWrapper(const std::string &fileName, h5_int32_t flags = H5_O_WRONLY);
     H5PartWrapper(const std::string &fileName, int restartStep, std::string sourceFile, h5_int32_t flags = H5_O_RDWR);
@@ -70,15 +88,87 @@ protected:
 
     static void reportOnError(h5_int64_t rc, const char* file, int line);
 
+    // true if the particle with the given ID is written to the phase space
+    // dump, see PSDUMPSUBSAMPLE
+    static bool isSelectedForDump(h5_int64_t id);
+
+    // write the step attributes which describe how the particle data of
+    // the step are reduced, see PSDUMPPRECISION and PSDUMPSUBSAMPLE
+    void writeDumpReductionAttributes(bool singlePrecision, h5_int64_t subsample);
+
+    // read the attributes written by writeDumpReductionAttributes for
+    // the current step into singlePrecision_m and subsampleFactor_m; steps
+    // without them are full dumps in double precision
+    void readDumpReductionAttributes();
+
+    // write a column of the particle data, converted to single precision
+    // if requested
+    void writeFloatData(const char* name, const h5_float64_t* data,
+                        size_t numParticles, bool singlePrecision);
+
+    // store the datasets of the current step in chunks of chunkSize
+    // particles, at most the number of particles of the step; nothing
+    // is changed if chunkSize isn't positive, see PSDUMPCHUNKSIZE
+    void setChunkSize(size_t numLocalParticles, h5_int64_t chunkSize);
+
+    // read a column of the particle data of the current view, converted
+    // to double precision if the step was written in single precision
+    void readFloatData(const char* name, h5_float64_t* data, size_t numParticles);
+
+    // Start the background thread which writes the queued steps. At most
+    // maxQueued steps are queued or being written at any time. The thread
+    // uses its own communicator; returns false if MPI wasn't initialized
+    // with MPI_THREAD_MULTIPLE.
+    bool startAsyncWrites(unsigned int maxQueued);
+    bool hasAsyncWrites() const;
+    // block until less than maxQueued steps are pending
+    void waitForAsyncSlot();
+    void enqueueAsyncWrite(std::function<void()> write);
+    // write the queued steps and stop the background thread; has to be
+    // called in the destructors of derived classes
+    void stopAsyncWrites();
+
     h5_file_t file_m;
     std::string fileName_m;
     std::string predecessorOPALFlavour_m;
     h5_int64_t numSteps_m;
     bool startedFromExistingFile_m;
+    bool singlePrecision_m;
+    h5_int64_t subsampleFactor_m;
 
     static std::string copyFilePrefix_m;
+
+private:
+    void runAsyncWrites();
+
+    // communicator of the file, a duplicate of the one of IPPL if the
+    // steps are written by the background thread
+    MPI_Comm comm_m;
+
+    std::thread asyncThread_m;
+    std::mutex asyncMutex_m;
+    std::condition_variable asyncCondition_m;
+    std::deque<std::function<void()> > asyncQueue_m;
+    unsigned int asyncPending_m;
+    unsigned int maxAsyncPending_m;
+    bool stopAsync_m;
+    std::exception_ptr asyncError_m;
+
+    std::vector<h5_float32_t> f32Buffer_m;
+
+    static std::set<H5PartWrapper*> asyncWrappers_m;
 };
 
+inline
+bool H5PartWrapper::isSelectedForDump(h5_int64_t id) {
+    return id % Options::psDumpSubsample == 0;
+}
+
+inline
+bool H5PartWrapper::hasAsyncWrites() const {
+    return asyncThread_m.joinable();
+}
+
 inline
 void H5PartWrapper::reportOnError(h5_int64_t rc, const char* file, int line) {
     if (rc != H5_SUCCESS)
@@ -87,6 +177,7 @@ void H5PartWrapper::reportOnError(h5_int64_t rc, const char* file, int line) {
 
 inline
 double H5PartWrapper::getLastPosition() {
+    flush();
     if (!file_m) open(H5_O_RDONLY);
 
     h5_ssize_t numStepsInSource = H5GetNumSteps(file_m);
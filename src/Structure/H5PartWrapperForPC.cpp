@@ -77,6 +77,7 @@ void H5PartWrapperForPC::readStep(PartBunchBase<double, 3>* bunch,
     h5_ssize_t numStepsInSource = H5GetNumSteps(file_m);
     h5_ssize_t readStep = numStepsInSource - 1;
     REPORTONERROR(H5SetStep(file_m, readStep));
+    readDumpReductionAttributes();
 
     readStepHeader(bunch);
     readStepData(bunch, firstParticle, lastParticle);
@@ -166,45 +167,48 @@ void H5PartWrapperForPC::readStepData(PartBunchBase<double, 3>* bunch,
     h5_float64_t *f64buffer = reinterpret_cast<h5_float64_t*>(buffer_ptr);
     h5_int64_t *i64buffer = reinterpret_cast<h5_int64_t*>(buffer_ptr);
 
-    READDATA(Float64, file_m, "x", f64buffer);
+    readFloatData("x", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](0) = f64buffer[n];
         bunch->Bin[n] = 0;
     }
 
-    READDATA(Float64, file_m, "y", f64buffer);
+    readFloatData("y", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](yIndex) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "z", f64buffer);
+    readFloatData("z", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](zIndex) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "px", f64buffer);
+    readFloatData("px", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](0) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "py", f64buffer);
+    readFloatData("py", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](yIndex) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "pz", f64buffer);
+    readFloatData("pz", f64buffer, numParticles);
     for(long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](zIndex) = f64buffer[n];
     }
 
+    // each particle of a subsampled dump represents subsampleFactor_m
+    // particles of the original bunch; charge and mass are both scaled
+    // to keep the charge-to-mass ratio used by the integrators
     READDATA(Float64, file_m, "q", f64buffer);
     for(long int n = 0; n < numParticles; ++ n) {
-        bunch->Q[n] = f64buffer[n];
+        bunch->Q[n] = subsampleFactor_m * f64buffer[n];
     }
 
     READDATA(Float64, file_m, "mass", f64buffer);
     for(long int n = 0; n < numParticles; ++ n) {
-        bunch->M[n] = f64buffer[n];
+        bunch->M[n] = subsampleFactor_m * f64buffer[n];
     }
 
     if ( bunch->getNumBunch() > 1 ) {
@@ -453,6 +457,9 @@ void H5PartWrapperForPC::writeStepHeader(PartBunchBase<double, 3>* bunch,
         WRITESTEPATTRIB(Float64, file_m, "E-head", (h5_float64_t *)&headE, 3);
         WRITESTEPATTRIB(Float64, file_m, "B-tail", (h5_float64_t *)&tailB, 3);
         WRITESTEPATTRIB(Float64, file_m, "E-tail", (h5_float64_t *)&tailE, 3);
+
+        writeDumpReductionAttributes(Options::psDumpPrecision == DumpPrecision::SINGLE,
+                                     Options::psDumpSubsample);
     } catch (std::out_of_range & m) {
         ERRORMSG(m.what() << endl);
 
@@ -463,26 +470,25 @@ void H5PartWrapperForPC::writeStepHeader(PartBunchBase<double, 3>* bunch,
 
 void H5PartWrapperForPC::writeStepData(PartBunchBase<double, 3>* bunch) {
     /*
-      find particle with ID==0
-      and save index in zID
+      skip the particle with ID==0 and, if PSDUMPSUBSAMPLE is set,
+      the particles which aren't selected for the dump
 
-      FIXME After issue 287 is resolved this shouldn't be
-            necessary anymore!
+      FIXME After issue 287 is resolved the particle with ID==0
+            shouldn't be necessary anymore!
      */
-
-    size_t IDZero = bunch->getLocalNum();
-    bool found = false;
+    const bool singlePrecision = (Options::psDumpPrecision == DumpPrecision::SINGLE);
+    const size_t numParticles = bunch->getLocalNum();
+    std::vector<size_t> selected;
+    selected.reserve(numParticles);
+    for (size_t k = 0; k < numParticles; ++ k) {
 #ifndef ENABLE_AMR
-    for(size_t k = 0; k < IDZero; ++ k) {
-        if (bunch->ID[k] == 0) {
-            found = true;
-            IDZero = k;
-        }
-    }
+        if (bunch->ID[k] == 0) continue;
 #endif
+        if (!isSelectedForDump(bunch->ID[k])) continue;
+        selected.push_back(k);
+    }
 
-    const size_t numLocalParticles = (found? bunch->getLocalNum() - 1: bunch->getLocalNum());
-    const size_t skipID = IDZero;
+    const size_t numLocalParticles = selected.size();
 
     std::vector<char> buffer(numLocalParticles * sizeof(h5_float64_t));
     char* buffer_ptr = Util::c_data(buffer);
@@ -491,128 +497,67 @@ void H5PartWrapperForPC::writeStepData(PartBunchBase<double, 3>* bunch) {
 
 
     REPORTONERROR(H5PartSetNumParticles(file_m, numLocalParticles));
+    setChunkSize(numLocalParticles, Options::psDumpChunkSize);
 
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->R[i](0);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->R[i + 1](0);
-
-    WRITEDATA(Float64, file_m, "x", f64buffer);
-
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->R[i](1);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->R[i + 1](1);
-
-    WRITEDATA(Float64, file_m, "y", f64buffer);
-
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->R[i](2);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->R[i + 1](2);
-
-    WRITEDATA(Float64, file_m, "z", f64buffer);
-
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->P[i](0);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->P[i + 1](0);
-
-    WRITEDATA(Float64, file_m, "px", f64buffer);
-
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->P[i](1);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->P[i + 1](1);
+    const char* rNames[] = {"x", "y", "z"};
+    for (unsigned int d = 0; d < 3; ++ d) {
+        for (size_t i = 0; i < numLocalParticles; ++ i)
+            f64buffer[i] = bunch->R[selected[i]](d);
 
-    WRITEDATA(Float64, file_m, "py", f64buffer);
+        writeFloatData(rNames[d], f64buffer, numLocalParticles, singlePrecision);
+    }
 
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->P[i](2);
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->P[i + 1](2);
+    const char* pNames[] = {"px", "py", "pz"};
+    for (unsigned int d = 0; d < 3; ++ d) {
+        for (size_t i = 0; i < numLocalParticles; ++ i)
+            f64buffer[i] = bunch->P[selected[i]](d);
 
-    WRITEDATA(Float64, file_m, "pz", f64buffer);
+        writeFloatData(pNames[d], f64buffer, numLocalParticles, singlePrecision);
+    }
 
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->Q[i];
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->Q[i + 1];
+    // charge and mass are always written in double precision
+    for (size_t i = 0; i < numLocalParticles; ++ i)
+        f64buffer[i] = bunch->Q[selected[i]];
 
     WRITEDATA(Float64, file_m, "q", f64buffer);
 
-    for(size_t i = 0; i < skipID; ++ i)
-        f64buffer[i] =  bunch->M[i];
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        f64buffer[i] = bunch->M[i + 1];
+    for (size_t i = 0; i < numLocalParticles; ++ i)
+        f64buffer[i] = bunch->M[selected[i]];
 
     WRITEDATA(Float64, file_m, "mass", f64buffer);
 
-    for(size_t i = 0; i < skipID; ++ i)
-        i64buffer[i] =  bunch->ID[i];
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-        i64buffer[i] = bunch->ID[i + 1];
+    for (size_t i = 0; i < numLocalParticles; ++ i)
+        i64buffer[i] = bunch->ID[selected[i]];
 
     WRITEDATA(Int64, file_m, "id", i64buffer);
 
     if ( bunch->hasBinning() ) {
-        for(size_t i = 0; i < skipID; ++ i)
-            i64buffer[i] =  bunch->Bin[i];
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            i64buffer[i] = bunch->Bin[i + 1];
+        for (size_t i = 0; i < numLocalParticles; ++ i)
+            i64buffer[i] = bunch->Bin[selected[i]];
 
         WRITEDATA(Int64, file_m, "bin", i64buffer);
     }
 
-    for  (size_t i = 0; i < skipID; ++ i)
-        i64buffer[i] = bunch->bunchNum[i];
-    for (size_t i = skipID; i < numLocalParticles; ++ i)
-            i64buffer[i] = bunch->bunchNum[i + 1];
+    for (size_t i = 0; i < numLocalParticles; ++ i)
+        i64buffer[i] = bunch->bunchNum[selected[i]];
     WRITEDATA(Int64, file_m, "bunchNumber", i64buffer);
 
     if (Options::ebDump) {
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Ef[i](0);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Ef[i + 1](0);
-
-        WRITEDATA(Float64, file_m, "Ex", f64buffer);
-
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Ef[i](1);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Ef[i + 1](1);
-
-        WRITEDATA(Float64, file_m, "Ey", f64buffer);
-
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Ef[i](2);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Ef[i + 1](2);
-
-        WRITEDATA(Float64, file_m, "Ez", f64buffer);
+        const char* eNames[] = {"Ex", "Ey", "Ez"};
+        for (unsigned int d = 0; d < 3; ++ d) {
+            for (size_t i = 0; i < numLocalParticles; ++ i)
+                f64buffer[i] = bunch->Ef[selected[i]](d);
 
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Bf[i](0);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Bf[i + 1](0);
-
-        WRITEDATA(Float64, file_m, "Bx", f64buffer);
-
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Bf[i](1);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Bf[i + 1](1);
-
-        WRITEDATA(Float64, file_m, "By", f64buffer);
-
-        for(size_t i = 0; i < skipID; ++ i)
-            f64buffer[i] =  bunch->Bf[i](2);
-        for (size_t i = skipID; i < numLocalParticles; ++ i)
-            f64buffer[i] = bunch->Bf[i + 1](2);
+            writeFloatData(eNames[d], f64buffer, numLocalParticles, singlePrecision);
+        }
 
-        WRITEDATA(Float64, file_m, "Bz", f64buffer);
+        const char* bNames[] = {"Bx", "By", "Bz"};
+        for (unsigned int d = 0; d < 3; ++ d) {
+            for (size_t i = 0; i < numLocalParticles; ++ i)
+                f64buffer[i] = bunch->Bf[selected[i]](d);
 
+            writeFloatData(bNames[d], f64buffer, numLocalParticles, singlePrecision);
+        }
     }
 
     /// Write space charge field map if asked for.
@@ -34,7 +34,9 @@
 
 H5PartWrapperForPT::H5PartWrapperForPT(const std::string& fileName, h5_int32_t flags):
     H5PartWrapper(fileName, flags)
-{ }
+{
+    setupStepData();
+}
 
 H5PartWrapperForPT::H5PartWrapperForPT(const std::string& fileName, int restartStep, std::string sourceFile, h5_int32_t flags):
     H5PartWrapper(fileName, restartStep, sourceFile, flags)
@@ -43,10 +45,26 @@ H5PartWrapperForPT::H5PartWrapperForPT(const std::string& fileName, int restartS
         restartStep = H5GetNumSteps(file_m) - 1 ;
         OpalData::getInstance()->setRestartStep(restartStep);
     }
+    setupStepData();
+}
+
+H5PartWrapperForPT::~H5PartWrapperForPT() {
+    // the queued steps refer to the buffers of this object
+    stopAsyncWrites();
 }
 
-H5PartWrapperForPT::~H5PartWrapperForPT()
-{ }
+void H5PartWrapperForPT::setupStepData() {
+    numQueuedSteps_m = 0;
+    if (Options::asyncPsDump) {
+        if (startAsyncWrites(maxQueuedSteps_m)) {
+            stepData_m.resize(maxQueuedSteps_m);
+            return;
+        }
+        WARNMSG("H5PartWrapperForPT: ASYNCPSDUMP needs MPI_THREAD_MULTIPLE, start OPAL with "
+                "--mpithreadmultiple; writing the phase space synchronously" << endl);
+    }
+    stepData_m.resize(1);
+}
 
 void H5PartWrapperForPT::readHeader() {
     h5_int64_t numFileAttributes = H5GetNumFileAttribs(file_m);
@@ -106,6 +124,7 @@ void H5PartWrapperForPT::readStep(PartBunchBase<double, 3>* bunch, h5_ssize_t fi
     h5_ssize_t numStepsInSource = H5GetNumSteps(file_m);
     h5_ssize_t readStep = numStepsInSource - 1;
     REPORTONERROR(H5SetStep(file_m, readStep));
+    readDumpReductionAttributes();
 
     readStepHeader(bunch);
     readStepData(bunch, firstParticle, lastParticle);
@@ -161,40 +180,42 @@ void H5PartWrapperForPT::readStepData(PartBunchBase<double, 3>* bunch, h5_ssize_
     h5_float64_t* f64buffer = reinterpret_cast<h5_float64_t*>(buffer_ptr);
     h5_int32_t* i32buffer = reinterpret_cast<h5_int32_t*>(buffer_ptr);
 
-    READDATA(Float64, file_m, "x", f64buffer);
+    readFloatData("x", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](0) = f64buffer[n];
         bunch->Bin[n] = 0;
     }
 
-    READDATA(Float64, file_m, "y", f64buffer);
+    readFloatData("y", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](1) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "z", f64buffer);
+    readFloatData("z", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->R[n](2) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "px", f64buffer);
+    readFloatData("px", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](0) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "py", f64buffer);
+    readFloatData("py", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](1) = f64buffer[n];
     }
 
-    READDATA(Float64, file_m, "pz", f64buffer);
+    readFloatData("pz", f64buffer, numParticles);
     for (long int n = 0; n < numParticles; ++ n) {
         bunch->P[n](2) = f64buffer[n];
     }
 
+    // each particle of a subsampled dump represents subsampleFactor_m
+    // particles of the original bunch
     READDATA(Float64, file_m, "q", f64buffer);
     for (long int n = 0; n < numParticles; ++ n) {
-        bunch->Q[n] = f64buffer[n];
+        bunch->Q[n] = subsampleFactor_m * f64buffer[n];
     }
 
     READDATA(Int32, file_m, "id", i32buffer);
@@ -291,196 +312,263 @@ void H5PartWrapperForPT::writeHeader() {
 void H5PartWrapperForPT::writeStep(PartBunchBase<double, 3>* bunch, const std::map<std::string, double>& additionalStepAttributes) {
     if (bunch->getTotalNum() == 0) return;
 
-    open(H5_O_APPENDONLY);
     bunch->calcBeamParameters();
-    writeStepHeader(bunch, additionalStepAttributes);
-    writeStepData(bunch);
-    close();
+
+    if (!hasAsyncWrites()) {
+        StepData& step = stepData_m.front();
+        packStepHeader(bunch, additionalStepAttributes, step);
+        packStepData(bunch, step);
+        writeStepData(step);
+        return;
+    }
+
+    // the step which used this buffer before is written once a slot is free
+    waitForAsyncSlot();
+    StepData& step = stepData_m[numQueuedSteps_m % stepData_m.size()];
+    ++ numQueuedSteps_m;
+
+    packStepHeader(bunch, additionalStepAttributes, step);
+    packStepData(bunch, step);
+    enqueueAsyncWrite([this, &step]() { writeStepData(step); });
 }
 
-void H5PartWrapperForPT::writeStepHeader(PartBunchBase<double, 3>* bunch, const std::map<std::string, double>& additionalStepAttributes) {
-    double   actPos   = bunch->get_sPos();
-    double   t        = bunch->getT();
-    Vector_t rmin     = bunch->get_origin();
-    Vector_t rmax     = bunch->get_maxExtent();
-    Vector_t centroid = bunch->get_centroid();
-
-    Vector_t maxP(0.0);
-    Vector_t minP(0.0);
-
-    Vector_t xsigma = bunch->get_rrms();
-    Vector_t psigma = bunch->get_prms();
-    Vector_t vareps = bunch->get_norm_emit();
-    Vector_t geomvareps = bunch->get_emit();
-    Vector_t RefPartR = bunch->RefPartR_m;
-    Vector_t RefPartP = bunch->RefPartP_m;
-    Vector_t TaitBryant = Util::getTaitBryantAngles(bunch->toLabTrafo_m.getRotation());
-    Vector_t pmean = bunch->get_pmean();
-
-    double meanEnergy = bunch->get_meanKineticEnergy();
-    double energySpread = bunch->getdE();
+void H5PartWrapperForPT::packStepHeader(PartBunchBase<double, 3>* bunch, const std::map<std::string, double>& additionalStepAttributes, StepData& step) {
+    step.actPos   = bunch->get_sPos();
+    step.t        = bunch->getT();
+    step.rmin     = bunch->get_origin();
+    step.rmax     = bunch->get_maxExtent();
+    step.centroid = bunch->get_centroid();
+
+    step.maxP = Vector_t(0.0);
+    step.minP = Vector_t(0.0);
+
+    step.xsigma = bunch->get_rrms();
+    step.psigma = bunch->get_prms();
+    step.vareps = bunch->get_norm_emit();
+    step.geomvareps = bunch->get_emit();
+    step.RefPartR = bunch->RefPartR_m;
+    step.RefPartP = bunch->RefPartP_m;
+    step.TaitBryant = Util::getTaitBryantAngles(bunch->toLabTrafo_m.getRotation());
+    step.pmean = bunch->get_pmean();
+
+    step.meanEnergy = bunch->get_meanKineticEnergy();
+    step.energySpread = bunch->getdE();
     double I_0 = 4.0 * Physics::pi * Physics::epsilon_0 * Physics::c * bunch->getM() / bunch->getQ();
-    double sigma = ((xsigma[0] * xsigma[0]) + (xsigma[1] * xsigma[1])) /
+    const Vector_t& xsigma = step.xsigma;
+    const Vector_t& geomvareps = step.geomvareps;
+    step.sigma = ((xsigma[0] * xsigma[0]) + (xsigma[1] * xsigma[1])) /
         (2.0 * bunch->get_gamma() * I_0 * (geomvareps[0] * geomvareps[0] + geomvareps[1] * geomvareps[1]));
 
-    h5_int64_t localTrackStep = (h5_int64_t)bunch->getLocalTrackStep();
-    h5_int64_t globalTrackStep = (h5_int64_t)bunch->getGlobalTrackStep();
+    step.localTrackStep = (h5_int64_t)bunch->getLocalTrackStep();
+    step.globalTrackStep = (h5_int64_t)bunch->getGlobalTrackStep();
 
-    double mass = Units::eV2GeV * bunch->getM();
-    double charge = bunch->getCharge();
+    step.mass = Units::eV2GeV * bunch->getM();
+    step.charge = bunch->getCharge();
 
-    h5_int64_t numBunch = 1;
-    h5_int64_t SteptoLastInj = 0;
+    bunch->get_PBounds(step.minP, step.maxP);
+
+    try {
+        step.referenceB = Vector_t({additionalStepAttributes.at("B-ref_x"),
+                                    additionalStepAttributes.at("B-ref_z"),
+                                    additionalStepAttributes.at("B-ref_y")});
+        step.referenceE = Vector_t({additionalStepAttributes.at("E-ref_x"),
+                                    additionalStepAttributes.at("E-ref_z"),
+                                    additionalStepAttributes.at("E-ref_y")});
+    } catch (std::out_of_range & m) {
+        ERRORMSG(m.what() << endl);
+
+        throw OpalException("H5PartWrapperForPC::writeStepHeader",
+                            "some additional step attribute not found");
+    }
+}
 
-    bunch->get_PBounds(minP, maxP);
+void H5PartWrapperForPT::packStepData(PartBunchBase<double, 3>* bunch, StepData& step) {
+    step.ebDump = Options::ebDump;
+    step.rhoDump = Options::rhoDump;
+    step.singlePrecision = (Options::psDumpPrecision == DumpPrecision::SINGLE);
+    step.subsample = Options::psDumpSubsample;
+    step.chunkSize = Options::psDumpChunkSize;
+
+    const size_t numParticles = bunch->getLocalNum();
+    size_t numLocalParticles = numParticles;
+    if (step.subsample > 1) {
+        numLocalParticles = 0;
+        for (size_t i = 0; i < numParticles; ++ i) {
+            if (isSelectedForDump(bunch->ID[i])) ++ numLocalParticles;
+        }
+    }
+    step.numLocalParticles = numLocalParticles;
+
+    // the buffers keep their capacity, hence they are only reallocated if
+    // the number of particles grows
+    const size_t numColumns = (step.ebDump ? 13 : 7);
+    step.f64Data.resize(numColumns * numLocalParticles);
+    step.id.resize(numLocalParticles);
+    step.ptype.resize(numLocalParticles);
+    step.porigin.resize(numLocalParticles);
+
+    h5_float64_t* x  = step.f64Data.data();
+    h5_float64_t* y  = x + numLocalParticles;
+    h5_float64_t* z  = y + numLocalParticles;
+    h5_float64_t* px = z + numLocalParticles;
+    h5_float64_t* py = px + numLocalParticles;
+    h5_float64_t* pz = py + numLocalParticles;
+    h5_float64_t* q  = pz + numLocalParticles;
+    for (size_t i = 0, j = 0; i < numParticles; ++ i) {
+        if (step.subsample > 1 && !isSelectedForDump(bunch->ID[i])) continue;
+
+        const Vector_t& R = bunch->R[i];
+        const Vector_t& P = bunch->P[i];
+        x[j]  = R(0);
+        y[j]  = R(1);
+        z[j]  = R(2);
+        px[j] = P(0);
+        py[j] = P(1);
+        pz[j] = P(2);
+        q[j]  = bunch->Q[i];
+        step.id[j] = bunch->ID[i];
+        step.ptype[j] = (h5_int32_t) bunch->PType[i];
+        step.porigin[j] = (h5_int32_t) bunch->POrigin[i];
+        ++ j;
+    }
+
+    if (step.ebDump) {
+        h5_float64_t* Ex = q + numLocalParticles;
+        h5_float64_t* Ey = Ex + numLocalParticles;
+        h5_float64_t* Ez = Ey + numLocalParticles;
+        h5_float64_t* Bx = Ez + numLocalParticles;
+        h5_float64_t* By = Bx + numLocalParticles;
+        h5_float64_t* Bz = By + numLocalParticles;
+        for (size_t i = 0, j = 0; i < numParticles; ++ i) {
+            if (step.subsample > 1 && !isSelectedForDump(bunch->ID[i])) continue;
+
+            const Vector_t& E = bunch->Ef[i];
+            const Vector_t& B = bunch->Bf[i];
+            Ex[j] = E(0);
+            Ey[j] = E(1);
+            Ez[j] = E(2);
+            Bx[j] = B(0);
+            By[j] = B(1);
+            Bz[j] = B(2);
+            ++ j;
+        }
+    }
+
+    if (step.rhoDump) {
+        NDIndex<3> idx = bunch->getFieldLayout().getLocalNDIndex();
+        step.rhoDomain = idx;
+        step.rhoOrigin = bunch->get_origin();
+        step.rhoSpacing = bunch->get_hr();
+        step.rho.resize(idx[0].length() * idx[1].length() * idx[2].length());
+
+        size_t ii = 0;
+        // h5block uses the fortran convention of storing data:
+        // INTEGER, DIMENSION(2,3) :: a
+        // => {a(1,1), a(2,1), a(1,2), a(2,2), a(1,3), a(2,3)}
+        for (int i = idx[2].min(); i <= idx[2].max(); ++ i) {
+            for (int j = idx[1].min(); j <= idx[1].max(); ++ j) {
+                for (int k = idx[0].min(); k <= idx[0].max(); ++ k) {
+                    step.rho[ii] = bunch->getRho(k, j, i);
+                    ++ ii;
+                }
+            }
+        }
+    }
+}
 
-    /* ------------------------------------------------------------------------ */
+void H5PartWrapperForPT::writeStepData(const StepData& step) {
+    open(H5_O_APPENDONLY);
+    writeStepHeader(step);
+    writeStepParticles(step);
+    close();
+}
+
+void H5PartWrapperForPT::writeStepHeader(const StepData& step) {
+    h5_int64_t numBunch = 1;
+    h5_int64_t SteptoLastInj = 0;
 
     REPORTONERROR(H5SetStep(file_m, numSteps_m));
 
     char const* OPALFlavour = "opal-t";
     WRITESTRINGSTEPATTRIB(file_m, "OPAL_flavour", OPALFlavour);
-    WRITESTEPATTRIB(Float64, file_m, "SPOS", &actPos, 1);
-    WRITESTEPATTRIB(Float64, file_m, "RefPartR", (h5_float64_t*)&RefPartR, 3);
-    WRITESTEPATTRIB(Float64, file_m, "centroid", (h5_float64_t*)&centroid, 3);
-    WRITESTEPATTRIB(Float64, file_m, "RMSX", (h5_float64_t*)&xsigma, 3);
+    WRITESTEPATTRIB(Float64, file_m, "SPOS", &step.actPos, 1);
+    WRITESTEPATTRIB(Float64, file_m, "RefPartR", (h5_float64_t*)&step.RefPartR, 3);
+    WRITESTEPATTRIB(Float64, file_m, "centroid", (h5_float64_t*)&step.centroid, 3);
+    WRITESTEPATTRIB(Float64, file_m, "RMSX", (h5_float64_t*)&step.xsigma, 3);
 
-    WRITESTEPATTRIB(Float64, file_m, "RefPartP", (h5_float64_t*)&RefPartP, 3);
-    WRITESTEPATTRIB(Float64, file_m, "MEANP", (h5_float64_t*)&pmean, 3);
-    WRITESTEPATTRIB(Float64, file_m, "RMSP", (h5_float64_t*)&psigma, 3);
-    WRITESTEPATTRIB(Float64, file_m, "TaitBryantAngles", (h5_float64_t*)&TaitBryant, 3);
+    WRITESTEPATTRIB(Float64, file_m, "RefPartP", (h5_float64_t*)&step.RefPartP, 3);
+    WRITESTEPATTRIB(Float64, file_m, "MEANP", (h5_float64_t*)&step.pmean, 3);
+    WRITESTEPATTRIB(Float64, file_m, "RMSP", (h5_float64_t*)&step.psigma, 3);
+    WRITESTEPATTRIB(Float64, file_m, "TaitBryantAngles", (h5_float64_t*)&step.TaitBryant, 3);
 
-    WRITESTEPATTRIB(Float64, file_m, "#varepsilon", (h5_float64_t*)&vareps, 3);
-    WRITESTEPATTRIB(Float64, file_m, "#varepsilon-geom", (h5_float64_t*)&geomvareps, 3);
+    WRITESTEPATTRIB(Float64, file_m, "#varepsilon", (h5_float64_t*)&step.vareps, 3);
+    WRITESTEPATTRIB(Float64, file_m, "#varepsilon-geom", (h5_float64_t*)&step.geomvareps, 3);
 
-    WRITESTEPATTRIB(Float64, file_m, "minX", (h5_float64_t*)&rmin, 3);
-    WRITESTEPATTRIB(Float64, file_m, "maxX", (h5_float64_t*)&rmax, 3);
+    WRITESTEPATTRIB(Float64, file_m, "minX", (h5_float64_t*)&step.rmin, 3);
+    WRITESTEPATTRIB(Float64, file_m, "maxX", (h5_float64_t*)&step.rmax, 3);
 
-    WRITESTEPATTRIB(Float64, file_m, "minP", (h5_float64_t*)&minP, 3);
-    WRITESTEPATTRIB(Float64, file_m, "maxP", (h5_float64_t*)&maxP, 3);
+    WRITESTEPATTRIB(Float64, file_m, "minP", (h5_float64_t*)&step.minP, 3);
+    WRITESTEPATTRIB(Float64, file_m, "maxP", (h5_float64_t*)&step.maxP, 3);
 
     WRITESTEPATTRIB(Int64, file_m, "Step", &numSteps_m, 1);
-    WRITESTEPATTRIB(Int64, file_m, "LocalTrackStep", &localTrackStep, 1);
-    WRITESTEPATTRIB(Int64, file_m, "GlobalTrackStep", &globalTrackStep, 1);
+    WRITESTEPATTRIB(Int64, file_m, "LocalTrackStep", &step.localTrackStep, 1);
+    WRITESTEPATTRIB(Int64, file_m, "GlobalTrackStep", &step.globalTrackStep, 1);
 
-    WRITESTEPATTRIB(Float64, file_m, "#sigma", &sigma, 1);
+    WRITESTEPATTRIB(Float64, file_m, "#sigma", &step.sigma, 1);
 
-    WRITESTEPATTRIB(Float64, file_m, "TIME", &t, 1);
+    WRITESTEPATTRIB(Float64, file_m, "TIME", &step.t, 1);
 
-    WRITESTEPATTRIB(Float64, file_m, "ENERGY", &meanEnergy, 1);
-    WRITESTEPATTRIB(Float64, file_m, "dE", &energySpread, 1);
+    WRITESTEPATTRIB(Float64, file_m, "ENERGY", &step.meanEnergy, 1);
+    WRITESTEPATTRIB(Float64, file_m, "dE", &step.energySpread, 1);
 
     /// Write particle mass and charge per particle. (Consider making these file attributes.)
-    WRITESTEPATTRIB(Float64, file_m, "MASS", &mass, 1);
+    WRITESTEPATTRIB(Float64, file_m, "MASS", &step.mass, 1);
 
-    WRITESTEPATTRIB(Float64, file_m, "CHARGE", &charge, 1);
+    WRITESTEPATTRIB(Float64, file_m, "CHARGE", &step.charge, 1);
 
     WRITESTEPATTRIB(Int64, file_m, "NumBunch", &numBunch, 1);
 
     WRITESTEPATTRIB(Int64, file_m, "SteptoLastInj", &SteptoLastInj, 1);
 
-    try {
-        Vector_t referenceB({additionalStepAttributes.at("B-ref_x"),
-                            additionalStepAttributes.at("B-ref_z"),
-                            additionalStepAttributes.at("B-ref_y")});
-        Vector_t referenceE({additionalStepAttributes.at("E-ref_x"),
-                            additionalStepAttributes.at("E-ref_z"),
-                            additionalStepAttributes.at("E-ref_y")});
-
-        WRITESTEPATTRIB(Float64, file_m, "B-ref", (h5_float64_t*)&referenceB, 3);
-        WRITESTEPATTRIB(Float64, file_m, "E-ref", (h5_float64_t*)&referenceE, 3);
-    } catch (std::out_of_range & m) {
-        ERRORMSG(m.what() << endl);
+    WRITESTEPATTRIB(Float64, file_m, "B-ref", (h5_float64_t*)&step.referenceB, 3);
+    WRITESTEPATTRIB(Float64, file_m, "E-ref", (h5_float64_t*)&step.referenceE, 3);
 
-        throw OpalException("H5PartWrapperForPC::writeStepHeader",
-                            "some additional step attribute not found");
-    }
+    writeDumpReductionAttributes(step.singlePrecision, step.subsample);
 
     ++ numSteps_m;
 }
 
-void H5PartWrapperForPT::writeStepData(PartBunchBase<double, 3>* bunch) {
-    size_t numLocalParticles = bunch->getLocalNum();
+void H5PartWrapperForPT::writeStepParticles(const StepData& step) {
+    const size_t numLocalParticles = step.numLocalParticles;
 
     REPORTONERROR(H5PartSetNumParticles(file_m, numLocalParticles));
-
-    std::vector<char> buffer(numLocalParticles * sizeof(h5_float64_t));
-    char* buffer_ptr = Util::c_data(buffer);
-    h5_float64_t* f64buffer = reinterpret_cast<h5_float64_t*>(buffer_ptr);
-    h5_int64_t* i64buffer = reinterpret_cast<h5_int64_t*>(buffer_ptr);
-    h5_int32_t* i32buffer = reinterpret_cast<h5_int32_t*>(buffer_ptr);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->R[i](0);
-    WRITEDATA(Float64, file_m, "x", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->R[i](1);
-    WRITEDATA(Float64, file_m, "y", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->R[i](2);
-    WRITEDATA(Float64, file_m, "z", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->P[i](0);
-    WRITEDATA(Float64, file_m, "px", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->P[i](1);
-    WRITEDATA(Float64, file_m, "py", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->P[i](2);
-    WRITEDATA(Float64, file_m, "pz", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        f64buffer[i] =  bunch->Q[i];
-    WRITEDATA(Float64, file_m, "q", f64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        i64buffer[i] =  bunch->ID[i];
-    WRITEDATA(Int64, file_m, "id", i64buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        i32buffer[i] = (h5_int32_t) bunch->PType[i];
-    WRITEDATA(Int32, file_m, "ptype", i32buffer);
-
-    for (size_t i = 0; i < numLocalParticles; ++ i)
-        i32buffer[i] = (h5_int32_t) bunch->POrigin[i];
-    WRITEDATA(Int32, file_m, "porigin", i32buffer);
-
-    if (Options::ebDump) {
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Ef[i](0);
-        WRITEDATA(Float64, file_m, "Ex", f64buffer);
-
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Ef[i](1);
-        WRITEDATA(Float64, file_m, "Ey", f64buffer);
-
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Ef[i](2);
-        WRITEDATA(Float64, file_m, "Ez", f64buffer);
-
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Bf[i](0);
-        WRITEDATA(Float64, file_m, "Bx", f64buffer);
-
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Bf[i](1);
-        WRITEDATA(Float64, file_m, "By", f64buffer);
-
-        for (size_t i = 0; i < numLocalParticles; ++ i)
-            f64buffer[i] =  bunch->Bf[i](2);
-        WRITEDATA(Float64, file_m, "Bz", f64buffer);
-
+    setChunkSize(numLocalParticles, step.chunkSize);
+
+    // the charge is always written in double precision
+    const h5_float64_t* column = step.f64Data.data();
+    const char* f64Names[] = {"x", "y", "z", "px", "py", "pz"};
+    for (const char* name: f64Names) {
+        writeFloatData(name, column, numLocalParticles, step.singlePrecision);
+        column += numLocalParticles;
+    }
+    WRITEDATA(Float64, file_m, "q", column);
+    column += numLocalParticles;
+
+    WRITEDATA(Int64, file_m, "id", step.id.data());
+    WRITEDATA(Int32, file_m, "ptype", step.ptype.data());
+    WRITEDATA(Int32, file_m, "porigin", step.porigin.data());
+
+    if (step.ebDump) {
+        const char* ebNames[] = {"Ex", "Ey", "Ez", "Bx", "By", "Bz"};
+        for (const char* name: ebNames) {
+            writeFloatData(name, column, numLocalParticles, step.singlePrecision);
+            column += numLocalParticles;
+        }
     }
 
     /// Write space charge field map if asked for.
-    if (Options::rhoDump) {
-        NDIndex<3> idx = bunch->getFieldLayout().getLocalNDIndex();
-        NDIndex<3> elem;
+    if (step.rhoDump) {
+        const NDIndex<3>& idx = step.rhoDomain;
         h5_err_t herr = H5Block3dSetView(
                                          file_m,
                                          idx[0].min(), idx[0].max(),
@@ -488,35 +576,21 @@ void H5PartWrapperForPT::writeStepData(PartBunchBase<double, 3>* bunch) {
                                          idx[2].min(), idx[2].max());
         reportOnError(herr, __FILE__, __LINE__);
 
-        std::unique_ptr<h5_float64_t[]> data(new h5_float64_t[(idx[0].max() + 1)  * (idx[1].max() + 1) * (idx[2].max() + 1)]);
-
-        int ii = 0;
-        // h5block uses the fortran convention of storing data:
-        // INTEGER, DIMENSION(2,3) :: a
-        // => {a(1,1), a(2,1), a(1,2), a(2,2), a(1,3), a(2,3)}
-        for (int i = idx[2].min(); i <= idx[2].max(); ++ i) {
-            for (int j = idx[1].min(); j <= idx[1].max(); ++ j) {
-                for (int k = idx[0].min(); k <= idx[0].max(); ++ k) {
-                    data[ii] = bunch->getRho(k, j, i);
-                    ++ ii;
-                }
-            }
-        }
-        herr = H5Block3dWriteScalarFieldFloat64(file_m, "rho", data.get());
+        herr = H5Block3dWriteScalarFieldFloat64(file_m, "rho", step.rho.data());
         reportOnError(herr, __FILE__, __LINE__);
 
         /// Need this to align particles and fields when writing space charge map.
         herr = H5Block3dSetFieldOrigin(file_m, "rho",
-                                       (h5_float64_t)bunch->get_origin()(0),
-                                       (h5_float64_t)bunch->get_origin()(1),
-                                       (h5_float64_t)bunch->get_origin()(2));
+                                       (h5_float64_t)step.rhoOrigin(0),
+                                       (h5_float64_t)step.rhoOrigin(1),
+                                       (h5_float64_t)step.rhoOrigin(2));
         reportOnError(herr, __FILE__, __LINE__);
 
         herr = H5Block3dSetFieldSpacing(file_m, "rho",
-                                        (h5_float64_t)bunch->get_hr()(0),
-                                        (h5_float64_t)bunch->get_hr()(1),
-                                        (h5_float64_t)bunch->get_hr()(2));
+                                        (h5_float64_t)step.rhoSpacing(0),
+                                        (h5_float64_t)step.rhoSpacing(1),
+                                        (h5_float64_t)step.rhoSpacing(2));
         reportOnError(herr, __FILE__, __LINE__);
 
     }
-}
\ No newline at end of file
+}
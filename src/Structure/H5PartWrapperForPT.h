@@ -20,8 +20,13 @@
 
 #include "Structure/H5PartWrapper.h"
 
+#include "Algorithms/Vektor.h"
+#include "Index/NDIndex.h"
+
 #include "H5hut.h"
 
+#include <vector>
+
 class H5PartWrapperForPT: public H5PartWrapper {
 public:
     H5PartWrapperForPT(const std::string& fileName, h5_int32_t flags = H5_O_WRONLY);
@@ -40,8 +45,69 @@ private:
     void readStepHeader(PartBunchBase<double, 3>*);
     void readStepData(PartBunchBase<double, 3>*, h5_ssize_t, h5_ssize_t);
 
-    void writeStepHeader(PartBunchBase<double, 3>*, const std::map<std::string, double>&);
-    void writeStepData(PartBunchBase<double, 3>*);
+    // A step is packed on the main thread and then written, either at once
+    // or by the background thread if ASYNCPSDUMP is set.
+    struct StepData {
+        double actPos;
+        double t;
+        double sigma;
+        double meanEnergy;
+        double energySpread;
+        double mass;
+        double charge;
+        Vector_t rmin;
+        Vector_t rmax;
+        Vector_t centroid;
+        Vector_t minP;
+        Vector_t maxP;
+        Vector_t xsigma;
+        Vector_t psigma;
+        Vector_t vareps;
+        Vector_t geomvareps;
+        Vector_t RefPartR;
+        Vector_t RefPartP;
+        Vector_t TaitBryant;
+        Vector_t pmean;
+        Vector_t referenceB;
+        Vector_t referenceE;
+        h5_int64_t localTrackStep;
+        h5_int64_t globalTrackStep;
+
+        bool ebDump;
+        bool rhoDump;
+        bool singlePrecision;
+        h5_int64_t subsample;
+        h5_int64_t chunkSize;
+        // number of local particles which are written, see PSDUMPSUBSAMPLE
+        size_t numLocalParticles;
+        // x, y, z, px, py, pz, q and, if ebDump, Ex, Ey, Ez, Bx, By, Bz;
+        // one column of numLocalParticles values each
+        std::vector<h5_float64_t> f64Data;
+        std::vector<h5_int64_t> id;
+        std::vector<h5_int32_t> ptype;
+        std::vector<h5_int32_t> porigin;
+
+        NDIndex<3> rhoDomain;
+        Vector_t rhoOrigin;
+        Vector_t rhoSpacing;
+        std::vector<h5_float64_t> rho;
+    };
+
+    void setupStepData();
+
+    void packStepHeader(PartBunchBase<double, 3>*, const std::map<std::string, double>&, StepData&);
+    void packStepData(PartBunchBase<double, 3>*, StepData&);
+
+    void writeStepData(const StepData&);
+    void writeStepHeader(const StepData&);
+    void writeStepParticles(const StepData&);
+
+    // number of steps which can be queued for the background thread; one
+    // is written while the next one is packed
+    static constexpr unsigned int maxQueuedSteps_m = 2;
+
+    std::vector<StepData> stepData_m;
+    size_t numQueuedSteps_m;
 };
 
 inline
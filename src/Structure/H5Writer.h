@@ -83,6 +83,7 @@ private:
 
 inline
 void H5Writer::close() {
+    h5wrapper_m->flush();
     h5wrapper_m->close();
 }
 
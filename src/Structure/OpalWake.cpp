@@ -173,6 +173,16 @@ void OpalWake::initWakefunction(const ElementBase& element) {
                             "The attribute \"TYPE\" isn't set for the \"WAKE\" statement");
     }
     OpalWakeType type = stringOpalWakeType_s.at(Attributes::getString(itsAttr[TYPE]));
+
+    // the elements use clones named after them; the wake functions are named
+    // after the WAKE statement such that the elements can share their wakes
+    const Object* definition = this;
+    while (definition->getParent() != nullptr &&
+           definition->getParent()->getParent() != nullptr) {
+        definition = definition->getParent();
+    }
+    const std::string& name = definition->getOpalName();
+
     switch (type) {
         case OpalWakeType::CSR: {
             if (filters.size() == 0 && Attributes::getReal(itsAttr[NBIN]) <= 7) {
@@ -180,7 +190,7 @@ void OpalWake::initWakefunction(const ElementBase& element) {
                                     "At least 8 bins have to be used, ideally far more");
             }
 
-            wf_m = new CSRWakeFunction(getOpalName(), filters,
+            wf_m = new CSRWakeFunction(name, filters,
                                        (int)(Attributes::getReal(itsAttr[NBIN])));
             break;
         }
@@ -190,14 +200,14 @@ void OpalWake::initWakefunction(const ElementBase& element) {
                                     "At least 8 bins have to be used, ideally far more");
             }
 
-            wf_m = new CSRIGFWakeFunction(getOpalName(), filters,
+            wf_m = new CSRIGFWakeFunction(name, filters,
                                           (int)(Attributes::getReal(itsAttr[NBIN])));
             break;
         }
         case OpalWakeType::LONGSHORTRANGE: {
             int acMode = Attributes::getString(itsAttr[CONDUCT]) == "DC"? 2: 1;
 
-            wf_m = new GreenWakeFunction(getOpalName(), filters,
+            wf_m = new GreenWakeFunction(name, filters,
                                          (int)(Attributes::getReal(itsAttr[NBIN])),
                                          Attributes::getReal(itsAttr[Z0]),
                                          Attributes::getReal(itsAttr[RADIUS]),
@@ -212,7 +222,7 @@ void OpalWake::initWakefunction(const ElementBase& element) {
         case OpalWakeType::TRANSVSHORTRANGE: {
             int acMode = Attributes::getString(itsAttr[CONDUCT]) == "DC" ? 2: 1;
 
-            wf_m = new GreenWakeFunction(getOpalName(), filters,
+            wf_m = new GreenWakeFunction(name, filters,
                                          (int)(Attributes::getReal(itsAttr[NBIN])),
                                          Attributes::getReal(itsAttr[Z0]),
                                          Attributes::getReal(itsAttr[RADIUS]),
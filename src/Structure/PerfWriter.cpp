@@ -0,0 +1,302 @@
+//
+// Class PerfWriter
+//   This class writes a SDDS file with performance information: the wall
+//   time per step spent in the phases of a step as measured by the
+//   IpplTimings timers, the distribution of the particles over the
+//   processors, the amount of data sent when particles are swapped between
+//   processors and the achieved particle pushes per second. On Linux the
+//   CPU cycles and instructions are added if the hardware counters are
+//   accessible with perf_event_open.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Structure/PerfWriter.h"
+
+#include "AbstractObjects/OpalData.h"
+#include "Algorithms/PartBunchBase.h"
+#include "Physics/Units.h"
+#include "Utilities/Timer.h"
+
+#include "Ippl.h"
+#include "Utility/IpplMessageCounter.h"
+#include "Utility/IpplTimings.h"
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#define OPAL_PERF_EVENTS
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    struct Phase {
+        std::string name;
+        std::string description;
+        std::vector<const char*> timers;
+    };
+
+    // the phases of a step and the timers which measure them; timers
+    // which don't exist in a run are ignored
+    const std::vector<Phase> phases = {
+        {"push",      "particle push",            {"TIntegration1", "TIntegration2", "Integration"}},
+        {"extfields", "external field evaluation", {"External field eval"}},
+        {"scatter",   "charge deposition",        {"SF: Scatter"}},
+        {"fft",       "field solver",             {"ComputePotential"}},
+        {"gather",    "field interpolation",      {"SF: Gather"}},
+        {"wake",      "wake fields",              {"WakeField"}},
+        {"io",        "output",                   {"Write Stat", "Write H5-File"}}
+    };
+
+    // the counter region of IPPL in which the particles are swapped
+    const std::string swapRegion = "Swap Particles";
+
+#ifdef OPAL_PERF_EVENTS
+    const std::vector<std::pair<unsigned long long, std::string> > hardwareCounters = {
+        {PERF_COUNT_HW_CPU_CYCLES,   "cycles"},
+        {PERF_COUNT_HW_INSTRUCTIONS, "instructions"}
+    };
+#endif
+}
+
+
+PerfWriter::PerfWriter(const std::string& fname, bool restart)
+    : SDDSWriter(fname, restart)
+    , lastStep_m(0)
+    , lastTime_m(std::chrono::steady_clock::now())
+    , lastSwapBytes_m(IpplMessageCounter::getInstance().getTotalSize(swapRegion))
+{
+    lastPhaseTimes_m = getPhaseTimes();
+    openCounters();
+    lastCounters_m = readCounters();
+}
+
+
+PerfWriter::~PerfWriter() {
+#ifdef OPAL_PERF_EVENTS
+    for (int fd: counters_m) {
+        ::close(fd);
+    }
+#endif
+}
+
+
+void PerfWriter::openCounters() {
+#ifdef OPAL_PERF_EVENTS
+    for (const auto& counter: hardwareCounters) {
+        perf_event_attr attr;
+        std::fill_n(reinterpret_cast<char*>(&attr), sizeof(attr), 0);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = counter.first;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // count the threads which are created later too
+        attr.inherit = 1;
+
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) break;
+        counters_m.push_back(fd);
+    }
+
+    // the columns have to be the same on all processors
+    int available = (counters_m.size() == hardwareCounters.size());
+    MPI_Allreduce(MPI_IN_PLACE, &available, 1, MPI_INT, MPI_MIN, Ippl::getComm());
+    if (!available) {
+        for (int fd: counters_m) {
+            ::close(fd);
+        }
+        counters_m.clear();
+    }
+#endif
+}
+
+
+std::vector<long long> PerfWriter::readCounters() const {
+    std::vector<long long> values(counters_m.size(), 0);
+#ifdef OPAL_PERF_EVENTS
+    for (size_t i = 0; i < counters_m.size(); ++ i) {
+        if (::read(counters_m[i], &values[i], sizeof(long long)) != sizeof(long long)) {
+            values[i] = 0;
+        }
+    }
+#endif
+    return values;
+}
+
+
+std::vector<double> PerfWriter::getPhaseTimes() const {
+    std::vector<double> times(phases.size(), 0.0);
+    for (size_t i = 0; i < phases.size(); ++ i) {
+        for (const char* name: phases[i].timers) {
+            IpplTimings::TimerInfo* timer = IpplTimings::infoTimer(name);
+            if (timer != 0) {
+                times[i] += timer->wallTime;
+            }
+        }
+    }
+    return times;
+}
+
+
+void PerfWriter::fillHeader() {
+
+    if (this->hasColumns()) {
+        return;
+    }
+
+    columns_m.addColumn("t", "double", "ns", "Time");
+
+    columns_m.addColumn("s", "double", "m", "Path length");
+
+    columns_m.addColumn("step", "long", "1", "Global track step");
+
+    columns_m.addColumn("time-per-step", "double", "s", "Wall time per step");
+
+    for (const Phase& phase: phases) {
+        columns_m.addColumn(phase.name + "-Max", "double", "s",
+                            "Maximum wall time per step of the " + phase.description);
+
+        columns_m.addColumn(phase.name + "-Avg", "double", "s",
+                            "Average wall time per step of the " + phase.description);
+    }
+
+    columns_m.addColumn("particles-Min", "long", "1", "Minimum number of particles per processor");
+
+    columns_m.addColumn("particles-Max", "long", "1", "Maximum number of particles per processor");
+
+    columns_m.addColumn("particles-Avg", "double", "1", "Average number of particles per processor");
+
+    columns_m.addColumn("swap-bytes", "double", "B",
+                        "Data sent per step when swapping particles between processors");
+
+    columns_m.addColumn("pushes-per-second", "double", "1/s", "Particle pushes per second");
+
+#ifdef OPAL_PERF_EVENTS
+    for (size_t i = 0; i < counters_m.size(); ++ i) {
+        columns_m.addColumn(hardwareCounters[i].second, "double", "1",
+                            "Total number of CPU " + hardwareCounters[i].second + " per step");
+    }
+#endif
+
+    if ( mode_m == std::ios::app )
+        return;
+
+    OPALTimer::Timer simtimer;
+
+    std::string dateStr(simtimer.date());
+    std::string timeStr(simtimer.time());
+
+    std::stringstream ss;
+
+    ss << "Performance statistics '"
+       << OpalData::getInstance()->getInputFn() << "' "
+       << dateStr << "" << timeStr;
+
+    this->addDescription(ss.str(), "performance parameters");
+
+    this->addDefaultParameters();
+
+    this->addInfo("ascii", 1);
+}
+
+
+void PerfWriter::write(PartBunchBase<double, 3>* beam) {
+
+    const long long step = beam->getLocalTrackStep();
+    if (step < lastStep_m) {
+        // new TRACK command
+        lastStep_m = 0;
+    }
+    const double numSteps = std::max(step - lastStep_m, 1ll);
+    lastStep_m = step;
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - lastTime_m).count();
+    lastTime_m = now;
+
+    // per step: phase times, swapped bytes, hardware counters and the
+    // number of particles, once negated to get the minimum
+    const size_t numPhases = phases.size();
+    std::vector<double> phaseTimes = getPhaseTimes();
+    std::vector<double> maxValues(numPhases + 2), sumValues(numPhases + 2 + counters_m.size());
+    for (size_t i = 0; i < numPhases; ++ i) {
+        maxValues[i] = (phaseTimes[i] - lastPhaseTimes_m[i]) / numSteps;
+        sumValues[i] = maxValues[i];
+    }
+    lastPhaseTimes_m = phaseTimes;
+
+    const double localNum = beam->getLocalNum();
+    maxValues[numPhases] = localNum;
+    maxValues[numPhases + 1] = -localNum;
+
+    // unsigned arithmetic gives the right difference after a wrap around
+    const unsigned int swapBytes = IpplMessageCounter::getInstance().getTotalSize(swapRegion);
+    sumValues[numPhases] = (swapBytes - lastSwapBytes_m) / numSteps;
+    sumValues[numPhases + 1] = localNum;
+    lastSwapBytes_m = swapBytes;
+
+    std::vector<long long> counters = readCounters();
+    for (size_t i = 0; i < counters.size(); ++ i) {
+        sumValues[numPhases + 2 + i] = (counters[i] - lastCounters_m[i]) / numSteps;
+    }
+    lastCounters_m = counters;
+
+    if (Ippl::myNode() == 0) {
+        MPI_Reduce(MPI_IN_PLACE, maxValues.data(), maxValues.size(), MPI_DOUBLE, MPI_MAX, 0, Ippl::getComm());
+        MPI_Reduce(MPI_IN_PLACE, sumValues.data(), sumValues.size(), MPI_DOUBLE, MPI_SUM, 0, Ippl::getComm());
+    } else {
+        MPI_Reduce(maxValues.data(), nullptr, maxValues.size(), MPI_DOUBLE, MPI_MAX, 0, Ippl::getComm());
+        MPI_Reduce(sumValues.data(), nullptr, sumValues.size(), MPI_DOUBLE, MPI_SUM, 0, Ippl::getComm());
+        return;
+    }
+
+    fillHeader();
+
+    this->open();
+
+    this->writeHeader();
+
+    const int nProcs = Ippl::getNodes();
+
+    columns_m.addColumnValue("t", beam->getT() * Units::s2ns);
+    columns_m.addColumnValue("s", beam->get_sPos());
+    columns_m.addColumnValue("step", (unsigned long)beam->getGlobalTrackStep());
+    columns_m.addColumnValue("time-per-step", elapsed / numSteps);
+
+    for (size_t i = 0; i < numPhases; ++ i) {
+        columns_m.addColumnValue(phases[i].name + "-Max", maxValues[i]);
+        columns_m.addColumnValue(phases[i].name + "-Avg", sumValues[i] / nProcs);
+    }
+
+    columns_m.addColumnValue("particles-Min", (unsigned long)-maxValues[numPhases + 1]);
+    columns_m.addColumnValue("particles-Max", (unsigned long)maxValues[numPhases]);
+    columns_m.addColumnValue("particles-Avg", sumValues[numPhases + 1] / nProcs);
+    columns_m.addColumnValue("swap-bytes", sumValues[numPhases]);
+    columns_m.addColumnValue("pushes-per-second",
+                             (elapsed > 0.0 ? sumValues[numPhases + 1] * numSteps / elapsed : 0.0));
+
+#ifdef OPAL_PERF_EVENTS
+    for (size_t i = 0; i < counters_m.size(); ++ i) {
+        columns_m.addColumnValue(hardwareCounters[i].second, sumValues[numPhases + 2 + i]);
+    }
+#endif
+
+    this->writeRow();
+
+    this->close();
+}
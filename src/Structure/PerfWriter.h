@@ -0,0 +1,63 @@
+//
+// Class PerfWriter
+//   This class writes a SDDS file with performance information: the wall
+//   time per step spent in the phases of a step as measured by the
+//   IpplTimings timers, the distribution of the particles over the
+//   processors, the amount of data sent when particles are swapped between
+//   processors and the achieved particle pushes per second. On Linux the
+//   CPU cycles and instructions are added if the hardware counters are
+//   accessible with perf_event_open.
+//
+//   Every row holds the averages per step since the previous row.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef OPAL_PERF_WRITER_H
+#define OPAL_PERF_WRITER_H
+
+#include "Structure/SDDSWriter.h"
+
+#include <chrono>
+#include <vector>
+
+class PerfWriter: public SDDSWriter {
+
+public:
+    PerfWriter(const std::string& fname, bool restart);
+
+    ~PerfWriter();
+
+    void write(PartBunchBase<double, 3>* beam) override;
+
+private:
+    void fillHeader();
+
+    // accumulated wall time of the timers of every phase on this processor
+    std::vector<double> getPhaseTimes() const;
+
+    void openCounters();
+    std::vector<long long> readCounters() const;
+
+    std::vector<double> lastPhaseTimes_m;
+    long long lastStep_m;
+    std::chrono::steady_clock::time_point lastTime_m;
+    unsigned int lastSwapBytes_m;
+
+    // file descriptors of the hardware counters, empty if they aren't
+    // available on all processors
+    std::vector<int> counters_m;
+    std::vector<long long> lastCounters_m;
+};
+
+#endif
@@ -0,0 +1,230 @@
+//
+// Class TriangleBVH
+//   Bounding volume hierarchy over the triangles of a BoundaryGeometry.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Structure/TriangleBVH.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+TriangleBVH::TriangleBVH():
+    padding_m(0.0),
+    numLeaves_m(0),
+    depth_m(0)
+{ }
+
+void TriangleBVH::build(const std::vector<Vector_t>& points,
+                        const std::vector<std::array<unsigned int, 4>>& triangles) {
+    nodes_m.clear();
+    triangleIds_m.clear();
+    numLeaves_m = 0;
+    depth_m = 0;
+    if (triangles.empty()) return;
+
+    std::vector<TriangleInfo> info(triangles.size());
+    Vector_t meshMin(std::numeric_limits<double>::max());
+    Vector_t meshMax(std::numeric_limits<double>::lowest());
+    for (unsigned int i = 0; i < triangles.size(); ++ i) {
+        const Vector_t& A = points[triangles[i][1]];
+        const Vector_t& B = points[triangles[i][2]];
+        const Vector_t& C = points[triangles[i][3]];
+        TriangleInfo& tri = info[i];
+        for (unsigned int d = 0; d < 3; ++ d) {
+            tri.min_m[d] = std::min({A[d], B[d], C[d]});
+            tri.max_m[d] = std::max({A[d], B[d], C[d]});
+            meshMin[d] = std::min(meshMin[d], tri.min_m[d]);
+            meshMax[d] = std::max(meshMax[d], tri.max_m[d]);
+        }
+        tri.centroid_m = 0.5 * (tri.min_m + tri.max_m);
+        tri.id_m = i;
+    }
+
+    const Vector_t extent = meshMax - meshMin;
+    padding_m = 1e-9 * std::sqrt(dot(extent, extent));
+
+    // a binary tree with leaves of at least one triangle has less than
+    // 2 * n nodes
+    nodes_m.reserve(2 * triangles.size());
+    triangleIds_m.reserve(triangles.size());
+    buildNode(info, 0, info.size(), 1);
+    nodes_m.shrink_to_fit();
+}
+
+unsigned int TriangleBVH::buildNode(std::vector<TriangleInfo>& info,
+                                    unsigned int begin, unsigned int end,
+                                    unsigned int depth) {
+    const unsigned int idx = nodes_m.size();
+    nodes_m.emplace_back();
+    depth_m = std::max(depth_m, depth);
+
+    Vector_t boxMin(std::numeric_limits<double>::max());
+    Vector_t boxMax(std::numeric_limits<double>::lowest());
+    Vector_t centroidMin(std::numeric_limits<double>::max());
+    Vector_t centroidMax(std::numeric_limits<double>::lowest());
+    for (unsigned int i = begin; i < end; ++ i) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            boxMin[d] = std::min(boxMin[d], info[i].min_m[d]);
+            boxMax[d] = std::max(boxMax[d], info[i].max_m[d]);
+            centroidMin[d] = std::min(centroidMin[d], info[i].centroid_m[d]);
+            centroidMax[d] = std::max(centroidMax[d], info[i].centroid_m[d]);
+        }
+    }
+    nodes_m[idx].min_m = boxMin - padding_m;
+    nodes_m[idx].max_m = boxMax + padding_m;
+
+    const unsigned int count = end - begin;
+    const Vector_t centroidExtent = centroidMax - centroidMin;
+    unsigned int axis = 0;
+    if (centroidExtent[1] > centroidExtent[axis]) axis = 1;
+    if (centroidExtent[2] > centroidExtent[axis]) axis = 2;
+
+    auto makeLeaf = [&]() {
+        nodes_m[idx].first_m = triangleIds_m.size();
+        nodes_m[idx].count_m = count;
+        for (unsigned int i = begin; i < end; ++ i) {
+            triangleIds_m.push_back(info[i].id_m);
+        }
+        ++ numLeaves_m;
+        return idx;
+    };
+
+    if (count <= maxLeafSize_s ||
+        depth >= maxDepth_s ||
+        centroidExtent[axis] <= 0.0) {
+        return makeLeaf();
+    }
+
+    // binned surface area heuristic along the axis with the largest extent
+    // of the centroids
+    struct Bin {
+        Vector_t min_m = Vector_t(std::numeric_limits<double>::max());
+        Vector_t max_m = Vector_t(std::numeric_limits<double>::lowest());
+        unsigned int count_m = 0;
+    };
+    Bin bins[numBins_s];
+    const double scale = numBins_s / centroidExtent[axis];
+    auto getBin = [&](const TriangleInfo& tri) {
+        unsigned int b = (tri.centroid_m[axis] - centroidMin[axis]) * scale;
+        return std::min(b, numBins_s - 1);
+    };
+    for (unsigned int i = begin; i < end; ++ i) {
+        Bin& bin = bins[getBin(info[i])];
+        ++ bin.count_m;
+        for (unsigned int d = 0; d < 3; ++ d) {
+            bin.min_m[d] = std::min(bin.min_m[d], info[i].min_m[d]);
+            bin.max_m[d] = std::max(bin.max_m[d], info[i].max_m[d]);
+        }
+    }
+
+    // cost of the split after bin b, sweeping from the right
+    double rightCost[numBins_s];
+    Bin right;
+    for (unsigned int b = numBins_s - 1; b > 0; -- b) {
+        right.count_m += bins[b].count_m;
+        for (unsigned int d = 0; d < 3; ++ d) {
+            right.min_m[d] = std::min(right.min_m[d], bins[b].min_m[d]);
+            right.max_m[d] = std::max(right.max_m[d], bins[b].max_m[d]);
+        }
+        rightCost[b - 1] = (right.count_m > 0 ?
+                            right.count_m * halfArea(right.min_m, right.max_m) : 0.0);
+    }
+
+    double bestCost = std::numeric_limits<double>::max();
+    unsigned int bestSplit = 0;
+    Bin left;
+    for (unsigned int b = 0; b < numBins_s - 1; ++ b) {
+        left.count_m += bins[b].count_m;
+        for (unsigned int d = 0; d < 3; ++ d) {
+            left.min_m[d] = std::min(left.min_m[d], bins[b].min_m[d]);
+            left.max_m[d] = std::max(left.max_m[d], bins[b].max_m[d]);
+        }
+        if (left.count_m == 0 || left.count_m == count) continue;
+
+        const double cost = left.count_m * halfArea(left.min_m, left.max_m) + rightCost[b];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestSplit = b;
+        }
+    }
+
+    unsigned int middle = begin;
+    if (bestCost < std::numeric_limits<double>::max()) {
+        auto it = std::partition(info.begin() + begin, info.begin() + end,
+                                 [&](const TriangleInfo& tri) { return getBin(tri) <= bestSplit; });
+        middle = it - info.begin();
+    }
+    if (middle == begin || middle == end) {
+        // all centroids in one bin, split at the median instead
+        middle = begin + count / 2;
+        std::nth_element(info.begin() + begin, info.begin() + middle, info.begin() + end,
+                         [axis](const TriangleInfo& a, const TriangleInfo& b) {
+                             return a.centroid_m[axis] < b.centroid_m[axis];
+                         });
+    }
+
+    buildNode(info, begin, middle, depth + 1);
+    const unsigned int rightChild = buildNode(info, middle, end, depth + 1);
+    nodes_m[idx].first_m = rightChild;
+    nodes_m[idx].count_m = 0;
+
+    return idx;
+}
+
+double TriangleBVH::halfArea(const Vector_t& min, const Vector_t& max) {
+    const Vector_t e = max - min;
+    return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+}
+
+void TriangleBVH::write(std::ostream& out) const {
+    const uint64_t numNodes = nodes_m.size();
+    const uint64_t numIds = triangleIds_m.size();
+    const uint64_t numLeaves = numLeaves_m;
+    out.write(reinterpret_cast<const char*>(&numNodes), sizeof(numNodes));
+    out.write(reinterpret_cast<const char*>(&numIds), sizeof(numIds));
+    out.write(reinterpret_cast<const char*>(&numLeaves), sizeof(numLeaves));
+    out.write(reinterpret_cast<const char*>(&depth_m), sizeof(depth_m));
+    out.write(reinterpret_cast<const char*>(&padding_m), sizeof(padding_m));
+    out.write(reinterpret_cast<const char*>(nodes_m.data()), numNodes * sizeof(Node));
+    out.write(reinterpret_cast<const char*>(triangleIds_m.data()), numIds * sizeof(int));
+}
+
+bool TriangleBVH::read(std::istream& in) {
+    uint64_t numNodes = 0, numIds = 0, numLeaves = 0;
+    in.read(reinterpret_cast<char*>(&numNodes), sizeof(numNodes));
+    in.read(reinterpret_cast<char*>(&numIds), sizeof(numIds));
+    in.read(reinterpret_cast<char*>(&numLeaves), sizeof(numLeaves));
+    in.read(reinterpret_cast<char*>(&depth_m), sizeof(depth_m));
+    in.read(reinterpret_cast<char*>(&padding_m), sizeof(padding_m));
+    if (!in.good() || depth_m > maxDepth_s || numNodes > 2 * numIds) {
+        nodes_m.clear();
+        triangleIds_m.clear();
+        return false;
+    }
+    nodes_m.resize(numNodes);
+    triangleIds_m.resize(numIds);
+    numLeaves_m = numLeaves;
+    in.read(reinterpret_cast<char*>(nodes_m.data()), numNodes * sizeof(Node));
+    in.read(reinterpret_cast<char*>(triangleIds_m.data()), numIds * sizeof(int));
+    if (!in.good()) {
+        nodes_m.clear();
+        triangleIds_m.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,176 @@
+//
+// Class TriangleBVH
+//   Bounding volume hierarchy over the triangles of a BoundaryGeometry.
+//
+//   The nodes are stored in one array in depth-first order: the left child
+//   of an inner node directly follows its parent, the index of the right
+//   child is stored in the node. Each leaf references a contiguous range
+//   of triangle IDs. The tree is built with a binned surface area heuristic,
+//   hence regions with many small triangles are subdivided more finely than
+//   regions with large ones, independent of the size of the largest
+//   triangle of the mesh.
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef OPAL_TRIANGLE_BVH_H
+#define OPAL_TRIANGLE_BVH_H
+
+#include "Algorithms/Vektor.h"
+
+#include <array>
+#include <iosfwd>
+#include <utility>
+#include <vector>
+
+class TriangleBVH {
+public:
+    TriangleBVH();
+
+    /// Build the tree over the triangles; the IDs of the vertices of
+    /// triangle i are triangles[i][1], triangles[i][2] and triangles[i][3]
+    /// as in BoundaryGeometry
+    void build(const std::vector<Vector_t>& points,
+               const std::vector<std::array<unsigned int, 4>>& triangles);
+
+    /// Call visit(triangleId) for every triangle whose leaf box intersects
+    /// the line segment from P to Q; every triangle is visited at most once
+    template <class Visitor>
+    void forEachCandidate(const Vector_t& P, const Vector_t& Q, Visitor&& visit) const;
+
+    /// Write the tree to a binary stream, respectively read it back; used by
+    /// the geometry cache of BoundaryGeometry. read returns false if the
+    /// stream doesn't contain a valid tree.
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+    bool empty() const;
+    size_t getNumNodes() const;
+    size_t getNumLeaves() const;
+    unsigned int getDepth() const;
+
+private:
+    struct Node {
+        Vector_t min_m;
+        Vector_t max_m;
+        // leaves: index of the first triangle in triangleIds_m,
+        // inner nodes: index of the right child
+        unsigned int first_m;
+        // number of triangles, 0 for inner nodes
+        unsigned int count_m;
+    };
+
+    struct TriangleInfo {
+        Vector_t min_m;
+        Vector_t max_m;
+        Vector_t centroid_m;
+        unsigned int id_m;
+    };
+
+    unsigned int buildNode(std::vector<TriangleInfo>& info,
+                           unsigned int begin, unsigned int end,
+                           unsigned int depth);
+
+    // true if the segment P + t * (Q - P), 0 <= t <= 1, intersects the box
+    // of node; invDir is the component-wise inverse of Q - P
+    static bool intersectsSegment(const Node& node,
+                                  const Vector_t& P, const Vector_t& dir,
+                                  const Vector_t& invDir);
+
+    static double halfArea(const Vector_t& min, const Vector_t& max);
+
+    static constexpr unsigned int maxLeafSize_s = 4;
+    static constexpr unsigned int maxDepth_s = 64;
+    static constexpr unsigned int numBins_s = 16;
+
+    std::vector<Node> nodes_m;
+    std::vector<int> triangleIds_m;
+
+    // the boxes are enlarged by this amount such that triangles touching
+    // a segment aren't missed due to rounding
+    double padding_m;
+    size_t numLeaves_m;
+    unsigned int depth_m;
+};
+
+inline
+bool TriangleBVH::empty() const {
+    return nodes_m.empty();
+}
+
+inline
+size_t TriangleBVH::getNumNodes() const {
+    return nodes_m.size();
+}
+
+inline
+size_t TriangleBVH::getNumLeaves() const {
+    return numLeaves_m;
+}
+
+inline
+unsigned int TriangleBVH::getDepth() const {
+    return depth_m;
+}
+
+inline
+bool TriangleBVH::intersectsSegment(const Node& node,
+                                    const Vector_t& P, const Vector_t& dir,
+                                    const Vector_t& invDir) {
+    double tmin = 0.0;
+    double tmax = 1.0;
+    for (unsigned int d = 0; d < 3; ++ d) {
+        if (dir[d] == 0.0) {
+            if (P[d] < node.min_m[d] || P[d] > node.max_m[d]) return false;
+            continue;
+        }
+        double t0 = (node.min_m[d] - P[d]) * invDir[d];
+        double t1 = (node.max_m[d] - P[d]) * invDir[d];
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tmin) tmin = t0;
+        if (t1 < tmax) tmax = t1;
+        if (tmin > tmax) return false;
+    }
+    return true;
+}
+
+template <class Visitor>
+void TriangleBVH::forEachCandidate(const Vector_t& P, const Vector_t& Q, Visitor&& visit) const {
+    if (nodes_m.empty()) return;
+
+    const Vector_t dir = Q - P;
+    Vector_t invDir;
+    for (unsigned int d = 0; d < 3; ++ d) {
+        invDir[d] = (dir[d] == 0.0 ? 0.0 : 1.0 / dir[d]);
+    }
+
+    unsigned int stack[maxDepth_s + 2];
+    unsigned int top = 0;
+    stack[top ++] = 0;
+    while (top > 0) {
+        const unsigned int idx = stack[-- top];
+        const Node& node = nodes_m[idx];
+        if (!intersectsSegment(node, P, dir, invDir)) continue;
+
+        if (node.count_m > 0) {
+            for (unsigned int i = node.first_m; i < node.first_m + node.count_m; ++ i) {
+                visit(triangleIds_m[i]);
+            }
+        } else {
+            stack[top ++] = node.first_m;
+            stack[top ++] = idx + 1;
+        }
+    }
+}
+
+#endif
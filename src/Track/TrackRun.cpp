@@ -37,6 +37,8 @@
 #include "Physics/Physics.h"
 #include "Physics/Units.h"
 
+#include "Solvers/GreenWakeFunction.h"
+
 #include "Track/Track.h"
 
 #include "Utilities/OpalException.h"
@@ -52,6 +54,9 @@
 #include "OPALconfig.h"
 #include "changes.h"
 
+#include "Utility/IpplTimings.h"
+
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -233,6 +238,12 @@ void TrackRun::execute() {
         opalData_m->setRestartRun(false);
     }
 
+    // flush the intervals of the timers which were recorded during tracking
+    IpplTimings::writeTrace("timing-trace");
+
+    // the WAKE definitions and the bunch may change before the next TRACK
+    GreenWakeFunction::clearWakeCache();
+
     opalData_m->bunchIsAllocated();
 }
 
@@ -396,6 +407,13 @@ void TrackRun::setupTTracker(){
 
     // findPhasesForMaxEnergy();
 
+    unsigned int numSubsteps = 1;
+    if (Track::block->timeIntegrator == Steppers::TimeIntegrator::MTS) {
+        numSubsteps = std::max(Options::mtsSubsteps, 1);
+        *gmsg << "* Multiple time stepping (MTS) integrator, " << numSubsteps
+              << " substeps of the external fields per time step" << endl;
+    }
+
     itsTracker_m.reset(new ParallelTTracker(*Track::block->use->fetchLine(),
                                       Track::block->bunch,
                                       *dataSink_m,
@@ -405,7 +423,8 @@ void TrackRun::setupTTracker(){
                                       Track::block->localTimeSteps,
                                       Track::block->zstart,
                                       Track::block->zstop,
-                                      Track::block->dT));
+                                      Track::block->dT,
+                                      numSubsteps));
 }
 
 void TrackRun::setupCyclotronTracker(){
@@ -700,6 +719,9 @@ Inform& TrackRun::print(Inform& os) const {
            << "* ********************************************************************************** " << '\n';
     }
     os << "* Phase space dump frequency    = " << Options::psDumpFreq << '\n'
+       << "* Phase space dump precision    = " << (Options::psDumpPrecision == DumpPrecision::SINGLE ? "SINGLE" : "DOUBLE") << '\n'
+       << "* Phase space dump subsampling  = " << Options::psDumpSubsample << '\n'
+       << "* Phase space dump chunk size   = " << Options::psDumpChunkSize << '\n'
        << "* Statistics dump frequency     = " << Options::statDumpFreq << " w.r.t. the time step." << '\n'
        << "* DT                            = " << Track::block->dT.front() << " [s]\n"
        << "* MAXSTEPS                      = " << Track::block->localTimeSteps.front() << '\n'
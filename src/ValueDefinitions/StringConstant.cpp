@@ -158,6 +158,10 @@ StringConstant::StringConstant():
     CREATE_STRINGCONSTANT("STANDARD");
     CREATE_STRINGCONSTANT("INTEGRATED");
 
+    // FieldSolver / FFTLIB
+    CREATE_STRINGCONSTANT("FFTPACK");
+    CREATE_STRINGCONSTANT("FFTW");
+
     // FieldSolver / ITSOLVER
     CREATE_STRINGCONSTANT("CG");
     CREATE_STRINGCONSTANT("BICGSTAB");
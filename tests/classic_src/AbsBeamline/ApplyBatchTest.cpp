@@ -0,0 +1,299 @@
+#include "gtest/gtest.h"
+
+#include "AbsBeamline/RBend3D.h"
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "BeamlineCore/MultipoleRep.h"
+#include "BeamlineCore/RFCavityRep.h"
+#include "BeamlineCore/SBendRep.h"
+#include "BeamlineCore/SolenoidRep.h"
+#include "BeamlineCore/TravelingWaveRep.h"
+#include "Fields/Fieldmap.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compares Component::applyBatch of the elements that override it with
+// the per particle apply(i, t, E, B) for the same particles
+
+namespace {
+    // grid of the test maps in cm, nx, ny and nz cells
+    const double xmin = -1.0, xmax = 1.0;
+    const double ymin = -1.5, ymax = 1.5;
+    const double zmin = 0.0, zmax = 5.0;
+    const unsigned int nx = 4, ny = 6, nz = 10;
+
+    // frequency of the dynamic test map in MHz
+    const double mapFrequency = 1300.0;
+
+    double component(unsigned int c, double x, double y, double z) {
+        return (c + 1) * (0.3 + 0.2 * x - 0.1 * y * y + 0.05 * x * z) + std::sin(z + c);
+    }
+
+    void writeMap(const std::string& filename, bool dynamic) {
+        std::ofstream out(filename);
+        out << std::setprecision(17);
+        out << (dynamic ? "3DDynamic" : "3DMagnetoStatic") << " FALSE\n";
+        if (dynamic) {
+            out << mapFrequency << "\n";
+        }
+        out << xmin << " " << xmax << " " << nx << "\n"
+            << ymin << " " << ymax << " " << ny << "\n"
+            << zmin << " " << zmax << " " << nz << "\n";
+
+        const unsigned int numComponents = (dynamic ? 6 : 3);
+        for (unsigned int i = 0; i <= nx; ++ i) {
+            const double x = xmin + i * (xmax - xmin) / nx;
+            for (unsigned int j = 0; j <= ny; ++ j) {
+                const double y = ymin + j * (ymax - ymin) / ny;
+                for (unsigned int k = 0; k <= nz; ++ k) {
+                    const double z = zmin + k * (zmax - zmin) / nz;
+                    for (unsigned int c = 0; c < numComponents; ++ c) {
+                        out << (c > 0 ? " " : "") << component(c, x, y, z);
+                    }
+                    out << "\n";
+                }
+            }
+        }
+    }
+
+    void removeMap(const std::string& filename) {
+        _Fieldmap::deleteFieldmap(filename);
+        std::remove(filename.c_str());
+    }
+
+    // fills the bunch with particles spread over the box [lower, upper];
+    // the number of particles isn't a multiple of the block size of the
+    // batched field map evaluation
+    void fillBunch(PartBunch& bunch, const Vector_t& lower, const Vector_t& upper) {
+        const size_t n = 101;
+        bunch.create(n);
+        for (size_t i = 0; i < n; ++ i) {
+            const Vector_t u({std::fmod(0.6180339887 * i, 1.0),
+                              std::fmod(0.7548776662 * i, 1.0),
+                              std::fmod(0.5698402910 * i, 1.0)});
+            for (unsigned int d = 0; d < 3; ++ d) {
+                bunch.R[i](d) = lower(d) + (upper(d) - lower(d)) * u(d);
+            }
+            bunch.P[i] = Vector_t({0.001 * i, -0.002 * i, 0.5});
+            bunch.Q[i] = Physics::q_e;
+            bunch.M[i] = Physics::m_p;
+            bunch.Bin[i] = 0;
+        }
+    }
+
+    struct Counts {
+        size_t outOfBounds = 0;
+        size_t withField = 0;
+    };
+
+    // evaluates the element with apply(i, t, E, B) particle by particle and
+    // checks that applyBatch gives the same fields and out-of-bounds flags
+    Counts compareApplyBatch(Component& element, PartBunch& bunch) {
+        const size_t n = bunch.getLocalNum();
+        std::vector<size_t> indices(n);
+        std::vector<Vector_t> R(n), P(n);
+        std::vector<double> t(n);
+        for (size_t i = 0; i < n; ++ i) {
+            indices[i] = i;
+            R[i] = bunch.R[i];
+            P[i] = bunch.P[i];
+            t[i] = 1e-11 * i;
+        }
+
+        std::vector<Vector_t> E(n, Vector_t(0.0)), B(n, Vector_t(0.0));
+        std::vector<bool> outOfBounds(n);
+        for (size_t i = 0; i < n; ++ i) {
+            outOfBounds[i] = element.apply(i, t[i], E[i], B[i]);
+        }
+
+        std::vector<Vector_t> batchE(n, Vector_t(0.0)), batchB(n, Vector_t(0.0));
+        std::unique_ptr<bool[]> batchOutOfBounds(new bool[n]);
+        element.applyBatch(indices.data(), n, R.data(), P.data(), t.data(),
+                           batchE.data(), batchB.data(), batchOutOfBounds.get());
+
+        Counts counts;
+        for (size_t i = 0; i < n; ++ i) {
+            EXPECT_EQ(batchOutOfBounds[i], outOfBounds[i]) << "particle " << i;
+            for (unsigned int d = 0; d < 3; ++ d) {
+                EXPECT_EQ(batchE[i](d), E[i](d)) << "particle " << i;
+                EXPECT_EQ(batchB[i](d), B[i](d)) << "particle " << i;
+            }
+            if (outOfBounds[i]) {
+                ++ counts.outOfBounds;
+            } else if (dot(E[i], E[i]) + dot(B[i], B[i]) > 0.0) {
+                ++ counts.withField;
+            }
+        }
+        EXPECT_LT(counts.outOfBounds + counts.withField, n);
+
+        return counts;
+    }
+
+    // compares with and without deleting particles that leave the
+    // element transversally
+    void compareApplyBatch(Component& element, PartBunch& bunch, bool hasAperture) {
+        for (bool deleteOnTransverseExit: {true, false}) {
+            element.setFlagDeleteOnTransverseExit(deleteOnTransverseExit);
+            const Counts counts = compareApplyBatch(element, bunch);
+            EXPECT_EQ(counts.outOfBounds > 0, hasAperture && deleteOnTransverseExit);
+            EXPECT_GT(counts.withField, 0u);
+        }
+    }
+}
+
+TEST(ApplyBatchTest, RFCavity)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const std::string filename = "ApplyBatchTest_RFCavity.T7";
+    writeMap(filename, true);
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+
+    RFCavityRep cavity("CAVITY");
+    cavity.setFieldMapFN(filename);
+    cavity.setAmplitudem(10.0);
+    cavity.setFrequencym(Physics::two_pi * mapFrequency * Units::MHz2Hz);
+    cavity.setPhasem(0.3);
+    double startField = 0.0, endField = 0.0;
+    cavity.initialise(&bunch, startField, endField);
+    cavity.goOnline(0.0);
+
+    fillBunch(bunch, Vector_t({-0.012, -0.017, -0.01}), Vector_t({0.012, 0.017, 0.06}));
+    compareApplyBatch(cavity, bunch, true);
+
+    removeMap(filename);
+}
+
+TEST(ApplyBatchTest, TravelingWave)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const std::string filename = "ApplyBatchTest_TravelingWave.T7";
+    writeMap(filename, true);
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+
+    TravelingWaveRep wave("WAVE");
+    wave.setFieldMapFN(filename);
+    wave.setAmplitudem(10.0);
+    wave.setFrequencym(Physics::two_pi * mapFrequency * Units::MHz2Hz);
+    wave.setPhasem(0.3);
+    wave.setNumCells(4);
+    wave.setMode(1.0 / 3.0);
+    double startField = 0.0, endField = 0.0;
+    wave.initialise(&bunch, startField, endField);
+    wave.goOnline(0.0);
+
+    // covers the entry, core and exit regions
+    fillBunch(bunch, Vector_t({-0.012, -0.017, -0.02}), Vector_t({0.012, 0.017, 0.06}));
+    compareApplyBatch(wave, bunch, true);
+
+    removeMap(filename);
+}
+
+TEST(ApplyBatchTest, Solenoid)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const std::string filename = "ApplyBatchTest_Solenoid.T7";
+    writeMap(filename, false);
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+
+    SolenoidRep solenoid("SOLENOID");
+    solenoid.setFieldMapFN(filename);
+    solenoid.setKS(0.8);
+    double startField = 0.0, endField = 0.0;
+    solenoid.initialise(&bunch, startField, endField);
+    solenoid.goOnline(0.0);
+
+    fillBunch(bunch, Vector_t({-0.012, -0.017, -0.01}), Vector_t({0.012, 0.017, 0.06}));
+    compareApplyBatch(solenoid, bunch, true);
+
+    removeMap(filename);
+}
+
+TEST(ApplyBatchTest, Multipole)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+
+    MultipoleRep multipole("MULTIPOLE");
+    multipole.setElementLength(0.5);
+    multipole.setAperture(ApertureType::RECTANGULAR, std::vector<double>({0.02, 0.03, 1.0}));
+    multipole.setNormalComponent(2, 10.0);
+    multipole.setNormalComponent(3, 2.0, 0.5);
+    multipole.setSkewComponent(2, 1.5);
+    double startField = 0.0, endField = 0.0;
+    multipole.initialise(&bunch, startField, endField);
+
+    fillBunch(bunch, Vector_t({-0.03, -0.04, -0.1}), Vector_t({0.03, 0.04, 0.6}));
+    compareApplyBatch(multipole, bunch, true);
+}
+
+TEST(ApplyBatchTest, Bend2D)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+    bunch.setdT(1.0e-12);
+
+    SBendRep bend("BEND");
+    bend.setFieldMapFN("1DPROFILE1-DEFAULT");
+    bend.setElementLength(0.2);
+    bend.setDesignEnergy(10.0);
+    bend.setBendAngle(0.523599);
+    bend.setFullGap(0.04);
+    bend.setEntranceAngle(0.0);
+    bend.setAperture(ApertureType::RECTANGULAR, std::vector<double>({0.1, 0.04, 1.0}));
+    double startField = 0.0, endField = 0.0;
+    bend.initialise(&bunch, startField, endField);
+
+    // particles above and below the gap hit the poles
+    fillBunch(bunch, Vector_t({-0.15, -0.04, -0.15}), Vector_t({0.15, 0.04, 0.35}));
+    compareApplyBatch(bend, bunch, true);
+}
+
+TEST(ApplyBatchTest, RBend3D)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const std::string filename = "ApplyBatchTest_RBend3D.T7";
+    writeMap(filename, false);
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+    bunch.setdT(1.0e-12);
+
+    RBend3D bend("RBEND3D");
+    bend.setFieldMapFN(filename);
+    bend.setElementLength(0.05);
+    bend.setDesignEnergy(10.0);
+    bend.setFieldAmplitude(0.1, 0.0);
+    double startField = 0.0, endField = 0.0;
+    bend.initialise(&bunch, startField, endField);
+
+    // RBend3D has no aperture, particles outside of the field map are
+    // kept without field
+    fillBunch(bunch, Vector_t({-0.012, -0.017, -0.01}), Vector_t({0.012, 0.017, 0.06}));
+    compareApplyBatch(bend, bunch, false);
+
+    removeMap(filename);
+}
@@ -0,0 +1,271 @@
+#include "gtest/gtest.h"
+
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "BeamlineCore/CyclotronRep.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+#include "Structure/LossDataSink.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+    const double mapRmin = 0.1;         // [m]
+    const double mapDelr = 0.01;        // [m]
+    const double mapSymmetry = 4.0;
+    const int mapNrad = 50;
+    const int mapNtet = 90;
+
+    // midplane field map with nrad x ntet nodes which is filled in memory
+    class MidplaneCyclotron: public CyclotronRep {
+    public:
+        explicit MidplaneCyclotron(bool fieldTable):
+            CyclotronRep("CYCLOTRON")
+        {
+            setCyclotronType("CARBONCYCL");
+            setBFieldType();
+            setSymmetry(mapSymmetry);
+            setTrimCoilThreshold(0.0);
+            setFieldTable(fieldTable);
+
+            BP_m.rmin_m = mapRmin;
+            BP_m.delr_m = mapDelr;
+            BP_m.tetmin_m = 0.0;
+            BP_m.dtet_m = 360.0 / mapSymmetry / mapNtet;
+            BP_m.Bfact_m = 1.0;
+
+            Bfield_m.nrad_m = mapNrad;
+            Bfield_m.ntet_m = mapNtet;
+            Bfield_m.ntetS_m = mapNtet + 1;
+            Bfield_m.ntot_m = mapNrad * Bfield_m.ntetS_m;
+            Bfield_m.bfld_m.resize(Bfield_m.ntot_m);
+            Bfield_m.dbr_m.resize(Bfield_m.ntot_m);
+            Bfield_m.dbt_m.resize(Bfield_m.ntot_m);
+            for (int i = 0; i < mapNrad; ++ i) {
+                const double r = mapRmin + i * mapDelr;
+                for (int k = 0; k < Bfield_m.ntetS_m; ++ k) {
+                    const double tet = k * BP_m.dtet_m * Units::deg2rad;
+                    Bfield_m.bfld_m[idx(i, k)] = 1.0 + 0.1 * r + 0.05 * std::sin(mapSymmetry * tet);
+                    Bfield_m.dbr_m[idx(i, k)] = 0.1 + 0.01 * tet;
+                    Bfield_m.dbt_m[idx(i, k)] = 0.05 * mapSymmetry * std::cos(mapSymmetry * tet);
+                }
+            }
+
+            if (fieldTable) {
+                buildFieldTable();
+            }
+        }
+
+        void setBunch(PartBunchBase<double, 3>* bunch) {
+            RefPartBunch_m = bunch;
+        }
+    };
+}
+
+// the batched evaluation of the midplane field gives the same fields as
+// the scalar one and reports the points outside of the field map
+TEST(CyclotronTest, BatchedApplyAtMapBoundary)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    for (bool fieldTable: {false, true}) {
+        MidplaneCyclotron cyclotron(fieldTable);
+
+        const double rmin = mapRmin;
+        const double rmax = mapRmin + (mapNrad - 1) * mapDelr;
+        const double delr = mapDelr;
+        std::vector<double> rad, z, tet;
+        std::vector<bool> expectedInside;
+        for (double angle: {0.05, 1.3, 2.9, 4.0, 6.2}) {
+            for (double r: {rmin - 1.5 * delr, rmin + 0.5 * delr, 0.5 * (rmin + rmax),
+                            rmax - 0.5 * delr, rmax + 0.5 * delr, rmax + 3.0 * delr}) {
+                rad.push_back(r);
+                z.push_back(0.01);
+                tet.push_back(angle);
+                expectedInside.push_back(r > rmin && r < rmax);
+            }
+        }
+
+        const size_t n = rad.size();
+        std::vector<double> br(n, 1.0), bt(n, 1.0), bz(n, 1.0);
+        std::unique_ptr<bool[]> isInside(new bool[n]);
+        const size_t numOutside = cyclotron.apply(n, rad.data(), z.data(), tet.data(),
+                                                  br.data(), bt.data(), bz.data(),
+                                                  isInside.get());
+
+        size_t expectedOutside = 0;
+        for (size_t i = 0; i < n; ++ i) {
+            EXPECT_EQ(isInside[i], expectedInside[i]) << "point " << i;
+
+            double brint = 0.0, btint = 0.0, bzint = 0.0;
+            EXPECT_EQ(cyclotron.interpolate(rad[i], tet[i], brint, btint, bzint), isInside[i]);
+
+            const Vector_t R({rad[i] * std::cos(tet[i]), rad[i] * std::sin(tet[i]), z[i]});
+            Vector_t E(0.0), B(0.0);
+            const bool outside = cyclotron.apply(R, Vector_t(0.0), 0.0, E, B);
+            EXPECT_EQ(outside, !isInside[i]) << "point " << i;
+
+            if (!isInside[i]) {
+                ++ expectedOutside;
+                EXPECT_EQ(br[i], 0.0);
+                EXPECT_EQ(bt[i], 0.0);
+                EXPECT_EQ(bz[i], 0.0);
+                continue;
+            }
+            EXPECT_NEAR(br[i], brint, 1e-12);
+            EXPECT_NEAR(bt[i], btint, 1e-12);
+            EXPECT_NEAR(bz[i], bzint, 1e-12);
+            EXPECT_NEAR(B[2], -bz[i], 1e-12);
+        }
+        EXPECT_EQ(numOutside, expectedOutside);
+        EXPECT_GT(numOutside, 0u);
+        EXPECT_LT(numOutside, n);
+    }
+}
+
+// the precomputed field table (FIELDTABLE = TRUE) gives the same fields
+// as the interpolation from the field map arrays; both interpolate
+// bilinearly from the same nodes, they differ only by rounding
+TEST(CyclotronTest, FieldTableMatchesInterpolation)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    MidplaneCyclotron withoutTable(false);
+    MidplaneCyclotron withTable(true);
+
+    const double tolerance = 1e-12;    // relative to the field [kG]
+    const double rmax = mapRmin + (mapNrad - 1) * mapDelr;
+    std::vector<double> rad, z, tet;
+    for (int i = 0; i < 97; ++ i) {
+        rad.push_back(mapRmin - 2 * mapDelr + (rmax - mapRmin + 4 * mapDelr) * std::fmod(0.6180339887 * i, 1.0));
+        tet.push_back(Physics::two_pi * std::fmod(0.7548776662 * i, 1.0));
+        z.push_back(0.02 * std::fmod(0.5698402910 * i, 1.0) - 0.01);
+    }
+
+    const size_t n = rad.size();
+    size_t numInside = 0;
+    for (size_t i = 0; i < n; ++ i) {
+        double brint = 0.0, btint = 0.0, bzint = 0.0;
+        const bool inside = withoutTable.interpolate(rad[i], tet[i], brint, btint, bzint);
+        double brtab = 0.0, bttab = 0.0, bztab = 0.0;
+        EXPECT_EQ(withTable.interpolate(rad[i], tet[i], brtab, bttab, bztab), inside) << "point " << i;
+        if (!inside) continue;
+
+        ++ numInside;
+        const double scale = std::abs(bzint);
+        EXPECT_NEAR(brtab, brint, tolerance * scale) << "point " << i;
+        EXPECT_NEAR(bttab, btint, tolerance * scale) << "point " << i;
+        EXPECT_NEAR(bztab, bzint, tolerance * scale) << "point " << i;
+
+        // off the midplane
+        const Vector_t R({rad[i] * std::cos(tet[i]), rad[i] * std::sin(tet[i]), z[i]});
+        Vector_t E(0.0), B(0.0), Etab(0.0), Btab(0.0);
+        EXPECT_EQ(withTable.apply(R, Vector_t(0.0), 0.0, Etab, Btab),
+                  withoutTable.apply(R, Vector_t(0.0), 0.0, E, B)) << "point " << i;
+        for (unsigned int d = 0; d < 3; ++ d) {
+            EXPECT_NEAR(Btab[d], B[d], tolerance * scale) << "point " << i;
+        }
+    }
+    EXPECT_GT(numInside, 0u);
+    EXPECT_LT(numInside, n);
+
+    // the batched evaluation
+    std::vector<double> br(n), bt(n), bz(n), brtab(n), bttab(n), bztab(n);
+    std::unique_ptr<bool[]> isInside(new bool[n]), isInsideTab(new bool[n]);
+    EXPECT_EQ(withTable.apply(n, rad.data(), z.data(), tet.data(),
+                              brtab.data(), bttab.data(), bztab.data(), isInsideTab.get()),
+              withoutTable.apply(n, rad.data(), z.data(), tet.data(),
+                                 br.data(), bt.data(), bz.data(), isInside.get()));
+    for (size_t i = 0; i < n; ++ i) {
+        EXPECT_EQ(isInsideTab[i], isInside[i]) << "point " << i;
+        const double scale = std::abs(bz[i]);
+        EXPECT_NEAR(brtab[i], br[i], tolerance * scale) << "point " << i;
+        EXPECT_NEAR(bttab[i], bt[i], tolerance * scale) << "point " << i;
+        EXPECT_NEAR(bztab[i], bz[i], tolerance * scale) << "point " << i;
+    }
+}
+
+// applyBatch, which is used by the block integrators of
+// ParallelCyclotronTracker, agrees with apply(i, t, E, B) for particles
+// inside and outside of the aperture and the field map
+TEST(CyclotronTest, ApplyBatch)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    for (bool fieldTable: {false, true}) {
+        MidplaneCyclotron cyclotron(fieldTable);
+        cyclotron.setMinR(0.05);
+        cyclotron.setMaxR(1.0);
+        cyclotron.setMinZ(-0.05);
+        cyclotron.setMaxZ(0.05);
+        cyclotron.lossDs_m.reset(new LossDataSink(fieldTable ?
+                                                  "CyclotronTestApplyBatchTable" :
+                                                  "CyclotronTestApplyBatch", false));
+
+        PartData data;
+        PartBunch bunch(&data);
+        cyclotron.setBunch(&bunch);
+
+        const double rmax = mapRmin + (mapNrad - 1) * mapDelr;
+        std::vector<Vector_t> R;
+        for (double angle: {0.05, 1.3, 2.9, 4.0, 6.2}) {
+            for (double r: {0.07, mapRmin + 0.5 * mapDelr, 0.3, rmax - 0.5 * mapDelr,
+                            rmax + 0.5 * mapDelr, 1.2}) {
+                for (double z: {0.0, 0.01, 0.07}) {
+                    R.push_back(Vector_t({r * std::cos(angle), r * std::sin(angle), z}));
+                }
+            }
+        }
+
+        const size_t n = R.size();
+        bunch.create(n);
+        std::vector<size_t> indices(n);
+        std::vector<Vector_t> P(n);
+        std::vector<double> t(n);
+        for (size_t i = 0; i < n; ++ i) {
+            indices[i] = i;
+            P[i] = Vector_t({0.01 * i, 0.1, 0.0});
+            t[i] = 1e-9 * i;
+            bunch.R[i] = R[i];
+            bunch.P[i] = P[i];
+            bunch.Q[i] = Physics::q_e;
+            bunch.M[i] = Physics::m_p;
+            bunch.Bin[i] = 0;
+            bunch.bunchNum[i] = 0;
+        }
+
+        std::vector<Vector_t> E(n, Vector_t(0.0)), B(n, Vector_t(0.0));
+        std::vector<bool> outOfBounds(n);
+        std::vector<int> bin(n);
+        for (size_t i = 0; i < n; ++ i) {
+            outOfBounds[i] = cyclotron.apply(i, t[i], E[i], B[i]);
+            bin[i] = bunch.Bin[i];
+            bunch.Bin[i] = 0;
+        }
+        const size_t numLost = cyclotron.lossDs_m->size();
+
+        std::vector<Vector_t> batchE(n, Vector_t(0.0)), batchB(n, Vector_t(0.0));
+        std::unique_ptr<bool[]> batchOutOfBounds(new bool[n]);
+        cyclotron.applyBatch(indices.data(), n, R.data(), P.data(), t.data(),
+                             batchE.data(), batchB.data(), batchOutOfBounds.get());
+
+        size_t expectedLost = 0;
+        for (size_t i = 0; i < n; ++ i) {
+            EXPECT_EQ(batchOutOfBounds[i], outOfBounds[i]) << "particle " << i;
+            EXPECT_EQ(bunch.Bin[i], bin[i]) << "particle " << i;
+            for (unsigned int d = 0; d < 3; ++ d) {
+                EXPECT_EQ(batchE[i](d), E[i](d)) << "particle " << i;
+                EXPECT_EQ(batchB[i](d), B[i](d)) << "particle " << i;
+            }
+            if (outOfBounds[i]) ++ expectedLost;
+        }
+        EXPECT_EQ(numLost, expectedLost);
+        EXPECT_EQ(cyclotron.lossDs_m->size(), 2 * expectedLost);
+        EXPECT_GT(expectedLost, 0u);
+        EXPECT_LT(expectedLost, n);
+    }
+}
@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+
+#include "AbstractObjects/OpalData.h"
+#include "Fields/Fieldmap.h"
+#include "Fields/FieldmapCache.h"
+#include "Utilities/Options.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // grid of the test maps in cm, nx, ny and nz cells
+    const double xmin = -1.0, xmax = 1.0;
+    const double ymin = -1.5, ymax = 1.5;
+    const double zmin = 0.0, zmax = 5.0;
+    const unsigned int nx = 4, ny = 6, nz = 10;
+
+    double component(unsigned int c, double x, double y, double z) {
+        return (c + 1) * (0.3 + 0.2 * x - 0.1 * y * y + 0.05 * x * z) + std::sin(z + c);
+    }
+
+    void writeMap(const std::string& filename, bool dynamic) {
+        std::ofstream out(filename);
+        out << std::setprecision(17);
+        out << (dynamic ? "3DDynamic" : "3DMagnetoStatic") << " FALSE\n";
+        if (dynamic) {
+            out << "1300.0\n";
+        }
+        out << xmin << " " << xmax << " " << nx << "\n"
+            << ymin << " " << ymax << " " << ny << "\n"
+            << zmin << " " << zmax << " " << nz << "\n";
+
+        const unsigned int numComponents = (dynamic ? 6 : 3);
+        for (unsigned int i = 0; i <= nx; ++ i) {
+            const double x = xmin + i * (xmax - xmin) / nx;
+            for (unsigned int j = 0; j <= ny; ++ j) {
+                const double y = ymin + j * (ymax - ymin) / ny;
+                for (unsigned int k = 0; k <= nz; ++ k) {
+                    const double z = zmin + k * (zmax - zmin) / nz;
+                    for (unsigned int c = 0; c < numComponents; ++ c) {
+                        out << (c > 0 ? " " : "") << component(c, x, y, z);
+                    }
+                    out << "\n";
+                }
+            }
+        }
+    }
+
+    // points inside and outside of the map, in m; the number of points
+    // isn't a multiple of the block size of the batched evaluation
+    std::vector<Vector_t> getPoints() {
+        const size_t n = 101;
+        std::vector<Vector_t> points(n);
+        for (size_t i = 0; i < n; ++ i) {
+            const double u = std::fmod(0.6180339887 * i, 1.0);
+            const double v = std::fmod(0.7548776662 * i, 1.0);
+            const double w = std::fmod(0.5698402910 * i, 1.0);
+            points[i] = Vector_t({-0.012 + 0.024 * u,
+                                  -0.017 + 0.034 * v,
+                                  -0.005 + 0.06 * w});
+        }
+        return points;
+    }
+
+    struct Result {
+        std::vector<Vector_t> E, B;
+        std::vector<bool> outOfBounds;
+    };
+
+    // evaluates the map with getFieldstrength and checks that
+    // getFieldstrengthBatch gives the same
+    Result evaluate(const std::string& filename) {
+        Fieldmap map = _Fieldmap::getFieldmap(filename);
+        _Fieldmap::readMap(filename);
+
+        const std::vector<Vector_t> points = getPoints();
+        const size_t n = points.size();
+
+        Result result{std::vector<Vector_t>(n, Vector_t(0.0)),
+                      std::vector<Vector_t>(n, Vector_t(0.0)),
+                      std::vector<bool>(n)};
+        for (size_t i = 0; i < n; ++ i) {
+            result.outOfBounds[i] = map->getFieldstrength(points[i], result.E[i], result.B[i]);
+        }
+
+        std::vector<Vector_t> E(n, Vector_t(0.0)), B(n, Vector_t(0.0));
+        std::unique_ptr<bool[]> outOfBounds(new bool[n]);
+        map->getFieldstrengthBatch(points.data(), n, E.data(), B.data(), outOfBounds.get());
+
+        size_t numOutOfBounds = 0, numWithField = 0;
+        for (size_t i = 0; i < n; ++ i) {
+            EXPECT_EQ(outOfBounds[i], result.outOfBounds[i]) << "point " << i;
+            for (unsigned int d = 0; d < 3; ++ d) {
+                EXPECT_EQ(E[i](d), result.E[i](d)) << "point " << i;
+                EXPECT_EQ(B[i](d), result.B[i](d)) << "point " << i;
+            }
+            if (result.outOfBounds[i]) {
+                ++ numOutOfBounds;
+            } else if (result.B[i](0) != 0.0) {
+                ++ numWithField;
+            }
+        }
+        EXPECT_GT(numOutOfBounds, 0u);
+        EXPECT_GT(numWithField, 0u);
+        EXPECT_LT(numOutOfBounds + numWithField, n);
+
+        map.reset();
+        _Fieldmap::deleteFieldmap(filename);
+
+        return result;
+    }
+
+    void expectEqual(const Result& left, const Result& right) {
+        ASSERT_EQ(left.E.size(), right.E.size());
+        for (size_t i = 0; i < left.E.size(); ++ i) {
+            EXPECT_EQ(left.outOfBounds[i], right.outOfBounds[i]) << "point " << i;
+            for (unsigned int d = 0; d < 3; ++ d) {
+                EXPECT_EQ(left.E[i](d), right.E[i](d)) << "point " << i;
+                EXPECT_EQ(left.B[i](d), right.B[i](d)) << "point " << i;
+            }
+        }
+    }
+
+    // without cache, on a cache miss and on a cache hit
+    void testMap(const std::string& filename, bool dynamic) {
+        OpalTestUtilities::SilenceTest silencer;
+
+        writeMap(filename, dynamic);
+        fs::create_directories(OpalData::getInstance()->getAuxiliaryOutputDirectory());
+        const std::string cacheFile = FieldmapCache::getCacheFileName(filename);
+        fs::remove(cacheFile);
+
+        const bool cacheFieldmaps = Options::cacheFieldmaps;
+        Options::cacheFieldmaps = false;
+        const Result uncached = evaluate(filename);
+
+        Options::cacheFieldmaps = true;
+        const Result cacheMiss = evaluate(filename);
+        EXPECT_TRUE(FieldmapCache::hasValidCache(filename, dynamic ? 6 : 3,
+                                                 (nx + 1) * (ny + 1) * (nz + 1)));
+        const Result cacheHit = evaluate(filename);
+        Options::cacheFieldmaps = cacheFieldmaps;
+
+        expectEqual(cacheMiss, uncached);
+        expectEqual(cacheHit, uncached);
+
+        fs::remove(cacheFile);
+        fs::remove(filename);
+    }
+}
+
+TEST(FM3DTest, Dynamic) {
+    testMap("FM3DTest_dynamic.T7", true);
+}
+
+TEST(FM3DTest, MagnetoStatic) {
+    testMap("FM3DTest_magnetostatic.T7", false);
+}
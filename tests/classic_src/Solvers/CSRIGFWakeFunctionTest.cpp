@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+#include "Solvers/CSRIGFWakeFunction.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+    void setMomentum(PartBunch& bunch, double pz) {
+        for (size_t i = 0; i < bunch.getLocalNum(); ++ i) {
+            bunch.P[i] = Vector_t({0.0, 0.0, pz});
+        }
+    }
+}
+
+// the tracker doesn't compute the moments of the bunch in every step, the
+// Green function has to use the energy of the bunch when the wake is applied
+TEST(CSRIGFWakeFunctionTest, GreenFunctionUsesCurrentEnergy)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_e * Units::GeV2eV, 1.0e7);
+    PartBunch bunch(&data);
+
+    const size_t numParticles = 1000;
+    bunch.create(numParticles);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        bunch.R[i] = Vector_t({0.0, 0.0, 1.0e-3 * i / numParticles});
+        bunch.Q[i] = -1.0e-15;
+        bunch.M[i] = data.getM() * Units::eV2MeV;
+        bunch.Ef[i] = Vector_t(0.0);
+    }
+
+    const unsigned int numBins = 64;
+    CSRIGFWakeFunction wake("CSR", std::vector<Filter*>(), numBins);
+    wake.bendRadius_m = 1.0;
+    wake.totalBendAngle_m = 1.0;
+    wake.FieldBegin_m = -0.5;
+
+    setMomentum(bunch, 10.0);
+    wake.apply(&bunch);
+    const std::vector<double> oldGreenFunction(wake.Grn_m);
+
+    // the energy changes without a call to calcBeamParameters()
+    const double pz = 20.0;
+    setMomentum(bunch, pz);
+    wake.apply(&bunch);
+
+    CSRIGFWakeFunction reference("CSR", std::vector<Filter*>(), numBins);
+    reference.bendRadius_m = wake.bendRadius_m;
+    reference.lineDensity_m.assign(wake.lineDensity_m.begin(), wake.lineDensity_m.end());
+    reference.Chi_m.resize(wake.Chi_m.size(), 0.0);
+    reference.Grn_m.resize(wake.Grn_m.size(), 0.0);
+    reference.calculateGreenFunction(std::sqrt(pz * pz + 1.0),
+                                     bunch.getLongitudinalProfile(numBins).hz);
+
+    ASSERT_EQ(wake.Grn_m.size(), reference.Grn_m.size());
+    EXPECT_NE(wake.Grn_m[0], oldGreenFunction[0]);
+    for (size_t i = 0; i < reference.Grn_m.size(); ++ i) {
+        EXPECT_NEAR(wake.Grn_m[i], reference.Grn_m[i], 1e-9 * std::abs(reference.Grn_m[i]));
+    }
+}
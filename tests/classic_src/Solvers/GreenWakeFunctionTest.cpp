@@ -73,3 +73,34 @@ TEST(GreenWakeFunctionTest, TestApply)
         EXPECT_NEAR(      OutEnergy[gwf.NBin_m-1], finalEnergyValues[acmode-1], relativeErrorEnergy[acmode-1]);
     }
 }
+
+TEST(GreenWakeFunctionTest, TestFFTPlanReuse)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    std::vector<Filter *> filters;
+    GreenWakeFunction gwf("opal", filters, 100, 1e3, 0.1, 1, 1, 1, WakeDirection::LONGITUDINAL, true, "");
+    gwf.NBin_m = 10;
+    gwf.FftWField_m.resize(2 * gwf.NBin_m - 1);
+    gwf.CalcWakeFFT(1e-6);
+
+    double charge = 0.8e-9;
+    double K = 0.20536314319923724e-9;
+    std::vector<double> firstEnergy(gwf.NBin_m), secondEnergy(gwf.NBin_m);
+    gwf.compEnergy(K, charge, testLambda, firstEnergy.data());
+    EXPECT_EQ(gwf.fft_m.getLength(), 2 * gwf.NBin_m - 1);
+
+    // the second call reuses the wavetables and the scratch buffer and
+    // has to give the same result
+    gwf.compEnergy(K, charge, testLambda, secondEnergy.data());
+    EXPECT_EQ(gwf.fft_m.getLength(), 2 * gwf.NBin_m - 1);
+    for (int i = 0; i < gwf.NBin_m; ++ i) {
+        EXPECT_DOUBLE_EQ(secondEnergy[i], firstEnergy[i]);
+    }
+
+    // the wavetables are reallocated if the number of bins changes
+    gwf.NBin_m = 12;
+    gwf.FftWField_m.resize(2 * gwf.NBin_m - 1);
+    gwf.CalcWakeFFT(1e-6);
+    EXPECT_EQ(gwf.fft_m.getLength(), 2 * gwf.NBin_m - 1);
+}
@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include "FieldLayout/FieldLayout.h"
+#include "Particle/ParticleSpatialLayout.h"
+#include "Particle/IpplParticleBase.h"
+
+#include <vector>
+
+namespace {
+    class Particles: public IpplParticleBase< ParticleSpatialLayout<double, 3> > {
+    public:
+        ParticleAttrib<double> q;
+
+        Particles(ParticleSpatialLayout<double,3>* psl) :
+            IpplParticleBase<ParticleSpatialLayout<double, 3> >(psl) {
+            addAttribute(q);
+        }
+    };
+}
+
+TEST(Particle, Permute)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    Index I(4), J(4), K(4);
+    FieldLayout<3> layout(I, J, K, PARALLEL, PARALLEL, PARALLEL, 1);
+    Particles parts(new ParticleSpatialLayout<double,3>(layout));
+
+    const size_t np = 5;
+    parts.create(np);
+    for (size_t i = 0; i < np; ++ i) {
+        parts.R[i] = Vektor<double, 3>({1.0 * i, 2.0 * i, 3.0 * i});
+        parts.q[i] = 10.0 * i;
+    }
+
+    ParticleAttribBase::SortList_t order = {3, 0, 4, 1, 2};
+    parts.permute(order);
+
+    // all attributes are reordered consistently, the list is unchanged
+    for (size_t i = 0; i < np; ++ i) {
+        EXPECT_EQ(parts.R[i](0), order[i]);
+        EXPECT_EQ(parts.R[i](2), 3.0 * order[i]);
+        EXPECT_EQ(parts.q[i], 10.0 * order[i]);
+        EXPECT_EQ(parts.ID[i], parts.ID[0] + order[i] - order[0]);
+    }
+    EXPECT_EQ(order, ParticleAttribBase::SortList_t({3, 0, 4, 1, 2}));
+}
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+
+#include "Algorithms/StepSizeConfig.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+TEST(StepSizeConfigTest, SingleRate)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    StepSizeConfig config;
+    config.push_back(2e-12, 0.2, 50);
+    config.push_back(1e-12, 0.1, 100);
+    config.sortAscendingZStop();
+    config.resetIterator();
+
+    EXPECT_DOUBLE_EQ(config.getdT(), 1e-12);
+    EXPECT_EQ(config.getNumSteps(), 100ul);
+    EXPECT_EQ(config.getNumSubsteps(), 1u);
+
+    ++ config;
+    EXPECT_DOUBLE_EQ(config.getdT(), 2e-12);
+    EXPECT_EQ(config.getNumSteps(), 50ul);
+    EXPECT_EQ(config.getNumSubsteps(), 1u);
+
+    EXPECT_EQ(config.getMaxSteps(), 150ull);
+    EXPECT_DOUBLE_EQ(config.getMinTimeStep(), 1e-12);
+    EXPECT_EQ(config.getNumStepsFinestResolution(), 200ull);
+}
+
+TEST(StepSizeConfigTest, Substeps)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    // the time steps and numbers of steps refer to the substeps of the
+    // multiple time stepping integrator
+    StepSizeConfig config;
+    config.push_back(1e-12, 0.1, 100, 4);
+    config.push_back(2e-12, 0.2, 50, 0);
+    config.sortAscendingZStop();
+    config.resetIterator();
+
+    EXPECT_DOUBLE_EQ(config.getdT(), 0.25e-12);
+    EXPECT_EQ(config.getNumSteps(), 400ul);
+    EXPECT_EQ(config.getNumSubsteps(), 4u);
+
+    ++ config;
+    EXPECT_DOUBLE_EQ(config.getdT(), 2e-12);
+    EXPECT_EQ(config.getNumSteps(), 50ul);
+    EXPECT_EQ(config.getNumSubsteps(), 1u);
+
+    EXPECT_EQ(config.getMaxSteps(), 450ull);
+    EXPECT_DOUBLE_EQ(config.getMinTimeStep(), 0.25e-12);
+    EXPECT_EQ(config.getNumStepsFinestResolution(), 800ull);
+
+    // the copy starts at the first configuration
+    StepSizeConfig copy(config);
+    EXPECT_EQ(copy.getNumSubsteps(), 4u);
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include "AbstractObjects/OpalData.h"
+#include "BasicActions/Option.h"
+#include "OpalParser/OpalParser.h"
+#include "Parser/Statement.h"
+#include "Parser/StringStream.h"
+#include "Utilities/OpalException.h"
+#include "Utilities/Options.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+    void runStatement(const std::string& input) {
+        if (OpalData::getInstance()->find("OPTION") == nullptr) {
+            OpalData::getInstance()->create(new Option());
+        }
+
+        OpalParser parser;
+        StringStream stream(input);
+        std::unique_ptr<Statement> statement(parser.readStatement(&stream));
+        parser.parse(*statement);
+    }
+}
+
+TEST(OptionTest, PlainOption) {
+    OpalTestUtilities::SilenceTest silencer;
+
+    EXPECT_NO_THROW(runStatement("OPTION, ECHO=FALSE;"));
+    EXPECT_EQ(Options::numThreads, 0);
+}
+
+TEST(OptionTest, NumThreads) {
+    OpalTestUtilities::SilenceTest silencer;
+
+    EXPECT_NO_THROW(runStatement("OPTION, NUMTHREADS=1;"));
+    EXPECT_EQ(Options::numThreads, 1);
+
+    // the value is kept by later OPTION statements
+    EXPECT_NO_THROW(runStatement("OPTION, ECHO=FALSE;"));
+    EXPECT_EQ(Options::numThreads, 1);
+
+    EXPECT_THROW(runStatement("OPTION, NUMTHREADS=-1;"), OpalException);
+
+    EXPECT_NO_THROW(runStatement("OPTION, NUMTHREADS=0;"));
+    EXPECT_EQ(Options::numThreads, 0);
+}
+
+TEST(OptionTest, SpaceChargeSolveTolerance) {
+    OpalTestUtilities::SilenceTest silencer;
+
+    EXPECT_THROW(runStatement("OPTION, SCSOLVETOL=-0.1;"), OpalException);
+
+    EXPECT_NO_THROW(runStatement("OPTION, SCSOLVETOL=0.01;"));
+    EXPECT_DOUBLE_EQ(Options::scSolveTol, 0.01);
+
+    EXPECT_NO_THROW(runStatement("OPTION, ECHO=FALSE;"));
+    EXPECT_DOUBLE_EQ(Options::scSolveTol, 0.01);
+
+    // zero switches the criterion off again
+    EXPECT_NO_THROW(runStatement("OPTION, SCSOLVETOL=0;"));
+    EXPECT_DOUBLE_EQ(Options::scSolveTol, 0.0);
+}
+
+TEST(OptionTest, TraceTimers) {
+    OpalTestUtilities::SilenceTest silencer;
+
+    EXPECT_THROW(runStatement("OPTION, TRACETIMERS=-1;"), OpalException);
+    EXPECT_EQ(Options::traceTimers, 0u);
+
+    EXPECT_NO_THROW(runStatement("OPTION, TRACETIMERS=0;"));
+    EXPECT_EQ(Options::traceTimers, 0u);
+}
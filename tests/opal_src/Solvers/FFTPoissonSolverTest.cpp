@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include "Algorithms/PBunchDefs.h"
+#include "Solvers/FFTPoissonSolver.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace {
+    // mesh of the bunch with nr nodes and a Gaussian charge density which
+    // is off center and has different widths in x, y and z
+    class ReferenceCharge {
+    public:
+        ReferenceCharge():
+            hr_m({1.0e-4, 1.5e-4, 2.0e-4})
+        {
+            NDIndex<3> domain;
+            for (unsigned int d = 0; d < 3; ++ d) {
+                domain[d] = Index(nr_m[d] + 1);
+            }
+            e_dim_tag decomp[3] = {SERIAL, PARALLEL, PARALLEL};
+            mesh_m.reset(new Mesh_t(domain));
+            mesh_m->set_meshSpacing(&(hr_m[0]));
+            layout_m.reset(new FieldLayout_t(*mesh_m, decomp));
+
+            for (unsigned int i = 0; i < 2 * 3; ++ i) {
+                bc_m[i] = new ZeroFace<double, 3, Mesh_t, Center_t>(i);
+                vbc_m[i] = new ZeroFace<Vector_t, 3, Mesh_t, Center_t>(i);
+            }
+        }
+
+        // potential and field of the charge density computed with solver
+        void solve(FFTPoissonSolver& solver, bool imageCharges,
+                   Field_t& phi, VField_t& eg) {
+            phi.initialize(*mesh_m, *layout_m, GuardCellSizes<3>(1), bc_m);
+            eg.initialize(*mesh_m, *layout_m, GuardCellSizes<3>(1), vbc_m);
+
+            Index I(nr_m[0]), J(nr_m[1]), K(nr_m[2]);
+            phi[I][J][K] = exp(-(I - 6.3) * (I - 6.3) / 8.0
+                               -(J - 7.9) * (J - 7.9) / 12.0
+                               -(K - 9.1) * (K - 9.1) / 20.0);
+            if (imageCharges) {
+                solver.computePotential(phi, hr_m, 3.0e-3);
+            } else {
+                solver.computePotential(phi, hr_m);
+            }
+            eg = -Grad(phi, eg);
+        }
+
+        Mesh_t* getMesh() { return mesh_m.get(); }
+        FieldLayout_t* getLayout() { return layout_m.get(); }
+
+    private:
+        const Vektor<int, 3> nr_m = Vektor<int, 3>({12, 16, 20});
+        Vector_t hr_m;
+        std::unique_ptr<Mesh_t> mesh_m;
+        std::unique_ptr<FieldLayout_t> layout_m;
+        BConds<double, 3, Mesh_t, Center_t> bc_m;
+        BConds<Vector_t, 3, Mesh_t, Center_t> vbc_m;
+    };
+
+    // compare the solution of the pruned FFTs with the one of the full FFTs
+    void comparePrunedFFT(const std::string& greensFunction, const std::string& bcz,
+                          bool imageCharges) {
+        ReferenceCharge charge;
+        FFTPoissonSolver full(charge.getMesh(), charge.getLayout(), greensFunction, bcz,
+                              "FFTPACK", 0.0, false);
+        FFTPoissonSolver pruned(charge.getMesh(), charge.getLayout(), greensFunction, bcz,
+                                "FFTPACK", 0.0, true);
+
+        Field_t phiFull, phiPruned;
+        VField_t egFull, egPruned;
+        charge.solve(full, imageCharges, phiFull, egFull);
+        charge.solve(pruned, imageCharges, phiPruned, egPruned);
+
+        const double phiMax = max(fabs(phiFull));
+        EXPECT_GT(phiMax, 0.0);
+        EXPECT_LT(max(fabs(phiPruned - phiFull)), 1e-12 * phiMax);
+
+        const double egNorm = sum(dot(egFull, egFull));
+        EXPECT_GT(egNorm, 0.0);
+        EXPECT_LT(sum(dot(egPruned - egFull, egPruned - egFull)), 1e-24 * egNorm);
+    }
+}
+
+TEST(FFTPoissonSolverTest, PrunedFFTOpenSpace)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    comparePrunedFFT("STANDARD", "OPEN", false);
+    comparePrunedFFT("INTEGRATED", "OPEN", false);
+}
+
+TEST(FFTPoissonSolverTest, PrunedFFTImageCharges)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    comparePrunedFFT("INTEGRATED", "OPEN", true);
+}
+
+TEST(FFTPoissonSolverTest, PrunedFFTPeriodicZ)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    comparePrunedFFT("STANDARD", "PERIODIC", false);
+}
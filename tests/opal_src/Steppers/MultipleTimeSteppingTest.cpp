@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include "Algorithms/PartData.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+#include "Steppers/BorisPusher.h"
+#include "Steppers/MultipleTimeStepping.h"
+#include "Utilities/OpalException.h"
+
+#include <cmath>
+
+namespace {
+    // a proton gyrates in a uniform magnetic field, the fast external
+    // field, and is focused by a weak linear electric field which stands in
+    // for the slow self fields
+    const double magneticField = 1.0;   // [T]
+    const double focusing = 2.5e5;      // [V / m^2]
+
+    struct Particle {
+        Vector_t R;
+        Vector_t P;
+    };
+
+    void push(Vector_t& R, const Vector_t& P, double dt) {
+        R += 0.5 * dt * Physics::c * P / std::sqrt(1.0 + dot(P, P));
+    }
+
+    Vector_t getSelfField(const Vector_t& R) {
+        return Vector_t({-focusing * R(0), -focusing * R(1), 0.0});
+    }
+
+    // the sequence of a step of ParallelTTracker::execute
+    Particle track(const BorisPusher& pusher, const MultipleTimeStepping& mts,
+                   double dt, unsigned long long numSteps) {
+        Particle particle{Vector_t({1.0e-3, 0.0, 0.0}), Vector_t({0.0, 0.01, 0.0})};
+        for (unsigned long long step = 0; step < numSteps; ++ step) {
+            push(particle.R, particle.P, dt);
+
+            Vector_t Ef(0.0), Bf(0.0);
+            if (mts.isSelfFieldStep(step)) {
+                Ef = getSelfField(particle.R);
+                if (mts.getNumSubsteps() > 1) {
+                    Ef *= mts.getSelfFieldWeight();
+                }
+            }
+            Bf += Vector_t({0.0, 0.0, magneticField});
+
+            pusher.kick(particle.R, particle.P, Ef, Bf, dt);
+            push(particle.R, particle.P, dt);
+        }
+
+        return particle;
+    }
+
+    // the single-rate integrator before multiple time stepping was added
+    Particle trackSingleRate(const BorisPusher& pusher, double dt, unsigned long long numSteps) {
+        Particle particle{Vector_t({1.0e-3, 0.0, 0.0}), Vector_t({0.0, 0.01, 0.0})};
+        for (unsigned long long step = 0; step < numSteps; ++ step) {
+            push(particle.R, particle.P, dt);
+
+            Vector_t Ef(0.0), Bf(0.0);
+            Ef = getSelfField(particle.R);
+            Bf += Vector_t({0.0, 0.0, magneticField});
+
+            pusher.kick(particle.R, particle.P, Ef, Bf, dt);
+            push(particle.R, particle.P, dt);
+        }
+
+        return particle;
+    }
+
+    double getDistance(const Particle& a, const Particle& b) {
+        return std::sqrt(dot(a.R - b.R, a.R - b.R));
+    }
+}
+
+TEST(MultipleTimeStepping, Schedule)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    EXPECT_THROW(MultipleTimeStepping(2), OpalException);
+    EXPECT_THROW(MultipleTimeStepping(4), OpalException);
+
+    MultipleTimeStepping mts(5);
+    mts.setFirstStep(7);
+    for (unsigned long long step = 7; step < 22; ++ step) {
+        EXPECT_EQ(mts.isSelfFieldStep(step), (step - 7) % 5 == 2);
+    }
+    EXPECT_DOUBLE_EQ(mts.getSelfFieldWeight(), 5.0);
+
+    MultipleTimeStepping singleRate;
+    singleRate.setFirstStep(3);
+    for (unsigned long long step = 3; step < 10; ++ step) {
+        EXPECT_TRUE(singleRate.isSelfFieldStep(step));
+        EXPECT_EQ(singleRate.getSelfFieldStep(step), step);
+    }
+}
+
+TEST(MultipleTimeStepping, OneSubstepIsSingleRate)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e7);
+    BorisPusher pusher(data);
+
+    const double dt = 1.0e-9;
+    const unsigned long long numSteps = 500;
+    Particle singleRate = trackSingleRate(pusher, dt, numSteps);
+    Particle mts = track(pusher, MultipleTimeStepping(1), dt, numSteps);
+
+    for (unsigned int d = 0; d < 3; ++ d) {
+        EXPECT_EQ(mts.R(d), singleRate.R(d));
+        EXPECT_EQ(mts.P(d), singleRate.P(d));
+    }
+}
+
+TEST(MultipleTimeStepping, Convergence)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e7);
+    BorisPusher pusher(data);
+
+    // an eighth of the period of the gyration
+    const double gamma = std::sqrt(1.0 + 0.01 * 0.01);
+    const double cyclotronFrequency = magneticField * Physics::c * Physics::c / (gamma * data.getM());
+    const double dt = Physics::two_pi / cyclotronFrequency / 8;
+    const unsigned long long numSteps = 64;
+    const unsigned int numSubsteps = 3;
+
+    const Particle reference = trackSingleRate(pusher, dt / (numSubsteps * 64),
+                                               numSteps * numSubsteps * 64);
+
+    MultipleTimeStepping mts(numSubsteps);
+    const double error = getDistance(track(pusher, mts, dt / numSubsteps,
+                                           numSteps * numSubsteps),
+                                     reference);
+    const double errorHalfStep = getDistance(track(pusher, mts, dt / (2 * numSubsteps),
+                                                   2 * numSteps * numSubsteps),
+                                             reference);
+    const double errorSingleRate = getDistance(trackSingleRate(pusher, dt, numSteps),
+                                               reference);
+
+    // second order in the time step and more accurate than the single-rate
+    // integrator with the same time step of the self fields
+    EXPECT_GT(error / errorHalfStep, 3.0);
+    EXPECT_LT(error, errorSingleRate);
+}
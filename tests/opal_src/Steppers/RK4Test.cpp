@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "Physics/Physics.h"
+#include "Steppers/RK4.h"
+
+namespace {
+    // uniform magnetic and electric field, particles beyond xMax_m are out of bound
+    struct UniformField {
+        PartBunchBase<double, 3>* bunch_m;
+        double xMax_m;
+
+        bool operator()(const double& /*t*/, const size_t& i,
+                        Vector_t& Efield, Vector_t& Bfield) const {
+            Efield = Vector_t({0.0, 0.0, 1.0e5});
+            Bfield = Vector_t({0.1, 0.0, 1.0});
+            return bunch_m->R[i](0) > xMax_m;
+        }
+    };
+
+    // same field, can also evaluate several particles at once
+    struct UniformBlockField: public UniformField {
+        size_t* numBlockCalls_m;
+
+        using UniformField::operator();
+
+        void operator()(const double& t, const size_t* indices, size_t n,
+                        Vector_t* Efield, Vector_t* Bfield, bool* outOfBound) const {
+            ++ (*numBlockCalls_m);
+            for (size_t k = 0; k < n; ++ k) {
+                outOfBound[k] = (*this)(t, indices[k], Efield[k], Bfield[k]);
+            }
+        }
+    };
+}
+
+TEST(RK4, AdvanceBlock)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data;
+    PartBunch bunch(&data);
+
+    const size_t numParticles = 150;    // more than two blocks
+    bunch.create(numParticles);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        bunch.R[i] = Vector_t({1.0e-3 * i, -2.0e-3 * i, 0.0});
+        bunch.P[i] = Vector_t({0.1, 0.01 * i, 0.0});
+        bunch.Q[i] = Physics::q_e;
+        bunch.M[i] = Physics::m_p;
+        bunch.Bin[i] = 0;
+    }
+
+    UniformField field{&bunch, 0.1};
+    RK4<UniformField> stepper(field);
+
+    const double t = 0.0;
+    const double dt = 1.0e-9;
+
+    std::vector<Vector_t> R(numParticles), P(numParticles);
+    std::vector<int> bin(numParticles);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        R[i] = bunch.R[i];
+        P[i] = bunch.P[i];
+    }
+
+    bool anyLost = false;
+    for (size_t i = 0; i < numParticles; ++ i) {
+        anyLost |= stepper.advance(&bunch, i, t, dt);
+        std::swap(R[i], bunch.R[i]);
+        std::swap(P[i], bunch.P[i]);
+        bin[i] = bunch.Bin[i];
+        bunch.Bin[i] = 0;
+    }
+    EXPECT_TRUE(anyLost);
+
+    EXPECT_EQ(stepper.advanceBlock(&bunch, 0, numParticles, t, dt), anyLost);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            EXPECT_DOUBLE_EQ(bunch.R[i](d), R[i](d));
+            EXPECT_DOUBLE_EQ(bunch.P[i](d), P[i](d));
+        }
+        EXPECT_EQ(bunch.Bin[i], bin[i]);
+    }
+}
+
+TEST(RK4, AdvanceBlockWithBlockFieldFunction)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    static_assert(!hasBlockFieldFunction<UniformField>::value);
+    static_assert(hasBlockFieldFunction<UniformBlockField>::value);
+
+    PartData data;
+    PartBunch bunch(&data);
+
+    const size_t numParticles = 150;
+    bunch.create(numParticles);
+    std::vector<Vector_t> R(numParticles), P(numParticles);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        R[i] = Vector_t({1.0e-3 * i, -2.0e-3 * i, 0.0});
+        P[i] = Vector_t({0.1, 0.01 * i, 0.0});
+        bunch.R[i] = R[i];
+        bunch.P[i] = P[i];
+        bunch.Q[i] = Physics::q_e;
+        bunch.M[i] = Physics::m_p;
+        bunch.Bin[i] = 0;
+    }
+
+    UniformField field{&bunch, 0.1};
+    RK4<UniformField> stepper(field);
+
+    size_t numBlockCalls = 0;
+    UniformBlockField blockField{{&bunch, 0.1}, &numBlockCalls};
+    RK4<UniformBlockField> blockStepper(blockField);
+
+    const double t = 0.0;
+    const double dt = 1.0e-9;
+
+    const bool anyLost = stepper.advanceBlock(&bunch, 0, numParticles, t, dt);
+    EXPECT_TRUE(anyLost);
+    std::vector<Vector_t> expectedR(numParticles), expectedP(numParticles);
+    std::vector<int> bin(numParticles);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        expectedR[i] = bunch.R[i];
+        expectedP[i] = bunch.P[i];
+        bin[i] = bunch.Bin[i];
+        bunch.R[i] = R[i];
+        bunch.P[i] = P[i];
+        bunch.Bin[i] = 0;
+    }
+
+    EXPECT_EQ(blockStepper.advanceBlock(&bunch, 0, numParticles, t, dt), anyLost);
+    // one call per stage and block
+    EXPECT_EQ(numBlockCalls, 4 * 3u);
+    for (size_t i = 0; i < numParticles; ++ i) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            EXPECT_EQ(bunch.R[i](d), expectedR[i](d));
+            EXPECT_EQ(bunch.P[i](d), expectedP[i](d));
+        }
+        EXPECT_EQ(bunch.Bin[i], bin[i]);
+    }
+}
@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include "Algorithms/CoordinateSystemTrafo.h"
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "Algorithms/Quaternion.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+#include "Steppers/SpaceChargeSubcycling.h"
+#include "Utilities/Options.h"
+
+#include <limits>
+
+namespace {
+    // repartitioning is off, as with a single process
+    const unsigned int noRepartition = std::numeric_limits<unsigned int>::max();
+
+    const Vector_t rrms({1.0e-3, 2.0e-3, 3.0e-3});
+    const double meanGamma = 1.01;
+
+    // the space charge fields of a solve in step, in the frame of the beam
+    Vector_t getE(size_t i, unsigned long long step) {
+        return Vector_t({1.0 * i, -2.0 * step, 3.0 + i * step});
+    }
+
+    Vector_t getB(size_t i, unsigned long long step) {
+        return Vector_t({-0.5 * step, 0.25 * i, 1.0 + step});
+    }
+
+    void fillBunch(PartBunch& bunch, size_t n) {
+        bunch.create(n);
+        for (size_t i = 0; i < n; ++ i) {
+            bunch.R[i] = Vector_t({0.001 * i, -0.001 * i, 0.002 * i});
+            bunch.P[i] = Vector_t({0.0, 0.0, 0.1});
+            bunch.Q[i] = Physics::q_e;
+            bunch.M[i] = Physics::m_p;
+            bunch.Bin[i] = 0;
+        }
+    }
+
+    // the transformation of ParallelTTracker::computeSpaceChargeFields for
+    // the mean momentum meanP
+    CoordinateSystemTrafo getBeamToReference(const Vector_t& meanP) {
+        Quaternion alignment = getQuaternion(meanP, Vector_t({0, 0, 1}));
+        return CoordinateSystemTrafo(Vector_t(0.0), alignment.conjugate());
+    }
+}
+
+TEST(SpaceChargeSubcycling, StorageOnlyIfFieldsAreReused)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    {
+        PartBunch bunch(&data);
+        fillBunch(bunch, 10);
+
+        SpaceChargeSubcycling everyStep(1);
+        EXPECT_FALSE(everyStep.isEnabled());
+        everyStep.attach(&bunch);
+        EXPECT_FALSE(bunch.hasSpaceChargeFieldStorage());
+        EXPECT_EQ(bunch.Efsc.size(), 0u);
+        EXPECT_EQ(bunch.Bfsc.size(), 0u);
+
+        // swapping particles mustn't touch the unregistered attributes
+        bunch.swap(0, 9);
+        EXPECT_EQ(bunch.Efsc.size(), 0u);
+    }
+
+    PartBunch bunch(&data);
+    fillBunch(bunch, 10);
+
+    SpaceChargeSubcycling subcycling(4);
+    EXPECT_TRUE(subcycling.isEnabled());
+    subcycling.attach(&bunch);
+    EXPECT_TRUE(bunch.hasSpaceChargeFieldStorage());
+    EXPECT_EQ(bunch.Efsc.size(), 10u);
+    EXPECT_EQ(bunch.Bfsc.size(), 10u);
+
+    // attaching twice doesn't register the attributes twice
+    subcycling.attach(&bunch);
+    bunch.create(5);
+    EXPECT_EQ(bunch.Efsc.size(), 15u);
+    EXPECT_EQ(bunch.Bfsc.size(), 15u);
+}
+
+TEST(SpaceChargeSubcycling, FieldsAreReusedBetweenSolves)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const int sortFreq = Options::sortFreq;
+    Options::sortFreq = 0;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+    const size_t n = 7;
+    fillBunch(bunch, n);
+
+    const int solveFrequency = 4;
+    SpaceChargeSubcycling subcycling(solveFrequency);
+    subcycling.attach(&bunch);
+
+    // the beam turns from the z- to the x-direction; the beam frame
+    // coordinates (x, y, z) are (-z, y, x) in the reference frame
+    const CoordinateSystemTrafo beamToReference = getBeamToReference(Vector_t({1.0, 0.0, 0.0}));
+
+    unsigned long long lastSolve = 0;
+    unsigned int numSolves = 0;
+    for (unsigned long long step = 0; step < 13; ++ step) {
+        bunch.Ef = Vector_t(0.0);
+        bunch.Bf = Vector_t(0.0);
+
+        const bool solve = subcycling.isSolveDue(step, false, noRepartition, rrms, meanGamma);
+        EXPECT_EQ(solve, step % solveFrequency == 0) << "step " << step;
+        if (solve) {
+            for (size_t i = 0; i < n; ++ i) {
+                bunch.Ef[i] = getE(i, step);
+                bunch.Bf[i] = getB(i, step);
+            }
+            subcycling.storeFields(&bunch, step, rrms, meanGamma);
+            lastSolve = step;
+            ++ numSolves;
+            continue;
+        }
+
+        subcycling.restoreFields(&bunch, beamToReference);
+        for (size_t i = 0; i < n; ++ i) {
+            const Vector_t E = getE(i, lastSolve);
+            const Vector_t B = getB(i, lastSolve);
+            EXPECT_NEAR(bunch.Ef[i](0), E(2), 1e-12) << "step " << step << ", particle " << i;
+            EXPECT_NEAR(bunch.Ef[i](1), E(1), 1e-12) << "step " << step << ", particle " << i;
+            EXPECT_NEAR(bunch.Ef[i](2), -E(0), 1e-12) << "step " << step << ", particle " << i;
+            EXPECT_NEAR(bunch.Bf[i](0), B(2), 1e-12) << "step " << step << ", particle " << i;
+            EXPECT_NEAR(bunch.Bf[i](1), B(1), 1e-12) << "step " << step << ", particle " << i;
+            EXPECT_NEAR(bunch.Bf[i](2), -B(0), 1e-12) << "step " << step << ", particle " << i;
+        }
+    }
+    EXPECT_EQ(numSolves, 4u);
+
+    // the stored fields follow the particles
+    bunch.swap(1, 5);
+    subcycling.restoreFields(&bunch, CoordinateSystemTrafo());
+    for (unsigned int d = 0; d < 3; ++ d) {
+        EXPECT_DOUBLE_EQ(bunch.Ef[1](d), getE(5, lastSolve)(d));
+        EXPECT_DOUBLE_EQ(bunch.Ef[5](d), getE(1, lastSolve)(d));
+        EXPECT_DOUBLE_EQ(bunch.Bf[1](d), getB(5, lastSolve)(d));
+        EXPECT_DOUBLE_EQ(bunch.Bf[5](d), getB(1, lastSolve)(d));
+    }
+
+    Options::sortFreq = sortFreq;
+}
+
+TEST(SpaceChargeSubcycling, SolveIsForced)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const int sortFreq = Options::sortFreq;
+    Options::sortFreq = 0;
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+    fillBunch(bunch, 3);
+
+    SpaceChargeSubcycling subcycling(10, 0.1);
+    subcycling.attach(&bunch);
+
+    // no fields are stored before the first solve
+    EXPECT_TRUE(subcycling.isSolveDue(5, false, noRepartition, rrms, meanGamma));
+    subcycling.storeFields(&bunch, 0, rrms, meanGamma);
+    EXPECT_FALSE(subcycling.isSolveDue(1, false, noRepartition, rrms, meanGamma));
+
+    // emission: the new particles have no stored fields
+    EXPECT_TRUE(subcycling.isSolveDue(1, true, noRepartition, rrms, meanGamma));
+
+    // repartitioning in step 2 with a frequency of 3
+    EXPECT_TRUE(SpaceChargeSubcycling::isRepartitionStep(2, 3));
+    EXPECT_TRUE(subcycling.isSolveDue(2, false, 3, rrms, meanGamma));
+    EXPECT_FALSE(subcycling.isSolveDue(3, false, 3, rrms, meanGamma));
+
+    // sorting in step 3 with a frequency of 4
+    Options::sortFreq = 4;
+    EXPECT_TRUE(SpaceChargeSubcycling::isSortStep(3));
+    EXPECT_TRUE(subcycling.isSolveDue(3, false, noRepartition, rrms, meanGamma));
+    EXPECT_FALSE(subcycling.isSolveDue(4, false, noRepartition, rrms, meanGamma));
+    Options::sortFreq = 0;
+
+    // changes of the beam size or the energy beyond the tolerance
+    EXPECT_FALSE(subcycling.isSolveDue(5, false, noRepartition, 1.05 * rrms, meanGamma));
+    EXPECT_TRUE(subcycling.isSolveDue(5, false, noRepartition,
+                                      Vector_t({rrms(0), 1.2 * rrms(1), rrms(2)}), meanGamma));
+    EXPECT_FALSE(subcycling.isSolveDue(5, false, noRepartition, rrms, 1.05 * meanGamma));
+    EXPECT_TRUE(subcycling.isSolveDue(5, false, noRepartition, rrms, 1.2 * meanGamma));
+
+    // the frequency
+    EXPECT_TRUE(subcycling.isSolveDue(10, false, noRepartition, rrms, meanGamma));
+
+    // without subcycling every step is solved
+    SpaceChargeSubcycling everyStep;
+    EXPECT_TRUE(everyStep.isSolveDue(1, false, noRepartition, rrms, meanGamma));
+
+    Options::sortFreq = sortFreq;
+}
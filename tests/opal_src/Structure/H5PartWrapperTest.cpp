@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include "Algorithms/PartBunch.h"
+#include "Algorithms/PartData.h"
+#include "Physics/Physics.h"
+#include "Physics/Units.h"
+#include "Structure/H5PartWrapperForPC.h"
+#include "Utilities/Options.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace {
+    std::map<std::string, double> getAdditionalStepAttributes() {
+        std::map<std::string, double> attributes;
+        for (const std::string name: {"REFPR", "REFPT", "REFPZ", "REFR", "REFTHETA",
+                                      "REFZ", "AZIMUTH", "ELEVATION"}) {
+            attributes[name] = 0.0;
+        }
+        for (const std::string name: {"B-ref", "E-ref", "B-head", "E-head", "B-tail", "E-tail"}) {
+            for (const std::string suffix: {"_x", "_y", "_z"}) {
+                attributes[name + suffix] = 0.0;
+            }
+        }
+        return attributes;
+    }
+}
+
+// restart from a subsampled OPAL-cycl dump: the macro charge and the macro
+// mass are scaled by the same factor, the charge-to-mass ratio is kept
+TEST(H5PartWrapperTest, SubsampledRestartKeepsChargeToMass)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    const std::string filename = "H5PartWrapperTest_subsample.h5";
+    const int subsample = 3;
+    const double charge = 2.0e-15;
+    const double mass = 4.0e-6;
+
+    const int psDumpSubsample = Options::psDumpSubsample;
+    const int psDumpChunkSize = Options::psDumpChunkSize;
+    Options::psDumpSubsample = subsample;
+    Options::psDumpChunkSize = 16;
+
+    const size_t n = 100;
+    {
+        PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+        PartBunch bunch(&data);
+        bunch.create(n);
+        for (size_t i = 0; i < n; ++ i) {
+            bunch.R[i] = Vector_t({1.0 + 0.001 * i, -0.002 * i, 0.0005 * i});
+            bunch.P[i] = Vector_t({0.001 * i, 0.1, -0.0001 * i});
+            bunch.Bin[i] = 0;
+            bunch.bunchNum[i] = 0;
+        }
+        bunch.setCharge(charge);
+        bunch.setMass(mass);
+
+        H5PartWrapperForPC writer(filename, H5_O_WRONLY);
+        writer.writeHeader();
+        writer.writeStep(&bunch, getAdditionalStepAttributes());
+    }
+
+    PartData data(1.0, Physics::m_p * Units::GeV2eV, 1.0e8);
+    PartBunch bunch(&data);
+    H5PartWrapperForPC reader(filename, -1, filename, H5_O_WRONLY);
+    const size_t numParticles = reader.getNumParticles();
+    // the particle with ID 0 isn't written
+    EXPECT_EQ(numParticles, (n - 1) / subsample);
+
+    bunch.create(numParticles);
+    reader.readHeader();
+    reader.readStep(&bunch, 0, numParticles - 1);
+
+    for (size_t i = 0; i < numParticles; ++ i) {
+        EXPECT_DOUBLE_EQ(bunch.Q[i], subsample * charge) << "particle " << i;
+        EXPECT_DOUBLE_EQ(bunch.M[i], subsample * mass) << "particle " << i;
+        EXPECT_DOUBLE_EQ(bunch.Q[i] / bunch.M[i], charge / mass) << "particle " << i;
+    }
+
+    Options::psDumpSubsample = psDumpSubsample;
+    Options::psDumpChunkSize = psDumpChunkSize;
+    std::remove(filename.c_str());
+}
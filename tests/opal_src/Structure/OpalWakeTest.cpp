@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include "AbsBeamline/ElementBase.h"
+#include "AbstractObjects/OpalData.h"
+#include "Elements/OpalDrift.h"
+#include "OpalParser/OpalParser.h"
+#include "Parser/Statement.h"
+#include "Parser/StringStream.h"
+#include "Solvers/GreenWakeFunction.h"
+#include "Structure/OpalWake.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+    void runStatement(const std::string& input) {
+        OpalData* opal = OpalData::getInstance();
+        if (opal->find("WAKE") == nullptr) {
+            opal->create(new OpalWake());
+        }
+        if (opal->find("DRIFT") == nullptr) {
+            opal->create(new OpalDrift());
+        }
+
+        OpalParser parser;
+        StringStream stream(input);
+        std::unique_ptr<Statement> statement(parser.readStatement(&stream));
+        parser.parse(*statement);
+    }
+
+    GreenWakeFunction* getWake(const std::string& element) {
+        OpalDrift* drift = dynamic_cast<OpalDrift*>(OpalData::getInstance()->find(element));
+        if (drift == nullptr) return nullptr;
+
+        drift->update();
+        return dynamic_cast<GreenWakeFunction*>(drift->getElement()->getWake());
+    }
+}
+
+TEST(OpalWakeTest, SharedGreenWakeFunction)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    runStatement("WK: WAKE, TYPE=\"LONG-SHORT-RANGE\", NBIN=10, CONST_LENGTH=TRUE, "
+                 "CONDUCT=\"AC\", Z0=1e3, RADIUS=0.1, SIGMA=1, TAU=1;");
+    runStatement("D1: DRIFT, L=1.0, WAKEF=\"WK\";");
+    runStatement("D2: DRIFT, L=2.0, WAKEF=\"WK\";");
+    runStatement("D4: DRIFT, L=4.0, WAKEF=\"WK\";");
+
+    GreenWakeFunction* wake1 = getWake("D1");
+    GreenWakeFunction* wake2 = getWake("D2");
+    GreenWakeFunction* wake4 = getWake("D4");
+    ASSERT_NE(wake1, nullptr);
+    ASSERT_NE(wake2, nullptr);
+    ASSERT_NE(wake4, nullptr);
+    ASSERT_NE(wake1, wake2);
+
+    // both elements use a clone of the WAKE statement
+    EXPECT_EQ(wake1->getName(), "WK");
+    EXPECT_EQ(wake2->getName(), "WK");
+
+    GreenWakeFunction::clearWakeCache();
+
+    const double spacing = 1e-6;
+    wake1->computeWakeField(spacing);
+    EXPECT_EQ(GreenWakeFunction::wakeCache_s.size(), 1u);
+
+    // the same spacing reuses the wake of the first element
+    wake2->computeWakeField(spacing);
+    EXPECT_EQ(GreenWakeFunction::wakeCache_s.size(), 1u);
+    EXPECT_EQ(wake1->FftWField_m, wake2->FftWField_m);
+
+    // an element which reaches its first apply with another bunch length
+    // computes its own wake
+    wake4->computeWakeField(2 * spacing);
+    EXPECT_EQ(GreenWakeFunction::wakeCache_s.size(), 2u);
+    EXPECT_NE(wake1->FftWField_m, wake4->FftWField_m);
+
+    // another wake definition has its own entry
+    runStatement("WK2: WAKE, TYPE=\"LONG-SHORT-RANGE\", NBIN=20, CONST_LENGTH=TRUE, "
+                 "CONDUCT=\"AC\", Z0=1e3, RADIUS=0.1, SIGMA=1, TAU=1;");
+    runStatement("D3: DRIFT, L=3.0, WAKEF=\"WK2\";");
+    GreenWakeFunction* wake3 = getWake("D3");
+    ASSERT_NE(wake3, nullptr);
+    wake3->computeWakeField(spacing);
+    EXPECT_EQ(GreenWakeFunction::wakeCache_s.size(), 3u);
+    EXPECT_NE(wake1->FftWField_m, wake3->FftWField_m);
+
+    GreenWakeFunction::clearWakeCache();
+    EXPECT_TRUE(GreenWakeFunction::wakeCache_s.empty());
+}
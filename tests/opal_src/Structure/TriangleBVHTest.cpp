@@ -0,0 +1,265 @@
+#include "gtest/gtest.h"
+
+#include "AbstractObjects/OpalData.h"
+#include "OpalParser/OpalParser.h"
+#include "Parser/Statement.h"
+#include "Parser/StringStream.h"
+#include "Physics/Physics.h"
+#include "Structure/BoundaryGeometry.h"
+#include "Structure/TriangleBVH.h"
+
+#include "opal_test_utilities/SilenceTest.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef std::array<unsigned int, 4> Triangle_t;
+
+    // tube along z with radius R; the triangles of the lower half are large,
+    // the ones of the upper half small, as in cavity meshes with a refined
+    // region with nphi x nz quadrilaterals
+    void makeTube(std::vector<Vector_t>& points, std::vector<Triangle_t>& triangles,
+                  unsigned int nphi = 256, unsigned int nz = 512) {
+        const double R = 0.05;
+        auto addSection = [&](double z0, double z1, unsigned int nphi, unsigned int nz) {
+            const unsigned int first = points.size();
+            for (unsigned int k = 0; k <= nz; ++ k) {
+                const double z = z0 + (z1 - z0) * k / nz;
+                for (unsigned int j = 0; j < nphi; ++ j) {
+                    const double phi = 2 * M_PI * j / nphi;
+                    points.push_back(Vector_t({R * std::cos(phi), R * std::sin(phi), z}));
+                }
+            }
+            for (unsigned int k = 0; k < nz; ++ k) {
+                for (unsigned int j = 0; j < nphi; ++ j) {
+                    const unsigned int a = first + k * nphi + j;
+                    const unsigned int b = first + k * nphi + (j + 1) % nphi;
+                    const unsigned int c = a + nphi;
+                    const unsigned int d = b + nphi;
+                    triangles.push_back({0, a, b, d});
+                    triangles.push_back({0, a, d, c});
+                }
+            }
+        };
+        addSection(0.0, 0.5, 16, 8);
+        addSection(0.5, 1.0, nphi, nz);
+    }
+
+    // Moeller-Trumbore, true if the segment from P to Q hits the triangle
+    bool intersectSegment(const std::vector<Vector_t>& points, const Triangle_t& tri,
+                          const Vector_t& P, const Vector_t& Q) {
+        const Vector_t& A = points[tri[1]];
+        const Vector_t e1 = points[tri[2]] - A;
+        const Vector_t e2 = points[tri[3]] - A;
+        const Vector_t dir = Q - P;
+        const Vector_t p = cross(dir, e2);
+        const double det = dot(e1, p);
+        if (std::abs(det) < 1e-300) return false;
+        const Vector_t s = P - A;
+        const double u = dot(s, p) / det;
+        if (u < 0.0 || u > 1.0) return false;
+        const Vector_t q = cross(s, e1);
+        const double v = dot(dir, q) / det;
+        if (v < 0.0 || u + v > 1.0) return false;
+        const double t = dot(e2, q) / det;
+        return t >= 0.0 && t <= 1.0;
+    }
+
+    // particle steps of length about 1 mm close to the wall of the tube
+    void makeSegments(std::vector<Vector_t>& P, std::vector<Vector_t>& Q, unsigned int n) {
+        std::mt19937_64 gen(42);
+        std::uniform_real_distribution<double> radius(0.045, 0.055);
+        std::uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+        std::uniform_real_distribution<double> height(0.01, 0.99);
+        std::normal_distribution<double> step(0.0, 1e-3);
+        for (unsigned int i = 0; i < n; ++ i) {
+            const double r = radius(gen);
+            const double phi = angle(gen);
+            P.push_back(Vector_t({r * std::cos(phi), r * std::sin(phi), height(gen)}));
+            Q.push_back(P.back() + Vector_t({step(gen), step(gen), step(gen)}));
+        }
+    }
+
+    BoundaryGeometry* makeGeometry(const std::string& name, const std::string& accelerator,
+                                   const std::vector<Vector_t>& points,
+                                   const std::vector<Triangle_t>& triangles) {
+        OpalData* opal = OpalData::getInstance();
+        if (opal->find("GEOMETRY") == nullptr) {
+            opal->create(new BoundaryGeometry());
+        }
+
+        // the point inside the tube isn't searched, the rays of the search
+        // hit vertices of the mesh
+        OpalParser parser;
+        StringStream stream(name + ": GEOMETRY, ACCELERATOR=\"" + accelerator + "\", "
+                            "INSIDEPOINT={0.001, 0.002, 0.3};");
+        std::unique_ptr<Statement> statement(parser.readStatement(&stream));
+        parser.parse(*statement);
+
+        BoundaryGeometry* geometry = BoundaryGeometry::find(name);
+        geometry->initialize(points, triangles);
+        return geometry;
+    }
+
+    // the momentum with which a particle moves from P to Q in the time dt
+    Vector_t getMomentum(const Vector_t& P, const Vector_t& Q, double dt) {
+        const Vector_t d = Q - P;
+        const double length = std::sqrt(dot(d, d));
+        const double beta = length / (Physics::c * dt);
+        return d / length * beta / std::sqrt(1.0 - beta * beta);
+    }
+}
+
+TEST(TriangleBVHTest, CandidatesContainAllHits)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    std::vector<Vector_t> points;
+    std::vector<Triangle_t> triangles;
+    makeTube(points, triangles);
+
+    TriangleBVH bvh;
+    bvh.build(points, triangles);
+    EXPECT_FALSE(bvh.empty());
+    EXPECT_LT(bvh.getNumNodes(), 2 * triangles.size());
+    EXPECT_LE(bvh.getDepth(), 64u);
+
+    std::vector<Vector_t> P, Q;
+    makeSegments(P, Q, 300);
+    // segments crossing the whole tube
+    P.push_back(Vector_t({-0.1, 0.0, 0.25}));
+    Q.push_back(Vector_t({0.1, 0.0, 0.25}));
+    P.push_back(Vector_t({0.0, -0.1, 0.75}));
+    Q.push_back(Vector_t({0.0, 0.1, 0.75}));
+
+    unsigned int numHits = 0;
+    for (unsigned int i = 0; i < P.size(); ++ i) {
+        std::multiset<int> candidates;
+        bvh.forEachCandidate(P[i], Q[i], [&](int t) { candidates.insert(t); });
+
+        for (unsigned int t = 0; t < triangles.size(); ++ t) {
+            EXPECT_LE(candidates.count(t), 1u);
+            if (intersectSegment(points, triangles[t], P[i], Q[i])) {
+                EXPECT_EQ(candidates.count(t), 1u) << "segment " << i << " triangle " << t;
+                ++ numHits;
+            }
+        }
+    }
+    EXPECT_GT(numHits, 0u);
+}
+
+TEST(TriangleBVHTest, WriteRead)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    std::vector<Vector_t> points;
+    std::vector<Triangle_t> triangles;
+    makeTube(points, triangles);
+
+    TriangleBVH bvh;
+    bvh.build(points, triangles);
+
+    std::stringstream buffer;
+    bvh.write(buffer);
+    const std::string data = buffer.str();
+
+    TriangleBVH copy;
+    ASSERT_TRUE(copy.read(buffer));
+    EXPECT_EQ(copy.getNumNodes(), bvh.getNumNodes());
+    EXPECT_EQ(copy.getNumLeaves(), bvh.getNumLeaves());
+    EXPECT_EQ(copy.getDepth(), bvh.getDepth());
+
+    std::vector<Vector_t> P, Q;
+    makeSegments(P, Q, 1000);
+    for (unsigned int i = 0; i < P.size(); ++ i) {
+        std::vector<int> expected, found;
+        bvh.forEachCandidate(P[i], Q[i], [&](int t) { expected.push_back(t); });
+        copy.forEachCandidate(P[i], Q[i], [&](int t) { found.push_back(t); });
+        EXPECT_EQ(found, expected);
+    }
+
+    // a truncated stream is rejected
+    std::istringstream in(data.substr(0, data.size() / 2));
+    EXPECT_FALSE(copy.read(in));
+    EXPECT_TRUE(copy.empty());
+}
+
+// both search structures of BoundaryGeometry find the intersections of
+// the particle steps with the triangles
+TEST(TriangleBVHTest, BoundaryGeometryBVHMatchesVoxels)
+{
+    OpalTestUtilities::SilenceTest silencer;
+
+    std::vector<Vector_t> points;
+    std::vector<Triangle_t> triangles;
+    makeTube(points, triangles, 64, 64);
+
+    BoundaryGeometry* bvhGeometry = makeGeometry("BVHGEOMETRY", "BVH", points, triangles);
+    BoundaryGeometry* voxelGeometry = makeGeometry("VOXELGEOMETRY", "VOXEL", points, triangles);
+
+    std::vector<Vector_t> P, Q;
+    makeSegments(P, Q, 300);
+    P.push_back(Vector_t({-0.1, 0.0, 0.25}));
+    Q.push_back(Vector_t({0.1, 0.0, 0.25}));
+    P.push_back(Vector_t({0.0, -0.1, 0.75}));
+    Q.push_back(Vector_t({0.0, 0.1, 0.75}));
+
+    const double dt = 1e-9;
+    std::vector<Vector_t> momenta;
+    std::vector<size_t> expectedIndices;
+    std::vector<Vector_t> expectedPoints;
+    std::vector<int> expectedIds;
+    for (unsigned int i = 0; i < P.size(); ++ i) {
+        momenta.push_back(getMomentum(P[i], Q[i], dt));
+        const Vector_t& v = momenta.back();
+        const Vector_t end = P[i] + (Physics::c * v * dt / std::sqrt(1.0 + dot(v, v)));
+
+        bool expected = false;
+        for (const Triangle_t& tri: triangles) {
+            expected = expected || intersectSegment(points, tri, P[i], end);
+        }
+
+        Vector_t bvhPoint, voxelPoint;
+        int bvhId = -1, voxelId = -1;
+        const int bvhResult = bvhGeometry->partInside(P[i], v, dt, bvhPoint, bvhId);
+        const int voxelResult = voxelGeometry->partInside(P[i], v, dt, voxelPoint, voxelId);
+        ASSERT_EQ(bvhResult == 0, expected) << "segment " << i;
+        ASSERT_EQ(voxelResult, bvhResult) << "segment " << i;
+        if (!expected) continue;
+
+        // the closest intersection to the start of the step
+        for (unsigned int d = 0; d < 3; ++ d) {
+            EXPECT_NEAR(bvhPoint(d), voxelPoint(d), 1e-12);
+        }
+        EXPECT_TRUE(intersectSegment(points, triangles[bvhId], P[i], end));
+        EXPECT_TRUE(intersectSegment(points, triangles[voxelId], P[i], end));
+
+        expectedIndices.push_back(i);
+        expectedPoints.push_back(bvhPoint);
+        expectedIds.push_back(bvhId);
+    }
+    EXPECT_GT(expectedIndices.size(), 0u);
+
+    // the bulk test of all particles gives the same intersections
+    std::vector<size_t> hitIndices;
+    std::vector<Vector_t> hitPoints;
+    std::vector<int> hitIds;
+    const size_t numHits = bvhGeometry->partInside(P.size(), P.data(), momenta.data(), dt,
+                                                   hitIndices, hitPoints, hitIds);
+    EXPECT_EQ(numHits, expectedIndices.size());
+    EXPECT_EQ(hitIndices, expectedIndices);
+    EXPECT_EQ(hitIds, expectedIds);
+    ASSERT_EQ(hitPoints.size(), expectedPoints.size());
+    for (size_t k = 0; k < hitPoints.size(); ++ k) {
+        for (unsigned int d = 0; d < 3; ++ d) {
+            EXPECT_DOUBLE_EQ(hitPoints[k](d), expectedPoints[k](d));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+//
+// geometryBench
+//   Compare the search structures of the GEOMETRY, the bounding volume
+//   hierarchy (ACCELERATOR=BVH) and the voxel mesh (ACCELERATOR=VOXEL). The
+//   mesh is a tube with a coarse and a refined section, as in cavity meshes
+//   with a refined region. The particle steps of about 1 mm close to the
+//   wall are tested for collisions with both search structures. The times
+//   of the initialization and of the collision tests are printed.
+//
+//   usage: geometryBench [nphi nz numSteps]
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "AbstractObjects/OpalData.h"
+#include "OpalParser/OpalParser.h"
+#include "Parser/Statement.h"
+#include "Parser/StringStream.h"
+#include "Physics/Physics.h"
+#include "Structure/BoundaryGeometry.h"
+
+#include "Ippl.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+Ippl* ippl;
+Inform* gmsg;
+Inform* gmsgALL;
+
+namespace {
+    typedef std::array<unsigned int, 4> Triangle_t;
+
+    void makeTube(std::vector<Vector_t>& points, std::vector<Triangle_t>& triangles,
+                  unsigned int nphi, unsigned int nz) {
+        const double R = 0.05;
+        auto addSection = [&](double z0, double z1, unsigned int nphi, unsigned int nz) {
+            const unsigned int first = points.size();
+            for (unsigned int k = 0; k <= nz; ++ k) {
+                const double z = z0 + (z1 - z0) * k / nz;
+                for (unsigned int j = 0; j < nphi; ++ j) {
+                    const double phi = 2 * M_PI * j / nphi;
+                    points.push_back(Vector_t({R * std::cos(phi), R * std::sin(phi), z}));
+                }
+            }
+            for (unsigned int k = 0; k < nz; ++ k) {
+                for (unsigned int j = 0; j < nphi; ++ j) {
+                    const unsigned int a = first + k * nphi + j;
+                    const unsigned int b = first + k * nphi + (j + 1) % nphi;
+                    triangles.push_back({0, a, b, b + nphi});
+                    triangles.push_back({0, a, b + nphi, a + nphi});
+                }
+            }
+        };
+        addSection(0.0, 0.5, 16, 8);
+        addSection(0.5, 1.0, nphi, nz);
+    }
+
+    // particle steps of length about 1 mm in the time dt close to the wall
+    void makeSteps(std::vector<Vector_t>& R, std::vector<Vector_t>& P,
+                   unsigned int n, double dt) {
+        std::mt19937_64 gen(42);
+        std::uniform_real_distribution<double> radius(0.045, 0.055);
+        std::uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+        std::uniform_real_distribution<double> height(0.01, 0.99);
+        std::normal_distribution<double> step(0.0, 1e-3);
+        for (unsigned int i = 0; i < n; ++ i) {
+            const double r = radius(gen);
+            const double phi = angle(gen);
+            R.push_back(Vector_t({r * std::cos(phi), r * std::sin(phi), height(gen)}));
+
+            const Vector_t d({step(gen), step(gen), step(gen)});
+            const double beta = std::sqrt(dot(d, d)) / (Physics::c * dt);
+            P.push_back(d / (Physics::c * dt) / std::sqrt(1.0 - beta * beta));
+        }
+    }
+
+    BoundaryGeometry* makeGeometry(const std::string& name, const std::string& accelerator) {
+        OpalData* opal = OpalData::getInstance();
+        if (opal->find("GEOMETRY") == nullptr) {
+            opal->create(new BoundaryGeometry());
+        }
+
+        OpalParser parser;
+        StringStream stream(name + ": GEOMETRY, ACCELERATOR=\"" + accelerator + "\", "
+                            "INSIDEPOINT={0.001, 0.002, 0.3};");
+        std::unique_ptr<Statement> statement(parser.readStatement(&stream));
+        parser.parse(*statement);
+
+        return BoundaryGeometry::find(name);
+    }
+
+    void run(const std::string& accelerator,
+             const std::vector<Vector_t>& points, const std::vector<Triangle_t>& triangles,
+             const std::vector<Vector_t>& R, const std::vector<Vector_t>& P, double dt) {
+        BoundaryGeometry* geometry = makeGeometry(accelerator + "GEOMETRY", accelerator);
+
+        auto start = std::chrono::steady_clock::now();
+        geometry->initialize(points, triangles);
+        std::chrono::duration<double> initialization = std::chrono::steady_clock::now() - start;
+
+        std::vector<size_t> hitIndices;
+        std::vector<Vector_t> intersections;
+        std::vector<int> triangleIds;
+        start = std::chrono::steady_clock::now();
+        const size_t numHits = geometry->partInside(R.size(), R.data(), P.data(), dt,
+                                                    hitIndices, intersections, triangleIds);
+        std::chrono::duration<double> query = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  " << accelerator << ": initialization " << initialization.count() << " s, "
+                  << "collision tests " << query.count() << " s, "
+                  << numHits << " hits" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    gmsg = new Inform("geometryBench ");
+    gmsgALL = new Inform("geometryBench ", INFORM_ALL_NODES);
+    ippl = new Ippl(argc, argv);
+
+    unsigned int nphi = 256, nz = 512, numSteps = 200000;
+    if (argc > 3) {
+        nphi = std::atoi(argv[1]);
+        nz = std::atoi(argv[2]);
+        numSteps = std::atoi(argv[3]);
+    }
+
+    std::vector<Vector_t> points;
+    std::vector<Triangle_t> triangles;
+    makeTube(points, triangles, nphi, nz);
+
+    const double dt = 1e-9;
+    std::vector<Vector_t> R, P;
+    makeSteps(R, P, numSteps, dt);
+
+    std::cout << triangles.size() << " triangles, " << R.size() << " particle steps" << std::endl;
+    run("BVH", points, triangles, R, P, dt);
+    run("VOXEL", points, triangles, R, P, dt);
+
+    delete ippl;
+    delete gmsgALL;
+    delete gmsg;
+    return 0;
+}
@@ -0,0 +1,89 @@
+//
+// mergeTraces
+//   Merge the timer traces timing-trace-<rank>.json which are written by
+//   OPAL if the option TRACETIMERS is set into one file which can be
+//   opened with chrome://tracing or https://ui.perfetto.dev. Every rank
+//   is shown as a process, the threads of a rank as its threads.
+//
+//   usage: mergeTraces [-o output] trace-0.json trace-1.json ...
+//
+// Copyright (c) 2024, Paul Scherrer Institut, Villigen PSI, Switzerland
+// All rights reserved.
+//
+// This file is part of OPAL.
+//
+// OPAL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// You should have received a copy of the GNU General Public License
+// along with OPAL. If not, see <https://www.gnu.org/licenses/>.
+//
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    void printUsage(const char* name) {
+        std::cerr << "usage: " << name << " [-o output] trace-0.json trace-1.json ..." << std::endl;
+    }
+
+    // the per-rank files are JSON arrays with one event per line whose
+    // closing bracket may be missing
+    bool appendEvents(const std::string& fn, std::ostream& out, bool& first) {
+        std::ifstream in(fn);
+        if (!in) {
+            std::cerr << "can't open '" << fn << "'" << std::endl;
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t begin = line.find_first_not_of(" \t\r[");
+            size_t end = line.find_last_not_of(" \t\r,]");
+            if (begin == std::string::npos || end == std::string::npos || end < begin) continue;
+
+            out << (first ? "\n" : ",\n") << line.substr(begin, end - begin + 1);
+            first = false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string output = "timing-trace.json";
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++ i];
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream out(output);
+    if (!out) {
+        std::cerr << "can't open '" << output << "'" << std::endl;
+        return 1;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (const std::string& fn: inputs) {
+        if (!appendEvents(fn, out, first)) return 1;
+    }
+    out << "\n]}\n";
+
+    return 0;
+}